@@ -0,0 +1,74 @@
+#include <algorithm>
+#include "AudioLatencyController.h"
+
+//Weight of the newest latency measurement in the smoothed latency
+static const float g_latencySmoothing = 0.25f;
+//Ratio change for a latency error equal to the target latency
+static const float g_ratioGain = 0.01f;
+//Playback rate never goes further than 0.5% from the nominal rate
+static const float g_maxRatioDeviation = 0.005f;
+//Largest ratio change allowed between two writes
+static const float g_maxRatioStep = 0.0005f;
+
+CAudioLatencyController::CAudioLatencyController(unsigned int sampleRate)
+    : m_sampleRate(sampleRate)
+    , m_targetLatency(0)
+    , m_latency(0)
+    , m_underrunCount(0)
+{
+}
+
+void CAudioLatencyController::SetTargetLatency(unsigned int targetLatency)
+{
+	m_targetLatency = targetLatency;
+}
+
+void CAudioLatencyController::Reset()
+{
+	m_smoothedLatency = 0;
+	m_ratio = 1.0f;
+	m_latency = 0;
+	m_underrunCount = 0;
+}
+
+unsigned int CAudioLatencyController::Update(CSoundHandler* handler)
+{
+	m_underrunCount = handler->GetUnderrunCount();
+
+	int queuedSampleCount = handler->GetQueuedSampleCount();
+	if(queuedSampleCount < 0)
+	{
+		//Handler doesn't know how much it has queued, nothing to control
+		m_latency = 0;
+		return m_sampleRate;
+	}
+
+	//Queued sample count includes both channels
+	float latency = static_cast<float>(queuedSampleCount / 2) * 1000.f / static_cast<float>(m_sampleRate);
+	m_smoothedLatency += (latency - m_smoothedLatency) * g_latencySmoothing;
+	m_latency = static_cast<uint32>(m_smoothedLatency);
+
+	unsigned int targetLatency = m_targetLatency;
+	if(targetLatency == 0)
+	{
+		m_ratio = 1.0f;
+		return m_sampleRate;
+	}
+
+	//Play slightly faster when too much is queued, slightly slower when running dry
+	float error = (m_smoothedLatency - static_cast<float>(targetLatency)) / static_cast<float>(targetLatency);
+	float targetRatio = 1.0f + std::min(std::max(error * g_ratioGain, -g_maxRatioDeviation), g_maxRatioDeviation);
+	m_ratio += std::min(std::max(targetRatio - m_ratio, -g_maxRatioStep), g_maxRatioStep);
+
+	return static_cast<unsigned int>(static_cast<float>(m_sampleRate) * m_ratio + 0.5f);
+}
+
+uint32 CAudioLatencyController::GetLatency() const
+{
+	return m_latency;
+}
+
+uint32 CAudioLatencyController::GetUnderrunCount() const
+{
+	return m_underrunCount;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+#include "Types.h"
+#include "../tools/PsfPlayer/Source/SoundHandler.h"
+
+//Keeps the amount of audio queued in the sound handler around a target latency by
+//slightly speeding up or slowing down playback. The rate is changed in small steps
+//so that the pitch change stays inaudible.
+class CAudioLatencyController
+{
+public:
+	CAudioLatencyController(unsigned int);
+
+	void SetTargetLatency(unsigned int);
+
+	unsigned int Update(CSoundHandler*);
+	void Reset();
+
+	uint32 GetLatency() const;
+	uint32 GetUnderrunCount() const;
+
+private:
+	unsigned int m_sampleRate = 0;
+	std::atomic<unsigned int> m_targetLatency;
+
+	float m_smoothedLatency = 0;
+	float m_ratio = 1.0f;
+
+	std::atomic<uint32> m_latency;
+	std::atomic<uint32> m_underrunCount;
+};
@@ -0,0 +1,105 @@
+#include <cassert>
+#include <chrono>
+#include "AudioStream.h"
+
+CAudioStream::CAudioStream(CSoundHandler* handler, CAudioLatencyController& latencyController, unsigned int maxWriteSize)
+    : m_handler(handler)
+    , m_latencyController(latencyController)
+    , m_readPosition(0)
+    , m_writePosition(0)
+    , m_writeSize(maxWriteSize)
+    , m_overrunCount(0)
+    , m_threadDone(false)
+{
+	assert(m_handler != nullptr);
+	assert(maxWriteSize != 0);
+
+	//Ring size needs to be a power of 2 for positions to be able to wrap around
+	uint32 ringSize = 1;
+	while(ringSize < (maxWriteSize * MAX_BUFFERED_WRITES))
+	{
+		ringSize <<= 1;
+	}
+	m_ring.resize(ringSize);
+	m_ringMask = ringSize - 1;
+	m_writeBuffer.resize(maxWriteSize);
+
+	m_thread = std::thread([this]() { ThreadProc(); });
+}
+
+CAudioStream::~CAudioStream()
+{
+	m_threadDone = true;
+	m_thread.join();
+}
+
+void CAudioStream::SetWriteSize(unsigned int writeSize)
+{
+	assert((writeSize != 0) && (writeSize <= m_writeBuffer.size()));
+	m_writeSize = writeSize;
+}
+
+bool CAudioStream::Write(const int16* samples, unsigned int sampleCount)
+{
+	uint32 writePosition = m_writePosition.load(std::memory_order_relaxed);
+	uint32 readPosition = m_readPosition.load(std::memory_order_acquire);
+	uint32 bufferedCount = writePosition - readPosition;
+	if((bufferedCount + sampleCount) > (m_writeSize * MAX_BUFFERED_WRITES))
+	{
+		//Audio thread is falling behind, drop these samples instead of adding more latency
+		m_overrunCount++;
+		return false;
+	}
+	for(unsigned int i = 0; i < sampleCount; i++)
+	{
+		m_ring[(writePosition + i) & m_ringMask] = samples[i];
+	}
+	m_writePosition.store(writePosition + sampleCount, std::memory_order_release);
+	return true;
+}
+
+unsigned int CAudioStream::GetBufferedSampleCount() const
+{
+	uint32 readPosition = m_readPosition.load(std::memory_order_acquire);
+	uint32 writePosition = m_writePosition.load(std::memory_order_acquire);
+	return writePosition - readPosition;
+}
+
+uint32 CAudioStream::GetOverrunCount() const
+{
+	return m_overrunCount;
+}
+
+void CAudioStream::Read(int16* samples, unsigned int sampleCount)
+{
+	uint32 readPosition = m_readPosition.load(std::memory_order_relaxed);
+	for(unsigned int i = 0; i < sampleCount; i++)
+	{
+		samples[i] = m_ring[(readPosition + i) & m_ringMask];
+	}
+	m_readPosition.store(readPosition + sampleCount, std::memory_order_release);
+}
+
+void CAudioStream::ThreadProc()
+{
+	while(!m_threadDone)
+	{
+		unsigned int writeSize = m_writeSize;
+		uint32 readPosition = m_readPosition.load(std::memory_order_relaxed);
+		uint32 writePosition = m_writePosition.load(std::memory_order_acquire);
+		if((writePosition - readPosition) < writeSize)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		Read(m_writeBuffer.data(), writeSize);
+
+		if(m_handler->HasFreeBuffers())
+		{
+			m_handler->RecycleBuffers();
+		}
+		unsigned int sampleRate = m_latencyController.Update(m_handler);
+		m_handler->Write(m_writeBuffer.data(), writeSize, sampleRate);
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "Types.h"
+#include "../tools/PsfPlayer/Source/SoundHandler.h"
+#include "AudioLatencyController.h"
+
+//Hands rendered samples from the emulation thread over to an audio thread that
+//feeds the sound handler. Samples go through a single producer, single consumer
+//lock-free ring, the emulation thread never waits for the sound handler.
+class CAudioStream
+{
+public:
+	CAudioStream(CSoundHandler*, CAudioLatencyController&, unsigned int);
+	virtual ~CAudioStream();
+
+	void SetWriteSize(unsigned int);
+
+	bool Write(const int16*, unsigned int);
+
+	unsigned int GetBufferedSampleCount() const;
+	uint32 GetOverrunCount() const;
+
+private:
+	enum
+	{
+		//Number of write sizes that can be buffered before the producer starts dropping samples
+		MAX_BUFFERED_WRITES = 2,
+	};
+
+	void ThreadProc();
+	void Read(int16*, unsigned int);
+
+	CSoundHandler* m_handler = nullptr;
+	CAudioLatencyController& m_latencyController;
+
+	std::vector<int16> m_ring;
+	uint32 m_ringMask = 0;
+	std::atomic<uint32> m_readPosition;
+	std::atomic<uint32> m_writePosition;
+
+	std::atomic<unsigned int> m_writeSize;
+	std::atomic<uint32> m_overrunCount;
+	std::vector<int16> m_writeBuffer;
+
+	std::atomic<bool> m_threadDone;
+	std::thread m_thread;
+};
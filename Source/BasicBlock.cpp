@@ -1,5 +1,6 @@
 #include "BasicBlock.h"
 #include "MemStream.h"
+#include "make_unique.h"
 #include "offsetof_def.h"
 #include "MipsJitter.h"
 #include "Jitter_CodeGenFactory.h"
@@ -79,15 +80,12 @@ void CBasicBlock::Compile()
 
 	Framework::CMemStream stream;
 	{
-		static
-#ifdef AOT_BUILD_CACHE
-		    __declspec(thread)
-#endif
-		        CMipsJitter* jitter = nullptr;
-		if(jitter == nullptr)
+		//One jitter per thread, blocks can be compiled by many virtual machines at once
+		static thread_local std::unique_ptr<CMipsJitter> jitter;
+		if(!jitter)
 		{
 			Jitter::CCodeGen* codeGen = Jitter::CreateCodeGen();
-			jitter = new CMipsJitter(codeGen);
+			jitter = std::make_unique<CMipsJitter>(codeGen);
 
 			for(unsigned int i = 0; i < 4; i++)
 			{
@@ -100,7 +98,7 @@ void CBasicBlock::Compile()
 		jitter->GetCodeGen()->SetExternalSymbolReferencedHandler([&](auto symbol, auto offset, auto refType) { this->HandleExternalFunctionReference(symbol, offset, refType); });
 		jitter->SetStream(&stream);
 		jitter->Begin();
-		CompileRange(jitter);
+		CompileRange(jitter.get());
 		jitter->End();
 	}
 
@@ -1,14 +1,20 @@
 #include <algorithm>
 #include <stdexcept>
+#include <thread>
 #include <string.h>
 #include <assert.h>
 #include "CsoImageStream.h"
+#include "ThreadPool.h"
 #include "zlib.h"
 
 typedef uint32 uint32_le;
 typedef uint64 uint64_le;
 
 static const uint32 CSO_READ_BUFFER_SIZE = 256 * 1024;
+static const uint32 CSO_FRAME_CACHE_SIZE = 16 * 1024 * 1024;
+static const uint32 CSO_PREFETCH_SIZE = 512 * 1024;
+static const uint32 CSO_PREFETCH_JOB_SIZE = 64 * 1024;
+static const uint32 CSO_SEQUENTIAL_THRESHOLD = 2;
 
 struct CsoHeader
 {
@@ -21,12 +27,25 @@ struct CsoHeader
 	uint8 reserved[2];
 };
 
+static Framework::CThreadPool& GetDecompressionPool()
+{
+	//Shared by every stream, games can open several images (DVD layers, CD + DVD, etc.)
+	static Framework::CThreadPool pool(std::max<unsigned int>(std::thread::hardware_concurrency() / 2, 1));
+	return pool;
+}
+
 CCsoImageStream::CCsoImageStream(CStream* baseStream)
     : m_baseStream(baseStream)
     , m_readBuffer(nullptr)
-    , m_zlibBuffer(nullptr)
     , m_index(nullptr)
+    , m_frameCount(0)
     , m_position(0)
+    , m_maxCachedFrames(0)
+    , m_lastFrame(~0U)
+    , m_sequentialCount(0)
+    , m_prefetchEnd(0)
+    , m_prefetchFrameCount(0)
+    , m_pendingJobCount(0)
 {
 	if(baseStream == nullptr)
 	{
@@ -39,8 +58,12 @@ CCsoImageStream::CCsoImageStream(CStream* baseStream)
 
 CCsoImageStream::~CCsoImageStream()
 {
+	//Wait for pending decompression jobs before releasing anything
+	{
+		std::unique_lock<std::mutex> frameReadyLock(m_frameReadyMutex);
+		m_frameReadyCondition.wait(frameReadyLock, [this]() { return m_pendingJobCount == 0; });
+	}
 	delete[] m_readBuffer;
-	delete[] m_zlibBuffer;
 	delete[] m_index;
 }
 
@@ -87,6 +110,7 @@ void CCsoImageStream::ReadFileHeader()
 void CCsoImageStream::InitializeBuffers()
 {
 	uint32 numFrames = static_cast<uint32>((m_totalSize + m_frameSize - 1) / m_frameSize);
+	m_frameCount = numFrames;
 
 	// We might read a bit of alignment too, so be prepared.
 	if(m_frameSize + (1 << m_indexShift) < CSO_READ_BUFFER_SIZE)
@@ -97,8 +121,6 @@ void CCsoImageStream::InitializeBuffers()
 	{
 		m_readBuffer = new uint8[m_frameSize + (1 << m_indexShift)];
 	}
-	m_zlibBuffer = new uint8[m_frameSize + (1 << m_indexShift)];
-	m_zlibBufferFrame = numFrames;
 
 	const uint32 indexSize = numFrames + 1;
 	m_index = new uint32[indexSize];
@@ -106,6 +128,9 @@ void CCsoImageStream::InitializeBuffers()
 	{
 		throw std::runtime_error("Unable to read CSO index.");
 	}
+
+	m_prefetchFrameCount = std::max<uint32>(CSO_PREFETCH_SIZE / m_frameSize, 1);
+	m_maxCachedFrames = std::max<uint32>(CSO_FRAME_CACHE_SIZE / m_frameSize, m_prefetchFrameCount * 2);
 }
 
 void CCsoImageStream::Seek(int64 position, Framework::STREAM_SEEK_DIRECTION origin)
@@ -170,42 +195,52 @@ uint32 CCsoImageStream::ReadFromNextFrame(uint8* dest, uint64 maxBytes)
 	// This is how many bytes we will actually be reading from this frame.
 	const uint32 bytes = static_cast<uint32>(std::min(maxBytes, static_cast<uint64>(m_frameSize - offset)));
 
-	// Grab the index data for the frame we're about to read.
-	const bool compressed = (m_index[frame + 0] & 0x80000000) == 0;
-	const uint32 index0 = m_index[frame + 0] & 0x7FFFFFFF;
-	const uint32 index1 = m_index[frame + 1] & 0x7FFFFFFF;
-
 	// Calculate where the compressed payload is (if compressed.)
-	const uint64 frameRawPos = static_cast<uint64>(index0) << m_indexShift;
-	const uint64 frameRawSize = (index1 - index0) << m_indexShift;
+	const uint64 frameRawPos = GetFrameRawPos(frame);
+	const uint64 frameRawSize = GetFrameRawPos(frame + 1) - frameRawPos;
 
-	if(!compressed)
+	if(!IsFrameCompressed(frame))
 	{
 		// Just read directly, easy.
 		if(ReadBaseAt(frameRawPos + offset, dest, bytes) != bytes)
 		{
 			throw std::runtime_error("Unable to read uncompressed bytes from CSO.");
 		}
+		return bytes;
 	}
-	else
+
+	UpdateReadPattern(frame);
+
+	// We don't need to decompress if this frame was recently used or prefetched.
+	if(auto cachedFrame = FindFrame(frame))
 	{
-		// We don't need to decompress if we already did this same frame last time.
-		if(m_zlibBufferFrame != frame)
-		{
-			// This might be less bytes than frameRawSize in case of padding on the last frame.
-			// This is because the index positions must be aligned.
-			const uint64 readRawBytes = ReadBaseAt(frameRawPos, m_readBuffer, frameRawSize);
-			DecompressFrame(frame, readRawBytes);
-		}
+		memcpy(dest, cachedFrame->data.data() + offset, bytes);
+		return bytes;
+	}
+
+	// This might be less bytes than frameRawSize in case of padding on the last frame.
+	// This is because the index positions must be aligned.
+	const uint64 readRawBytes = ReadBaseAt(frameRawPos, m_readBuffer, frameRawSize);
 
-		// Now we just copy the offset data from the cache.
-		memcpy(dest, m_zlibBuffer + offset, bytes);
+	if((bytes == m_frameSize) && (m_sequentialCount >= CSO_SEQUENTIAL_THRESHOLD))
+	{
+		// Whole frame requested while streaming, it won't be read again soon,
+		// decompress directly in the destination buffer.
+		DecompressFrame(m_readBuffer, readRawBytes, dest);
+		return bytes;
 	}
 
+	auto newFrame = std::make_shared<FRAME>();
+	newFrame->data.resize(m_frameSize);
+	DecompressFrame(m_readBuffer, readRawBytes, newFrame->data.data());
+	newFrame->ready = true;
+	InsertFrame(frame, newFrame);
+
+	memcpy(dest, newFrame->data.data() + offset, bytes);
 	return bytes;
 }
 
-void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
+void CCsoImageStream::DecompressFrame(const uint8* src, uint64 srcSize, uint8* dest) const
 {
 	z_stream z;
 	z.zalloc = Z_NULL;
@@ -216,9 +251,9 @@ void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
 		throw std::runtime_error("Unable to initialize zlib for CSO decompression.");
 	}
 
-	z.next_in = m_readBuffer;
-	z.avail_in = static_cast<uint32>(readBufferSize);
-	z.next_out = m_zlibBuffer;
+	z.next_in = const_cast<Bytef*>(src);
+	z.avail_in = static_cast<uint32>(srcSize);
+	z.next_out = dest;
 	z.avail_out = m_frameSize;
 
 	int status = inflate(&z, Z_FINISH);
@@ -228,9 +263,6 @@ void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
 		throw std::runtime_error("Unable to decompress CSO frame using zlib.");
 	}
 	inflateEnd(&z);
-
-	// Our buffer now contains this frame.
-	m_zlibBufferFrame = frame;
 }
 
 uint64 CCsoImageStream::ReadBaseAt(uint64 pos, uint8* dest, uint64 bytes)
@@ -238,3 +270,148 @@ uint64 CCsoImageStream::ReadBaseAt(uint64 pos, uint8* dest, uint64 bytes)
 	m_baseStream->Seek(pos, Framework::STREAM_SEEK_SET);
 	return m_baseStream->Read(dest, bytes);
 }
+
+bool CCsoImageStream::IsFrameCompressed(uint32 frame) const
+{
+	return (m_index[frame] & 0x80000000) == 0;
+}
+
+uint64 CCsoImageStream::GetFrameRawPos(uint32 frame) const
+{
+	return static_cast<uint64>(m_index[frame] & 0x7FFFFFFF) << m_indexShift;
+}
+
+CCsoImageStream::FramePtr CCsoImageStream::FindFrame(uint32 frame)
+{
+	auto frameIterator = m_frameMap.find(frame);
+	if(frameIterator == std::end(m_frameMap))
+	{
+		return FramePtr();
+	}
+	m_frames.splice(std::begin(m_frames), m_frames, frameIterator->second);
+	auto result = m_frames.front().second;
+
+	// Frame might still be decompressing on the prefetch pool.
+	{
+		std::unique_lock<std::mutex> frameReadyLock(m_frameReadyMutex);
+		m_frameReadyCondition.wait(frameReadyLock, [&]() { return result->ready; });
+	}
+	if(result->failed)
+	{
+		throw std::runtime_error("Unable to decompress CSO frame using zlib.");
+	}
+	return result;
+}
+
+void CCsoImageStream::InsertFrame(uint32 frame, const FramePtr& framePtr)
+{
+	assert(m_frameMap.find(frame) == std::end(m_frameMap));
+	if(m_frames.size() >= m_maxCachedFrames)
+	{
+		m_frameMap.erase(m_frames.back().first);
+		m_frames.pop_back();
+	}
+	m_frames.emplace_front(frame, framePtr);
+	m_frameMap[frame] = std::begin(m_frames);
+}
+
+void CCsoImageStream::UpdateReadPattern(uint32 frame)
+{
+	if(frame == m_lastFrame)
+	{
+		return;
+	}
+	if(frame == (m_lastFrame + 1))
+	{
+		m_sequentialCount++;
+	}
+	else
+	{
+		m_sequentialCount = 0;
+	}
+	m_lastFrame = frame;
+
+	if(m_sequentialCount < CSO_SEQUENTIAL_THRESHOLD) return;
+
+	// Keep decompressed frames ahead of the read position.
+	if((m_prefetchEnd > frame) && ((m_prefetchEnd - frame) >= (m_prefetchFrameCount / 2))) return;
+
+	uint32 startFrame = std::max<uint32>(frame + 1, m_prefetchEnd);
+	uint32 endFrame = std::min<uint32>(frame + 1 + m_prefetchFrameCount, m_frameCount);
+	if(startFrame < endFrame)
+	{
+		PrefetchFrames(startFrame, endFrame);
+	}
+	m_prefetchEnd = endFrame;
+}
+
+void CCsoImageStream::PrefetchFrames(uint32 startFrame, uint32 endFrame)
+{
+	// Compressed data for the whole range is contiguous, read it with a single request
+	// on this thread (base stream isn't thread safe) and let the pool inflate the frames.
+	const uint64 rangeRawPos = GetFrameRawPos(startFrame);
+	const uint64 rangeRawSize = GetFrameRawPos(endFrame) - rangeRawPos;
+	auto rawData = std::make_shared<std::vector<uint8>>(rangeRawSize);
+	const uint64 readRawBytes = ReadBaseAt(rangeRawPos, rawData->data(), rangeRawSize);
+	rawData->resize(readRawBytes);
+
+	typedef std::pair<uint32, FramePtr> FrameJobItem;
+	std::vector<FrameJobItem> jobItems;
+	auto enqueueJob = [&]() {
+		if(jobItems.empty()) return;
+		{
+			std::lock_guard<std::mutex> frameReadyLock(m_frameReadyMutex);
+			m_pendingJobCount++;
+		}
+		GetDecompressionPool().Enqueue(
+		    [this, rawData, rangeRawPos, jobItems]() {
+			    for(const auto& jobItem : jobItems)
+			    {
+				    uint32 frame = jobItem.first;
+				    const auto& framePtr = jobItem.second;
+				    bool failed = false;
+				    try
+				    {
+					    uint64 srcPos = GetFrameRawPos(frame) - rangeRawPos;
+					    uint64 srcEnd = std::min<uint64>(GetFrameRawPos(frame + 1) - rangeRawPos, rawData->size());
+					    if(srcPos >= srcEnd)
+					    {
+						    throw std::runtime_error("Frame is out of bounds.");
+					    }
+					    DecompressFrame(rawData->data() + srcPos, srcEnd - srcPos, framePtr->data.data());
+				    }
+				    catch(...)
+				    {
+					    failed = true;
+				    }
+				    {
+					    std::lock_guard<std::mutex> frameReadyLock(m_frameReadyMutex);
+					    framePtr->failed = failed;
+					    framePtr->ready = true;
+				    }
+				    m_frameReadyCondition.notify_all();
+			    }
+			    //Stream can be destroyed as soon as this is seen, don't touch it afterwards
+			    std::lock_guard<std::mutex> frameReadyLock(m_frameReadyMutex);
+			    m_pendingJobCount--;
+			    m_frameReadyCondition.notify_all();
+		    });
+		jobItems.clear();
+	};
+
+	const uint32 framesPerJob = std::max<uint32>(CSO_PREFETCH_JOB_SIZE / m_frameSize, 1);
+	for(uint32 frame = startFrame; frame < endFrame; frame++)
+	{
+		if(!IsFrameCompressed(frame)) continue;
+		if(m_frameMap.find(frame) != std::end(m_frameMap)) continue;
+		auto framePtr = std::make_shared<FRAME>();
+		framePtr->data.resize(m_frameSize);
+		InsertFrame(frame, framePtr);
+		jobItems.emplace_back(frame, framePtr);
+		if(jobItems.size() == framesPerJob)
+		{
+			enqueueJob();
+		}
+	}
+	enqueueJob();
+}
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <list>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
 #include "Types.h"
 #include "Stream.h"
 
@@ -16,21 +22,50 @@ public:
 	virtual uint64 Write(const void* src, uint64 bytes) override;
 
 private:
+	struct FRAME
+	{
+		std::vector<uint8> data;
+		bool ready = false;
+		bool failed = false;
+	};
+	typedef std::shared_ptr<FRAME> FramePtr;
+	typedef std::list<std::pair<uint32, FramePtr>> FrameList;
+	typedef std::unordered_map<uint32, FrameList::iterator> FrameMap;
+
 	void ReadFileHeader();
 	void InitializeBuffers();
 	uint64 GetTotalSize() const;
 	uint32 ReadFromNextFrame(uint8* dest, uint64 maxBytes);
 	uint64 ReadBaseAt(uint64 pos, uint8* dest, uint64 bytes);
-	void DecompressFrame(uint32 frame, uint64 readBufferSize);
+	void DecompressFrame(const uint8* src, uint64 srcSize, uint8* dest) const;
+
+	bool IsFrameCompressed(uint32 frame) const;
+	uint64 GetFrameRawPos(uint32 frame) const;
+	FramePtr FindFrame(uint32 frame);
+	void InsertFrame(uint32 frame, const FramePtr&);
+	void UpdateReadPattern(uint32 frame);
+	void PrefetchFrames(uint32 startFrame, uint32 endFrame);
 
 	Framework::CStream* m_baseStream;
 	uint32 m_frameSize;
 	uint8 m_frameShift;
 	uint8 m_indexShift;
 	uint8* m_readBuffer;
-	uint8* m_zlibBuffer;
-	uint32 m_zlibBufferFrame;
 	uint32* m_index;
+	uint32 m_frameCount;
 	uint64 m_totalSize;
 	uint64 m_position;
+
+	//Decompressed frames, most recently used first
+	FrameList m_frames;
+	FrameMap m_frameMap;
+	uint32 m_maxCachedFrames;
+
+	uint32 m_lastFrame;
+	uint32 m_sequentialCount;
+	uint32 m_prefetchEnd;
+	uint32 m_prefetchFrameCount;
+	std::mutex m_frameReadyMutex;
+	std::condition_variable m_frameReadyCondition;
+	uint32 m_pendingJobCount;
 };
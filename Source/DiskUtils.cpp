@@ -6,6 +6,9 @@
 #include "DiskUtils.h"
 #include "IszImageStream.h"
 #include "CsoImageStream.h"
+#ifdef HAS_ZSTD
+#include "ZsiImageStream.h"
+#endif
 #include "MdsDiscImage.h"
 #include "StdStream.h"
 #include "StringUtils.h"
@@ -24,9 +27,10 @@
 #include "TargetConditionals.h"
 #endif
 
+static const char* s3ImagePathPrefix = "//s3/";
+
 static Framework::CStream* CreateImageStream(const fs::path& imagePath)
 {
-	static const char* s3ImagePathPrefix = "//s3/";
 	auto imagePathString = imagePath.string();
 	if(imagePathString.find(s3ImagePathPrefix) == 0)
 	{
@@ -50,6 +54,11 @@ static Framework::CStream* CreateImageStream(const fs::path& imagePath)
 #endif
 }
 
+static bool IsMappableImagePath(const fs::path& imagePath)
+{
+	return imagePath.string().find(s3ImagePathPrefix) != 0;
+}
+
 DiskUtils::OpticalMediaPtr DiskUtils::CreateOpticalMediaFromPath(const fs::path& imagePath)
 {
 	assert(!imagePath.empty());
@@ -66,6 +75,14 @@ DiskUtils::OpticalMediaPtr DiskUtils::CreateOpticalMediaFromPath(const fs::path&
 	{
 		stream = std::make_shared<CCsoImageStream>(CreateImageStream(imagePath));
 	}
+	else if(!stricmp(extension.c_str(), ".zsi"))
+	{
+#ifdef HAS_ZSTD
+		stream = std::make_shared<CZsiImageStream>(CreateImageStream(imagePath));
+#else
+		throw std::runtime_error("ZSI support was disabled during build configuration.");
+#endif
+	}
 	else if(!stricmp(extension.c_str(), ".mds"))
 	{
 		auto imageStream = std::unique_ptr<Framework::CStream>(CreateImageStream(imagePath));
@@ -76,7 +93,7 @@ DiskUtils::OpticalMediaPtr DiskUtils::CreateOpticalMediaFromPath(const fs::path&
 		imageDataPath.replace_extension("mdf");
 		auto imageDataStream = std::shared_ptr<Framework::CStream>(CreateImageStream(imageDataPath));
 
-		return std::unique_ptr<COpticalMedia>(COpticalMedia::CreateDvd(imageDataStream, discImage.IsDualLayer(), discImage.GetLayerBreak()));
+		return std::unique_ptr<COpticalMedia>(COpticalMedia::CreateDvd(imageDataStream, discImage.IsDualLayer(), discImage.GetLayerBreak(), imageDataPath));
 	}
 #ifdef _WIN32
 	else if(imagePath.string()[0] == '\\')
@@ -99,9 +116,14 @@ DiskUtils::OpticalMediaPtr DiskUtils::CreateOpticalMediaFromPath(const fs::path&
 #endif
 
 	//If it's null after all that, just feed it to a StdStream
+	//Those are plain image files that can also be memory mapped
 	if(!stream)
 	{
 		stream = std::shared_ptr<Framework::CStream>(CreateImageStream(imagePath));
+		if(IsMappableImagePath(imagePath))
+		{
+			return std::unique_ptr<COpticalMedia>(COpticalMedia::CreateAuto(stream, imagePath));
+		}
 	}
 
 	return std::unique_ptr<COpticalMedia>(COpticalMedia::CreateAuto(stream));
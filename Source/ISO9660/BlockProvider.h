@@ -16,6 +16,50 @@ namespace ISO9660
 
 		virtual ~CBlockProvider() = default;
 		virtual void ReadBlock(uint32, void*) = 0;
+
+		//Hint that blocks will be read soon, used to schedule asynchronous
+		//reads. Providers that don't read ahead ignore it.
+		virtual void PrefetchBlocks(uint32, uint32)
+		{
+		}
+
+		//Returns a pointer to the block's data if the provider has it
+		//directly accessible in memory, nullptr otherwise.
+		virtual const uint8* GetBlockPointer(uint32)
+		{
+			return nullptr;
+		}
+	};
+
+	class CBlockProviderOffset : public CBlockProvider
+	{
+	public:
+		typedef std::shared_ptr<CBlockProvider> BlockProviderPtr;
+
+		CBlockProviderOffset(const BlockProviderPtr& provider, uint32 offset)
+		    : m_provider(provider)
+		    , m_offset(offset)
+		{
+		}
+
+		void ReadBlock(uint32 address, void* block) override
+		{
+			m_provider->ReadBlock(address + m_offset, block);
+		}
+
+		void PrefetchBlocks(uint32 address, uint32 count) override
+		{
+			m_provider->PrefetchBlocks(address + m_offset, count);
+		}
+
+		const uint8* GetBlockPointer(uint32 address) override
+		{
+			return m_provider->GetBlockPointer(address + m_offset);
+		}
+
+	private:
+		BlockProviderPtr m_provider;
+		uint32 m_offset = 0;
 	};
 
 	class CBlockProvider2048 : public CBlockProvider
@@ -45,6 +89,12 @@ namespace ISO9660
 	public:
 		typedef std::shared_ptr<Framework::CStream> StreamPtr;
 
+		enum
+		{
+			INTERNAL_BLOCKSIZE = 0x930ULL,
+			BLOCKHEADER_SIZE = 0x18ULL
+		};
+
 		CBlockProviderCDROMXA(const StreamPtr& stream)
 		    : m_stream(stream)
 		{
@@ -57,12 +107,6 @@ namespace ISO9660
 		}
 
 	private:
-		enum
-		{
-			INTERNAL_BLOCKSIZE = 0x930ULL,
-			BLOCKHEADER_SIZE = 0x18ULL
-		};
-
 		StreamPtr m_stream;
 	};
 }
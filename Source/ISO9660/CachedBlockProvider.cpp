@@ -0,0 +1,214 @@
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <cinttypes>
+#include "CachedBlockProvider.h"
+#include "../Log.h"
+
+#define LOG_NAME "iso9660_cache"
+
+using namespace ISO9660;
+
+static uint64 GetElapsedMicroseconds(const std::chrono::steady_clock::time_point& startTime)
+{
+	auto elapsed = std::chrono::steady_clock::now() - startTime;
+	return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+CCachedBlockProvider::CCachedBlockProvider(const BlockProviderPtr& source)
+    : m_source(source)
+{
+	m_prefetchThread = std::thread([this]() { PrefetchThreadProc(); });
+}
+
+CCachedBlockProvider::~CCachedBlockProvider()
+{
+	{
+		std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+		m_prefetchThreadDone = true;
+	}
+	m_prefetchCondition.notify_all();
+	m_prefetchThread.join();
+
+	uint64 readCount = m_stats.hitCount + m_stats.missCount;
+	CLog::GetInstance().Print(LOG_NAME, "Hits: %" PRIu64 ", misses: %" PRIu64 " (%" PRIu64 "%% hit rate), prefetched blocks: %" PRIu64 ", failed prefetches: %" PRIu64 ".\r\n",
+	                          m_stats.hitCount, m_stats.missCount,
+	                          (readCount != 0) ? (m_stats.hitCount * 100) / readCount : 0,
+	                          m_stats.prefetchedBlockCount, m_stats.prefetchFailedCount);
+	CLog::GetInstance().Print(LOG_NAME, "Miss read time: %" PRIu64 "us total, %" PRIu64 "us max. Prefetch read time: %" PRIu64 "us total.\r\n",
+	                          m_stats.missReadTime, m_stats.maxMissReadTime, m_stats.prefetchReadTime);
+}
+
+void CCachedBlockProvider::ReadBlock(uint32 address, void* block)
+{
+	{
+		std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+		UpdateReadPattern(address);
+		if(auto entry = FindEntry(address))
+		{
+			memcpy(block, entry->data.data(), BLOCKSIZE);
+			m_stats.hitCount++;
+			return;
+		}
+		m_stats.missCount++;
+	}
+
+	auto startTime = std::chrono::steady_clock::now();
+	BlockData data;
+	{
+		std::lock_guard<std::mutex> sourceLock(m_sourceMutex);
+		//Prefetch thread might have brought the block in while we were waiting
+		bool cached = false;
+		{
+			std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+			if(auto entry = FindEntry(address))
+			{
+				data = entry->data;
+				cached = true;
+			}
+		}
+		if(!cached)
+		{
+			m_source->ReadBlock(address, data.data());
+		}
+	}
+	uint64 readTime = GetElapsedMicroseconds(startTime);
+
+	{
+		std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+		InsertEntry(address, data);
+		m_stats.missReadTime += readTime;
+		m_stats.maxMissReadTime = std::max(m_stats.maxMissReadTime, readTime);
+	}
+
+	memcpy(block, data.data(), BLOCKSIZE);
+}
+
+void CCachedBlockProvider::PrefetchBlocks(uint32 address, uint32 count)
+{
+	std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+	count = std::min<uint32>(count, MAX_PREFETCH_BLOCK_COUNT);
+	QueuePrefetch(address, count, true);
+	m_readAheadEnd = address + count;
+}
+
+CCachedBlockProvider::STATS CCachedBlockProvider::GetStats() const
+{
+	std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+	return m_stats;
+}
+
+const CCachedBlockProvider::CACHE_ENTRY* CCachedBlockProvider::FindEntry(uint32 address)
+{
+	auto entryIterator = m_entryMap.find(address);
+	if(entryIterator == std::end(m_entryMap)) return nullptr;
+	//Move to front of LRU list
+	m_entries.splice(std::begin(m_entries), m_entries, entryIterator->second);
+	return &m_entries.front();
+}
+
+void CCachedBlockProvider::InsertEntry(uint32 address, const BlockData& data)
+{
+	auto entryIterator = m_entryMap.find(address);
+	if(entryIterator != std::end(m_entryMap))
+	{
+		m_entries.splice(std::begin(m_entries), m_entries, entryIterator->second);
+	}
+	else if(m_entries.size() < CACHE_BLOCK_COUNT)
+	{
+		m_entries.emplace_front();
+	}
+	else
+	{
+		//Recycle least recently used entry
+		m_entryMap.erase(m_entries.back().address);
+		m_entries.splice(std::begin(m_entries), m_entries, std::prev(std::end(m_entries)));
+	}
+	auto& entry = m_entries.front();
+	entry.address = address;
+	entry.data = data;
+	m_entryMap[address] = std::begin(m_entries);
+}
+
+void CCachedBlockProvider::QueuePrefetch(uint32 address, uint32 count, bool urgent)
+{
+	if(count == 0) return;
+	if(urgent)
+	{
+		m_prefetchQueue.push_front(PrefetchRange(address, count));
+	}
+	else
+	{
+		m_prefetchQueue.push_back(PrefetchRange(address, count));
+	}
+	m_prefetchCondition.notify_one();
+}
+
+void CCachedBlockProvider::UpdateReadPattern(uint32 address)
+{
+	if(address == (m_lastReadAddress + 1))
+	{
+		m_sequentialCount++;
+	}
+	else
+	{
+		m_sequentialCount = 0;
+	}
+	m_lastReadAddress = address;
+
+	if(m_sequentialCount < SEQUENTIAL_THRESHOLD) return;
+
+	//Keep the read ahead window in front of the read position
+	if((m_readAheadEnd > address) && ((m_readAheadEnd - address) >= (READAHEAD_BLOCK_COUNT / 2))) return;
+
+	uint32 readAheadStart = std::max<uint32>(address + 1, m_readAheadEnd);
+	uint32 readAheadEnd = address + 1 + READAHEAD_BLOCK_COUNT;
+	QueuePrefetch(readAheadStart, readAheadEnd - readAheadStart, false);
+	m_readAheadEnd = readAheadEnd;
+}
+
+void CCachedBlockProvider::PrefetchThreadProc()
+{
+	while(1)
+	{
+		uint32 address = 0;
+		{
+			std::unique_lock<std::mutex> cacheLock(m_cacheMutex);
+			m_prefetchCondition.wait(cacheLock, [this]() { return m_prefetchThreadDone || !m_prefetchQueue.empty(); });
+			if(m_prefetchThreadDone) break;
+			auto& range = m_prefetchQueue.front();
+			address = range.first;
+			range.first++;
+			range.second--;
+			if(range.second == 0)
+			{
+				m_prefetchQueue.pop_front();
+			}
+			if(m_entryMap.find(address) != std::end(m_entryMap)) continue;
+		}
+
+		auto startTime = std::chrono::steady_clock::now();
+		BlockData data;
+		try
+		{
+			std::lock_guard<std::mutex> sourceLock(m_sourceMutex);
+			m_source->ReadBlock(address, data.data());
+		}
+		catch(const std::exception&)
+		{
+			//Not logged here, the block is read again when needed and the error surfaces to that reader
+			std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+			m_stats.prefetchFailedCount++;
+			m_prefetchQueue.clear();
+			continue;
+		}
+		uint64 readTime = GetElapsedMicroseconds(startTime);
+
+		{
+			std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+			InsertEntry(address, data);
+			m_stats.prefetchedBlockCount++;
+			m_stats.prefetchReadTime += readTime;
+		}
+	}
+}
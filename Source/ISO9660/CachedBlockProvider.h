@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <list>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "BlockProvider.h"
+
+namespace ISO9660
+{
+	//Keeps recently read sectors in memory and reads ahead of sequential
+	//access patterns on a background thread. All accesses to the source
+	//provider are serialized, so it can safely wrap a stream that isn't thread safe.
+	class CCachedBlockProvider : public CBlockProvider
+	{
+	public:
+		typedef std::shared_ptr<CBlockProvider> BlockProviderPtr;
+
+		struct STATS
+		{
+			uint64 hitCount = 0;
+			uint64 missCount = 0;
+			uint64 prefetchedBlockCount = 0;
+			uint64 prefetchFailedCount = 0;
+			uint64 missReadTime = 0; //In microseconds
+			uint64 maxMissReadTime = 0;
+			uint64 prefetchReadTime = 0;
+		};
+
+		CCachedBlockProvider(const BlockProviderPtr&);
+		virtual ~CCachedBlockProvider();
+
+		void ReadBlock(uint32, void*) override;
+		void PrefetchBlocks(uint32, uint32) override;
+
+		STATS GetStats() const;
+
+	private:
+		enum
+		{
+			CACHE_BLOCK_COUNT = 0x2000,
+			MAX_PREFETCH_BLOCK_COUNT = CACHE_BLOCK_COUNT / 4,
+			READAHEAD_BLOCK_COUNT = 0x100,
+			SEQUENTIAL_THRESHOLD = 4,
+		};
+
+		typedef std::array<uint8, BLOCKSIZE> BlockData;
+
+		struct CACHE_ENTRY
+		{
+			uint32 address = 0;
+			BlockData data;
+		};
+
+		typedef std::list<CACHE_ENTRY> EntryList;
+		typedef std::unordered_map<uint32, EntryList::iterator> EntryMap;
+		typedef std::pair<uint32, uint32> PrefetchRange;
+
+		const CACHE_ENTRY* FindEntry(uint32);
+		void InsertEntry(uint32, const BlockData&);
+		void QueuePrefetch(uint32, uint32, bool);
+		void UpdateReadPattern(uint32);
+		void PrefetchThreadProc();
+
+		BlockProviderPtr m_source;
+		std::mutex m_sourceMutex;
+
+		mutable std::mutex m_cacheMutex;
+		EntryList m_entries;
+		EntryMap m_entryMap;
+		STATS m_stats;
+
+		uint32 m_lastReadAddress = ~0U;
+		uint32 m_sequentialCount = 0;
+		uint32 m_readAheadEnd = 0;
+
+		std::deque<PrefetchRange> m_prefetchQueue;
+		std::condition_variable m_prefetchCondition;
+		std::thread m_prefetchThread;
+		bool m_prefetchThreadDone = false;
+	};
+}
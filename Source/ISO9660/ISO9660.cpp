@@ -1,5 +1,7 @@
 #include <string.h>
 #include <limits.h>
+#include <cctype>
+#include <algorithm>
 #include "ISO9660.h"
 #include "StdStream.h"
 #include "File.h"
@@ -21,6 +23,11 @@ CISO9660::~CISO9660()
 
 void CISO9660::ReadBlock(uint32 address, void* data)
 {
+	if(auto blockPtr = m_blockProvider->GetBlockPointer(address))
+	{
+		memcpy(data, blockPtr, CBlockProvider::BLOCKSIZE);
+		return;
+	}
 	//The buffer is needed to make sure exception handlers
 	//are properly called as some system calls (ie.: ReadFile)
 	//won't generate an exception when trying to write to
@@ -29,11 +36,26 @@ void CISO9660::ReadBlock(uint32 address, void* data)
 	memcpy(data, m_blockBuffer, CBlockProvider::BLOCKSIZE);
 }
 
+void CISO9660::PrefetchBlocks(uint32 address, uint32 count)
+{
+	m_blockProvider->PrefetchBlocks(address, count);
+}
+
 bool CISO9660::GetFileRecord(CDirectoryRecord* record, const char* filename)
 {
 	//Remove the first '/'
 	if(filename[0] == '/' || filename[0] == '\\') filename++;
 
+	auto filePath = NormalizePath(filename);
+	{
+		auto fileIterator = m_fileIndex.find(filePath);
+		if(fileIterator != std::end(m_fileIndex))
+		{
+			(*record) = fileIterator->second;
+			return true;
+		}
+	}
+
 	unsigned int recordIndex = m_pathTable.FindRoot();
 
 	while(1)
@@ -54,9 +76,84 @@ bool CISO9660::GetFileRecord(CDirectoryRecord* record, const char* filename)
 
 	unsigned int address = m_pathTable.GetDirectoryAddress(recordIndex);
 
+	if(m_indexedDirectories.find(address) == std::end(m_indexedDirectories))
+	{
+		auto directoryPath = filePath.substr(0, filePath.size() - NormalizePath(filename).size());
+		IndexDirectory(directoryPath, address);
+
+		auto fileIterator = m_fileIndex.find(filePath);
+		if(fileIterator != std::end(m_fileIndex))
+		{
+			(*record) = fileIterator->second;
+			return true;
+		}
+	}
+
+	//Not in the index, might still be found by the prefix match
 	return GetFileRecordFromDirectory(record, address, filename);
 }
 
+std::string CISO9660::NormalizePath(const char* path)
+{
+	std::string result(path);
+	for(auto& character : result)
+	{
+		character = toupper(static_cast<unsigned char>(character));
+	}
+	//Remove version number and empty extension of the file name ("FILE.;1" -> "FILE")
+	auto nameStart = result.rfind('/');
+	nameStart = (nameStart == std::string::npos) ? 0 : (nameStart + 1);
+	auto versionPos = result.find(';', nameStart);
+	if(versionPos != std::string::npos)
+	{
+		result.erase(versionPos);
+	}
+	if((result.size() > nameStart) && (result.back() == '.'))
+	{
+		result.pop_back();
+	}
+	return result;
+}
+
+void CISO9660::IndexDirectory(const std::string& directoryPath, uint32 address)
+{
+	m_indexedDirectories.insert(address);
+
+	uint64 directoryStart = static_cast<uint64>(address) * CBlockProvider::BLOCKSIZE;
+	CFile directory(m_blockProvider.get(), directoryStart);
+
+	//First record ("." entry) gives us the size of the directory extent
+	uint64 directorySize = CBlockProvider::BLOCKSIZE;
+	bool first = true;
+
+	while(1)
+	{
+		uint64 recordPosition = directory.Tell();
+		if(recordPosition >= directorySize) break;
+
+		CDirectoryRecord entry(&directory);
+		if(entry.GetLength() == 0)
+		{
+			//Records don't cross sector boundaries, rest of the sector is padding
+			uint64 nextBlockPosition = ((recordPosition / CBlockProvider::BLOCKSIZE) + 1) * CBlockProvider::BLOCKSIZE;
+			directory.Seek(nextBlockPosition, Framework::STREAM_SEEK_SET);
+			continue;
+		}
+
+		if(first)
+		{
+			directorySize = std::max<uint64>(entry.GetDataLength(), CBlockProvider::BLOCKSIZE);
+			first = false;
+			continue;
+		}
+
+		//Skip the ".." entry
+		if((entry.GetName()[0] == 0x00) || (entry.GetName()[0] == 0x01)) continue;
+
+		m_fileIndex.emplace(directoryPath + NormalizePath(entry.GetName()), entry);
+	}
+}
+
 bool CISO9660::GetFileRecordFromDirectory(CDirectoryRecord* record, uint32 address, const char* filename)
 {
 	CFile directory(m_blockProvider.get(), address * CBlockProvider::BLOCKSIZE);
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include "BlockProvider.h"
 #include "VolumeDescriptor.h"
 #include "PathTable.h"
@@ -15,16 +18,25 @@ public:
 	~CISO9660();
 
 	void ReadBlock(uint32, void*);
+	void PrefetchBlocks(uint32, uint32);
 
 	Framework::CStream* Open(const char*);
 	bool GetFileRecord(ISO9660::CDirectoryRecord*, const char*);
 
 private:
+	typedef std::unordered_map<std::string, ISO9660::CDirectoryRecord> FileIndex;
+
+	static std::string NormalizePath(const char*);
 	bool GetFileRecordFromDirectory(ISO9660::CDirectoryRecord*, uint32, const char*);
+	void IndexDirectory(const std::string&, uint32);
 
 	BlockProviderPtr m_blockProvider;
 	ISO9660::CVolumeDescriptor m_volumeDescriptor;
 	ISO9660::CPathTable m_pathTable;
 
+	//Lazily populated, one directory at a time, keyed by normalized path
+	FileIndex m_fileIndex;
+	std::unordered_set<uint32> m_indexedDirectories;
+
 	uint8 m_blockBuffer[ISO9660::CBlockProvider::BLOCKSIZE];
 };
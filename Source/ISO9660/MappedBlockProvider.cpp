@@ -0,0 +1,261 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include "MappedBlockProvider.h"
+#include "AlignedAlloc.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/vfs.h>
+#include <sys/sysmacros.h>
+#include <linux/magic.h>
+#else
+#include <sys/param.h>
+#include <sys/mount.h>
+#endif
+#endif
+
+using namespace ISO9660;
+
+//I/O errors on a mapping can't be reported to the reader, the process gets
+//SIGBUS (or an in-page exception) instead. Network and removable storage can
+//go away while the image is open, only map images on local fixed storage.
+#ifdef _WIN32
+static bool IsLocalFixedStorage(const fs::path& imagePath)
+{
+	wchar_t volumePath[MAX_PATH] = {};
+	if(!GetVolumePathNameW(imagePath.native().c_str(), volumePath, MAX_PATH)) return false;
+	UINT driveType = GetDriveTypeW(volumePath);
+	return (driveType == DRIVE_FIXED) || (driveType == DRIVE_RAMDISK);
+}
+#elif defined(__linux__)
+static bool IsLocalFixedStorage(int fd)
+{
+	struct statfs fsStat = {};
+	if(fstatfs(fd, &fsStat) != 0) return false;
+	switch(fsStat.f_type)
+	{
+	case EXT4_SUPER_MAGIC:
+	case XFS_SUPER_MAGIC:
+	case BTRFS_SUPER_MAGIC:
+	case F2FS_SUPER_MAGIC:
+	case TMPFS_MAGIC:
+		break;
+	default:
+		return false;
+	}
+	//Removable flag is on the disk, not on its partitions
+	struct stat fileStat = {};
+	if(fstat(fd, &fileStat) != 0) return false;
+	auto devicePath = fs::path("/sys/dev/block") / (std::to_string(major(fileStat.st_dev)) + ":" + std::to_string(minor(fileStat.st_dev)));
+	for(const auto& removablePath : {devicePath / "removable", devicePath / ".." / "removable"})
+	{
+		FILE* removableFile = fopen(removablePath.string().c_str(), "rb");
+		if(removableFile == nullptr) continue;
+		int removable = fgetc(removableFile);
+		fclose(removableFile);
+		return removable == '0';
+	}
+	//No block device behind it (tmpfs, btrfs subvolume), can't be removed
+	return true;
+}
+#else
+static bool IsLocalFixedStorage(int fd)
+{
+	struct statfs fsStat = {};
+	if(fstatfs(fd, &fsStat) != 0) return false;
+	if(!(fsStat.f_flags & MNT_LOCAL)) return false;
+#ifdef MNT_REMOVABLE
+	if(fsStat.f_flags & MNT_REMOVABLE) return false;
+#endif
+	return true;
+}
+#endif
+
+CMappedBlockProvider::CMappedBlockProvider(const fs::path& imagePath, uint32 blockStride, uint32 blockOffset)
+    : m_blockStride(blockStride)
+    , m_blockOffset(blockOffset)
+    , m_pageSize(framework_getpagesize())
+{
+	assert(m_blockStride >= BLOCKSIZE);
+#ifdef _WIN32
+	if(!IsLocalFixedStorage(imagePath))
+	{
+		throw std::runtime_error("Disc image isn't on local fixed storage, it won't be mapped.");
+	}
+	HANDLE file = CreateFileW(imagePath.native().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+	                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		throw std::runtime_error("Failed to open disc image for mapping.");
+	}
+	m_file = file;
+	LARGE_INTEGER fileSize = {};
+	if(!GetFileSizeEx(file, &fileSize) || (fileSize.QuadPart == 0) || (static_cast<uint64>(fileSize.QuadPart) > SIZE_MAX))
+	{
+		CloseHandle(file);
+		throw std::runtime_error("Disc image can't be mapped.");
+	}
+	m_size = fileSize.QuadPart;
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(mapping == NULL)
+	{
+		CloseHandle(file);
+		throw std::runtime_error("Failed to create disc image mapping.");
+	}
+	m_mapping = mapping;
+	m_data = reinterpret_cast<const uint8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if(m_data == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		throw std::runtime_error("Failed to map disc image.");
+	}
+#else
+	m_fd = open(imagePath.string().c_str(), O_RDONLY);
+	if(m_fd < 0)
+	{
+		throw std::runtime_error("Failed to open disc image for mapping.");
+	}
+	struct stat fileStat = {};
+	if((fstat(m_fd, &fileStat) != 0) || !S_ISREG(fileStat.st_mode) || (fileStat.st_size == 0) ||
+	   (static_cast<uint64>(fileStat.st_size) > SIZE_MAX))
+	{
+		close(m_fd);
+		throw std::runtime_error("Disc image can't be mapped.");
+	}
+	if(!IsLocalFixedStorage(m_fd))
+	{
+		close(m_fd);
+		throw std::runtime_error("Disc image isn't on local fixed storage, it won't be mapped.");
+	}
+	m_size = fileStat.st_size;
+	void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+	if(data == MAP_FAILED)
+	{
+		close(m_fd);
+		throw std::runtime_error("Failed to map disc image.");
+	}
+	m_data = reinterpret_cast<const uint8*>(data);
+#endif
+}
+
+CMappedBlockProvider::~CMappedBlockProvider()
+{
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_mapping);
+	CloseHandle(m_file);
+#else
+	munmap(const_cast<uint8*>(m_data), m_size);
+	close(m_fd);
+#endif
+}
+
+void CMappedBlockProvider::ReadBlock(uint32 address, void* block)
+{
+	if(auto blockPtr = GetBlockPointer(address))
+	{
+		memcpy(block, blockPtr, BLOCKSIZE);
+	}
+	else
+	{
+		//Out of bounds, behave like a read past the end of the stream
+		memset(block, 0, BLOCKSIZE);
+	}
+}
+
+const uint8* CMappedBlockProvider::GetBlockPointer(uint32 address)
+{
+	uint64 offset = 0;
+	uint64 size = 0;
+	if(!GetMappedRange(address, 1, offset, size) || (size != BLOCKSIZE))
+	{
+		return nullptr;
+	}
+	UpdateAccessPattern(address);
+	return m_data + offset;
+}
+
+void CMappedBlockProvider::PrefetchBlocks(uint32 address, uint32 count)
+{
+	uint64 offset = 0;
+	uint64 size = 0;
+	if(!GetMappedRange(address, count, offset, size)) return;
+	Advise(offset, size, ADVICE_WILLNEED);
+	m_readAheadEnd = address + count;
+}
+
+bool CMappedBlockProvider::GetMappedRange(uint32 address, uint32 count, uint64& offset, uint64& size) const
+{
+	uint64 startOffset = (static_cast<uint64>(address) * m_blockStride) + m_blockOffset;
+	if((count == 0) || (startOffset >= m_size)) return false;
+	uint64 endOffset = ((static_cast<uint64>(address) + count - 1) * m_blockStride) + m_blockOffset + BLOCKSIZE;
+	offset = startOffset;
+	size = std::min(endOffset, m_size) - startOffset;
+	return true;
+}
+
+void CMappedBlockProvider::UpdateAccessPattern(uint32 address)
+{
+	if(address == (m_lastReadAddress + 1))
+	{
+		m_sequentialCount++;
+	}
+	else if(address != m_lastReadAddress)
+	{
+		m_sequentialCount = 0;
+	}
+	m_lastReadAddress = address;
+
+	bool sequential = (m_sequentialCount >= SEQUENTIAL_THRESHOLD);
+	if(sequential != m_sequentialMode)
+	{
+		Advise(0, m_size, sequential ? ADVICE_SEQUENTIAL : ADVICE_NORMAL);
+		m_sequentialMode = sequential;
+	}
+
+	if(!sequential) return;
+
+	//Ask the OS to bring the next blocks in before we need them
+	if((m_readAheadEnd > address) && ((m_readAheadEnd - address) >= (READAHEAD_BLOCK_COUNT / 2))) return;
+	uint32 readAheadStart = std::max<uint32>(address + 1, m_readAheadEnd);
+	uint32 readAheadEnd = address + 1 + READAHEAD_BLOCK_COUNT;
+	uint64 offset = 0;
+	uint64 size = 0;
+	if(GetMappedRange(readAheadStart, readAheadEnd - readAheadStart, offset, size))
+	{
+		Advise(offset, size, ADVICE_WILLNEED);
+	}
+	m_readAheadEnd = readAheadEnd;
+}
+
+void CMappedBlockProvider::Advise(uint64 offset, uint64 size, ADVICE advice)
+{
+#ifndef _WIN32
+	uint64 pageStart = offset & ~(m_pageSize - 1);
+	uint64 pageEnd = offset + size;
+	int adviceValue = MADV_NORMAL;
+	switch(advice)
+	{
+	case ADVICE_SEQUENTIAL:
+		adviceValue = MADV_SEQUENTIAL;
+		break;
+	case ADVICE_WILLNEED:
+		adviceValue = MADV_WILLNEED;
+		break;
+	default:
+		break;
+	}
+	//Hints only, failure doesn't matter
+	madvise(const_cast<uint8*>(m_data + pageStart), pageEnd - pageStart, adviceValue);
+#endif
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "filesystem_def.h"
+#include "BlockProvider.h"
+
+namespace ISO9660
+{
+	//Maps the whole disc image in memory. Sectors are accessed directly from
+	//the mapping and the OS page cache acts as the sector cache.
+	class CMappedBlockProvider : public CBlockProvider
+	{
+	public:
+		CMappedBlockProvider(const fs::path&, uint32 blockStride = BLOCKSIZE, uint32 blockOffset = 0);
+		virtual ~CMappedBlockProvider();
+
+		void ReadBlock(uint32, void*) override;
+		const uint8* GetBlockPointer(uint32) override;
+		void PrefetchBlocks(uint32, uint32) override;
+
+	private:
+		enum
+		{
+			READAHEAD_BLOCK_COUNT = 0x200,
+			SEQUENTIAL_THRESHOLD = 4,
+		};
+
+		enum ADVICE
+		{
+			ADVICE_NORMAL,
+			ADVICE_SEQUENTIAL,
+			ADVICE_WILLNEED,
+		};
+
+		bool GetMappedRange(uint32, uint32, uint64&, uint64&) const;
+		void UpdateAccessPattern(uint32);
+		void Advise(uint64, uint64, ADVICE);
+
+		const uint8* m_data = nullptr;
+		uint64 m_size = 0;
+		uint32 m_blockStride = BLOCKSIZE;
+		uint32 m_blockOffset = 0;
+		uint64 m_pageSize = 0;
+
+		uint32 m_lastReadAddress = ~0U;
+		uint32 m_sequentialCount = 0;
+		uint32 m_readAheadEnd = 0;
+		bool m_sequentialMode = false;
+
+#ifdef _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#else
+		int m_fd = -1;
+#endif
+	};
+}
@@ -23,6 +23,7 @@ void CLog::Print(const char* logName, const char* format, ...)
 {
 #if defined(_DEBUG) && !defined(DISABLE_LOGGING)
 	if(!m_showPrints) return;
+	std::lock_guard<std::mutex> logsLock(m_logsMutex);
 	auto& logStream(GetLog(logName));
 	va_list args;
 	va_start(args, format);
@@ -35,6 +36,7 @@ void CLog::Print(const char* logName, const char* format, ...)
 void CLog::Warn(const char* logName, const char* format, ...)
 {
 #if defined(_DEBUG) && !defined(DISABLE_LOGGING)
+	std::lock_guard<std::mutex> logsLock(m_logsMutex);
 	auto& logStream(GetLog(logName));
 	va_list args;
 	va_start(args, format);
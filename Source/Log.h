@@ -2,6 +2,7 @@
 
 #include <string>
 #include <map>
+#include <mutex>
 #include "filesystem_def.h"
 #include "StdStream.h"
 #include "Singleton.h"
@@ -22,5 +23,6 @@ private:
 
 	fs::path m_logBasePath;
 	LogMapType m_logs;
+	std::mutex m_logsMutex;
 	bool m_showPrints = false;
 };
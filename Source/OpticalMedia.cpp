@@ -1,24 +1,25 @@
 #include <cassert>
 #include <cstring>
 #include "OpticalMedia.h"
+#include "ISO9660/MappedBlockProvider.h"
 
 #define DVD_LAYER_MAX_BLOCKS 2295104
 
-COpticalMedia* COpticalMedia::CreateAuto(StreamPtr& stream)
+COpticalMedia* COpticalMedia::CreateAuto(StreamPtr& stream, const fs::path& imagePath)
 {
 	auto result = new COpticalMedia();
 	//Simulate a disk with only one data track
+	BlockProviderPtr blockProvider;
 	try
 	{
-		auto blockProvider = std::make_shared<ISO9660::CBlockProvider2048>(stream);
-		result->m_fileSystem = std::make_unique<CISO9660>(blockProvider);
+		blockProvider = std::make_shared<ISO9660::CBlockProvider2048>(stream);
+		CISO9660 fileSystem(blockProvider);
 		result->m_track0DataType = TRACK_DATA_TYPE_MODE1_2048;
 	}
 	catch(...)
 	{
 		//Failed with block size 2048, try with CD-ROM XA
-		auto blockProvider = std::make_shared<ISO9660::CBlockProviderCDROMXA>(stream);
-		result->m_fileSystem = std::make_unique<CISO9660>(blockProvider);
+		blockProvider = std::make_shared<ISO9660::CBlockProviderCDROMXA>(stream);
 		result->m_track0DataType = TRACK_DATA_TYPE_MODE2_2352;
 	}
 
@@ -27,25 +28,35 @@ COpticalMedia* COpticalMedia::CreateAuto(StreamPtr& stream)
 		try
 		{
 			result->CheckDualLayerDvd(stream);
-			result->SetupSecondLayer(stream);
 		}
 		catch(...)
 		{
 			//Failed to check if we got a dual layer DVD (ex.: Couldn't get stream size of physical disc)
+			result->m_dvdIsDualLayer = false;
 		}
 	}
+
+	//Stream must not be accessed directly from now on, the cache reads from it on its own thread
+	result->SetupFileSystem(blockProvider, imagePath);
+	try
+	{
+		result->SetupSecondLayer();
+	}
+	catch(...)
+	{
+	}
 	return result;
 }
 
-COpticalMedia* COpticalMedia::CreateDvd(StreamPtr& stream, bool isDualLayer, uint32 secondLayerStart)
+COpticalMedia* COpticalMedia::CreateDvd(StreamPtr& stream, bool isDualLayer, uint32 secondLayerStart, const fs::path& imagePath)
 {
 	auto result = new COpticalMedia();
 	auto blockProvider = std::make_shared<ISO9660::CBlockProvider2048>(stream);
-	result->m_fileSystem = std::make_unique<CISO9660>(blockProvider);
 	result->m_track0DataType = TRACK_DATA_TYPE_MODE1_2048;
 	result->m_dvdIsDualLayer = isDualLayer;
 	result->m_dvdSecondLayerStart = secondLayerStart;
-	result->SetupSecondLayer(stream);
+	result->SetupFileSystem(blockProvider, imagePath);
+	result->SetupSecondLayer();
 	return result;
 }
 
@@ -65,6 +76,11 @@ CISO9660* COpticalMedia::GetFileSystemL1()
 	return m_fileSystemL1.get();
 }
 
+ISO9660::CCachedBlockProvider::STATS COpticalMedia::GetReadCacheStats() const
+{
+	return m_readCache ? m_readCache->GetStats() : ISO9660::CCachedBlockProvider::STATS();
+}
+
 bool COpticalMedia::GetDvdIsDualLayer() const
 {
 	return m_dvdIsDualLayer;
@@ -124,9 +140,48 @@ void COpticalMedia::CheckDualLayerDvd(const StreamPtr& stream)
 	assert(m_dvdSecondLayerStart != 0);
 }
 
-void COpticalMedia::SetupSecondLayer(const StreamPtr& stream)
+COpticalMedia::BlockProviderPtr COpticalMedia::CreateMappedBlockProvider(const fs::path& imagePath, TRACK_DATA_TYPE dataType)
+{
+	try
+	{
+		switch(dataType)
+		{
+		case TRACK_DATA_TYPE_MODE1_2048:
+			return std::make_shared<ISO9660::CMappedBlockProvider>(imagePath);
+		case TRACK_DATA_TYPE_MODE2_2352:
+			return std::make_shared<ISO9660::CMappedBlockProvider>(imagePath,
+			                                                       ISO9660::CBlockProviderCDROMXA::INTERNAL_BLOCKSIZE,
+			                                                       ISO9660::CBlockProviderCDROMXA::BLOCKHEADER_SIZE);
+		default:
+			return BlockProviderPtr();
+		}
+	}
+	catch(...)
+	{
+		//Mapping is not possible (ex.: address space too small, image on network or removable storage), we'll fallback to stream
+		return BlockProviderPtr();
+	}
+}
+
+void COpticalMedia::SetupFileSystem(const BlockProviderPtr& streamBlockProvider, const fs::path& imagePath)
+{
+	if(!imagePath.empty())
+	{
+		//The OS page cache already acts as a sector cache for mapped images
+		m_blockProvider = CreateMappedBlockProvider(imagePath, m_track0DataType);
+	}
+	if(!m_blockProvider)
+	{
+		m_readCache = std::make_shared<ISO9660::CCachedBlockProvider>(streamBlockProvider);
+		m_blockProvider = m_readCache;
+	}
+	m_fileSystem = std::make_unique<CISO9660>(m_blockProvider);
+}
+
+void COpticalMedia::SetupSecondLayer()
 {
 	if(!m_dvdIsDualLayer) return;
-	auto blockProvider = std::make_shared<ISO9660::CBlockProvider2048>(stream, GetDvdSecondLayerStart());
+	//Both layers share the same block provider (and read cache)
+	auto blockProvider = std::make_shared<ISO9660::CBlockProviderOffset>(m_blockProvider, GetDvdSecondLayerStart());
 	m_fileSystemL1 = std::make_unique<CISO9660>(blockProvider);
 }
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Stream.h"
+#include "filesystem_def.h"
 #include "ISO9660/ISO9660.h"
+#include "ISO9660/CachedBlockProvider.h"
 
 class COpticalMedia
 {
@@ -15,13 +17,15 @@ public:
 
 	typedef std::shared_ptr<Framework::CStream> StreamPtr;
 
-	static COpticalMedia* CreateAuto(StreamPtr&);
-	static COpticalMedia* CreateDvd(StreamPtr&, bool = false, uint32 = 0);
+	//If an image path is specified, the image file will be memory mapped if possible
+	static COpticalMedia* CreateAuto(StreamPtr&, const fs::path& = fs::path());
+	static COpticalMedia* CreateDvd(StreamPtr&, bool = false, uint32 = 0, const fs::path& = fs::path());
 
 	//TODO: Get Track Count
 	TRACK_DATA_TYPE GetTrackDataType(uint32) const;
 	CISO9660* GetFileSystem();
 	CISO9660* GetFileSystemL1();
+	ISO9660::CCachedBlockProvider::STATS GetReadCacheStats() const;
 
 	bool GetDvdIsDualLayer() const;
 	uint32 GetDvdSecondLayerStart() const;
@@ -30,13 +34,20 @@ private:
 	COpticalMedia() = default;
 
 	typedef std::unique_ptr<CISO9660> Iso9660Ptr;
+	typedef std::shared_ptr<ISO9660::CBlockProvider> BlockProviderPtr;
+	typedef std::shared_ptr<ISO9660::CCachedBlockProvider> CachedBlockProviderPtr;
 
 	void CheckDualLayerDvd(const StreamPtr&);
-	void SetupSecondLayer(const StreamPtr&);
+	static BlockProviderPtr CreateMappedBlockProvider(const fs::path&, TRACK_DATA_TYPE);
+
+	void SetupFileSystem(const BlockProviderPtr&, const fs::path&);
+	void SetupSecondLayer();
 
 	TRACK_DATA_TYPE m_track0DataType = TRACK_DATA_TYPE_MODE1_2048;
 	bool m_dvdIsDualLayer = false;
 	uint32 m_dvdSecondLayerStart = 0;
+	BlockProviderPtr m_blockProvider;
+	CachedBlockProviderPtr m_readCache;
 	Iso9660Ptr m_fileSystem;
 	Iso9660Ptr m_fileSystemL1;
 };
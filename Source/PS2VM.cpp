@@ -15,8 +15,8 @@
 #include "StdStreamUtils.h"
 #include "GZipStream.h"
 #include "states/MemoryStateFile.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "states/QuickStateFile.h"
+#include "states/StateArchive.h"
 #include "xml/Node.h"
 #include "xml/Writer.h"
 #include "xml/Parser.h"
@@ -52,6 +52,7 @@ CPS2VM::CPS2VM()
     , m_eeExecutionTicks(0)
     , m_iopExecutionTicks(0)
     , m_spuUpdateTicks(SPU_UPDATE_TICKS)
+    , m_audioLatencyController(DST_SAMPLE_RATE)
     , m_eeProfilerZone(CProfiler::GetInstance().RegisterZone("EE"))
     , m_iopProfilerZone(CProfiler::GetInstance().RegisterZone("IOP"))
     , m_spuProfilerZone(CProfiler::GetInstance().RegisterZone("SPU"))
@@ -90,9 +91,24 @@ CPS2VM::CPS2VM()
 
 	m_ee = std::make_unique<Ee::CSubSystem>(m_iop->m_ram, *iopOs);
 	m_OnRequestLoadExecutableConnection = m_ee->m_os->OnRequestLoadExecutable.Connect(std::bind(&CPS2VM::ReloadExecutable, this, std::placeholders::_1, std::placeholders::_2));
+	m_OnExecutableChangeConnection = m_ee->m_os->OnExecutableChange.Connect(std::bind(&CPS2VM::OnEeExecutableChange, this));
 
 	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_AUDIO_SPUBLOCKCOUNT, 100);
 	m_spuBlockCount = CAppConfig::GetInstance().GetPreferenceInteger(PREF_AUDIO_SPUBLOCKCOUNT);
+
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_AUDIO_OUTPUTTHREAD_ENABLED, false);
+
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_AUDIO_TARGETLATENCY, 0);
+	ReloadAudioTargetLatency();
+
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_RUNAHEAD_FRAMES, 0);
+	m_runAheadFrameCount = std::max(CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_RUNAHEAD_FRAMES), 0);
+
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_EE_LIBCHLE_ENABLED, false);
+	m_ee->SetLibcHleEnabled(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_EE_LIBCHLE_ENABLED));
+
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_EE_IPU_ASYNC_ENABLED, false);
+	m_ee->SetIpuAsyncEnabled(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_EE_IPU_ASYNC_ENABLED));
 }
 
 //////////////////////////////////////////////////
@@ -146,6 +162,26 @@ void CPS2VM::ReloadSpuBlockCount()
 		    auto spuBlockCount = CAppConfig::GetInstance().GetPreferenceInteger(PREF_AUDIO_SPUBLOCKCOUNT);
 		    assert(spuBlockCount <= BLOCK_COUNT);
 		    m_spuBlockCount = spuBlockCount;
+		    if(m_audioStream)
+		    {
+			    m_audioStream->SetWriteSize(BLOCK_SIZE * m_spuBlockCount);
+		    }
+	    });
+}
+
+void CPS2VM::ReloadAudioTargetLatency()
+{
+	//Controller reads this atomically, no need to go through the mailbox
+	auto targetLatency = std::max(CAppConfig::GetInstance().GetPreferenceInteger(PREF_AUDIO_TARGETLATENCY), 0);
+	m_audioLatencyController.SetTargetLatency(targetLatency);
+}
+
+void CPS2VM::ReloadRunAheadFrameCount()
+{
+	m_mailBox.SendCall(
+	    [this]() {
+		    m_runAheadFrameCount = std::max(CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_RUNAHEAD_FRAMES), 0);
+		    m_runAheadPending = false;
 	    });
 }
 
@@ -234,6 +270,10 @@ void CPS2VM::Destroy()
 {
 	m_mailBox.SendCall(std::bind(&CPS2VM::DestroyImpl, this));
 	m_thread.join();
+	if(m_saveStateThread.joinable())
+	{
+		m_saveStateThread.join();
+	}
 	DestroyVM();
 }
 
@@ -244,18 +284,33 @@ fs::path CPS2VM::GetStateDirectoryPath()
 
 fs::path CPS2VM::GenerateStatePath(unsigned int slot) const
 {
-	auto stateFileName = string_format("%s.st%d.zip", m_ee->m_os->GetExecutableName(), slot);
+	auto stateFileName = string_format("%s.st%d.bin", m_ee->m_os->GetExecutableName(), slot);
 	return GetStateDirectoryPath() / fs::path(stateFileName);
 }
 
+fs::path CPS2VM::FindStatePath(unsigned int slot) const
+{
+	//Use states saved by older versions if there's no state in the current format
+	auto statePath = GenerateStatePath(slot);
+	if(!fs::exists(statePath))
+	{
+		auto legacyStateFileName = string_format("%s.st%d.zip", m_ee->m_os->GetExecutableName(), slot);
+		auto legacyStatePath = GetStateDirectoryPath() / fs::path(legacyStateFileName);
+		if(fs::exists(legacyStatePath))
+		{
+			return legacyStatePath;
+		}
+	}
+	return statePath;
+}
+
 std::future<bool> CPS2VM::SaveState(const fs::path& statePath)
 {
 	auto promise = std::make_shared<std::promise<bool>>();
 	auto future = promise->get_future();
 	m_mailBox.SendCall(
 	    [this, promise, statePath]() {
-		    auto result = SaveVMState(statePath);
-		    promise->set_value(result);
+		    SaveVMState(statePath, promise);
 	    });
 	return future;
 }
@@ -288,6 +343,18 @@ CPS2VM::CPU_UTILISATION_INFO CPS2VM::GetCpuUtilisationInfo() const
 	return m_cpuUtilisation;
 }
 
+CPS2VM::AUDIO_STATS CPS2VM::GetAudioStats() const
+{
+	AUDIO_STATS stats;
+	stats.latency = m_audioLatencyController.GetLatency();
+	stats.underrunCount = m_audioLatencyController.GetUnderrunCount();
+	if(m_audioStream)
+	{
+		stats.overrunCount = m_audioStream->GetOverrunCount();
+	}
+	return stats;
+}
+
 #ifdef DEBUGGER_INCLUDED
 
 #define TAGS_SECTION_TAGS ("tags")
@@ -411,6 +478,8 @@ void CPS2VM::ResetVM()
 	m_spuUpdateTicks = SPU_UPDATE_TICKS;
 	m_currentSpuBlock = 0;
 
+	m_runAheadPending = false;
+
 	RegisterModulesInPadHandler();
 }
 
@@ -419,31 +488,52 @@ void CPS2VM::DestroyVM()
 	CDROM0_Reset();
 }
 
-bool CPS2VM::SaveVMState(const fs::path& statePath)
+void CPS2VM::SaveVMState(const fs::path& statePath, const StatePromisePtr& promise)
 {
 	if(m_ee->m_gs == NULL)
 	{
 		printf("PS2VM: GS Handler was not instancied. Cannot save state.\r\n");
-		return false;
+		promise->set_value(false);
+		return;
 	}
 
+	auto state = std::make_shared<CQuickState>();
 	try
 	{
-		auto stateStream = Framework::CreateOutputStdStream(statePath.native());
-		Framework::CZipArchiveWriter archive;
-
-		m_ee->SaveState(archive);
-		m_iop->SaveState(archive);
-		m_ee->m_gs->SaveState(archive);
-
-		archive.Write(stateStream);
+		SaveQuickState(*state);
 	}
 	catch(...)
 	{
-		return false;
+		promise->set_value(false);
+		return;
 	}
 
-	return true;
+	//Only one save can be in flight at a time
+	if(m_saveStateThread.joinable())
+	{
+		m_saveStateThread.join();
+	}
+
+	//Compression and disk I/O are done on another thread, the VM can resume right away
+	m_saveStateThread = std::thread(
+	    [state, statePath, promise]() {
+		    auto tempStatePath = statePath;
+		    tempStatePath += ".tmp";
+		    try
+		    {
+			    {
+				    auto stateStream = Framework::CreateOutputStdStream(tempStatePath.native());
+				    CQuickStateFile::Write(stateStream, *state);
+			    }
+			    fs::rename(tempStatePath, statePath);
+		    }
+		    catch(...)
+		    {
+			    promise->set_value(false);
+			    return;
+		    }
+		    promise->set_value(true);
+	    });
 }
 
 bool CPS2VM::LoadVMState(const fs::path& statePath)
@@ -457,19 +547,46 @@ bool CPS2VM::LoadVMState(const fs::path& statePath)
 	try
 	{
 		auto stateStream = Framework::CreateInputStdStream(statePath.native());
-		Framework::CZipArchiveReader archive(stateStream);
-
-		try
+		if(CQuickStateFile::IsQuickStateFile(stateStream))
 		{
-			m_ee->LoadState(archive);
-			m_iop->LoadState(archive);
-			m_ee->m_gs->LoadState(archive);
+			CQuickState state;
+			CQuickStateFile::Read(stateStream, state);
+
+			try
+			{
+				//Unlike run-ahead rollbacks, the loaded state has nothing in common with the
+				//code currently in memory. Drop all compiled blocks before loading memory.
+				m_ee->m_EE.m_executor->Reset();
+				m_ee->m_VU0.m_executor->Reset();
+				m_ee->m_VU1.m_executor->Reset();
+				m_iop->m_cpu.m_executor->Reset();
+				LoadQuickState(state);
+			}
+			catch(...)
+			{
+				//Any error that occurs in the previous block is critical
+				PauseImpl();
+				throw;
+			}
 		}
-		catch(...)
+		else
 		{
-			//Any error that occurs in the previous block is critical
-			PauseImpl();
-			throw;
+			//Older states were zip archives
+			Framework::CZipArchiveReader archive(stateStream);
+			CZipStateArchiveReader stateArchive(archive);
+
+			try
+			{
+				m_ee->LoadState(stateArchive);
+				m_iop->LoadState(stateArchive);
+				m_ee->m_gs->LoadState(stateArchive);
+			}
+			catch(...)
+			{
+				//Any error that occurs in the previous block is critical
+				PauseImpl();
+				throw;
+			}
 		}
 	}
 	catch(...)
@@ -482,6 +599,75 @@ bool CPS2VM::LoadVMState(const fs::path& statePath)
 	return true;
 }
 
+void CPS2VM::SaveQuickState(CQuickState& state)
+{
+	VM_TIMING_STATE timingState;
+	timingState.vblankTicks = m_vblankTicks;
+	timingState.inVblank = m_inVblank;
+	timingState.spuUpdateTicks = m_spuUpdateTicks;
+	timingState.eeExecutionTicks = m_eeExecutionTicks;
+	timingState.iopExecutionTicks = m_iopExecutionTicks;
+
+	state.BeginSave();
+	state.SaveMemory(&timingState, sizeof(VM_TIMING_STATE));
+	m_ee->SaveQuickState(state);
+	m_iop->SaveQuickState(state);
+	m_ee->m_gs->SaveQuickState(state);
+	state.EndSave();
+}
+
+void CPS2VM::LoadQuickState(CQuickState& state)
+{
+	VM_TIMING_STATE timingState;
+
+	state.BeginLoad();
+	state.LoadMemory(&timingState, sizeof(VM_TIMING_STATE));
+	m_ee->LoadQuickState(state);
+	m_iop->LoadQuickState(state);
+	m_ee->m_gs->LoadQuickState(state);
+	state.EndLoad();
+
+	m_vblankTicks = timingState.vblankTicks;
+	m_inVblank = timingState.inVblank;
+	m_spuUpdateTicks = timingState.spuUpdateTicks;
+	m_eeExecutionTicks = timingState.eeExecutionTicks;
+	m_iopExecutionTicks = timingState.iopExecutionTicks;
+}
+
+void CPS2VM::RunAhead()
+{
+	m_runAheadPending = false;
+
+	auto gs = m_ee->m_gs;
+	if(gs == nullptr) return;
+
+	try
+	{
+		SaveQuickState(m_runAheadState);
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to save run-ahead state: %s\n", exception.what());
+		return;
+	}
+
+	//Emulate the next frames using the input we just sampled. Only the last one is
+	//presented, audio produced during that time is thrown away.
+	m_runningAhead = true;
+	m_runAheadFramesDone = 0;
+	while(m_runAheadFramesDone < m_runAheadFrameCount)
+	{
+		bool lastFrame = (m_runAheadFramesDone == (m_runAheadFrameCount - 1));
+		gs->SetPresentEnabled(lastFrame);
+		ExecuteTimeSlice();
+	}
+	m_runningAhead = false;
+
+	//Get back to where we were. The real frame is drawn (render targets need to follow
+	//the real timeline), but OnVBlankStart won't present it.
+	LoadQuickState(m_runAheadState);
+}
+
 void CPS2VM::PauseImpl()
 {
 	m_nStatus = PAUSED;
@@ -518,6 +704,7 @@ void CPS2VM::CreateGsHandlerImpl(const CGSHandler::FactoryFunction& factoryFunct
 		delete gs;
 	}
 	m_OnNewFrameConnection = m_ee->m_gs->OnNewFrame.Connect(std::bind(&CPS2VM::OnGsNewFrame, this));
+	m_ee->m_gs->NotifyExecutableChanged(m_ee->m_os->GetExecutableName());
 }
 
 void CPS2VM::DestroyGsHandlerImpl()
@@ -544,6 +731,14 @@ void CPS2VM::DestroyPadHandlerImpl()
 void CPS2VM::CreateSoundHandlerImpl(const CSoundHandler::FactoryFunction& factoryFunction)
 {
 	m_soundHandler = factoryFunction();
+	m_audioLatencyController.Reset();
+	if(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_AUDIO_OUTPUTTHREAD_ENABLED))
+	{
+		m_audioStream = std::make_unique<CAudioStream>(m_soundHandler, m_audioLatencyController, BLOCK_SIZE * BLOCK_COUNT);
+		m_audioStream->SetWriteSize(BLOCK_SIZE * m_spuBlockCount);
+		//SPU is rendered on its own thread as well, which feeds the audio stream directly
+		m_iop->SetSpuRenderThreadEnabled(true);
+	}
 }
 
 CSoundHandler* CPS2VM::GetSoundHandler()
@@ -554,6 +749,8 @@ CSoundHandler* CPS2VM::GetSoundHandler()
 void CPS2VM::DestroySoundHandlerImpl()
 {
 	if(m_soundHandler == nullptr) return;
+	m_iop->SetSpuRenderThreadEnabled(false);
+	m_audioStream.reset();
 	delete m_soundHandler;
 	m_soundHandler = nullptr;
 }
@@ -581,6 +778,13 @@ void CPS2VM::OnGsNewFrame()
 #endif
 }
 
+void CPS2VM::OnEeExecutableChange()
+{
+	//Lets the GS handler load anything it keeps per title
+	if(m_ee->m_gs == nullptr) return;
+	m_ee->m_gs->NotifyExecutableChanged(m_ee->m_os->GetExecutableName());
+}
+
 void CPS2VM::UpdateEe()
 {
 #ifdef PROFILE
@@ -652,25 +856,28 @@ void CPS2VM::UpdateSpu()
 	CProfilerZone profilerZone(m_spuProfilerZone);
 #endif
 
-	unsigned int blockOffset = (BLOCK_SIZE * m_currentSpuBlock);
-	int16* samplesSpu0 = m_samples + blockOffset;
+	//Handler runs on the SPU render thread if it's enabled
+	bool runningAhead = m_runningAhead;
+	m_iop->RenderSpu(BLOCK_SIZE, DST_SAMPLE_RATE,
+	                 [this, runningAhead](const int16* samples, unsigned int sampleCount) {
+		                 //Keep SPU state going (IRQs, etc.) while running ahead but don't output anything
+		                 if(runningAhead) return;
+		                 OutputSpuSamples(samples, sampleCount);
+	                 });
+}
 
-	m_iop->m_spuCore0.Render(samplesSpu0, BLOCK_SIZE, DST_SAMPLE_RATE);
+void CPS2VM::OutputSpuSamples(const int16* samples, unsigned int sampleCount)
+{
+	assert(sampleCount == BLOCK_SIZE);
 
-	if(m_iop->m_spuCore1.IsEnabled())
+	if(m_audioStream)
 	{
-		int16 samplesSpu1[BLOCK_SIZE];
-		m_iop->m_spuCore1.Render(samplesSpu1, BLOCK_SIZE, DST_SAMPLE_RATE);
-
-		for(unsigned int i = 0; i < BLOCK_SIZE; i++)
-		{
-			int32 resultSample = static_cast<int32>(samplesSpu0[i]) + static_cast<int32>(samplesSpu1[i]);
-			resultSample = std::max<int32>(resultSample, SHRT_MIN);
-			resultSample = std::min<int32>(resultSample, SHRT_MAX);
-			samplesSpu0[i] = static_cast<int16>(resultSample);
-		}
+		//Sound handler is fed by the audio thread, samples are dropped if it's falling behind
+		m_audioStream->Write(samples, sampleCount);
+		return;
 	}
 
+	memcpy(m_samples + (BLOCK_SIZE * m_currentSpuBlock), samples, sizeof(int16) * sampleCount);
 	m_currentSpuBlock++;
 	if(m_currentSpuBlock == m_spuBlockCount)
 	{
@@ -680,7 +887,8 @@ void CPS2VM::UpdateSpu()
 			{
 				m_soundHandler->RecycleBuffers();
 			}
-			m_soundHandler->Write(m_samples, BLOCK_SIZE * m_spuBlockCount, DST_SAMPLE_RATE);
+			unsigned int sampleRate = m_audioLatencyController.Update(m_soundHandler);
+			m_soundHandler->Write(m_samples, BLOCK_SIZE * m_spuBlockCount, sampleRate);
 		}
 		m_currentSpuBlock = 0;
 	}
@@ -741,6 +949,103 @@ void CPS2VM::ReloadExecutable(const char* executablePath, const CPS2OS::Argument
 	m_ee->m_os->BootFromVirtualPath(executablePath, arguments);
 }
 
+void CPS2VM::ExecuteTimeSlice()
+{
+	if(m_spuUpdateTicks <= 0)
+	{
+		UpdateSpu();
+		m_spuUpdateTicks += SPU_UPDATE_TICKS;
+	}
+
+	//EE execution
+	{
+		//Check vblank stuff
+		if(m_vblankTicks <= 0)
+		{
+			m_inVblank = !m_inVblank;
+			if(m_inVblank)
+			{
+				m_vblankTicks += VBLANK_TICKS;
+				OnVBlankStart();
+			}
+			else
+			{
+				m_vblankTicks += ONSCREEN_TICKS;
+				OnVBlankEnd();
+			}
+		}
+
+		//EE CPU is 8 times faster than the IOP CPU
+		static const int tickStep = 4800;
+		m_eeExecutionTicks += tickStep;
+		m_iopExecutionTicks += tickStep / 8;
+
+		UpdateEe();
+		UpdateIop();
+	}
+}
+
+void CPS2VM::OnVBlankStart()
+{
+	m_ee->NotifyVBlankStart();
+	m_iop->NotifyVBlankStart();
+
+	//Real frames are presented unless the frames emulated ahead are shown instead
+	bool singleStepping = m_singleStepEe || m_singleStepIop || m_singleStepVu0 || m_singleStepVu1;
+	bool runAhead = !m_runningAhead && (m_runAheadFrameCount != 0) && !singleStepping;
+
+	if(m_ee->m_gs != NULL)
+	{
+#ifdef PROFILE
+		CProfilerZone profilerZone(m_gsSyncProfilerZone);
+#endif
+		if(!m_runningAhead)
+		{
+			m_ee->m_gs->SetPresentEnabled(!runAhead);
+		}
+		m_ee->m_gs->SetVBlank();
+	}
+
+	if(m_pad != NULL)
+	{
+		m_pad->Update(m_ee->m_ram);
+	}
+
+	if(m_runningAhead)
+	{
+		m_runAheadFramesDone++;
+		return;
+	}
+
+	m_runAheadPending = runAhead;
+
+	if(m_soundHandler != nullptr)
+	{
+		AudioStatsUpdated(GetAudioStats());
+	}
+
+#ifdef PROFILE
+	{
+		CProfiler::GetInstance().CountCurrentZone();
+		auto stats = CProfiler::GetStats();
+		ProfileFrameDone(stats);
+		CProfiler::Reset();
+	}
+
+	m_cpuUtilisation = CPU_UTILISATION_INFO();
+#endif
+}
+
+void CPS2VM::OnVBlankEnd()
+{
+	m_ee->NotifyVBlankEnd();
+	m_iop->NotifyVBlankEnd();
+	if(m_ee->m_gs != NULL)
+	{
+		m_ee->m_gs->ResetVBlank();
+	}
+}
+
 void CPS2VM::EmuThread()
 {
 	fesetround(FE_TOWARDZERO);
@@ -763,66 +1068,10 @@ void CPS2VM::EmuThread()
 		}
 		if(m_nStatus == RUNNING)
 		{
-			if(m_spuUpdateTicks <= 0)
+			ExecuteTimeSlice();
+			if(m_runAheadPending)
 			{
-				UpdateSpu();
-				m_spuUpdateTicks += SPU_UPDATE_TICKS;
-			}
-
-			//EE execution
-			{
-				//Check vblank stuff
-				if(m_vblankTicks <= 0)
-				{
-					m_inVblank = !m_inVblank;
-					if(m_inVblank)
-					{
-						m_vblankTicks += VBLANK_TICKS;
-						m_ee->NotifyVBlankStart();
-						m_iop->NotifyVBlankStart();
-
-						if(m_ee->m_gs != NULL)
-						{
-#ifdef PROFILE
-							CProfilerZone profilerZone(m_gsSyncProfilerZone);
-#endif
-							m_ee->m_gs->SetVBlank();
-						}
-
-						if(m_pad != NULL)
-						{
-							m_pad->Update(m_ee->m_ram);
-						}
-#ifdef PROFILE
-						{
-							CProfiler::GetInstance().CountCurrentZone();
-							auto stats = CProfiler::GetInstance().GetStats();
-							ProfileFrameDone(stats);
-							CProfiler::GetInstance().Reset();
-						}
-
-						m_cpuUtilisation = CPU_UTILISATION_INFO();
-#endif
-					}
-					else
-					{
-						m_vblankTicks += ONSCREEN_TICKS;
-						m_ee->NotifyVBlankEnd();
-						m_iop->NotifyVBlankEnd();
-						if(m_ee->m_gs != NULL)
-						{
-							m_ee->m_gs->ResetVBlank();
-						}
-					}
-				}
-
-				//EE CPU is 8 times faster than the IOP CPU
-				static const int tickStep = 4800;
-				m_eeExecutionTicks += tickStep;
-				m_iopExecutionTicks += tickStep / 8;
-
-				UpdateEe();
-				UpdateIop();
+				RunAhead();
 			}
 #ifdef DEBUGGER_INCLUDED
 			if(
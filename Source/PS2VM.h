@@ -13,7 +13,10 @@
 #include "ee/Ee_SubSystem.h"
 #include "iop/Iop_SubSystem.h"
 #include "../tools/PsfPlayer/Source/SoundHandler.h"
+#include "AudioStream.h"
+#include "AudioLatencyController.h"
 #include "FrameDump.h"
+#include "states/QuickState.h"
 #include "Profiler.h"
 
 class CPS2VM : public CVirtualMachine
@@ -28,10 +31,18 @@ public:
 		int32 iopIdleTicks = 0;
 	};
 
+	struct AUDIO_STATS
+	{
+		uint32 latency = 0;
+		uint32 underrunCount = 0;
+		uint32 overrunCount = 0;
+	};
+
 	typedef std::unique_ptr<Ee::CSubSystem> EeSubSystemPtr;
 	typedef std::unique_ptr<Iop::CSubSystem> IopSubSystemPtr;
 	typedef std::function<void(const CFrameDump&)> FrameDumpCallback;
 	typedef Framework::CSignal<void(const CProfiler::ZoneArray&)> ProfileFrameDoneSignal;
+	typedef Framework::CSignal<void(const AUDIO_STATS&)> AudioStatsUpdatedSignal;
 
 	CPS2VM();
 	virtual ~CPS2VM() = default;
@@ -65,9 +76,12 @@ public:
 	CSoundHandler* GetSoundHandler();
 	void DestroySoundHandler();
 	void ReloadSpuBlockCount();
+	void ReloadAudioTargetLatency();
+	void ReloadRunAheadFrameCount();
 
 	static fs::path GetStateDirectoryPath();
 	fs::path GenerateStatePath(unsigned int) const;
+	fs::path FindStatePath(unsigned int) const;
 
 	std::future<bool> SaveState(const fs::path&);
 	std::future<bool> LoadState(const fs::path&);
@@ -75,6 +89,7 @@ public:
 	void TriggerFrameDump(const FrameDumpCallback&);
 
 	CPU_UTILISATION_INFO GetCpuUtilisationInfo() const;
+	AUDIO_STATS GetAudioStats() const;
 
 #ifdef DEBUGGER_INCLUDED
 	std::string MakeDebugTagsPackagePath(const char*);
@@ -88,6 +103,7 @@ public:
 	IopSubSystemPtr m_iop;
 
 	ProfileFrameDoneSignal ProfileFrameDone;
+	AudioStatsUpdatedSignal AudioStatsUpdated;
 
 private:
 	typedef std::unique_ptr<COpticalMedia> OpticalMediaPtr;
@@ -95,7 +111,9 @@ private:
 	void CreateVM();
 	void ResetVM();
 	void DestroyVM();
-	bool SaveVMState(const fs::path&);
+	typedef std::shared_ptr<std::promise<bool>> StatePromisePtr;
+
+	void SaveVMState(const fs::path&, const StatePromisePtr&);
 	bool LoadVMState(const fs::path&);
 
 	void ReloadExecutable(const char*, const CPS2OS::ArgumentList&);
@@ -116,8 +134,18 @@ private:
 	void UpdateEe();
 	void UpdateIop();
 	void UpdateSpu();
+	void OutputSpuSamples(const int16*, unsigned int);
+
+	void ExecuteTimeSlice();
+	void OnVBlankStart();
+	void OnVBlankEnd();
+
+	void SaveQuickState(CQuickState&);
+	void LoadQuickState(CQuickState&);
+	void RunAhead();
 
 	void OnGsNewFrame();
+	void OnEeExecutableChange();
 
 	void CDROM0_SyncPath();
 	void CDROM0_Reset();
@@ -152,6 +180,27 @@ private:
 
 	OpticalMediaPtr m_cdrom0;
 
+	struct VM_TIMING_STATE
+	{
+		int vblankTicks = 0;
+		bool inVblank = false;
+		int spuUpdateTicks = 0;
+		int eeExecutionTicks = 0;
+		int iopExecutionTicks = 0;
+	};
+
+	//Saved states are compressed and written to disk by this thread
+	std::thread m_saveStateThread;
+
+	//Run-ahead parameters
+	//Machine is saved after each vblank start, emulated for the specified number of
+	//frames with only the last one being drawn and shown, then restored.
+	CQuickState m_runAheadState;
+	int m_runAheadFrameCount = 0;
+	int m_runAheadFramesDone = 0;
+	bool m_runAheadPending = false;
+	bool m_runningAhead = false;
+
 	//SPU update parameters
 	enum
 	{
@@ -167,6 +216,8 @@ private:
 	int m_currentSpuBlock = 0;
 	int m_spuBlockCount;
 	CSoundHandler* m_soundHandler = nullptr;
+	std::unique_ptr<CAudioStream> m_audioStream;
+	CAudioLatencyController m_audioLatencyController;
 
 	CProfiler::ZoneHandle m_eeProfilerZone = 0;
 	CProfiler::ZoneHandle m_iopProfilerZone = 0;
@@ -176,4 +227,5 @@ private:
 
 	CPS2OS::RequestLoadExecutableEvent::Connection m_OnRequestLoadExecutableConnection;
 	Framework::CSignal<void(uint32)>::Connection m_OnNewFrameConnection;
+	Framework::CSignal<void()>::Connection m_OnExecutableChangeConnection;
 };
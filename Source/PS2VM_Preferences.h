@@ -7,3 +7,10 @@
 #define PREF_PS2_MC1_DIRECTORY ("ps2.mc1.directory.v2")
 
 #define PREF_AUDIO_SPUBLOCKCOUNT ("audio.spublockcount")
+#define PREF_AUDIO_OUTPUTTHREAD_ENABLED ("audio.outputthread.enabled")
+#define PREF_AUDIO_TARGETLATENCY ("audio.targetlatency")
+
+#define PREF_PS2_RUNAHEAD_FRAMES ("ps2.runahead.frames")
+
+#define PREF_PS2_EE_LIBCHLE_ENABLED ("ps2.ee.libchle.enabled")
+#define PREF_PS2_EE_IPU_ASYNC_ENABLED ("ps2.ee.ipu.async.enabled")
@@ -1,28 +1,53 @@
 #include "Profiler.h"
 
+#include <algorithm>
 #include <cassert>
+#include <mutex>
+
+static std::mutex g_zoneNamesMutex;
+static std::vector<std::string> g_zoneNames;
+
+//Times from threads that have exited are kept until the next reset
+static std::mutex g_profilersMutex;
+static std::vector<CProfiler*> g_profilers;
+static std::vector<uint64> g_retiredZoneTimes;
 
 CProfiler::CProfiler()
 {
+	std::lock_guard<std::mutex> profilersLock(g_profilersMutex);
+	g_profilers.push_back(this);
 }
 
 CProfiler::~CProfiler()
 {
+	std::lock_guard<std::mutex> profilersLock(g_profilersMutex);
+	g_profilers.erase(std::find(g_profilers.begin(), g_profilers.end(), this));
+	if(g_retiredZoneTimes.size() < m_zones.size())
+	{
+		g_retiredZoneTimes.resize(m_zones.size());
+	}
+	for(size_t i = 0; i < m_zones.size(); i++)
+	{
+		g_retiredZoneTimes[i] += m_zones[i].totalTime;
+	}
+}
+
+CProfiler& CProfiler::GetInstance()
+{
+	static thread_local CProfiler profiler;
+	return profiler;
 }
 
 CProfiler::ZoneHandle CProfiler::RegisterZone(const char* name)
 {
 #ifdef PROFILE
-	for(unsigned int i = 0; i < m_zones.size(); i++)
+	std::lock_guard<std::mutex> zoneNamesLock(g_zoneNamesMutex);
+	for(unsigned int i = 0; i < g_zoneNames.size(); i++)
 	{
-		const auto& zone(m_zones[i]);
-		if(zone.name == name) return i;
+		if(g_zoneNames[i] == name) return i;
 	}
-	auto newZone = ZONE();
-	newZone.name = name;
-	newZone.totalTime = 0;
-	m_zones.push_back(newZone);
-	return static_cast<CProfiler::ZoneHandle>(m_zones.size() - 1);
+	g_zoneNames.push_back(name);
+	return static_cast<CProfiler::ZoneHandle>(g_zoneNames.size() - 1);
 #else
 	return 0;
 #endif
@@ -68,18 +93,45 @@ void CProfiler::ExitZone()
 	m_zoneStack.pop();
 }
 
-CProfiler::ZoneArray CProfiler::GetStats() const
+CProfiler::ZoneArray CProfiler::GetStats()
 {
-	assert(std::this_thread::get_id() == m_workThreadId);
-	return m_zones;
+	ZoneArray result;
+	{
+		std::lock_guard<std::mutex> zoneNamesLock(g_zoneNamesMutex);
+		result.resize(g_zoneNames.size());
+		for(size_t i = 0; i < g_zoneNames.size(); i++)
+		{
+			result[i].name = g_zoneNames[i];
+		}
+	}
+
+	std::lock_guard<std::mutex> profilersLock(g_profilersMutex);
+	for(size_t i = 0; i < g_retiredZoneTimes.size(); i++)
+	{
+		result[i].totalTime += g_retiredZoneTimes[i];
+	}
+	for(auto profiler : g_profilers)
+	{
+		std::lock_guard<std::mutex> zonesLock(profiler->m_zonesMutex);
+		for(size_t i = 0; i < profiler->m_zones.size(); i++)
+		{
+			result[i].totalTime += profiler->m_zones[i].totalTime;
+		}
+	}
+	return result;
 }
 
 void CProfiler::Reset()
 {
-	assert(std::this_thread::get_id() == m_workThreadId);
-	for(auto& zone : m_zones)
+	std::lock_guard<std::mutex> profilersLock(g_profilersMutex);
+	g_retiredZoneTimes.clear();
+	for(auto profiler : g_profilers)
 	{
-		zone.totalTime = 0;
+		std::lock_guard<std::mutex> zonesLock(profiler->m_zonesMutex);
+		for(auto& zone : profiler->m_zones)
+		{
+			zone.totalTime = 0;
+		}
 	}
 }
 
@@ -92,11 +144,30 @@ void CProfiler::SetWorkThread()
 
 void CProfiler::AddTimeToZone(ZoneHandle zoneHandle, uint64 timeNs)
 {
+	//Other threads read zones when gathering stats
+	std::lock_guard<std::mutex> zonesLock(m_zonesMutex);
+	if(zoneHandle >= m_zones.size())
+	{
+		SyncZones();
+	}
 	assert(m_zones.size() > zoneHandle);
 	auto& zone = m_zones[zoneHandle];
 	zone.totalTime += timeNs;
 }
 
+void CProfiler::SyncZones()
+{
+	//Zones are registered from any thread, pick up the ones this thread doesn't know about yet
+	std::lock_guard<std::mutex> zoneNamesLock(g_zoneNamesMutex);
+	for(size_t i = m_zones.size(); i < g_zoneNames.size(); i++)
+	{
+		auto newZone = ZONE();
+		newZone.name = g_zoneNames[i];
+		newZone.totalTime = 0;
+		m_zones.push_back(newZone);
+	}
+}
+
 //////////////////////////////////////////////////////////////////////////
 //CProfilerZone
 
@@ -1,14 +1,16 @@
 #pragma once
 
 #include <string>
+#include <mutex>
 #include <stack>
 #include <thread>
 #include <vector>
 #include <chrono>
-#include "Singleton.h"
 #include "Types.h"
 
-class CProfiler : public CSingleton<CProfiler>
+//Each thread gets its own profiler, zone handles are shared by all of them.
+//Stats are the sum of the times measured by every thread.
+class CProfiler
 {
 public:
 	typedef uint32 ZoneHandle;
@@ -25,6 +27,8 @@ public:
 	CProfiler();
 	virtual ~CProfiler();
 
+	static CProfiler& GetInstance();
+
 	ZoneHandle RegisterZone(const char*);
 
 	void CountCurrentZone();
@@ -32,8 +36,8 @@ public:
 	void EnterZone(ZoneHandle);
 	void ExitZone();
 
-	ZoneArray GetStats() const;
-	void Reset();
+	static ZoneArray GetStats();
+	static void Reset();
 
 	void SetWorkThread();
 
@@ -41,7 +45,9 @@ private:
 	typedef std::stack<ZoneHandle> ZoneStack;
 
 	void AddTimeToZone(ZoneHandle, uint64);
+	void SyncZones();
 
+	std::mutex m_zonesMutex;
 	ZoneArray m_zones;
 	ZoneStack m_zoneStack;
 	TimePoint m_currentTime;
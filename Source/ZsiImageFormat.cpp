@@ -0,0 +1,91 @@
+#include <stdexcept>
+#include "ZsiImageFormat.h"
+
+using namespace ZsiImage;
+
+static void Store32(uint8* bytes, uint32 value)
+{
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		bytes[i] = static_cast<uint8>(value >> (i * 8));
+	}
+}
+
+static void Store64(uint8* bytes, uint64 value)
+{
+	Store32(bytes + 0, static_cast<uint32>(value));
+	Store32(bytes + 4, static_cast<uint32>(value >> 32));
+}
+
+static uint32 Load32(const uint8* bytes)
+{
+	uint32 value = 0;
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		value |= static_cast<uint32>(bytes[i]) << (i * 8);
+	}
+	return value;
+}
+
+static uint64 Load64(const uint8* bytes)
+{
+	return static_cast<uint64>(Load32(bytes + 0)) | (static_cast<uint64>(Load32(bytes + 4)) << 32);
+}
+
+void ZsiImage::WriteHeader(Framework::CStream& stream, const HEADER& header)
+{
+	uint8 bytes[HEADER_SIZE];
+	Store32(bytes + 0x00, header.magic);
+	Store32(bytes + 0x04, header.version);
+	Store64(bytes + 0x08, header.totalSize);
+	Store32(bytes + 0x10, header.frameSize);
+	Store32(bytes + 0x14, header.frameCount);
+	Store64(bytes + 0x18, header.indexOffset);
+	Store32(bytes + 0x20, header.dictionarySize);
+	Store32(bytes + 0x24, header.reserved);
+	stream.Write(bytes, HEADER_SIZE);
+}
+
+HEADER ZsiImage::ReadHeader(Framework::CStream& stream)
+{
+	uint8 bytes[HEADER_SIZE];
+	if(stream.Read(bytes, HEADER_SIZE) != HEADER_SIZE)
+	{
+		throw std::runtime_error("Could not read full ZSI header.");
+	}
+	HEADER header;
+	header.magic = Load32(bytes + 0x00);
+	header.version = Load32(bytes + 0x04);
+	header.totalSize = Load64(bytes + 0x08);
+	header.frameSize = Load32(bytes + 0x10);
+	header.frameCount = Load32(bytes + 0x14);
+	header.indexOffset = Load64(bytes + 0x18);
+	header.dictionarySize = Load32(bytes + 0x20);
+	header.reserved = Load32(bytes + 0x24);
+	return header;
+}
+
+void ZsiImage::WriteIndex(Framework::CStream& stream, const std::vector<uint32>& frameSizes)
+{
+	std::vector<uint8> bytes(frameSizes.size() * 4);
+	for(size_t i = 0; i < frameSizes.size(); i++)
+	{
+		Store32(bytes.data() + (i * 4), frameSizes[i]);
+	}
+	stream.Write(bytes.data(), bytes.size());
+}
+
+std::vector<uint32> ZsiImage::ReadIndex(Framework::CStream& stream, uint32 frameCount)
+{
+	std::vector<uint8> bytes(static_cast<size_t>(frameCount) * 4);
+	if(stream.Read(bytes.data(), bytes.size()) != bytes.size())
+	{
+		throw std::runtime_error("Unable to read ZSI index.");
+	}
+	std::vector<uint32> frameSizes(frameCount);
+	for(size_t i = 0; i < frameSizes.size(); i++)
+	{
+		frameSizes[i] = Load32(bytes.data() + (i * 4));
+	}
+	return frameSizes;
+}
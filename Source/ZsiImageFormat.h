@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include "Types.h"
+#include "Stream.h"
+
+//Seekable zstd compressed disc image
+//Layout:
+//- HEADER
+//- Dictionary (optional, dictionarySize bytes)
+//- Frames, each independently compressed (stored as is if compression didn't help)
+//- Index: one uint32 per frame containing the stored size of the frame
+//All values are stored little-endian
+namespace ZsiImage
+{
+	enum
+	{
+		MAGIC = 0x3149535A, //'ZSI1'
+		VERSION = 1,
+		DEFAULT_FRAME_SIZE = 0x10000,
+		MAX_FRAME_SIZE = 0x1000000,
+		HEADER_SIZE = 0x28,
+	};
+
+	struct HEADER
+	{
+		uint32 magic;
+		uint32 version;
+		uint64 totalSize;
+		uint32 frameSize;
+		uint32 frameCount;
+		uint64 indexOffset;
+		uint32 dictionarySize;
+		uint32 reserved;
+	};
+
+	void WriteHeader(Framework::CStream&, const HEADER&);
+	HEADER ReadHeader(Framework::CStream&);
+
+	void WriteIndex(Framework::CStream&, const std::vector<uint32>&);
+	std::vector<uint32> ReadIndex(Framework::CStream&, uint32);
+}
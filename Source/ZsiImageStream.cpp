@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cassert>
+#include <zstd.h>
+#include "ZsiImageStream.h"
+
+using namespace ZsiImage;
+
+CZsiImageStream::CZsiImageStream(Framework::CStream* baseStream)
+    : m_baseStream(baseStream)
+{
+	if(baseStream == nullptr)
+	{
+		throw std::runtime_error("Null base stream supplied.");
+	}
+
+	try
+	{
+		ReadHeader();
+		ReadIndex();
+	}
+	catch(...)
+	{
+		ZSTD_freeDDict(m_dictionary);
+		delete m_baseStream;
+		throw;
+	}
+
+	m_context = ZSTD_createDCtx();
+	m_readBuffer.resize(ZSTD_compressBound(m_header.frameSize));
+}
+
+CZsiImageStream::~CZsiImageStream()
+{
+	ZSTD_freeDCtx(m_context);
+	ZSTD_freeDDict(m_dictionary);
+	delete m_baseStream;
+}
+
+void CZsiImageStream::Seek(int64 position, Framework::STREAM_SEEK_DIRECTION origin)
+{
+	switch(origin)
+	{
+	case Framework::STREAM_SEEK_CUR:
+		m_position += position;
+		break;
+	case Framework::STREAM_SEEK_SET:
+		m_position = position;
+		break;
+	case Framework::STREAM_SEEK_END:
+		m_position = m_header.totalSize + position;
+		break;
+	}
+}
+
+uint64 CZsiImageStream::Tell()
+{
+	return m_position;
+}
+
+bool CZsiImageStream::IsEOF()
+{
+	return m_position >= m_header.totalSize;
+}
+
+uint64 CZsiImageStream::Read(void* buffer, uint64 size)
+{
+	uint64 remaining = size;
+	uint8* dest = reinterpret_cast<uint8*>(buffer);
+
+	while((remaining != 0) && !IsEOF())
+	{
+		uint32 frame = static_cast<uint32>(m_position / m_header.frameSize);
+		uint32 offset = static_cast<uint32>(m_position % m_header.frameSize);
+		uint32 frameRawSize = GetFrameRawSize(frame);
+		uint32 bytes = static_cast<uint32>(std::min<uint64>(remaining, frameRawSize - offset));
+
+		if((offset == 0) && (bytes == frameRawSize) && (m_frameMap.find(frame) == std::end(m_frameMap)))
+		{
+			//Whole frame requested, decompress directly in the destination buffer
+			DecompressFrame(frame, dest);
+		}
+		else
+		{
+			const auto& frameData = GetFrame(frame);
+			memcpy(dest, frameData.data() + offset, bytes);
+		}
+
+		remaining -= bytes;
+		m_position += bytes;
+		dest += bytes;
+	}
+
+	return size - remaining;
+}
+
+uint64 CZsiImageStream::Write(const void*, uint64)
+{
+	throw std::runtime_error("Unable to write to ZSI image, read only.");
+}
+
+void CZsiImageStream::ReadHeader()
+{
+	m_baseStream->Seek(0, Framework::STREAM_SEEK_SET);
+	m_header = ZsiImage::ReadHeader(*m_baseStream);
+	if(m_header.magic != MAGIC)
+	{
+		throw std::runtime_error("Not a valid ZSI file.");
+	}
+	if(m_header.version != VERSION)
+	{
+		throw std::runtime_error("Unsupported ZSI version.");
+	}
+	if((m_header.frameSize == 0) || (m_header.frameSize > MAX_FRAME_SIZE))
+	{
+		throw std::runtime_error("Invalid ZSI frame size.");
+	}
+	uint64 frameCount = (m_header.totalSize + m_header.frameSize - 1) / m_header.frameSize;
+	if(frameCount != m_header.frameCount)
+	{
+		throw std::runtime_error("Invalid ZSI frame count.");
+	}
+
+	if(m_header.dictionarySize != 0)
+	{
+		std::vector<uint8> dictionary(m_header.dictionarySize);
+		if(m_baseStream->Read(dictionary.data(), dictionary.size()) != dictionary.size())
+		{
+			throw std::runtime_error("Unable to read ZSI dictionary.");
+		}
+		m_dictionary = ZSTD_createDDict(dictionary.data(), dictionary.size());
+		if(m_dictionary == nullptr)
+		{
+			throw std::runtime_error("Invalid ZSI dictionary.");
+		}
+	}
+}
+
+void CZsiImageStream::ReadIndex()
+{
+	m_baseStream->Seek(m_header.indexOffset, Framework::STREAM_SEEK_SET);
+	auto frameSizes = ZsiImage::ReadIndex(*m_baseStream, m_header.frameCount);
+
+	m_frameOffsets.resize(m_header.frameCount + 1);
+	m_frameOffsets[0] = HEADER_SIZE + m_header.dictionarySize;
+	for(uint32 i = 0; i < m_header.frameCount; i++)
+	{
+		if(frameSizes[i] > ZSTD_compressBound(m_header.frameSize))
+		{
+			throw std::runtime_error("Invalid ZSI frame size in index.");
+		}
+		m_frameOffsets[i + 1] = m_frameOffsets[i] + frameSizes[i];
+	}
+	if(m_frameOffsets[m_header.frameCount] > m_header.indexOffset)
+	{
+		throw std::runtime_error("ZSI index is out of bounds.");
+	}
+}
+
+uint32 CZsiImageStream::GetFrameRawSize(uint32 frame) const
+{
+	uint64 frameStart = static_cast<uint64>(frame) * m_header.frameSize;
+	return static_cast<uint32>(std::min<uint64>(m_header.frameSize, m_header.totalSize - frameStart));
+}
+
+const CZsiImageStream::FrameData& CZsiImageStream::GetFrame(uint32 frame)
+{
+	auto frameIterator = m_frameMap.find(frame);
+	if(frameIterator != std::end(m_frameMap))
+	{
+		m_frames.splice(std::begin(m_frames), m_frames, frameIterator->second);
+		return m_frames.front().second;
+	}
+
+	FrameData frameData;
+	if(m_frames.size() >= MAX_CACHED_FRAMES)
+	{
+		//Recycle least recently used frame
+		frameData = std::move(m_frames.back().second);
+		m_frameMap.erase(m_frames.back().first);
+		m_frames.pop_back();
+	}
+	frameData.resize(GetFrameRawSize(frame));
+	DecompressFrame(frame, frameData.data());
+
+	m_frames.emplace_front(frame, std::move(frameData));
+	m_frameMap[frame] = std::begin(m_frames);
+	return m_frames.front().second;
+}
+
+void CZsiImageStream::DecompressFrame(uint32 frame, uint8* dest)
+{
+	assert(frame < m_header.frameCount);
+	uint64 storedSize = m_frameOffsets[frame + 1] - m_frameOffsets[frame];
+	uint32 rawSize = GetFrameRawSize(frame);
+
+	m_baseStream->Seek(m_frameOffsets[frame], Framework::STREAM_SEEK_SET);
+	if(storedSize == rawSize)
+	{
+		//Frame is stored uncompressed
+		if(m_baseStream->Read(dest, rawSize) != rawSize)
+		{
+			throw std::runtime_error("Unable to read uncompressed bytes from ZSI image.");
+		}
+		return;
+	}
+
+	if(m_baseStream->Read(m_readBuffer.data(), storedSize) != storedSize)
+	{
+		throw std::runtime_error("Unable to read compressed bytes from ZSI image.");
+	}
+
+	size_t result = (m_dictionary != nullptr)
+	                    ? ZSTD_decompress_usingDDict(m_context, dest, rawSize, m_readBuffer.data(), storedSize, m_dictionary)
+	                    : ZSTD_decompressDCtx(m_context, dest, rawSize, m_readBuffer.data(), storedSize);
+	if(ZSTD_isError(result) || (result != rawSize))
+	{
+		throw std::runtime_error("Unable to decompress ZSI frame.");
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include "Types.h"
+#include "Stream.h"
+#include "ZsiImageFormat.h"
+
+struct ZSTD_DCtx_s;
+struct ZSTD_DDict_s;
+
+class CZsiImageStream : public Framework::CStream
+{
+public:
+	CZsiImageStream(Framework::CStream*);
+	virtual ~CZsiImageStream();
+
+	void Seek(int64, Framework::STREAM_SEEK_DIRECTION) override;
+	uint64 Tell() override;
+	uint64 Read(void*, uint64) override;
+	uint64 Write(const void*, uint64) override;
+	bool IsEOF() override;
+
+private:
+	enum
+	{
+		MAX_CACHED_FRAMES = 16,
+	};
+
+	typedef std::vector<uint8> FrameData;
+	typedef std::list<std::pair<uint32, FrameData>> FrameList;
+	typedef std::unordered_map<uint32, FrameList::iterator> FrameMap;
+
+	void ReadHeader();
+	void ReadIndex();
+	uint32 GetFrameRawSize(uint32) const;
+	const FrameData& GetFrame(uint32);
+	void DecompressFrame(uint32, uint8*);
+
+	Framework::CStream* m_baseStream = nullptr;
+	ZsiImage::HEADER m_header = {};
+	std::vector<uint64> m_frameOffsets;
+	std::vector<uint8> m_readBuffer;
+	ZSTD_DCtx_s* m_context = nullptr;
+	ZSTD_DDict_s* m_dictionary = nullptr;
+	FrameList m_frames;
+	FrameMap m_frameMap;
+	uint64 m_position = 0;
+};
@@ -0,0 +1,185 @@
+#include <cassert>
+#include <stdexcept>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <zstd.h>
+#include <zdict.h>
+#include "ZsiImageWriter.h"
+#include "ThreadPool.h"
+
+using namespace ZsiImage;
+
+//Dictionary samples are taken from sectors spread across the whole image
+static const uint32 g_dictionarySampleSize = 0x2000;
+static const uint32 g_dictionaryMaxSampleCount = 0x1000;
+
+void CZsiImageWriter::Write(Framework::CStream& input, Framework::CStream& output, const PARAMS& params)
+{
+	if((params.frameSize == 0) || (params.frameSize > MAX_FRAME_SIZE))
+	{
+		throw std::runtime_error("Invalid frame size.");
+	}
+
+	input.Seek(0, Framework::STREAM_SEEK_END);
+	uint64 totalSize = input.Tell();
+	input.Seek(0, Framework::STREAM_SEEK_SET);
+
+	uint64 frameCount = (totalSize + params.frameSize - 1) / params.frameSize;
+	if(frameCount > UINT32_MAX)
+	{
+		throw std::runtime_error("Image is too large for the selected frame size.");
+	}
+
+	Buffer dictionary;
+	if(params.trainDictionary)
+	{
+		dictionary = TrainDictionary(input, totalSize, params);
+	}
+
+	ZSTD_CDict* compressionDictionary = nullptr;
+	if(!dictionary.empty())
+	{
+		compressionDictionary = ZSTD_createCDict(dictionary.data(), dictionary.size(), params.compressionLevel);
+	}
+
+	HEADER header = {};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.totalSize = totalSize;
+	header.frameSize = params.frameSize;
+	header.frameCount = static_cast<uint32>(frameCount);
+	header.dictionarySize = static_cast<uint32>(dictionary.size());
+
+	output.Seek(0, Framework::STREAM_SEEK_SET);
+	WriteHeader(output, header);
+	if(!dictionary.empty())
+	{
+		output.Write(dictionary.data(), dictionary.size());
+	}
+
+	unsigned int threadCount = (params.threadCount != 0) ? params.threadCount : std::max<unsigned int>(std::thread::hardware_concurrency(), 1);
+	uint32 framesPerJob = 8;
+	uint32 framesPerBatch = threadCount * framesPerJob * 2;
+
+	std::vector<uint32> frameSizes;
+	frameSizes.reserve(header.frameCount);
+
+	std::vector<Buffer> rawFrames(framesPerBatch);
+	std::vector<Buffer> compressedFrames(framesPerBatch);
+	std::atomic<bool> failed(false);
+
+	for(uint32 batchStart = 0; batchStart < header.frameCount; batchStart += framesPerBatch)
+	{
+		uint32 batchFrameCount = std::min<uint32>(framesPerBatch, header.frameCount - batchStart);
+		for(uint32 i = 0; i < batchFrameCount; i++)
+		{
+			uint64 frameStart = static_cast<uint64>(batchStart + i) * params.frameSize;
+			uint32 frameRawSize = static_cast<uint32>(std::min<uint64>(params.frameSize, totalSize - frameStart));
+			auto& rawFrame = rawFrames[i];
+			rawFrame.resize(frameRawSize);
+			if(input.Read(rawFrame.data(), frameRawSize) != frameRawSize)
+			{
+				ZSTD_freeCDict(compressionDictionary);
+				throw std::runtime_error("Failed to read from input image.");
+			}
+		}
+
+		{
+			Framework::CThreadPool threadPool(threadCount);
+			for(uint32 jobStart = 0; jobStart < batchFrameCount; jobStart += framesPerJob)
+			{
+				uint32 jobEnd = std::min<uint32>(jobStart + framesPerJob, batchFrameCount);
+				threadPool.Enqueue(
+				    [&, jobStart, jobEnd]() {
+					    auto context = ZSTD_createCCtx();
+					    for(uint32 i = jobStart; i < jobEnd; i++)
+					    {
+						    const auto& rawFrame = rawFrames[i];
+						    auto& compressedFrame = compressedFrames[i];
+						    compressedFrame.resize(ZSTD_compressBound(rawFrame.size()));
+						    size_t result = (compressionDictionary != nullptr)
+						                        ? ZSTD_compress_usingCDict(context, compressedFrame.data(), compressedFrame.size(), rawFrame.data(), rawFrame.size(), compressionDictionary)
+						                        : ZSTD_compressCCtx(context, compressedFrame.data(), compressedFrame.size(), rawFrame.data(), rawFrame.size(), params.compressionLevel);
+						    if(ZSTD_isError(result))
+						    {
+							    failed = true;
+							    compressedFrame.clear();
+						    }
+						    else if(result >= rawFrame.size())
+						    {
+							    //Didn't compress, store as is
+							    compressedFrame = rawFrame;
+						    }
+						    else
+						    {
+							    compressedFrame.resize(result);
+						    }
+					    }
+					    ZSTD_freeCCtx(context);
+				    });
+			}
+		}
+
+		if(failed)
+		{
+			ZSTD_freeCDict(compressionDictionary);
+			throw std::runtime_error("Failed to compress frame.");
+		}
+
+		for(uint32 i = 0; i < batchFrameCount; i++)
+		{
+			const auto& compressedFrame = compressedFrames[i];
+			output.Write(compressedFrame.data(), compressedFrame.size());
+			frameSizes.push_back(static_cast<uint32>(compressedFrame.size()));
+		}
+
+		if(params.progressCallback)
+		{
+			uint64 processed = std::min<uint64>(static_cast<uint64>(batchStart + batchFrameCount) * params.frameSize, totalSize);
+			params.progressCallback(processed, totalSize);
+		}
+	}
+
+	ZSTD_freeCDict(compressionDictionary);
+
+	header.indexOffset = output.Tell();
+	WriteIndex(output, frameSizes);
+
+	output.Seek(0, Framework::STREAM_SEEK_SET);
+	WriteHeader(output, header);
+}
+
+CZsiImageWriter::Buffer CZsiImageWriter::TrainDictionary(Framework::CStream& input, uint64 totalSize, const PARAMS& params)
+{
+	uint64 sampleSlotCount = totalSize / g_dictionarySampleSize;
+	uint32 sampleCount = static_cast<uint32>(std::min<uint64>(sampleSlotCount, g_dictionaryMaxSampleCount));
+	if(sampleCount == 0)
+	{
+		return Buffer();
+	}
+
+	Buffer samples(static_cast<size_t>(sampleCount) * g_dictionarySampleSize);
+	std::vector<size_t> sampleSizes(sampleCount, g_dictionarySampleSize);
+	uint64 sampleStride = sampleSlotCount / sampleCount;
+	for(uint32 i = 0; i < sampleCount; i++)
+	{
+		input.Seek(i * sampleStride * g_dictionarySampleSize, Framework::STREAM_SEEK_SET);
+		if(input.Read(samples.data() + (i * g_dictionarySampleSize), g_dictionarySampleSize) != g_dictionarySampleSize)
+		{
+			throw std::runtime_error("Failed to read dictionary samples from input image.");
+		}
+	}
+	input.Seek(0, Framework::STREAM_SEEK_SET);
+
+	Buffer dictionary(params.maxDictionarySize);
+	size_t dictionarySize = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), samples.data(), sampleSizes.data(), sampleCount);
+	if(ZDICT_isError(dictionarySize))
+	{
+		//Not enough variety in samples, go on without a dictionary
+		return Buffer();
+	}
+	dictionary.resize(dictionarySize);
+	return dictionary;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "Stream.h"
+#include "ZsiImageFormat.h"
+
+class CZsiImageWriter
+{
+public:
+	typedef std::function<void(uint64, uint64)> ProgressCallback;
+
+	struct PARAMS
+	{
+		uint32 frameSize = ZsiImage::DEFAULT_FRAME_SIZE;
+		int compressionLevel = 19;
+		bool trainDictionary = false;
+		uint32 maxDictionarySize = 0x1C000;
+		unsigned int threadCount = 0; //0 means one thread per hardware thread
+		ProgressCallback progressCallback;
+	};
+
+	static void Write(Framework::CStream& input, Framework::CStream& output, const PARAMS&);
+
+private:
+	typedef std::vector<uint8> Buffer;
+
+	static Buffer TrainDictionary(Framework::CStream&, uint64, const PARAMS&);
+};
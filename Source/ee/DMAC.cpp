@@ -886,7 +886,7 @@ void CDMAC::SetRegister(uint32 nAddress, uint32 nData)
 #endif
 }
 
-void CDMAC::LoadState(Framework::CZipArchiveReader& archive)
+void CDMAC::LoadState(CStateArchiveReader& archive)
 {
 	CRegisterStateFile registerFile(*archive.BeginReadFile(STATE_REGS_XML));
 	m_D_CTRL <<= registerFile.GetRegister32(STATE_REGS_CTRL);
@@ -908,7 +908,7 @@ void CDMAC::LoadState(Framework::CZipArchiveReader& archive)
 	m_D9.LoadState(archive);
 }
 
-void CDMAC::SaveState(Framework::CZipArchiveWriter& archive)
+void CDMAC::SaveState(CStateArchiveWriter& archive)
 {
 	CRegisterStateFile* registerFile = new CRegisterStateFile(STATE_REGS_XML);
 	registerFile->SetRegister32(STATE_REGS_CTRL, m_D_CTRL);
@@ -1,8 +1,7 @@
 #pragma once
 
 #include "Types.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 #include "Dmac_Channel.h"
 
 class CMIPS;
@@ -104,8 +103,8 @@ public:
 	uint32 GetRegister(uint32);
 	void SetRegister(uint32, uint32);
 
-	void LoadState(Framework::CZipArchiveReader&);
-	void SaveState(Framework::CZipArchiveWriter&);
+	void LoadState(CStateArchiveReader&);
+	void SaveState(CStateArchiveWriter&);
 
 	void DisassembleGet(uint32);
 	void DisassembleSet(uint32, uint32);
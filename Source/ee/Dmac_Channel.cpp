@@ -39,7 +39,7 @@ void CChannel::Reset()
 	m_nASR[1] = 0;
 }
 
-void CChannel::SaveState(Framework::CZipArchiveWriter& archive)
+void CChannel::SaveState(CStateArchiveWriter& archive)
 {
 	auto path = string_format(STATE_REGS_XML_FORMAT, m_number);
 	CRegisterStateFile* registerFile = new CRegisterStateFile(path.c_str());
@@ -53,7 +53,7 @@ void CChannel::SaveState(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(registerFile);
 }
 
-void CChannel::LoadState(Framework::CZipArchiveReader& archive)
+void CChannel::LoadState(CStateArchiveReader& archive)
 {
 	auto path = string_format(STATE_REGS_XML_FORMAT, m_number);
 	CRegisterStateFile registerFile(*archive.BeginReadFile(path.c_str()));
@@ -3,8 +3,7 @@
 #include "Types.h"
 #include <functional>
 #include "Convertible.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 class CDMAC;
 
@@ -67,8 +66,8 @@ namespace Dmac
 		CChannel(CDMAC&, unsigned int, const DmaReceiveHandler&);
 		virtual ~CChannel() = default;
 
-		void SaveState(Framework::CZipArchiveWriter&);
-		void LoadState(Framework::CZipArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
 
 		void Reset();
 		uint32 ReadCHCR();
@@ -1,6 +1,9 @@
 #include "EeExecutor.h"
+#include "EeLibcHleBasicBlock.h"
 #include "../Ps2Const.h"
 #include "AlignedAlloc.h"
+#include <atomic>
+#include <stdexcept>
 #include <zlib.h>
 
 #if defined(__unix__) || defined(__ANDROID__) || defined(__APPLE__)
@@ -30,19 +33,36 @@
 
 #endif
 
-static CEeExecutor* g_eeExecutor = nullptr;
+//Executors of all running virtual machines, the fault handler routes faults to the
+//executor owning the faulting address. Slots are lock-free since they're read from
+//inside the signal handler.
+#define MAX_EE_EXECUTORS (64)
+static std::atomic<CEeExecutor*> g_eeExecutors[MAX_EE_EXECUTORS];
 
 CEeExecutor::CEeExecutor(CMIPS& context, uint8* ram)
     : CGenericMipsExecutor(context, 0x20000000)
     , m_ram(ram)
+    , m_libcHle(context, ram)
 {
 	m_pageSize = framework_getpagesize();
 }
 
 void CEeExecutor::AddExceptionHandler()
 {
-	assert(g_eeExecutor == nullptr);
-	g_eeExecutor = this;
+	bool registered = false;
+	for(auto& executorSlot : g_eeExecutors)
+	{
+		CEeExecutor* emptySlot = nullptr;
+		if(executorSlot.compare_exchange_strong(emptySlot, this))
+		{
+			registered = true;
+			break;
+		}
+	}
+	if(!registered)
+	{
+		throw std::runtime_error("Too many EE executors running at once.");
+	}
 
 #ifdef DISABLE_PROTECTION
 	return;
@@ -90,7 +110,14 @@ void CEeExecutor::RemoveExceptionHandler()
 
 #endif //!DISABLE_PROTECTION
 
-	g_eeExecutor = nullptr;
+	for(auto& executorSlot : g_eeExecutors)
+	{
+		CEeExecutor* thisExecutor = this;
+		if(executorSlot.compare_exchange_strong(thisExecutor, nullptr))
+		{
+			break;
+		}
+	}
 }
 
 void CEeExecutor::Reset()
@@ -130,6 +157,16 @@ BasicBlockPtr CEeExecutor::BlockFactory(CMIPS& context, uint32 start, uint32 end
 	uint32 checksum = crc32(0, reinterpret_cast<Bytef*>(blockMemory), blockSize);
 
 	bool hasBreakpoint = m_context.HasBreakpointInRange(start, end);
+
+#if !defined(AOT_BUILD_CACHE) && !defined(AOT_USE_CACHE)
+	if(!hasBreakpoint && m_libcHle.HasHookAt(start))
+	{
+		auto result = std::make_shared<CEeLibcHleBasicBlock>(context, start, end);
+		result->Compile();
+		return result;
+	}
+#endif
+
 	if(!hasBreakpoint)
 	{
 		auto equalRange = m_cachedBlocks.equal_range(checksum);
@@ -157,6 +194,11 @@ BasicBlockPtr CEeExecutor::BlockFactory(CMIPS& context, uint32 start, uint32 end
 	return result;
 }
 
+CEeLibcHle& CEeExecutor::GetLibcHle()
+{
+	return m_libcHle;
+}
+
 bool CEeExecutor::HandleAccessFault(intptr_t ptr)
 {
 	ptrdiff_t addr = reinterpret_cast<uint8*>(ptr) - m_ram;
@@ -194,7 +236,15 @@ void CEeExecutor::SetMemoryProtected(void* addr, size_t size, bool protect)
 
 LONG WINAPI CEeExecutor::HandleException(_EXCEPTION_POINTERS* exceptionInfo)
 {
-	return g_eeExecutor->HandleExceptionInternal(exceptionInfo);
+	for(auto& executorSlot : g_eeExecutors)
+	{
+		auto executor = executorSlot.load();
+		if(executor && (executor->HandleExceptionInternal(exceptionInfo) == EXCEPTION_CONTINUE_EXECUTION))
+		{
+			return EXCEPTION_CONTINUE_EXECUTION;
+		}
+	}
+	return EXCEPTION_CONTINUE_SEARCH;
 }
 
 LONG CEeExecutor::HandleExceptionInternal(_EXCEPTION_POINTERS* exceptionInfo)
@@ -213,16 +263,16 @@ LONG CEeExecutor::HandleExceptionInternal(_EXCEPTION_POINTERS* exceptionInfo)
 #elif defined(__unix__) || defined(__ANDROID__)
 
 void CEeExecutor::HandleException(int sigId, siginfo_t* sigInfo, void* baseContext)
-{
-	g_eeExecutor->HandleExceptionInternal(sigId, sigInfo, baseContext);
-}
-
-void CEeExecutor::HandleExceptionInternal(int sigId, siginfo_t* sigInfo, void* baseContext)
 {
 	if(sigId != SIGSEGV) return;
-	if(HandleAccessFault(reinterpret_cast<intptr_t>(sigInfo->si_addr)))
+	auto faultAddress = reinterpret_cast<intptr_t>(sigInfo->si_addr);
+	for(auto& executorSlot : g_eeExecutors)
 	{
-		return;
+		auto executor = executorSlot.load();
+		if(executor && executor->HandleAccessFault(faultAddress))
+		{
+			return;
+		}
 	}
 	signal(SIGSEGV, SIG_DFL);
 }
@@ -10,6 +10,7 @@
 #endif
 
 #include "../GenericMipsExecutor.h"
+#include "EeLibcHle.h"
 
 class CEeExecutor : public CGenericMipsExecutor<BlockLookupTwoWay>
 {
@@ -25,6 +26,8 @@ public:
 
 	BasicBlockPtr BlockFactory(CMIPS&, uint32, uint32) override;
 
+	CEeLibcHle& GetLibcHle();
+
 private:
 	typedef std::unordered_multimap<uint32, BasicBlockPtr> CachedBlockMap;
 	CachedBlockMap m_cachedBlocks;
@@ -32,6 +35,8 @@ private:
 	uint8* m_ram = nullptr;
 	size_t m_pageSize = 0;
 
+	CEeLibcHle m_libcHle;
+
 	bool HandleAccessFault(intptr_t);
 	void SetMemoryProtected(void*, size_t, bool);
 
@@ -42,7 +47,6 @@ private:
 	LPVOID m_handler = NULL;
 #elif defined(__unix__) || defined(__ANDROID__)
 	static void HandleException(int, siginfo_t*, void*);
-	void HandleExceptionInternal(int, siginfo_t*, void*);
 #elif defined(__APPLE__)
 	void HandlerThreadProc();
 
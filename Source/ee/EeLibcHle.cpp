@@ -0,0 +1,531 @@
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+#include <memory>
+#include <cinttypes>
+#include "EeLibcHle.h"
+#include "../Ps2Const.h"
+#include "../Log.h"
+#include "PtrStream.h"
+#include "xml/Parser.h"
+
+#define LOG_NAME ("ee_libchle")
+
+//Subset of the patterns from ee_functions.xml that have a native counterpart
+static const char* g_libcFunctionPatterns = R"(<Functions>
+	<FunctionPatterns>
+		<FunctionPattern Name="memset">
+			2CC20008    ;SLTIU          V0, A2, $0008
+			1440XXXX    ;BNE            V0, R0, $XXXXXXXX
+			0080182D    ;DADDU          V1, A0, R0
+			3082000F    ;ANDI           V0, A0, $000F
+			1440XXXX    ;BNE            V0, R0, $XXXXXXXX
+			0080382D    ;DADDU          A3, A0, R0
+			30A900FF    ;ANDI           T1, A1, $00FF
+			2CCA0020    ;SLTIU          T2, A2, $0020
+			0120402D    ;DADDU          T0, T1, R0
+			00081A38    ;DSLL           V1, T0, 8
+			00694025    ;OR             T0, V1, T1
+			70081EE9    ;PCPYH          V1, T0
+			1540XXXX    ;BNE            T2, R0, $XXXXXXXX
+			2CC20008    ;SLTIU          V0, A2, $0008
+			70634389    ;PCPYLD         T0, V1, V1
+			7CE80000    ;SQ             T0, $0000(A3)
+			24C6FFE0    ;ADDIU          A2, A2, $FFE0
+			24E70010    ;ADDIU          A3, A3, $0010
+			2CC20020    ;SLTIU          V0, A2, $0020
+			7CE80000    ;SQ             T0, $0000(A3)
+			1040XXXX    ;BEQ            V0, R0, $XXXXXXXX
+			24E70010    ;ADDIU          A3, A3, $0010
+			1000XXXX    ;BEQ            R0, R0, $XXXXXXXX
+			2CC20008    ;SLTIU          V0, A2, $0008
+			24C6FFF8    ;ADDIU          A2, A2, $FFF8
+			24E70008    ;ADDIU          A3, A3, $0008
+			2CC20008    ;SLTIU          V0, A2, $0008
+			00000000    ;NOP
+			00000000    ;NOP
+			5040XXXX    ;BEQL           V0, R0, $XXXXXXXX
+			FCE30000    ;SD             V1, $0000(A3)
+			00E0182D    ;DADDU          V1, A3, R0
+			3C02FFFF    ;LUI            V0, $FFFF
+			24C6FFFF    ;ADDIU          A2, A2, $FFFF
+			3442FFFF    ;ORI            V0, V0, $FFFF
+			10C2XXXX    ;BEQ            A2, V0, $XXXXXXXX
+			00000000    ;NOP
+			3C02FFFF    ;LUI            V0, $FFFF
+			3442FFFF    ;ORI            V0, V0, $FFFF
+			A0650000    ;SB             A1, $0000(V1)
+			24C6FFFF    ;ADDIU          A2, A2, $FFFF
+			00000000    ;NOP
+			00000000    ;NOP
+			00000000    ;NOP
+			14C2XXXX    ;BNE            A2, V0, $XXXXXXXX
+			24630001    ;ADDIU          V1, V1, $0001
+			03E00008    ;JR             RA
+			0080102D    ;DADDU          V0, A0, R0
+		</FunctionPattern>
+		<FunctionPattern Name="memset">
+			2CC20008    ;SLTIU          V0, A2, $0008
+			1440XXXX    ;BNE            V0, R0, $XXXXXXXX
+			0080182D    ;DADDU          V1, A0, R0
+			3082000F    ;ANDI           V0, A0, $000F
+			1440XXXX    ;BNE            V0, R0, $XXXXXXXX
+			0080382D    ;DADDU          A3, A0, R0
+			30A900FF    ;ANDI           T1, A1, $00FF
+			2CCA0020    ;SLTIU          T2, A2, $0020
+			0120402D    ;DADDU          T0, T1, R0
+			00081A38    ;DSLL           V1, T0, 8
+			00694025    ;OR             T0, V1, T1
+			70081EE9    ;PCPYH          V1, T0
+			1540XXXX    ;BNE            T2, R0, $XXXXXXXX
+			2CC20008    ;SLTIU          V0, A2, $0008
+			70634389    ;PCPYLD         T0, V1, V1
+			7CE80000    ;SQ             T0, $0000(A3)
+			24C6FFE0    ;ADDIU          A2, A2, $FFE0
+			24E70010    ;ADDIU          A3, A3, $0010
+			2CC20020    ;SLTIU          V0, A2, $0020
+			7CE80000    ;SQ             T0, $0000(A3)
+			1040XXXX    ;BEQ            V0, R0, $XXXXXXXX
+			24E70010    ;ADDIU          A3, A3, $0010
+			1000XXXX    ;BEQ            R0, R0, $XXXXXXXX
+			2CC20008    ;SLTIU          V0, A2, $0008
+			24C6FFF8    ;ADDIU          A2, A2, $FFF8
+			24E70008    ;ADDIU          A3, A3, $0008
+			2CC20008    ;SLTIU          V0, A2, $0008
+			00000000    ;NOP
+			00000000    ;NOP
+			5040XXXX    ;BEQL           V0, R0, $XXXXXXXX
+			FCE30000    ;SD             V1, $0000(A3)
+			00E0182D    ;DADDU          V1, A3, R0
+			3C02FFFF    ;LUI            V0, $FFFF
+			24C6FFFF    ;ADDIU          A2, A2, $FFFF
+			3442FFFF    ;ORI            V0, V0, $FFFF
+			10C2XXXX    ;BEQ            A2, V0, $XXXXXXXX
+			00000000    ;NOP
+			3C02FFFF    ;LUI            V0, $FFFF
+			3442FFFF    ;ORI            V0, V0, $FFFF
+			A0650000    ;SB             A1, $0000(V1)
+			24C6FFFF    ;ADDIU          A2, A2, $FFFF
+			24630001    ;ADDIU          V1, V1, $0001
+			00000000    ;NOP
+			00000000    ;NOP
+			14C2XXXX    ;BNE            A2, V0, $XXXXXXXX
+			00000000    ;NOP
+			03E00008    ;JR             RA
+			0080102D    ;DADDU          V0, A0, R0
+		</FunctionPattern>
+		<FunctionPattern Name="memcpy">
+			0080402D    ;DADDU          T0, A0, R0
+			2CC20020    ;SLTIU          V0, A2, $0020
+			1440XXXX    ;BNE            V0, R0, $XXXXXXXX
+			0100182D    ;DADDU          V1, T0, R0
+			00A81025    ;OR             V0, A1, T0
+			3042000F    ;ANDI           V0, V0, $000F
+			5440XXXX    ;BNEL           V0, R0, $XXXXXXXX
+			24C6FFFF    ;ADDIU          A2, A2, $FFFF
+			0100382D    ;DADDU          A3, T0, R0
+			78A30000    ;LQ             V1, $0000(A1)
+			24C6FFE0    ;ADDIU          A2, A2, $FFE0
+			24A50010    ;ADDIU          A1, A1, $0010
+			2CC40020    ;SLTIU          A0, A2, $0020
+			7CE30000    ;SQ             V1, $0000(A3)
+			24E70010    ;ADDIU          A3, A3, $0010
+			78A20000    ;LQ             V0, $0000(A1)
+			24A50010    ;ADDIU          A1, A1, $0010
+			7CE20000    ;SQ             V0, $0000(A3)
+			1080FFF6    ;BEQ            A0, R0, $XXXXXXXX
+			24E7XXXX    ;ADDIU          A3, A3, $0010
+			2CC20008    ;SLTIU          V0, A2, $0008
+			1440XXXX    ;BNE            V0, R0, $XXXXXXXX
+			00E0182D    ;DADDU          V1, A3, R0
+			DCA30000    ;LD             V1, $0000(A1)
+			24C6FFF8    ;ADDIU          A2, A2, $FFF8
+			24A50008    ;ADDIU          A1, A1, $0008
+			2CC20008    ;SLTIU          V0, A2, $0008
+			FCE30000    ;SD             V1, $0000(A3)
+			1040FFFA    ;BEQ            V0, R0, $XXXXXXXX
+			24E70008    ;ADDIU          A3, A3, $0008
+			00E0182D    ;DADDU          V1, A3, R0
+			24C6FFFF    ;ADDIU          A2, A2, $FFFF
+			2402FFFF    ;ADDIU          V0, R0, $FFFF
+			10C2XXXX    ;BEQ            A2, V0, $XXXXXXXX
+			0040202D    ;DADDU          A0, V0, R0
+			90A20000    ;LBU            V0, $0000(A1)
+			24C6FFFF    ;ADDIU          A2, A2, $FFFF
+			24A50001    ;ADDIU          A1, A1, $0001
+			A0620000    ;SB             V0, $0000(V1)
+			00000000    ;NOP
+			14C4XXXX    ;BNE            A2, A0, $XXXXXXXX
+			24630001    ;ADDIU          V1, V1, $0001
+			03E00008    ;JR             RA
+			0100102D    ;DADDU          V0, T0, R0
+		</FunctionPattern>
+		<FunctionPattern Name="memcpy">
+			0080402D    ;DADDU          T0, A0, R0
+			2CC20020    ;SLTIU          V0, A2, $0020
+			1440XXXX    ;BNE            V0, R0, $XXXXXXXX
+			0100182D    ;DADDU          V1, T0, R0
+			00A81025    ;OR             V0, A1, T0
+			3042000F    ;ANDI           V0, V0, $000F
+			5440XXXX    ;BNEL           V0, R0, $XXXXXXXX
+			24C6FFFF    ;ADDIU          A2, A2, $FFFF
+			0100382D    ;DADDU          A3, T0, R0
+			78A30000    ;LQ             V1, $0000(A1)
+			24C6FFE0    ;ADDIU          A2, A2, $FFE0
+			24A50010    ;ADDIU          A1, A1, $0010
+			2CC40020    ;SLTIU          A0, A2, $0020
+			7CE30000    ;SQ             V1, $0000(A3)
+			24E70010    ;ADDIU          A3, A3, $0010
+			78A20000    ;LQ             V0, $0000(A1)
+			24A50010    ;ADDIU          A1, A1, $0010
+			7CE20000    ;SQ             V0, $0000(A3)
+			1080XXXX    ;BEQ            A0, R0, $XXXXXXXX
+			24E70010    ;ADDIU          A3, A3, $0010
+			2CC20008    ;SLTIU          V0, A2, $0008
+			1440XXXX    ;BNE            V0, R0, $XXXXXXXX
+			00E0182D    ;DADDU          V1, A3, R0
+			DCA30000    ;LD             V1, $0000(A1)
+			24C6FFF8    ;ADDIU          A2, A2, $FFF8
+			24A50008    ;ADDIU          A1, A1, $0008
+			2CC20008    ;SLTIU          V0, A2, $0008
+			FCE30000    ;SD             V1, $0000(A3)
+			1040XXXX    ;BEQ            V0, R0, $XXXXXXXX
+			24E70008    ;ADDIU          A3, A3, $0008
+			00E0182D    ;DADDU          V1, A3, R0
+			24C6FFFF    ;ADDIU          A2, A2, $FFFF
+			2402FFFF    ;ADDIU          V0, R0, $FFFF
+			10C2XXXX    ;BEQ            A2, V0, $XXXXXXXX
+			0040202D    ;DADDU          A0, V0, R0
+			90A20000    ;LBU            V0, $0000(A1)
+			24C6FFFF    ;ADDIU          A2, A2, $FFFF
+			24A50001    ;ADDIU          A1, A1, $0001
+			A0620000    ;SB             V0, $0000(V1)
+			24630001    ;ADDIU          V1, V1, $0001
+			14C4XXXX    ;BNE            A2, A0, $XXXXXXXX
+			00000000    ;NOP
+			03E00008    ;JR             RA
+			0100102D    ;DADDU          V0, T0, R0
+		</FunctionPattern>
+		<FunctionPattern Name="strcpy">
+			0080382D    ;DADDU          A3, A0, R0
+			00A74025    ;OR             T0, A1, A3
+			31020007    ;ANDI           V0, T0, $0007
+			1440XXXX    ;BNE            V0, R0, $XXXXXXXX
+			00E0182D    ;DADDU          V1, A3, R0
+			3102000F    ;ANDI           V0, T0, $000F
+			3C090101    ;LUI            T1, $0101
+			35290101    ;ORI            T1, T1, $0101
+			00094C38    ;DSLL           T1, T1, 16
+			35290101    ;ORI            T1, T1, $0101
+			00094C38    ;DSLL           T1, T1, 16
+			35290101    ;ORI            T1, T1, $0101
+			3C048080    ;LUI            A0, $8080
+			34848080    ;ORI            A0, A0, $8080
+			00042438    ;DSLL           A0, A0, 16
+			34848080    ;ORI            A0, A0, $8080
+			00042438    ;DSLL           A0, A0, 16
+			34848080    ;ORI            A0, A0, $8080
+			5440XXXX    ;BNEL           V0, R0, $XXXXXXXX
+			DCAA0000    ;LD             T2, $0000(A1)
+			71295389    ;PCPYLD         T2, T1, T1
+			78A90000    ;LQ             T1, $0000(A1)
+			70844389    ;PCPYLD         T0, A0, A0
+			712A1248    ;PSUBB          V0, T1, T2
+			70091CE9    ;PNOR           V1, R0, T1
+			70431489    ;PAND           V0, V0, V1
+			70481489    ;PAND           V0, V0, T0
+			704923A9    ;PCPYUD         A0, V0, T1
+			00441825    ;OR             V1, V0, A0
+			1460XXXX    ;BNE            V1, R0, $XXXXXXXX
+			00E0302D    ;DADDU          A2, A3, R0
+			7CC90000    ;SQ             T1, $0000(A2)
+			24A50010    ;ADDIU          A1, A1, $0010
+			78A90000    ;LQ             T1, $0000(A1)
+			712A1248    ;PSUBB          V0, T1, T2
+			70091CE9    ;PNOR           V1, R0, T1
+			70431489    ;PAND           V0, V0, V1
+			70481489    ;PAND           V0, V0, T0
+			704923A9    ;PCPYUD         A0, V0, T1
+			00441825    ;OR             V1, V0, A0
+			1060XXXX    ;BEQ            V1, R0, $XXXXXXXX
+			24C60010    ;ADDIU          A2, A2, $0010
+			1000XXXX    ;BEQ            R0, R0, $XXXXXXXX
+			00C0182D    ;DADDU          V1, A2, R0
+			0149102F    ;DSUBU          V0, T2, T1
+			000A1827    ;NOR            V1, R0, T2
+			00431024    ;AND            V0, V0, V1
+			00441024    ;AND            V0, V0, A0
+			1440XXXX    ;BNE            V0, R0, $XXXXXXXX
+			00E0302D    ;DADDU          A2, A3, R0
+			FCCA0000    ;SD             T2, $0000(A2)
+			24A50008    ;ADDIU          A1, A1, $0008
+			DCAA0000    ;LD             T2, $0000(A1)
+			000A1027    ;NOR            V0, R0, T2
+			0149182F    ;DSUBU          V1, T2, T1
+			00621824    ;AND            V1, V1, V0
+			00641824    ;AND            V1, V1, A0
+			1060XXXX    ;BEQ            V1, R0, $XXXXXXXX
+			24C60008    ;ADDIU          A2, A2, $0008
+			00C0182D    ;DADDU          V1, A2, R0
+			90A20000    ;LBU            V0, $0000(A1)
+			24A50001    ;ADDIU          A1, A1, $0001
+			A0620000    ;SB             V0, $0000(V1)
+			00021600    ;SLL            V0, V0, 24
+			24630001    ;ADDIU          V1, V1, $0001
+			1440XXXX    ;BNE            V0, R0, $XXXXXXXX
+			00000000    ;NOP
+			03E00008    ;JR             RA
+			00E0102D    ;DADDU          V0, A3, R0
+		</FunctionPattern>
+	</FunctionPatterns>
+</Functions>
+)";
+
+CEeLibcHle::CEeLibcHle(CMIPS& context, uint8* ram)
+    : m_context(context)
+    , m_ram(ram)
+{
+}
+
+CEeLibcHle::~CEeLibcHle()
+{
+	LogStats();
+}
+
+bool CEeLibcHle::IsEnabled() const
+{
+	return m_enabled;
+}
+
+void CEeLibcHle::SetEnabled(bool enabled)
+{
+	m_enabled = enabled;
+	if(!m_enabled)
+	{
+		ClearHooks();
+	}
+}
+
+void CEeLibcHle::FindHooks(uint32 minAddr, uint32 maxAddr)
+{
+	ClearHooks();
+	if(!m_enabled) return;
+	if(minAddr >= maxAddr) return;
+
+	maxAddr = std::min<uint32>(maxAddr, PS2::EE_RAM_SIZE) & ~0x03;
+
+	Framework::CPtrStream patternsStream(g_libcFunctionPatterns, strlen(g_libcFunctionPatterns));
+	auto patternsDocument = std::unique_ptr<Framework::Xml::CNode>(Framework::Xml::CParser::ParseDocument(patternsStream));
+	CMipsFunctionPatternDb patternDb(patternsDocument->Select("Functions"));
+
+	for(const auto& pattern : patternDb.GetPatterns())
+	{
+		HOOK hook = HOOK_MAX;
+		for(unsigned int i = 0; i < HOOK_MAX; i++)
+		{
+			if(pattern.name == GetHookName(static_cast<HOOK>(i)))
+			{
+				hook = static_cast<HOOK>(i);
+				break;
+			}
+		}
+		assert(hook != HOOK_MAX);
+		if(hook == HOOK_MAX) continue;
+
+		for(uint32 address = minAddr; address < maxAddr; address += 4)
+		{
+			auto text = reinterpret_cast<uint32*>(m_ram + address);
+			if(pattern.Matches(text, maxAddr - address))
+			{
+				CLog::GetInstance().Print(LOG_NAME, "Hooked '%s' at 0x%08X.\r\n", pattern.name.c_str(), address);
+				HOOK_INFO hookInfo;
+				hookInfo.hook = hook;
+				hookInfo.pattern = pattern;
+				m_hooks.insert(std::make_pair(address, std::move(hookInfo)));
+			}
+		}
+	}
+}
+
+void CEeLibcHle::ClearHooks()
+{
+	LogStats();
+	m_hooks.clear();
+	for(auto& stats : m_stats)
+	{
+		stats = HOOK_STATS();
+	}
+}
+
+bool CEeLibcHle::HasHookAt(uint32 address)
+{
+	auto hookIterator = m_hooks.find(address);
+	if(hookIterator == std::end(m_hooks)) return false;
+
+	//Code might have been replaced since the executable was scanned (overlays, self modifying code)
+	auto text = reinterpret_cast<uint32*>(m_ram + address);
+	if(!hookIterator->second.pattern.Matches(text, PS2::EE_RAM_SIZE - address))
+	{
+		CLog::GetInstance().Print(LOG_NAME, "Code at 0x%08X doesn't match '%s' anymore, removing hook.\r\n",
+		                          address, hookIterator->second.pattern.name.c_str());
+		m_hooks.erase(hookIterator);
+		return false;
+	}
+	return true;
+}
+
+bool CEeLibcHle::ExecuteHook(uint32 address)
+{
+	auto hookIterator = m_hooks.find(address);
+	if(hookIterator == std::end(m_hooks)) return false;
+
+	auto hook = hookIterator->second.hook;
+	auto& stats = m_stats[hook];
+	bool executed = false;
+	switch(hook)
+	{
+	case HOOK_MEMCPY:
+		executed = ExecuteMemcpy(stats);
+		break;
+	case HOOK_MEMSET:
+		executed = ExecuteMemset(stats);
+		break;
+	case HOOK_STRCPY:
+		executed = ExecuteStrcpy(stats);
+		break;
+	default:
+		assert(false);
+		break;
+	}
+
+	if(executed)
+	{
+		stats.hitCount++;
+	}
+	else
+	{
+		stats.fallbackCount++;
+	}
+	return executed;
+}
+
+CEeLibcHle::HOOK_STATS CEeLibcHle::GetStats(HOOK hook) const
+{
+	assert(hook < HOOK_MAX);
+	return m_stats[hook];
+}
+
+uint8* CEeLibcHle::GetRamPointer(uint32 address, uint32 size, uint32& physAddress) const
+{
+	physAddress = m_context.m_pAddrTranslator(&m_context, address);
+	if(physAddress >= PS2::EE_RAM_SIZE) return nullptr;
+	if(size > (PS2::EE_RAM_SIZE - physAddress)) return nullptr;
+	return m_ram + physAddress;
+}
+
+bool CEeLibcHle::ExecuteMemcpy(HOOK_STATS& stats)
+{
+	uint32 dstAddress = m_context.m_State.nGPR[CMIPS::A0].nV0;
+	uint32 srcAddress = m_context.m_State.nGPR[CMIPS::A1].nV0;
+	uint32 size = m_context.m_State.nGPR[CMIPS::A2].nV0;
+
+	uint32 dstPhysAddress = 0;
+	uint32 srcPhysAddress = 0;
+	auto dst = GetRamPointer(dstAddress, size, dstPhysAddress);
+	auto src = GetRamPointer(srcAddress, size, srcPhysAddress);
+	if(!dst || !src) return false;
+
+	//The emulated routine copies forward in chunks, overlapping copies must go through it
+	if((dstPhysAddress < (srcPhysAddress + size)) && (srcPhysAddress < (dstPhysAddress + size))) return false;
+
+	memcpy(dst, src, size);
+	stats.byteCount += size;
+
+	m_context.m_State.nGPR[CMIPS::V0].nD0 = m_context.m_State.nGPR[CMIPS::A0].nD0;
+	ReturnFromHook(size);
+	return true;
+}
+
+bool CEeLibcHle::ExecuteMemset(HOOK_STATS& stats)
+{
+	uint32 dstAddress = m_context.m_State.nGPR[CMIPS::A0].nV0;
+	uint8 value = static_cast<uint8>(m_context.m_State.nGPR[CMIPS::A1].nV0);
+	uint32 size = m_context.m_State.nGPR[CMIPS::A2].nV0;
+
+	uint32 dstPhysAddress = 0;
+	auto dst = GetRamPointer(dstAddress, size, dstPhysAddress);
+	if(!dst) return false;
+
+	memset(dst, value, size);
+	stats.byteCount += size;
+
+	m_context.m_State.nGPR[CMIPS::V0].nD0 = m_context.m_State.nGPR[CMIPS::A0].nD0;
+	ReturnFromHook(size);
+	return true;
+}
+
+bool CEeLibcHle::ExecuteStrcpy(HOOK_STATS& stats)
+{
+	uint32 dstAddress = m_context.m_State.nGPR[CMIPS::A0].nV0;
+	uint32 srcAddress = m_context.m_State.nGPR[CMIPS::A1].nV0;
+
+	uint32 srcPhysAddress = 0;
+	auto src = GetRamPointer(srcAddress, 1, srcPhysAddress);
+	if(!src) return false;
+
+	//String needs to be terminated before the end of RAM
+	auto srcEnd = reinterpret_cast<const uint8*>(memchr(src, 0, PS2::EE_RAM_SIZE - srcPhysAddress));
+	if(!srcEnd) return false;
+	uint32 size = static_cast<uint32>(srcEnd - src) + 1;
+
+	uint32 dstPhysAddress = 0;
+	auto dst = GetRamPointer(dstAddress, size, dstPhysAddress);
+	if(!dst) return false;
+
+	if((dstPhysAddress < (srcPhysAddress + size)) && (srcPhysAddress < (dstPhysAddress + size))) return false;
+
+	memcpy(dst, src, size);
+	stats.byteCount += size;
+
+	m_context.m_State.nGPR[CMIPS::V0].nD0 = m_context.m_State.nGPR[CMIPS::A0].nD0;
+	ReturnFromHook(size);
+	return true;
+}
+
+void CEeLibcHle::ReturnFromHook(uint32 size)
+{
+	//Charge roughly what the emulated routine would have cost
+	m_context.m_State.cycleQuota -= CALL_CYCLES + (size / BYTES_PER_CYCLE);
+	if(m_context.m_State.cycleQuota <= 0)
+	{
+		m_context.m_State.nHasException |= MIPS_EXECUTION_STATUS_QUOTADONE;
+	}
+	m_context.m_State.nPC = m_context.m_State.nGPR[CMIPS::RA].nV0;
+}
+
+void CEeLibcHle::LogStats() const
+{
+	for(unsigned int i = 0; i < HOOK_MAX; i++)
+	{
+		const auto& stats = m_stats[i];
+		if((stats.hitCount == 0) && (stats.fallbackCount == 0)) continue;
+		CLog::GetInstance().Print(LOG_NAME, "%s: %" PRIu64 " hits, %" PRIu64 " fallbacks, %" PRIu64 " bytes.\r\n",
+		                          GetHookName(static_cast<HOOK>(i)), stats.hitCount, stats.fallbackCount, stats.byteCount);
+	}
+}
+
+const char* CEeLibcHle::GetHookName(HOOK hook)
+{
+	switch(hook)
+	{
+	case HOOK_MEMCPY:
+		return "memcpy";
+	case HOOK_MEMSET:
+		return "memset";
+	case HOOK_STRCPY:
+		return "strcpy";
+	default:
+		assert(false);
+		return "";
+	}
+}
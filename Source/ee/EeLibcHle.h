@@ -0,0 +1,72 @@
+#pragma once
+
+#include <unordered_map>
+#include "Types.h"
+#include "../MIPS.h"
+#include "../MipsFunctionPatternDb.h"
+
+//Replaces statically linked libc routines recognized by their opcode patterns
+//with native implementations working directly on EE RAM. Calls that touch
+//anything else than main RAM (scratchpad, MMIO, VU memory) or that rely on
+//overlapping buffers are left to the emulated routine.
+class CEeLibcHle
+{
+public:
+	enum HOOK
+	{
+		HOOK_MEMCPY,
+		HOOK_MEMSET,
+		HOOK_STRCPY,
+		HOOK_MAX,
+	};
+
+	struct HOOK_STATS
+	{
+		uint64 hitCount = 0;
+		uint64 fallbackCount = 0;
+		uint64 byteCount = 0;
+	};
+
+	CEeLibcHle(CMIPS&, uint8*);
+	virtual ~CEeLibcHle();
+
+	bool IsEnabled() const;
+	void SetEnabled(bool);
+
+	void FindHooks(uint32, uint32);
+	void ClearHooks();
+	bool HasHookAt(uint32);
+
+	bool ExecuteHook(uint32);
+
+	HOOK_STATS GetStats(HOOK) const;
+
+private:
+	enum
+	{
+		CALL_CYCLES = 16,
+		BYTES_PER_CYCLE = 4,
+	};
+
+	struct HOOK_INFO
+	{
+		HOOK hook;
+		CMipsFunctionPatternDb::Pattern pattern;
+	};
+	typedef std::unordered_map<uint32, HOOK_INFO> HookMap;
+
+	uint8* GetRamPointer(uint32, uint32, uint32&) const;
+	bool ExecuteMemcpy(HOOK_STATS&);
+	bool ExecuteMemset(HOOK_STATS&);
+	bool ExecuteStrcpy(HOOK_STATS&);
+	void ReturnFromHook(uint32);
+	void LogStats() const;
+
+	static const char* GetHookName(HOOK);
+
+	CMIPS& m_context;
+	uint8* m_ram = nullptr;
+	bool m_enabled = false;
+	HookMap m_hooks;
+	HOOK_STATS m_stats[HOOK_MAX];
+};
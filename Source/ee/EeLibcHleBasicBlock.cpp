@@ -0,0 +1,35 @@
+#include "EeLibcHleBasicBlock.h"
+#include "EeExecutor.h"
+#include "../MipsJitter.h"
+
+CEeLibcHleBasicBlock::CEeLibcHleBasicBlock(CMIPS& context, uint32 begin, uint32 end)
+    : CBasicBlock(context, begin, end)
+{
+}
+
+void CEeLibcHleBasicBlock::CompileRange(CMipsJitter* jitter)
+{
+	jitter->PushCtx();
+	jitter->PushCst(m_begin);
+	jitter->Call(reinterpret_cast<void*>(&ExecuteHook), 2, Jitter::CJitter::RETURN_VALUE_32);
+
+	jitter->PushCst(0);
+	jitter->BeginIf(Jitter::CONDITION_NE);
+	{
+		//PC and cycle quota have already been updated by the hook
+		jitter->JumpTo(reinterpret_cast<void*>(&ReturnFromHook));
+	}
+	jitter->EndIf();
+
+	CBasicBlock::CompileRange(jitter);
+}
+
+uint32 CEeLibcHleBasicBlock::ExecuteHook(CMIPS* context, uint32 address)
+{
+	auto executor = static_cast<CEeExecutor*>(context->m_executor.get());
+	return executor->GetLibcHle().ExecuteHook(address) ? 1 : 0;
+}
+
+void CEeLibcHleBasicBlock::ReturnFromHook(CMIPS*)
+{
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "../BasicBlock.h"
+
+//Entry block of a hooked libc routine. Tries the native implementation first
+//and falls through to the emulated code if the call can't be handled natively.
+class CEeLibcHleBasicBlock : public CBasicBlock
+{
+public:
+	CEeLibcHleBasicBlock(CMIPS&, uint32, uint32);
+	virtual ~CEeLibcHleBasicBlock() = default;
+
+protected:
+	void CompileRange(CMipsJitter*) override;
+
+private:
+	static uint32 ExecuteHook(CMIPS*, uint32);
+	static void ReturnFromHook(CMIPS*);
+};
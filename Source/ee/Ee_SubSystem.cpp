@@ -154,6 +154,8 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 
 	m_os = new CPS2OS(m_EE, m_ram, m_bios, m_spr, m_gs, m_sif, iopBios);
 	m_OnRequestInstructionCacheFlushConnection = m_os->OnRequestInstructionCacheFlush.Connect(std::bind(&CSubSystem::FlushInstructionCache, this));
+	m_OnExecutableChangeConnection = m_os->OnExecutableChange.Connect(std::bind(&CSubSystem::FindLibcHleHooks, this));
+	m_OnExecutableUnloadingConnection = m_os->OnExecutableUnloading.Connect(std::bind(&CSubSystem::ClearLibcHleHooks, this));
 
 	SetupEePageTable();
 }
@@ -182,6 +184,21 @@ void CSubSystem::SetVpu1(std::shared_ptr<CVpu> newVpu1)
 	m_vpu1 = newVpu1;
 }
 
+void CSubSystem::SetLibcHleEnabled(bool enabled)
+{
+	auto& libcHle = static_cast<CEeExecutor*>(m_EE.m_executor.get())->GetLibcHle();
+	if(libcHle.IsEnabled() == enabled) return;
+	libcHle.SetEnabled(enabled);
+	if(enabled && m_os->GetELF())
+	{
+		FindLibcHleHooks();
+	}
+	else
+	{
+		m_EE.m_executor->Reset();
+	}
+}
+
 void CSubSystem::Reset()
 {
 	m_os->Release();
@@ -350,7 +367,7 @@ void CSubSystem::NotifyVBlankEnd()
 	m_intc.AssertLine(CINTC::INTC_LINE_VBLANK_END);
 }
 
-void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
+void CSubSystem::SaveState(CStateArchiveWriter& archive)
 {
 	archive.InsertFile(new CMemoryStateFile(STATE_EE, &m_EE.m_State, sizeof(MIPSSTATE)));
 	archive.InsertFile(new CMemoryStateFile(STATE_VU0, &m_VU0.m_State, sizeof(MIPSSTATE)));
@@ -362,16 +379,10 @@ void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(new CMemoryStateFile(STATE_VUMEM1, m_vuMem1, PS2::VUMEM1SIZE));
 	archive.InsertFile(new CMemoryStateFile(STATE_MICROMEM1, m_microMem1, PS2::MICROMEM1SIZE));
 
-	m_dmac.SaveState(archive);
-	m_intc.SaveState(archive);
-	m_sif.SaveState(archive);
-	m_vpu0->SaveState(archive);
-	m_vpu1->SaveState(archive);
-	m_timer.SaveState(archive);
-	m_gif.SaveState(archive);
+	SaveDeviceState(archive);
 }
 
-void CSubSystem::LoadState(Framework::CZipArchiveReader& archive)
+void CSubSystem::LoadState(CStateArchiveReader& archive)
 {
 	m_EE.m_executor->Reset();
 
@@ -385,6 +396,67 @@ void CSubSystem::LoadState(Framework::CZipArchiveReader& archive)
 	archive.BeginReadFile(STATE_VUMEM1)->Read(m_vuMem1, PS2::VUMEM1SIZE);
 	archive.BeginReadFile(STATE_MICROMEM1)->Read(m_microMem1, PS2::MICROMEM1SIZE);
 
+	LoadDeviceState(archive);
+}
+
+void CSubSystem::SaveQuickState(CQuickState& state)
+{
+	state.SaveMemory(&m_EE.m_State, sizeof(MIPSSTATE));
+	state.SaveMemory(&m_VU0.m_State, sizeof(MIPSSTATE));
+	state.SaveMemory(&m_VU1.m_State, sizeof(MIPSSTATE));
+	state.SaveMemory(m_ram, PS2::EE_RAM_SIZE);
+	state.SaveMemory(m_spr, PS2::EE_SPR_SIZE);
+	state.SaveMemory(m_vuMem0, PS2::VUMEM0SIZE);
+	state.SaveMemory(m_microMem0, PS2::MICROMEM0SIZE);
+	state.SaveMemory(m_vuMem1, PS2::VUMEM1SIZE);
+	state.SaveMemory(m_microMem1, PS2::MICROMEM1SIZE);
+
+	SaveDeviceState(state.GetArchiveWriter());
+}
+
+void CSubSystem::LoadQuickState(CQuickState& state)
+{
+	state.LoadMemory(&m_EE.m_State, sizeof(MIPSSTATE));
+	state.LoadMemory(&m_VU0.m_State, sizeof(MIPSSTATE));
+	state.LoadMemory(&m_VU1.m_State, sizeof(MIPSSTATE));
+
+	//Instead of resetting the executor, only clear blocks in pages that actually
+	//changed. Most code pages are left untouched between two snapshots.
+	state.LoadMemory(m_ram, PS2::EE_RAM_SIZE, framework_getpagesize(),
+	                 [this](size_t offset, size_t size) {
+		                 m_EE.m_executor->ClearActiveBlocksInRange(static_cast<uint32>(offset), static_cast<uint32>(offset + size), false);
+	                 });
+
+	state.LoadMemory(m_spr, PS2::EE_SPR_SIZE);
+	//Same goes for microprograms, compiled ones must not survive if the code changed
+	static const size_t microMemBlockSize = 0x100;
+	state.LoadMemory(m_vuMem0, PS2::VUMEM0SIZE);
+	state.LoadMemory(m_microMem0, PS2::MICROMEM0SIZE, microMemBlockSize,
+	                 [this](size_t offset, size_t size) {
+		                 m_VU0.m_executor->ClearActiveBlocksInRange(static_cast<uint32>(offset), static_cast<uint32>(offset + size), false);
+	                 });
+	state.LoadMemory(m_vuMem1, PS2::VUMEM1SIZE);
+	state.LoadMemory(m_microMem1, PS2::MICROMEM1SIZE, microMemBlockSize,
+	                 [this](size_t offset, size_t size) {
+		                 m_VU1.m_executor->ClearActiveBlocksInRange(static_cast<uint32>(offset), static_cast<uint32>(offset + size), false);
+	                 });
+
+	LoadDeviceState(state.GetArchiveReader());
+}
+
+void CSubSystem::SaveDeviceState(CStateArchiveWriter& archive)
+{
+	m_dmac.SaveState(archive);
+	m_intc.SaveState(archive);
+	m_sif.SaveState(archive);
+	m_vpu0->SaveState(archive);
+	m_vpu1->SaveState(archive);
+	m_timer.SaveState(archive);
+	m_gif.SaveState(archive);
+}
+
+void CSubSystem::LoadDeviceState(CStateArchiveReader& archive)
+{
 	m_dmac.LoadState(archive);
 	m_intc.LoadState(archive);
 	m_sif.LoadState(archive);
@@ -652,9 +724,20 @@ void CSubSystem::CopyVuState(CMIPS& dst, const CMIPS& src)
 	}
 }
 
+void CSubSystem::SetIpuAsyncEnabled(bool enabled)
+{
+	m_ipu.SetAsyncEnabled(enabled);
+}
+
 void CSubSystem::ExecuteIpu()
 {
 	m_dmac.ResumeDMA4();
+	if(m_ipu.IsAsyncEnabled())
+	{
+		//Commands run on the IPU worker, only move data between queues and DMA channels here
+		m_ipu.ProcessAsyncEvents();
+		return;
+	}
 	while(m_ipu.WillExecuteCommand())
 	{
 		m_ipu.ExecuteCommand();
@@ -703,6 +786,22 @@ void CSubSystem::FlushInstructionCache()
 	m_EE.m_executor->Reset();
 }
 
+void CSubSystem::FindLibcHleHooks()
+{
+	auto& libcHle = static_cast<CEeExecutor*>(m_EE.m_executor.get())->GetLibcHle();
+	if(!libcHle.IsEnabled()) return;
+	auto executableRange = m_os->GetExecutableRange();
+	libcHle.FindHooks(executableRange.first, executableRange.second);
+	//Make sure entry blocks of hooked functions get recompiled
+	m_EE.m_executor->Reset();
+}
+
+void CSubSystem::ClearLibcHleHooks()
+{
+	auto& libcHle = static_cast<CEeExecutor*>(m_EE.m_executor.get())->GetLibcHle();
+	libcHle.ClearHooks();
+}
+
 void CSubSystem::LoadBIOS()
 {
 	Framework::CStdStream BiosStream(fopen("./vfs/rom0/scph10000.bin", "rb"));
@@ -16,6 +16,7 @@
 #include "COP_VU.h"
 #include "PS2OS.h"
 #include "../gs/GSHandler.h"
+#include "../states/QuickState.h"
 
 #include "signal/Signal.h"
 
@@ -35,12 +36,18 @@ namespace Ee
 		void NotifyVBlankStart();
 		void NotifyVBlankEnd();
 
-		void SaveState(Framework::CZipArchiveWriter&);
-		void LoadState(Framework::CZipArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
+
+		void SaveQuickState(CQuickState&);
+		void LoadQuickState(CQuickState&);
 
 		void SetVpu0(std::shared_ptr<CVpu>);
 		void SetVpu1(std::shared_ptr<CVpu>);
 
+		void SetLibcHleEnabled(bool);
+		void SetIpuAsyncEnabled(bool);
+
 		uint8* m_ram = nullptr;
 		uint8* m_bios = nullptr;
 		uint8* m_spr = nullptr;
@@ -83,6 +90,9 @@ namespace Ee
 
 		void SetupEePageTable();
 
+		void SaveDeviceState(CStateArchiveWriter&);
+		void LoadDeviceState(CStateArchiveReader&);
+
 		uint32 IOPortReadHandler(uint32);
 		uint32 IOPortWriteHandler(uint32, uint32);
 
@@ -104,6 +114,8 @@ namespace Ee
 		void CheckPendingInterrupts();
 
 		void FlushInstructionCache();
+		void FindLibcHleHooks();
+		void ClearLibcHleHooks();
 
 		void LoadBIOS();
 		void FillFakeIopRam();
@@ -119,6 +131,8 @@ namespace Ee
 		CCOP_VU m_COP_VU;
 
 		Framework::CSignal<void()>::Connection m_OnRequestInstructionCacheFlushConnection;
+		Framework::CSignal<void()>::Connection m_OnExecutableChangeConnection;
+		Framework::CSignal<void()>::Connection m_OnExecutableUnloadingConnection;
 		CVpu::VuStateChangedEvent::Connection m_vu0StateChangedConnection;
 	};
 };
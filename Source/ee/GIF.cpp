@@ -45,7 +45,7 @@ void CGIF::Reset()
 	m_signalState = SIGNAL_STATE_NONE;
 }
 
-void CGIF::LoadState(Framework::CZipArchiveReader& archive)
+void CGIF::LoadState(CStateArchiveReader& archive)
 {
 	CRegisterStateFile registerFile(*archive.BeginReadFile(STATE_REGS_XML));
 	m_path3Masked = registerFile.GetRegister32(STATE_REGS_M3P) != 0;
@@ -59,7 +59,7 @@ void CGIF::LoadState(Framework::CZipArchiveReader& archive)
 	m_qtemp = registerFile.GetRegister32(STATE_REGS_QTEMP);
 }
 
-void CGIF::SaveState(Framework::CZipArchiveWriter& archive)
+void CGIF::SaveState(CStateArchiveWriter& archive)
 {
 	CRegisterStateFile* registerFile = new CRegisterStateFile(STATE_REGS_XML);
 	registerFile->SetRegister32(STATE_REGS_M3P, m_path3Masked ? 1 : 0);
@@ -256,19 +256,18 @@ uint32 CGIF::ProcessImage(const uint8* memory, uint32 address, uint32 end)
 	return (totalLoops * 0x10);
 }
 
-uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 address, uint32 end, const CGsPacketMetadata& packetMetadata)
+void CGIF::FlushWriteList(const CGsPacketMetadata& packetMetadata)
 {
-	static CGSHandler::RegisterWriteList writeList;
-	static const auto flushWriteList =
-	    [](CGSHandler* gs, const CGsPacketMetadata& packetMetadata) {
-		    if(!writeList.empty())
-		    {
-			    auto currentCapacity = writeList.capacity();
-			    gs->WriteRegisterMassively(std::move(writeList), &packetMetadata);
-			    writeList.reserve(currentCapacity);
-		    }
-	    };
+	if(!m_writeList.empty())
+	{
+		auto currentCapacity = m_writeList.capacity();
+		m_gs->WriteRegisterMassively(std::move(m_writeList), &packetMetadata);
+		m_writeList.reserve(currentCapacity);
+	}
+}
 
+uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 address, uint32 end, const CGsPacketMetadata& packetMetadata)
+{
 #ifdef PROFILE
 	CProfilerZone profilerZone(m_gifProfilerZone);
 #endif
@@ -280,7 +279,7 @@ uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 address, uint32 end
 
 	assert((m_activePath == 0) || (m_activePath == packetMetadata.pathIndex));
 	m_signalState = SIGNAL_STATE_NONE;
-	writeList.clear();
+	m_writeList.clear();
 
 	uint32 start = address;
 	while(address < end)
@@ -313,7 +312,7 @@ uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 address, uint32 end
 			{
 				if(tag.pre != 0)
 				{
-					writeList.push_back(CGSHandler::RegisterWrite(GS_REG_PRIM, static_cast<uint64>(tag.prim)));
+					m_writeList.push_back(CGSHandler::RegisterWrite(GS_REG_PRIM, static_cast<uint64>(tag.prim)));
 				}
 			}
 
@@ -325,17 +324,17 @@ uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 address, uint32 end
 		switch(m_cmd)
 		{
 		case 0x00:
-			address += ProcessPacked(writeList, memory, address, end);
+			address += ProcessPacked(m_writeList, memory, address, end);
 			break;
 		case 0x01:
-			address += ProcessRegList(writeList, memory, address, end);
+			address += ProcessRegList(m_writeList, memory, address, end);
 			break;
 		case 0x02:
 		case 0x03:
 			//We need to flush our list here because image data can be embedded in a GIF packet
 			//that specifies pixel transfer information in GS registers (and that has to be send first)
 			//This is done by FFX
-			flushWriteList(m_gs, packetMetadata);
+			FlushWriteList(packetMetadata);
 			address += ProcessImage(memory, address, end);
 			break;
 		}
@@ -355,7 +354,7 @@ uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 address, uint32 end
 		}
 	}
 
-	flushWriteList(m_gs, packetMetadata);
+	FlushWriteList(packetMetadata);
 
 #ifdef _DEBUG
 	CLog::GetInstance().Print(LOG_NAME, "Processed 0x%08X bytes.\r\n", address - start);
@@ -1,8 +1,7 @@
 #pragma once
 
 #include "Types.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 #include "../gs/GSHandler.h"
 #include "../Profiler.h"
 
@@ -56,8 +55,8 @@ public:
 
 	void SetPath3Masked(bool);
 
-	void LoadState(Framework::CZipArchiveReader&);
-	void SaveState(Framework::CZipArchiveWriter&);
+	void LoadState(CStateArchiveReader&);
+	void SaveState(CStateArchiveWriter&);
 
 private:
 	enum SIGNAL_STATE
@@ -70,6 +69,7 @@ private:
 	uint32 ProcessPacked(CGSHandler::RegisterWriteList&, const uint8*, uint32, uint32);
 	uint32 ProcessRegList(CGSHandler::RegisterWriteList&, const uint8*, uint32, uint32);
 	uint32 ProcessImage(const uint8*, uint32, uint32);
+	void FlushWriteList(const CGsPacketMetadata&);
 
 	void DisassembleGet(uint32);
 	void DisassembleSet(uint32, uint32);
@@ -88,6 +88,7 @@ private:
 	uint8* m_ram;
 	uint8* m_spr;
 	CGSHandler*& m_gs;
+	CGSHandler::RegisterWriteList m_writeList;
 
 	CProfiler::ZoneHandle m_gifProfilerZone = 0;
 };
@@ -75,14 +75,14 @@ void CINTC::AssertLine(uint32 nLine)
 	m_INTC_STAT |= (1 << nLine);
 }
 
-void CINTC::LoadState(Framework::CZipArchiveReader& archive)
+void CINTC::LoadState(CStateArchiveReader& archive)
 {
 	CRegisterStateFile registerFile(*archive.BeginReadFile(STATE_REGS_XML));
 	m_INTC_STAT = registerFile.GetRegister32("INTC_STAT");
 	m_INTC_MASK = registerFile.GetRegister32("INTC_MASK");
 }
 
-void CINTC::SaveState(Framework::CZipArchiveWriter& archive)
+void CINTC::SaveState(CStateArchiveWriter& archive)
 {
 	CRegisterStateFile* registerFile = new CRegisterStateFile(STATE_REGS_XML);
 	registerFile->SetRegister32("INTC_STAT", m_INTC_STAT);
@@ -2,8 +2,7 @@
 
 #include "Types.h"
 #include "DMAC.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 class CINTC
 {
@@ -40,8 +39,8 @@ public:
 
 	void AssertLine(uint32);
 
-	void LoadState(Framework::CZipArchiveReader&);
-	void SaveState(Framework::CZipArchiveWriter&);
+	void LoadState(CStateArchiveReader&);
+	void SaveState(CStateArchiveWriter&);
 
 private:
 	uint32 GetStat() const;
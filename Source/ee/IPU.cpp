@@ -1,5 +1,7 @@
 #include <cassert>
 #include <cstring>
+#include <cmath>
+#include <algorithm>
 #include <stdio.h>
 #include <exception>
 #include <functional>
@@ -18,7 +20,8 @@
 #include "mpeg2/QuantiserScaleTable.h"
 #include "mpeg2/InverseScanTable.h"
 #include "idct/TrivialC.h"
-#include "idct/IEEE1180.h"
+#include "IPU_Idct.h"
+#include "IPU_Csc.h"
 #include "../Log.h"
 #include "DMAC.h"
 #include "INTC.h"
@@ -77,14 +80,18 @@ CIPU::CIPU(CINTC& intc)
     , m_isBusy(false)
     , m_currentCmd(nullptr)
 {
+	m_BCLRCommand.SetInputResetHandler([this]() { ResetAsyncInput(); });
 }
 
 CIPU::~CIPU()
 {
+	StopAsyncThread();
 }
 
 void CIPU::Reset()
 {
+	auto asyncLock = SynchronizeAsync();
+
 	m_IPU_CTRL = 0;
 	m_IPU_CMD[0] = 0;
 	m_IPU_CMD[1] = 0;
@@ -103,6 +110,8 @@ void CIPU::Reset()
 
 	m_IN_FIFO.Reset();
 	m_OUT_FIFO.Reset();
+
+	ResetAsyncQueues();
 }
 
 uint32 CIPU::GetRegister(uint32 nAddress)
@@ -111,6 +120,8 @@ uint32 CIPU::GetRegister(uint32 nAddress)
 //	DisassembleGet(nAddress);
 #endif
 
+	auto asyncLock = SynchronizeAsync();
+
 	switch(nAddress)
 	{
 	case IPU_CMD + 0x0:
@@ -130,7 +141,7 @@ uint32 CIPU::GetRegister(uint32 nAddress)
 		}
 		break;
 	case IPU_CMD + 0x4:
-		return GetBusyBit(m_isBusy);
+		return GetBusyBit(IsBusy());
 		break;
 	case IPU_CMD + 0x8:
 	case IPU_CMD + 0xC:
@@ -139,7 +150,7 @@ uint32 CIPU::GetRegister(uint32 nAddress)
 	case IPU_CTRL + 0x0:
 	{
 		auto fifoState = GetFifoState();
-		return m_IPU_CTRL | GetBusyBit(m_isBusy) | fifoState.ifc;
+		return m_IPU_CTRL | GetBusyBit(IsBusy()) | fifoState.ifc;
 	}
 	break;
 	case IPU_CTRL + 0x4:
@@ -160,7 +171,7 @@ uint32 CIPU::GetRegister(uint32 nAddress)
 		break;
 
 	case IPU_TOP + 0x0:
-		if(!m_isBusy)
+		if(!IsBusy())
 		{
 			unsigned int availableSize = std::min<unsigned int>(32, m_IN_FIFO.GetAvailableBits());
 			//If no bits are available, return zero immediately, shift below won't have any effect
@@ -180,7 +191,7 @@ uint32 CIPU::GetRegister(uint32 nAddress)
 		//Not quite sure about this... are we really busy if there's no data in the FIFO?
 		//This was needed to fix Timesplitters
 		unsigned int availableSize = std::min<unsigned int>(32, m_IN_FIFO.GetAvailableBits());
-		return GetBusyBit(m_isBusy) | GetBusyBit(availableSize != 32);
+		return GetBusyBit(IsBusy()) | GetBusyBit(availableSize != 32);
 	}
 	break;
 
@@ -202,12 +213,14 @@ void CIPU::SetRegister(uint32 nAddress, uint32 nValue)
 	DisassembleSet(nAddress, nValue);
 #endif
 
+	auto asyncLock = SynchronizeAsync();
+
 	switch(nAddress)
 	{
 	case IPU_CMD + 0x0:
 		//Set BUSY states
 		{
-			assert(m_isBusy == false);
+			assert(IsBusy() == false);
 			if(m_currentCmd != NULL)
 			{
 				assert(m_IPU_CTRL & IPU_CTRL_ECD);
@@ -216,6 +229,11 @@ void CIPU::SetRegister(uint32 nAddress, uint32 nValue)
 			m_IPU_CTRL &= ~IPU_CTRL_SCD;
 			InitializeCommand(nValue);
 			m_isBusy = true;
+			if(m_asyncEnabled)
+			{
+				m_asyncHasWork = true;
+				m_asyncCondition.notify_all();
+			}
 		}
 #ifdef _DEBUG
 		DisassembleCommand(nValue);
@@ -233,6 +251,7 @@ void CIPU::SetRegister(uint32 nAddress, uint32 nValue)
 			m_currentCmd = nullptr;
 			m_IN_FIFO.Reset();
 			m_OUT_FIFO.Reset();
+			ResetAsyncQueues();
 		}
 		nValue &= 0x3FFF0000;
 		m_IPU_CTRL &= ~0x3FFF0000;
@@ -247,7 +266,18 @@ void CIPU::SetRegister(uint32 nAddress, uint32 nValue)
 	case IPU_IN_FIFO + 0x4:
 	case IPU_IN_FIFO + 0x8:
 	case IPU_IN_FIFO + 0xC:
-		m_IN_FIFO.Write(&nValue, 4);
+		if(m_asyncEnabled)
+		{
+			//Keep ordering with data that was already received through DMA
+			WriteAsyncInput(reinterpret_cast<const uint8*>(&nValue), 4);
+			FillInFifoFromAsyncQueue();
+			m_asyncHasWork = true;
+			m_asyncCondition.notify_all();
+		}
+		else
+		{
+			m_IN_FIFO.Write(&nValue, 4);
+		}
 		break;
 
 	default:
@@ -258,6 +288,18 @@ void CIPU::SetRegister(uint32 nAddress, uint32 nValue)
 
 void CIPU::CountTicks(uint32 ticks)
 {
+	if(m_asyncEnabled)
+	{
+		//Only delayed commands care about ticks
+		std::lock_guard<std::mutex> asyncLock(m_asyncMutex);
+		if(m_asyncCommandDelayed)
+		{
+			m_asyncPendingTicks += ticks;
+			m_asyncHasWork = true;
+			m_asyncCondition.notify_all();
+		}
+		return;
+	}
 	if(m_currentCmd)
 	{
 		m_currentCmd->CountTicks(ticks);
@@ -288,7 +330,7 @@ void CIPU::ExecuteCommand()
 
 		//Clear BUSY states
 		m_isBusy = false;
-		m_intc.AssertLine(CINTC::INTC_LINE_IPU);
+		SignalCommandDone();
 	}
 	catch(const Framework::CBitStream::CBitStreamException&)
 	{
@@ -395,6 +437,8 @@ void CIPU::InitializeCommand(uint32 value)
 
 void CIPU::SetDMA3ReceiveHandler(const Dma3ReceiveHandler& receiveHandler)
 {
+	m_dma3ReceiveHandler = receiveHandler;
+	if(m_asyncEnabled) return;
 	m_OUT_FIFO.SetReceiveHandler(receiveHandler);
 }
 
@@ -402,7 +446,20 @@ uint32 CIPU::ReceiveDMA4(uint32 address, uint32 nQWC, bool nTagIncluded, uint8*
 {
 	assert(nTagIncluded == false);
 
-	uint32 availableFifoSize = CINFIFO::BUFFERSIZE - m_IN_FIFO.GetSize();
+	//In async mode, the worker owns the IN FIFO and data goes through the input queue instead
+	std::unique_lock<std::mutex> asyncLock;
+	uint32 availableFifoSize = 0;
+	if(m_asyncEnabled)
+	{
+		asyncLock = std::unique_lock<std::mutex>(m_asyncMutex);
+		uint32 queuedSize = static_cast<uint32>(m_asyncInput.size()) - m_asyncInputPosition;
+		uint32 usedFifoSize = std::min<uint32>(m_asyncInFifoSize + queuedSize, CINFIFO::BUFFERSIZE);
+		availableFifoSize = (CINFIFO::BUFFERSIZE - usedFifoSize) & ~0xF;
+	}
+	else
+	{
+		availableFifoSize = CINFIFO::BUFFERSIZE - m_IN_FIFO.GetSize();
+	}
 
 	uint32 size = std::min<uint32>(nQWC * 0x10, availableFifoSize);
 	assert((size & 0xF) == 0);
@@ -421,7 +478,16 @@ uint32 CIPU::ReceiveDMA4(uint32 address, uint32 nQWC, bool nTagIncluded, uint8*
 
 	if(size != 0)
 	{
-		m_IN_FIFO.Write(memory + address, size);
+		if(m_asyncEnabled)
+		{
+			WriteAsyncInput(memory + address, size);
+			m_asyncHasWork = true;
+			m_asyncCondition.notify_all();
+		}
+		else
+		{
+			m_IN_FIFO.Write(memory + address, size);
+		}
 	}
 
 	return size / 0x10;
@@ -593,6 +659,222 @@ uint32 CIPU::GetBusyBit(bool condition) const
 	return condition ? 0x80000000 : 0x00000000;
 }
 
+bool CIPU::IsBusy() const
+{
+	//In async mode, a command is only considered done once its output reached DMA3
+	return m_isBusy || !m_asyncOutput.empty() || m_asyncOutFifoPending;
+}
+
+void CIPU::SignalCommandDone()
+{
+	if(m_asyncEnabled)
+	{
+		//Interrupt is raised on the EE thread once the output queue is drained
+		std::lock_guard<std::mutex> asyncLock(m_asyncMutex);
+		m_asyncInterruptPending = true;
+		m_asyncOutFifoPending = (m_OUT_FIFO.GetSize() != 0);
+	}
+	else
+	{
+		m_intc.AssertLine(CINTC::INTC_LINE_IPU);
+	}
+}
+
+void CIPU::SetAsyncEnabled(bool enabled)
+{
+	if(m_asyncEnabled == enabled) return;
+	if(enabled)
+	{
+		m_asyncEnabled = true;
+		m_asyncThreadDone = false;
+		m_OUT_FIFO.SetReceiveHandler(std::bind(&CIPU::QueueAsyncOutput, this, std::placeholders::_1, std::placeholders::_2));
+		m_asyncThread = std::thread([this]() { AsyncThreadProc(); });
+	}
+	else
+	{
+		StopAsyncThread();
+		m_asyncEnabled = false;
+		m_OUT_FIFO.SetReceiveHandler(m_dma3ReceiveHandler);
+		ResetAsyncQueues();
+	}
+}
+
+bool CIPU::IsAsyncEnabled() const
+{
+	return m_asyncEnabled;
+}
+
+void CIPU::ProcessAsyncEvents()
+{
+	assert(m_asyncEnabled);
+	std::lock_guard<std::mutex> asyncLock(m_asyncMutex);
+	if(!m_asyncOutput.empty())
+	{
+		uint32 copiedSize = m_dma3ReceiveHandler(m_asyncOutput.data(), static_cast<uint32>(m_asyncOutput.size() / 0x10)) * 0x10;
+		if(copiedSize != 0)
+		{
+			m_asyncOutput.erase(m_asyncOutput.begin(), m_asyncOutput.begin() + copiedSize);
+			m_asyncHasWork = true;
+		}
+	}
+	DeliverAsyncInterrupt();
+	if(m_asyncHasWork)
+	{
+		m_asyncCondition.notify_all();
+	}
+}
+
+void CIPU::DeliverAsyncInterrupt()
+{
+	//Async mutex must be held by caller
+	if(m_asyncInterruptPending && m_asyncOutput.empty() && !m_asyncOutFifoPending)
+	{
+		m_asyncInterruptPending = false;
+		m_intc.AssertLine(CINTC::INTC_LINE_IPU);
+	}
+}
+
+std::unique_lock<std::mutex> CIPU::SynchronizeAsync()
+{
+	if(!m_asyncEnabled) return std::unique_lock<std::mutex>();
+	std::unique_lock<std::mutex> asyncLock(m_asyncMutex);
+	m_asyncCondition.notify_all();
+	m_asyncCondition.wait(asyncLock, [this]() { return !m_asyncRunning && !m_asyncHasWork; });
+	//Worker is idle, state can be accessed from here on. Top up the IN FIFO
+	//like the DMA would have, so that IFC/BP match what the hardware reports.
+	if(FillInFifoFromAsyncQueue())
+	{
+		m_asyncHasWork = true;
+		m_asyncCondition.notify_all();
+	}
+	//Busy bit might go down now, make sure the interrupt is visible at the same time
+	DeliverAsyncInterrupt();
+	return asyncLock;
+}
+
+void CIPU::StopAsyncThread()
+{
+	if(!m_asyncThread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> asyncLock(m_asyncMutex);
+		m_asyncThreadDone = true;
+	}
+	m_asyncCondition.notify_all();
+	m_asyncThread.join();
+}
+
+void CIPU::ResetAsyncQueues()
+{
+	m_asyncInput.clear();
+	m_asyncInputPosition = 0;
+	m_asyncInFifoSize = 0;
+	m_asyncOutput.clear();
+	m_asyncOutFifoPending = false;
+	m_asyncPendingTicks = 0;
+	m_asyncCommandDelayed = false;
+	m_asyncInterruptPending = false;
+	m_asyncHasWork = false;
+}
+
+void CIPU::ResetAsyncInput()
+{
+	//Called by BCLR, data queued before the command must not end up in the IN FIFO
+	if(!m_asyncEnabled) return;
+	std::lock_guard<std::mutex> asyncLock(m_asyncMutex);
+	m_asyncInput.clear();
+	m_asyncInputPosition = 0;
+}
+
+bool CIPU::FillInFifoFromAsyncQueue()
+{
+	//Async mutex must be held by caller
+	uint32 queuedSize = static_cast<uint32>(m_asyncInput.size()) - m_asyncInputPosition;
+	uint32 size = std::min<uint32>(queuedSize, CINFIFO::BUFFERSIZE - m_IN_FIFO.GetSize());
+	if(size != 0)
+	{
+		m_IN_FIFO.Write(m_asyncInput.data() + m_asyncInputPosition, size);
+		m_asyncInputPosition += size;
+		if(m_asyncInputPosition == m_asyncInput.size())
+		{
+			m_asyncInput.clear();
+			m_asyncInputPosition = 0;
+		}
+	}
+	m_asyncInFifoSize = m_IN_FIFO.GetSize();
+	return size != 0;
+}
+
+void CIPU::WriteAsyncInput(const uint8* data, uint32 size)
+{
+	//Async mutex must be held by caller
+	if(m_asyncInputPosition != 0)
+	{
+		m_asyncInput.erase(m_asyncInput.begin(), m_asyncInput.begin() + m_asyncInputPosition);
+		m_asyncInputPosition = 0;
+	}
+	m_asyncInput.insert(m_asyncInput.end(), data, data + size);
+}
+
+uint32 CIPU::QueueAsyncOutput(const void* data, uint32 qwc)
+{
+	std::lock_guard<std::mutex> asyncLock(m_asyncMutex);
+	uint32 availableQwc = static_cast<uint32>(ASYNC_OUTPUT_QUEUE_SIZE - m_asyncOutput.size()) / 0x10;
+	uint32 size = std::min<uint32>(qwc, availableQwc) * 0x10;
+	auto bytes = reinterpret_cast<const uint8*>(data);
+	m_asyncOutput.insert(m_asyncOutput.end(), bytes, bytes + size);
+	return size / 0x10;
+}
+
+void CIPU::AsyncThreadProc()
+{
+	while(1)
+	{
+		uint32 ticks = 0;
+		{
+			std::unique_lock<std::mutex> asyncLock(m_asyncMutex);
+			m_asyncRunning = false;
+			m_asyncCondition.notify_all();
+			m_asyncCondition.wait(asyncLock, [this]() { return m_asyncThreadDone || m_asyncHasWork; });
+			if(m_asyncThreadDone) break;
+			m_asyncHasWork = false;
+			m_asyncRunning = true;
+			ticks = m_asyncPendingTicks;
+			m_asyncPendingTicks = 0;
+		}
+
+		//Output queue might have been drained since last time, push what the previous command left behind
+		if(m_OUT_FIFO.GetSize() != 0)
+		{
+			m_OUT_FIFO.Flush();
+		}
+
+		if(m_currentCmd && (ticks != 0))
+		{
+			m_currentCmd->CountTicks(ticks);
+		}
+
+		while(WillExecuteCommand())
+		{
+			{
+				std::lock_guard<std::mutex> asyncLock(m_asyncMutex);
+				FillInFifoFromAsyncQueue();
+			}
+			ExecuteCommand();
+			if(!WillExecuteCommand() || IsCommandDelayed()) break;
+			//Command is starved or output queue is full, keep going only if more input came in
+			std::lock_guard<std::mutex> asyncLock(m_asyncMutex);
+			if(!FillInFifoFromAsyncQueue()) break;
+		}
+
+		{
+			std::lock_guard<std::mutex> asyncLock(m_asyncMutex);
+			m_asyncCommandDelayed = IsCommandDelayed();
+			m_asyncOutFifoPending = (m_OUT_FIFO.GetSize() != 0);
+			m_asyncInFifoSize = m_IN_FIFO.GetSize();
+		}
+	}
+}
+
 CIPU::FIFO_STATE CIPU::GetFifoState() const
 {
 	uint32 bp = m_IN_FIFO.GetBitIndex();
@@ -826,6 +1108,42 @@ void CIPU::CINFIFO::Write(void* data, unsigned int size)
 	m_lookupBitsDirty = true;
 }
 
+unsigned int CIPU::CINFIFO::ReadBytes(uint8* data, unsigned int size)
+{
+	unsigned int readSize = std::min<unsigned int>(size, GetAvailableBits() / 8);
+	if(readSize == 0)
+	{
+		return 0;
+	}
+
+	if((m_bitPosition & 7) != 0)
+	{
+		for(unsigned int i = 0; i < readSize; i++)
+		{
+			uint32 value = 0;
+			bool result = TryGetBits_MSBF(8, value);
+			assert(result);
+			data[i] = static_cast<uint8>(value);
+		}
+		return readSize;
+	}
+
+	memcpy(data, m_buffer + (m_bitPosition / 8), readSize);
+	m_bitPosition += readSize * 8;
+
+	//Discard the read bytes
+	unsigned int discardSize = (m_bitPosition / 128) * 16;
+	if(discardSize != 0)
+	{
+		memmove(m_buffer, m_buffer + discardSize, m_size - discardSize);
+		m_size -= discardSize;
+		m_bitPosition -= discardSize * 8;
+	}
+	m_lookupBitsDirty = true;
+
+	return readSize;
+}
+
 bool CIPU::CINFIFO::TryPeekBits_LSBF(uint8 nBits, uint32& result)
 {
 	//Shouldn't be used
@@ -950,8 +1268,17 @@ void CIPU::CBCLRCommand::Initialize(CINFIFO* fifo, uint32 commandCode)
 	m_commandCode = commandCode;
 }
 
+void CIPU::CBCLRCommand::SetInputResetHandler(const InputResetHandler& inputResetHandler)
+{
+	m_inputResetHandler = inputResetHandler;
+}
+
 bool CIPU::CBCLRCommand::Execute()
 {
+	if(m_inputResetHandler)
+	{
+		m_inputResetHandler();
+	}
 	m_IN_FIFO->Reset();
 	m_IN_FIFO->SetBitPosition(m_commandCode & 0x7F);
 	return true;
@@ -1325,7 +1652,7 @@ bool CIPU::CBDECCommand::Execute()
 
 			memcpy(blockTemp, blockInfo.block, sizeof(int16) * 0x40);
 
-			IDCT::CIEEE1180::GetInstance()->Transform(blockTemp, blockInfo.block);
+			IPU::CIdct::GetInstance()->Transform(blockTemp, blockInfo.block);
 
 			m_state = STATE_DECODEBLOCK_GOTONEXT;
 		}
@@ -1415,7 +1742,8 @@ void CIPU::CBDECCommand_ReadDct::Initialize(CINFIFO* fifo, int16* block, unsigne
 	m_blockIndex = 0;
 	m_dcDiff = 0;
 
-	if(m_mbi && !m_isMpeg1CoeffVLCTable)
+	bool isTable1 = m_mbi && !m_isMpeg1CoeffVLCTable;
+	if(isTable1)
 	{
 		m_coeffTable = &CDctCoefficientTable1::GetInstance();
 	}
@@ -1423,6 +1751,7 @@ void CIPU::CBDECCommand_ReadDct::Initialize(CINFIFO* fifo, int16* block, unsigne
 	{
 		m_coeffTable = &CDctCoefficientTable0::GetInstance();
 	}
+	m_lookupTable = &CDctCoefficientLookupTable::GetInstance(isTable1, m_isMpeg2);
 }
 
 bool CIPU::CBDECCommand_ReadDct::Execute()
@@ -1466,6 +1795,10 @@ bool CIPU::CBDECCommand_ReadDct::Execute()
 		break;
 		case STATE_CHECKEOB:
 		{
+			if(TryDecodeCoeffsFast())
+			{
+				return true;
+			}
 			bool isEob = false;
 			if(m_coeffTable->TryIsEndOfBlock(m_IN_FIFO, isEob) != CVLCTable::DECODE_STATUS_SUCCESS)
 			{
@@ -1530,6 +1863,30 @@ bool CIPU::CBDECCommand_ReadDct::Execute()
 	}
 }
 
+//Decodes coefficients through the lookup table as long as enough bits are buffered
+//and codes are short enough. Returns true if the end of block was reached, otherwise
+//the state machine picks up from where this stopped.
+bool CIPU::CBDECCommand_ReadDct::TryDecodeCoeffsFast()
+{
+#ifdef _DECODE_LOGGING
+	unsigned int startIndex = m_blockIndex;
+#endif
+	bool isEob = m_lookupTable->TryDecodeCoeffs(*m_IN_FIFO, m_block, m_blockIndex);
+#ifdef _DECODE_LOGGING
+	//Blocks are cleared before decoding and table levels are never 0
+	for(unsigned int i = startIndex; i < m_blockIndex; i++)
+	{
+		if(m_block[i] == 0) continue;
+		CLog::GetInstance().Print(DECODE_LOG_NAME, "[%d]: %d ", i, m_block[i]);
+	}
+	if(isEob)
+	{
+		CLog::GetInstance().Print(DECODE_LOG_NAME, "\r\n");
+	}
+#endif
+	return isEob;
+}
+
 /////////////////////////////////////////////
 //BDEC ReadDcDiff subcommand implementation
 /////////////////////////////////////////////
@@ -1836,7 +2193,6 @@ bool CIPU::CSETVQCommand::Execute()
 
 CIPU::CCSCCommand::CCSCCommand()
 {
-	GenerateCbCrMap();
 }
 
 void CIPU::CCSCCommand::Initialize(CINFIFO* input, COUTFIFO* output, uint32 commandCode, uint16 TH0, uint16 TH1)
@@ -1882,91 +2238,28 @@ bool CIPU::CCSCCommand::Execute()
 			}
 			else
 			{
-				uint32 blockValue = 0;
-				if(!m_IN_FIFO->TryGetBits_MSBF(8, blockValue))
+				m_currentIndex += m_IN_FIFO->ReadBytes(m_block + m_currentIndex, BLOCK_SIZE - m_currentIndex);
+				if(m_currentIndex != BLOCK_SIZE)
 				{
 					return false;
 				}
-				m_block[m_currentIndex] = static_cast<uint8>(blockValue);
-				m_currentIndex++;
 			}
 		}
 		break;
 		case STATE_CONVERTBLOCK:
 		{
-			uint32 nPixel[0x100];
-
-			uint8* pY = m_block;
-			uint8* nBlockCb = m_block + 0x100;
-			uint8* nBlockCr = m_block + 0x140;
-
-			uint32* pPixel = nPixel;
-			unsigned int* pCbCrMap = m_nCbCrMap;
-
-			uint32 alphaTh0 = (m_TH0 & 0xFF) | ((m_TH0 & 0xFF) << 8) | ((m_TH0 & 0xFF) << 16);
-			uint32 alphaTh1 = (m_TH1 & 0xFF) | ((m_TH1 & 0xFF) << 8) | ((m_TH1 & 0xFF) << 16);
-
-			for(unsigned int i = 0; i < 16; i++)
+			if(m_command.ofm)
 			{
-				for(unsigned int j = 0; j < 16; j++)
-				{
-					float nY = pY[j];
-					float nCb = nBlockCb[pCbCrMap[j]];
-					float nCr = nBlockCr[pCbCrMap[j]];
-
-					float nR = nY + 1.402f * (nCr - 128);
-					float nG = nY - 0.34414f * (nCb - 128) - 0.71414f * (nCr - 128);
-					float nB = nY + 1.772f * (nCb - 128);
-
-					if(nR < 0)
-					{
-						nR = 0;
-					}
-					if(nR > 255)
-					{
-						nR = 255;
-					}
-					if(nG < 0)
-					{
-						nG = 0;
-					}
-					if(nG > 255)
-					{
-						nG = 255;
-					}
-					if(nB < 0)
-					{
-						nB = 0;
-					}
-					if(nB > 255)
-					{
-						nB = 255;
-					}
-
-					uint8 a = 0;
-					uint32 rgb = (static_cast<uint8>(nB) << 16) | (static_cast<uint8>(nG) << 8) | (static_cast<uint8>(nR) << 0);
-					if(rgb < alphaTh0)
-					{
-						a = 0;
-					}
-					else if(rgb < alphaTh1)
-					{
-						a = 0x40;
-					}
-					else
-					{
-						a = 0x80;
-					}
-
-					pPixel[j] = (a << 24) | rgb;
-				}
-
-				pY += 0x10;
-				pCbCrMap += 0x10;
-				pPixel += 0x10;
+				uint16 pixels[0x100];
+				ConvertBlockRgb16(pixels);
+				m_OUT_FIFO->Write(pixels, sizeof(uint16) * 0x100);
+			}
+			else
+			{
+				uint32 pixels[0x100];
+				ConvertBlockRgb32(pixels);
+				m_OUT_FIFO->Write(pixels, sizeof(uint32) * 0x100);
 			}
-
-			m_OUT_FIFO->Write(nPixel, sizeof(uint32) * 0x100);
 
 			m_mbCount--;
 			m_state = STATE_FLUSHBLOCK;
@@ -1989,21 +2282,37 @@ bool CIPU::CCSCCommand::Execute()
 	}
 }
 
-void CIPU::CCSCCommand::GenerateCbCrMap()
+void CIPU::CCSCCommand::ConvertBlockRgb32(uint32* pixels) const
+{
+	static_assert(BLOCK_SIZE == IPU::CCsc::BLOCK_SIZE, "CSC block sizes must match.");
+	IPU::CCsc::GetInstance()->ConvertBlockRgb32(m_block, pixels, m_TH0, m_TH1);
+}
+
+void CIPU::CCSCCommand::ConvertBlockRgb16(uint16* pixels) const
 {
-	unsigned int* pCbCrMap = m_nCbCrMap;
-	for(unsigned int i = 0; i < 0x40; i += 0x8)
+	static const int32 ditherMatrix[4][4] =
+	    {
+	        {-4, 0, -3, 1},
+	        {2, -2, 3, -1},
+	        {-3, 1, -4, 0},
+	        {3, -1, 2, -2},
+	    };
+
+	uint32 rgb32Pixels[0x100];
+	ConvertBlockRgb32(rgb32Pixels);
+
+	bool dither = (m_command.dte != 0);
+	for(unsigned int i = 0; i < 0x100; i++)
 	{
-		for(unsigned int j = 0; j < 0x10; j += 2)
-		{
-			pCbCrMap[j + 0x00] = (j / 2) + i;
-			pCbCrMap[j + 0x01] = (j / 2) + i;
+		uint32 pixel = rgb32Pixels[i];
+		int32 offset = dither ? ditherMatrix[(i / 0x10) & 3][i & 3] : 0;
 
-			pCbCrMap[j + 0x10] = (j / 2) + i;
-			pCbCrMap[j + 0x11] = (j / 2) + i;
-		}
+		int32 r = std::min<int32>(std::max<int32>(static_cast<int32>((pixel >> 0) & 0xFF) + offset, 0), 255);
+		int32 g = std::min<int32>(std::max<int32>(static_cast<int32>((pixel >> 8) & 0xFF) + offset, 0), 255);
+		int32 b = std::min<int32>(std::max<int32>(static_cast<int32>((pixel >> 16) & 0xFF) + offset, 0), 255);
+		uint32 a = ((pixel >> 24) == 0x40) ? 1 : 0;
 
-		pCbCrMap += 0x20;
+		pixels[i] = static_cast<uint16>((a << 15) | ((b >> 3) << 10) | ((g >> 3) << 5) | (r >> 3));
 	}
 }
 
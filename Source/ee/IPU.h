@@ -1,11 +1,16 @@
 #pragma once
 
 #include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "Types.h"
 #include "BitStream.h"
 #include "MemStream.h"
 #include "mpeg2/VLCTable.h"
 #include "mpeg2/DctCoefficientTable.h"
+#include "IPU_DctCoefficientLookupTable.h"
 #include "../MailBox.h"
 #include "Convertible.h"
 
@@ -42,7 +47,20 @@ public:
 	bool HasPendingOUTFIFOData() const;
 	void FlushOUTFIFOData();
 
+	//When enabled, commands run on a worker thread. Input is taken from DMA4 at the same
+	//pace as the IN FIFO would, output goes through a larger queue. Register accesses wait
+	//for the worker to be idle, so the EE sees consistent IPU_CTRL/IPU_BP values.
+	//Should be set before the VM starts running.
+	void SetAsyncEnabled(bool);
+	bool IsAsyncEnabled() const;
+	void ProcessAsyncEvents();
+
 private:
+	enum
+	{
+		ASYNC_OUTPUT_QUEUE_SIZE = 0x40000,
+	};
+
 	enum IPU_CTRL_BITS
 	{
 		IPU_CTRL_ECD = 0x00004000,
@@ -154,6 +172,7 @@ private:
 		virtual ~CINFIFO();
 
 		void Write(void*, unsigned int);
+		unsigned int ReadBytes(uint8*, unsigned int);
 
 		void Advance(uint8) override;
 		uint8 GetBitIndex() const override;
@@ -207,13 +226,17 @@ private:
 	class CBCLRCommand : public CCommand
 	{
 	public:
+		typedef std::function<void()> InputResetHandler;
+
 		CBCLRCommand();
 		void Initialize(CINFIFO*, uint32);
+		void SetInputResetHandler(const InputResetHandler&);
 		bool Execute() override;
 
 	private:
 		CINFIFO* m_IN_FIFO;
 		uint32 m_commandCode;
+		InputResetHandler m_inputResetHandler;
 	};
 
 	//0x01 ------------------------------------------------------------
@@ -315,6 +338,8 @@ private:
 			STATE_SKIPEOB
 		};
 
+		bool TryDecodeCoeffsFast();
+
 		CINFIFO* m_IN_FIFO;
 		STATE m_state;
 		int16* m_block;
@@ -324,6 +349,7 @@ private:
 		bool m_isMpeg2;
 		unsigned int m_blockIndex;
 		MPEG2::CDctCoefficientTable* m_coeffTable;
+		const IPU::CDctCoefficientLookupTable* m_lookupTable = nullptr;
 		int16* m_dcPredictor;
 		int16 m_dcDiff;
 		CBDECCommand_ReadDcDiff m_readDcDiffCommand;
@@ -477,7 +503,8 @@ private:
 			STATE_DONE,
 		};
 
-		void GenerateCbCrMap();
+		void ConvertBlockRgb32(uint32*) const;
+		void ConvertBlockRgb16(uint16*) const;
 
 		STATE m_state = STATE_DONE;
 		CMD_CSC m_command = make_convertible<CMD_CSC>(0);
@@ -490,8 +517,6 @@ private:
 		unsigned int m_currentIndex = 0;
 		unsigned int m_mbCount = 0;
 
-		unsigned int m_nCbCrMap[0x100];
-
 		uint8 m_block[BLOCK_SIZE];
 	};
 
@@ -524,8 +549,21 @@ private:
 	static void InverseScan(int16*, bool isZigZag);
 
 	uint32 GetBusyBit(bool) const;
+	bool IsBusy() const;
 	FIFO_STATE GetFifoState() const;
 
+	void SignalCommandDone();
+
+	std::unique_lock<std::mutex> SynchronizeAsync();
+	void StopAsyncThread();
+	void ResetAsyncQueues();
+	void ResetAsyncInput();
+	void DeliverAsyncInterrupt();
+	bool FillInFifoFromAsyncQueue();
+	void WriteAsyncInput(const uint8*, uint32);
+	uint32 QueueAsyncOutput(const void*, uint32);
+	void AsyncThreadProc();
+
 	void DisassembleGet(uint32);
 	void DisassembleSet(uint32, uint32);
 	void DisassembleCommand(uint32);
@@ -557,4 +595,24 @@ private:
 	CSETVQCommand m_SETVQCommand;
 	CCSCCommand m_CSCCommand;
 	CSETTHCommand m_SETTHCommand;
+
+	Dma3ReceiveHandler m_dma3ReceiveHandler;
+
+	bool m_asyncEnabled = false;
+	std::thread m_asyncThread;
+	std::mutex m_asyncMutex;
+	std::condition_variable m_asyncCondition;
+	bool m_asyncThreadDone = false;
+	bool m_asyncRunning = false;
+	bool m_asyncHasWork = false;
+	bool m_asyncCommandDelayed = false;
+	bool m_asyncInterruptPending = false;
+	uint32 m_asyncPendingTicks = 0;
+	std::vector<uint8> m_asyncInput;
+	uint32 m_asyncInputPosition = 0;
+	//IN FIFO level last seen by the worker, DMA4 never takes more than the FIFO could hold
+	//so that MADR/QWC stay in line with what IPU_CTRL.IFC reports
+	uint32 m_asyncInFifoSize = 0;
+	std::vector<uint8> m_asyncOutput;
+	bool m_asyncOutFifoPending = false;
 };
@@ -0,0 +1,204 @@
+#include <cmath>
+#include <algorithm>
+#include "IPU_Csc.h"
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define CSC_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CSC_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace IPU;
+
+CCsc::CCsc()
+{
+	//Products are computed in single precision like the original floating point
+	//conversion did, which keeps the fixed point results identical to it
+	for(unsigned int i = 0; i < 0x100; i++)
+	{
+		float value = static_cast<float>(i) - 128;
+		m_crToR[i] = static_cast<int32>(std::lround(static_cast<double>(1.402f * value) * 65536.0));
+		m_cbToG[i] = static_cast<int32>(std::lround(static_cast<double>(0.34414f * value) * 65536.0));
+		m_crToG[i] = static_cast<int32>(std::lround(static_cast<double>(0.71414f * value) * 65536.0));
+		m_cbToB[i] = static_cast<int32>(std::lround(static_cast<double>(1.772f * value) * 65536.0));
+	}
+}
+
+CCsc* CCsc::GetInstance()
+{
+	static CCsc instance;
+	return &instance;
+}
+
+#if defined(CSC_SSE2)
+
+//Adds the chroma contributions (each one shared by 2 horizontal pixels) to 16 luma values
+//and clamps the results to 0-255 through saturating packs
+static __m128i ConvertChannel(const __m128i* y, const int32* offsets)
+{
+	__m128i offsets0 = _mm_load_si128(reinterpret_cast<const __m128i*>(offsets));
+	__m128i offsets1 = _mm_load_si128(reinterpret_cast<const __m128i*>(offsets + 4));
+	__m128i value0 = _mm_srai_epi32(_mm_add_epi32(y[0], _mm_unpacklo_epi32(offsets0, offsets0)), 16);
+	__m128i value1 = _mm_srai_epi32(_mm_add_epi32(y[1], _mm_unpackhi_epi32(offsets0, offsets0)), 16);
+	__m128i value2 = _mm_srai_epi32(_mm_add_epi32(y[2], _mm_unpacklo_epi32(offsets1, offsets1)), 16);
+	__m128i value3 = _mm_srai_epi32(_mm_add_epi32(y[3], _mm_unpackhi_epi32(offsets1, offsets1)), 16);
+	return _mm_packus_epi16(_mm_packs_epi32(value0, value1), _mm_packs_epi32(value2, value3));
+}
+
+static void ConvertRows(const uint8* blockY, const int32* rOffsets, const int32* gOffsets, const int32* bOffsets,
+                        uint32* pixels, uint32 alphaTh0, uint32 alphaTh1)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i alphaTh0Vector = _mm_set1_epi32(alphaTh0);
+	__m128i alphaTh1Vector = _mm_set1_epi32(alphaTh1);
+	__m128i alphaHalf = _mm_set1_epi32(0x40000000);
+	__m128i alphaFull = _mm_set1_epi32(static_cast<int32>(0x80000000));
+
+	for(unsigned int row = 0; row < 0x10; row++)
+	{
+		unsigned int chromaOffset = (row / 2) * 8;
+
+		//Luma values in 16.16 fixed point
+		__m128i yBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blockY + (row * 0x10)));
+		__m128i yWords0 = _mm_unpacklo_epi8(yBytes, zero);
+		__m128i yWords1 = _mm_unpackhi_epi8(yBytes, zero);
+		__m128i y[4] =
+		    {
+		        _mm_unpacklo_epi16(zero, yWords0),
+		        _mm_unpackhi_epi16(zero, yWords0),
+		        _mm_unpacklo_epi16(zero, yWords1),
+		        _mm_unpackhi_epi16(zero, yWords1),
+		    };
+
+		__m128i r = ConvertChannel(y, rOffsets + chromaOffset);
+		__m128i g = ConvertChannel(y, gOffsets + chromaOffset);
+		__m128i b = ConvertChannel(y, bOffsets + chromaOffset);
+
+		__m128i rg[2] = {_mm_unpacklo_epi8(r, g), _mm_unpackhi_epi8(r, g)};
+		__m128i b0[2] = {_mm_unpacklo_epi8(b, zero), _mm_unpackhi_epi8(b, zero)};
+
+		auto rowPixels = reinterpret_cast<__m128i*>(pixels + (row * 0x10));
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			__m128i rgb = (i & 1) ? _mm_unpackhi_epi16(rg[i / 2], b0[i / 2]) : _mm_unpacklo_epi16(rg[i / 2], b0[i / 2]);
+			__m128i belowTh0 = _mm_cmplt_epi32(rgb, alphaTh0Vector);
+			__m128i belowTh1 = _mm_cmplt_epi32(rgb, alphaTh1Vector);
+			__m128i alpha = _mm_or_si128(_mm_and_si128(belowTh1, alphaHalf), _mm_andnot_si128(belowTh1, alphaFull));
+			alpha = _mm_andnot_si128(belowTh0, alpha);
+			_mm_storeu_si128(rowPixels + i, _mm_or_si128(rgb, alpha));
+		}
+	}
+}
+
+#elif defined(CSC_NEON)
+
+static uint8x16_t ConvertChannel(const int32x4_t* y, const int32* offsets)
+{
+	int32x4_t offsets0 = vld1q_s32(offsets);
+	int32x4_t offsets1 = vld1q_s32(offsets + 4);
+	int32x4_t value0 = vshrq_n_s32(vaddq_s32(y[0], vzip1q_s32(offsets0, offsets0)), 16);
+	int32x4_t value1 = vshrq_n_s32(vaddq_s32(y[1], vzip2q_s32(offsets0, offsets0)), 16);
+	int32x4_t value2 = vshrq_n_s32(vaddq_s32(y[2], vzip1q_s32(offsets1, offsets1)), 16);
+	int32x4_t value3 = vshrq_n_s32(vaddq_s32(y[3], vzip2q_s32(offsets1, offsets1)), 16);
+	int16x8_t words0 = vcombine_s16(vqmovn_s32(value0), vqmovn_s32(value1));
+	int16x8_t words1 = vcombine_s16(vqmovn_s32(value2), vqmovn_s32(value3));
+	return vcombine_u8(vqmovun_s16(words0), vqmovun_s16(words1));
+}
+
+static void ConvertRows(const uint8* blockY, const int32* rOffsets, const int32* gOffsets, const int32* bOffsets,
+                        uint32* pixels, uint32 alphaTh0, uint32 alphaTh1)
+{
+	uint8x16_t zero = vdupq_n_u8(0);
+	uint32x4_t alphaTh0Vector = vdupq_n_u32(alphaTh0);
+	uint32x4_t alphaTh1Vector = vdupq_n_u32(alphaTh1);
+	uint32x4_t alphaHalf = vdupq_n_u32(0x40000000);
+	uint32x4_t alphaFull = vdupq_n_u32(0x80000000);
+
+	for(unsigned int row = 0; row < 0x10; row++)
+	{
+		unsigned int chromaOffset = (row / 2) * 8;
+
+		//Luma values in 16.16 fixed point
+		uint8x16_t yBytes = vld1q_u8(blockY + (row * 0x10));
+		uint16x8_t yWords0 = vmovl_u8(vget_low_u8(yBytes));
+		uint16x8_t yWords1 = vmovl_u8(vget_high_u8(yBytes));
+		int32x4_t y[4] =
+		    {
+		        vreinterpretq_s32_u32(vshll_n_u16(vget_low_u16(yWords0), 16)),
+		        vreinterpretq_s32_u32(vshll_n_u16(vget_high_u16(yWords0), 16)),
+		        vreinterpretq_s32_u32(vshll_n_u16(vget_low_u16(yWords1), 16)),
+		        vreinterpretq_s32_u32(vshll_n_u16(vget_high_u16(yWords1), 16)),
+		    };
+
+		uint8x16_t r = ConvertChannel(y, rOffsets + chromaOffset);
+		uint8x16_t g = ConvertChannel(y, gOffsets + chromaOffset);
+		uint8x16_t b = ConvertChannel(y, bOffsets + chromaOffset);
+
+		uint16x8_t rg[2] = {vreinterpretq_u16_u8(vzip1q_u8(r, g)), vreinterpretq_u16_u8(vzip2q_u8(r, g))};
+		uint16x8_t b0[2] = {vreinterpretq_u16_u8(vzip1q_u8(b, zero)), vreinterpretq_u16_u8(vzip2q_u8(b, zero))};
+
+		uint32* rowPixels = pixels + (row * 0x10);
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			uint16x8_t rgbWords = (i & 1) ? vzip2q_u16(rg[i / 2], b0[i / 2]) : vzip1q_u16(rg[i / 2], b0[i / 2]);
+			uint32x4_t rgb = vreinterpretq_u32_u16(rgbWords);
+			uint32x4_t belowTh0 = vcltq_u32(rgb, alphaTh0Vector);
+			uint32x4_t belowTh1 = vcltq_u32(rgb, alphaTh1Vector);
+			uint32x4_t alpha = vbicq_u32(vbslq_u32(belowTh1, alphaHalf, alphaFull), belowTh0);
+			vst1q_u32(rowPixels + (i * 4), vorrq_u32(rgb, alpha));
+		}
+	}
+}
+
+#else
+
+static void ConvertRows(const uint8* blockY, const int32* rOffsets, const int32* gOffsets, const int32* bOffsets,
+                        uint32* pixels, uint32 alphaTh0, uint32 alphaTh1)
+{
+	for(unsigned int i = 0; i < 0x100; i++)
+	{
+		unsigned int chromaIndex = ((i / 0x20) * 8) + ((i & 0xF) / 2);
+		int32 y = static_cast<int32>(blockY[i]) << 16;
+
+		int32 r = (y + rOffsets[chromaIndex]) >> 16;
+		int32 g = (y + gOffsets[chromaIndex]) >> 16;
+		int32 b = (y + bOffsets[chromaIndex]) >> 16;
+
+		r = std::min<int32>(std::max<int32>(r, 0), 255);
+		g = std::min<int32>(std::max<int32>(g, 0), 255);
+		b = std::min<int32>(std::max<int32>(b, 0), 255);
+
+		uint32 rgb = (b << 16) | (g << 8) | r;
+		uint32 a = (rgb < alphaTh0) ? 0 : ((rgb < alphaTh1) ? 0x40 : 0x80);
+		pixels[i] = (a << 24) | rgb;
+	}
+}
+
+#endif
+
+void CCsc::ConvertBlockRgb32(const uint8* block, uint32* pixels, uint16 TH0, uint16 TH1) const
+{
+	const uint8* blockY = block;
+	const uint8* blockCb = block + 0x100;
+	const uint8* blockCr = block + 0x140;
+
+	//Each chroma sample covers 2x2 pixels, look up its contributions once
+	alignas(16) int32 rOffsets[0x40];
+	alignas(16) int32 gOffsets[0x40];
+	alignas(16) int32 bOffsets[0x40];
+	for(unsigned int i = 0; i < 0x40; i++)
+	{
+		unsigned int cb = blockCb[i];
+		unsigned int cr = blockCr[i];
+		rOffsets[i] = m_crToR[cr];
+		gOffsets[i] = -m_cbToG[cb] - m_crToG[cr];
+		bOffsets[i] = m_cbToB[cb];
+	}
+
+	uint32 alphaTh0 = (TH0 & 0xFF) | ((TH0 & 0xFF) << 8) | ((TH0 & 0xFF) << 16);
+	uint32 alphaTh1 = (TH1 & 0xFF) | ((TH1 & 0xFF) << 8) | ((TH1 & 0xFF) << 16);
+
+	ConvertRows(blockY, rOffsets, gOffsets, bOffsets, pixels, alphaTh0, alphaTh1);
+}
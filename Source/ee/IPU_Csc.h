@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Types.h"
+
+namespace IPU
+{
+	//Converts 4:2:0 macroblocks (256 Y samples followed by 64 Cb and 64 Cr samples)
+	//to RGBA32. Chroma contributions are kept in 16.16 fixed point tables derived from
+	//single precision products, which gives the same results as a float conversion.
+	class CCsc
+	{
+	public:
+		enum
+		{
+			BLOCK_SIZE = 0x180,
+			PIXEL_COUNT = 0x100,
+		};
+
+		CCsc();
+
+		static CCsc* GetInstance();
+
+		void ConvertBlockRgb32(const uint8*, uint32*, uint16, uint16) const;
+
+	private:
+		int32 m_crToR[0x100];
+		int32 m_cbToG[0x100];
+		int32 m_crToG[0x100];
+		int32 m_cbToB[0x100];
+	};
+}
@@ -0,0 +1,177 @@
+#include <cassert>
+#include "IPU_DctCoefficientLookupTable.h"
+#include "mpeg2/DctCoefficientTable0.h"
+#include "mpeg2/DctCoefficientTable1.h"
+
+using namespace IPU;
+using namespace MPEG2;
+
+namespace
+{
+	//Bit stream made of a lookup prefix followed by 32 padding bits
+	class CProbeBitStream : public Framework::CBitStream
+	{
+	public:
+		CProbeBitStream(uint32 prefix, bool padWithOnes)
+		{
+			m_bits = static_cast<uint64>(prefix) << (64 - CDctCoefficientLookupTable::LOOKUP_BITS);
+			if(padWithOnes)
+			{
+				m_bits |= (~0ULL >> CDctCoefficientLookupTable::LOOKUP_BITS);
+			}
+		}
+
+		void Advance(uint8 bits) override
+		{
+			if((m_position + bits) > BIT_COUNT)
+			{
+				throw CBitStreamException();
+			}
+			m_position += bits;
+		}
+
+		uint8 GetBitIndex() const override
+		{
+			return static_cast<uint8>(m_position);
+		}
+
+		bool TryPeekBits_LSBF(uint8, uint32&) override
+		{
+			return false;
+		}
+
+		bool TryPeekBits_MSBF(uint8 size, uint32& result) override
+		{
+			assert((size != 0) && (size <= 32));
+			if((m_position + size) > BIT_COUNT)
+			{
+				return false;
+			}
+			result = static_cast<uint32>((m_bits << m_position) >> (64 - size));
+			return true;
+		}
+
+	private:
+		enum
+		{
+			BIT_COUNT = CDctCoefficientLookupTable::LOOKUP_BITS + 32,
+		};
+
+		uint64 m_bits = 0;
+		unsigned int m_position = 0;
+	};
+
+	typedef CDctCoefficientLookupTable::ENTRY ENTRY;
+
+	bool ProbeEob(CDctCoefficientTable& table, uint32 prefix, bool padWithOnes, uint32& length)
+	{
+		CProbeBitStream stream(prefix, padWithOnes);
+		bool isEob = false;
+		if(table.TryIsEndOfBlock(&stream, isEob) != CVLCTable::DECODE_STATUS_SUCCESS) return false;
+		if(!isEob) return false;
+		if(table.TrySkipEndOfBlock(&stream) != CVLCTable::DECODE_STATUS_SUCCESS) return false;
+		length = stream.GetBitIndex();
+		return true;
+	}
+
+	bool ProbeCoefficient(CDctCoefficientTable& table, bool isMpeg2, bool isFirst, uint32 prefix, bool padWithOnes, ENTRY& entry)
+	{
+		CProbeBitStream stream(prefix, padWithOnes);
+		RUNLEVELPAIR runLevelPair;
+		try
+		{
+			auto status = isFirst ? table.TryGetRunLevelPairDc(&stream, &runLevelPair, isMpeg2) : table.TryGetRunLevelPair(&stream, &runLevelPair, isMpeg2);
+			if(status != CVLCTable::DECODE_STATUS_SUCCESS) return false;
+		}
+		catch(...)
+		{
+			return false;
+		}
+		entry.run = static_cast<uint8>(runLevelPair.run);
+		entry.level = static_cast<int16>(runLevelPair.level);
+		entry.length = stream.GetBitIndex();
+		return true;
+	}
+
+	//Only keeps results that don't depend on bits past the prefix
+	ENTRY ProbeEntry(CDctCoefficientTable& table, bool isMpeg2, bool isFirst, uint32 prefix)
+	{
+		ENTRY result;
+		if(!isFirst)
+		{
+			uint32 eobLength[2] = {};
+			bool isEob[2] = {ProbeEob(table, prefix, false, eobLength[0]), ProbeEob(table, prefix, true, eobLength[1])};
+			if(isEob[0] || isEob[1])
+			{
+				if(isEob[0] && isEob[1] && (eobLength[0] == eobLength[1]) && (eobLength[0] <= CDctCoefficientLookupTable::LOOKUP_BITS))
+				{
+					result.isEob = true;
+					result.length = static_cast<uint8>(eobLength[0]);
+				}
+				return result;
+			}
+		}
+		ENTRY entries[2];
+		if(!ProbeCoefficient(table, isMpeg2, isFirst, prefix, false, entries[0])) return result;
+		if(!ProbeCoefficient(table, isMpeg2, isFirst, prefix, true, entries[1])) return result;
+		if(entries[0].length > CDctCoefficientLookupTable::LOOKUP_BITS) return result;
+		if((entries[0].length != entries[1].length) || (entries[0].run != entries[1].run) || (entries[0].level != entries[1].level)) return result;
+		//Run can't be larger than a block
+		if(entries[0].run >= 0x40) return result;
+		return entries[0];
+	}
+}
+
+CDctCoefficientLookupTable::CDctCoefficientLookupTable(CDctCoefficientTable& table, bool isMpeg2)
+{
+	for(uint32 prefix = 0; prefix < ENTRY_COUNT; prefix++)
+	{
+		m_firstEntries[prefix] = ProbeEntry(table, isMpeg2, true, prefix);
+		m_entries[prefix] = ProbeEntry(table, isMpeg2, false, prefix);
+	}
+}
+
+bool CDctCoefficientLookupTable::TryDecodeCoeffs(Framework::CBitStream& stream, int16* block, unsigned int& blockIndex) const
+{
+	while(1)
+	{
+		uint32 bits = 0;
+		if(!stream.TryPeekBits_MSBF(LOOKUP_BITS, bits))
+		{
+			return false;
+		}
+		const auto& entry = (blockIndex == 0) ? m_firstEntries[bits] : m_entries[bits];
+		if(entry.length == 0)
+		{
+			return false;
+		}
+		stream.Advance(entry.length);
+		if(entry.isEob)
+		{
+			return true;
+		}
+		blockIndex += entry.run;
+		if(blockIndex >= 0x40)
+		{
+			throw CVLCTable::CVLCTableException();
+		}
+		block[blockIndex] = entry.level;
+		blockIndex++;
+	}
+}
+
+const CDctCoefficientLookupTable& CDctCoefficientLookupTable::GetInstance(bool isTable1, bool isMpeg2)
+{
+	static const CDctCoefficientLookupTable table0(CDctCoefficientTable0::GetInstance(), false);
+	static const CDctCoefficientLookupTable table0Mpeg2(CDctCoefficientTable0::GetInstance(), true);
+	static const CDctCoefficientLookupTable table1(CDctCoefficientTable1::GetInstance(), false);
+	static const CDctCoefficientLookupTable table1Mpeg2(CDctCoefficientTable1::GetInstance(), true);
+	if(isTable1)
+	{
+		return isMpeg2 ? table1Mpeg2 : table1;
+	}
+	else
+	{
+		return isMpeg2 ? table0Mpeg2 : table0;
+	}
+}
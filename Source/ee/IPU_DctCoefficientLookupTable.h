@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Types.h"
+#include "mpeg2/DctCoefficientTable.h"
+
+namespace IPU
+{
+	//First level lookup table for DCT coefficient codes. It is built by probing the
+	//MPEG2 coefficient table with every possible LOOKUP_BITS prefix, so it always agrees
+	//with it. Codes longer than LOOKUP_BITS (escapes included) are not in the table
+	//and need to be decoded through the coefficient table itself.
+	class CDctCoefficientLookupTable
+	{
+	public:
+		enum
+		{
+			LOOKUP_BITS = 11,
+		};
+
+		struct ENTRY
+		{
+			int16 level = 0;
+			uint8 run = 0;
+			uint8 length = 0; //0 if the code is not in the table
+			bool isEob = false;
+		};
+
+		CDctCoefficientLookupTable(MPEG2::CDctCoefficientTable&, bool);
+
+		static const CDctCoefficientLookupTable& GetInstance(bool isTable1, bool isMpeg2);
+
+		//Lookup for the first coefficient of non intra blocks (no EOB possible)
+		const ENTRY& GetFirstEntry(uint32 bits) const
+		{
+			return m_firstEntries[bits];
+		}
+
+		const ENTRY& GetEntry(uint32 bits) const
+		{
+			return m_entries[bits];
+		}
+
+		//Decodes coefficients into the block as long as enough bits are available and codes
+		//are in the table. Returns true once the end of block is skipped, otherwise decoding
+		//goes on through the coefficient table from the updated block index.
+		bool TryDecodeCoeffs(Framework::CBitStream&, int16*, unsigned int&) const;
+
+	private:
+		enum
+		{
+			ENTRY_COUNT = (1 << LOOKUP_BITS),
+		};
+
+		ENTRY m_firstEntries[ENTRY_COUNT];
+		ENTRY m_entries[ENTRY_COUNT];
+	};
+}
@@ -0,0 +1,261 @@
+#include <algorithm>
+#include "IPU_Idct.h"
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define IDCT_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define IDCT_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace IPU;
+
+enum
+{
+	W1 = 2841, //2048 * sqrt(2) * cos(1 * pi / 16)
+	W2 = 2676, //2048 * sqrt(2) * cos(2 * pi / 16)
+	W3 = 2408, //2048 * sqrt(2) * cos(3 * pi / 16)
+	W5 = 1609, //2048 * sqrt(2) * cos(5 * pi / 16)
+	W6 = 1108, //2048 * sqrt(2) * cos(6 * pi / 16)
+	W7 = 565,  //2048 * sqrt(2) * cos(7 * pi / 16)
+	W4 = 181,  //256 / sqrt(2)
+};
+
+static void TransformRow(const int16* input, int16* output)
+{
+	if((input[1] | input[2] | input[3] | input[4] | input[5] | input[6] | input[7]) == 0)
+	{
+		int16 value = static_cast<int16>(input[0] * 8);
+		std::fill(output, output + 8, value);
+		return;
+	}
+
+	//Even part
+	int32 d0 = (static_cast<int32>(input[0]) * 2048) + 128;
+	int32 d2 = static_cast<int32>(input[4]) * 2048;
+	int32 t0 = d0 + d2;
+	int32 t1 = d0 - d2;
+	int32 t2 = (W6 * input[6]) + (W2 * input[2]);
+	int32 t3 = (W6 * input[2]) - (W2 * input[6]);
+	int32 a0 = t0 + t2;
+	int32 a1 = t1 + t3;
+	int32 a2 = t1 - t3;
+	int32 a3 = t0 - t2;
+
+	//Odd part
+	t0 = (W7 * input[7]) + (W1 * input[1]);
+	t1 = (W7 * input[1]) - (W1 * input[7]);
+	t2 = (W3 * input[3]) + (W5 * input[5]);
+	t3 = (W3 * input[5]) - (W5 * input[3]);
+	int32 b0 = t0 + t2;
+	int32 b3 = t1 + t3;
+	t0 -= t2;
+	t1 -= t3;
+	int32 b1 = static_cast<int32>((static_cast<int64>(t0 + t1) * W4) >> 8);
+	int32 b2 = static_cast<int32>((static_cast<int64>(t0 - t1) * W4) >> 8);
+
+	output[0] = static_cast<int16>((a0 + b0) >> 8);
+	output[1] = static_cast<int16>((a1 + b1) >> 8);
+	output[2] = static_cast<int16>((a2 + b2) >> 8);
+	output[3] = static_cast<int16>((a3 + b3) >> 8);
+	output[4] = static_cast<int16>((a3 - b3) >> 8);
+	output[5] = static_cast<int16>((a2 - b2) >> 8);
+	output[6] = static_cast<int16>((a1 - b1) >> 8);
+	output[7] = static_cast<int16>((a0 - b0) >> 8);
+}
+
+//Columns are transformed IDCT_LANE_COUNT at a time, values are widened to 32 bits
+
+#if defined(IDCT_SSE2)
+
+#define IDCT_LANE_COUNT 4
+typedef __m128i IdctVector;
+
+static IdctVector LoadColumns(const int16* input)
+{
+	__m128i value = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input));
+	return _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16);
+}
+
+static void StoreColumns(int16* output, IdctVector value)
+{
+	__m128i result = _mm_packs_epi32(_mm_srai_epi32(value, 17), _mm_setzero_si128());
+	result = _mm_min_epi16(_mm_max_epi16(result, _mm_set1_epi16(-256)), _mm_set1_epi16(255));
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(output), result);
+}
+
+static IdctVector Add(IdctVector lhs, IdctVector rhs)
+{
+	return _mm_add_epi32(lhs, rhs);
+}
+
+static IdctVector Sub(IdctVector lhs, IdctVector rhs)
+{
+	return _mm_sub_epi32(lhs, rhs);
+}
+
+//No 32-bit multiply in SSE2, low halves of the 64-bit products are the same for signed values
+static IdctVector Mul(IdctVector value, int32 factor)
+{
+	__m128i factorVector = _mm_set1_epi32(factor);
+	__m128i even = _mm_mul_epu32(value, factorVector);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(value, 32), factorVector);
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static IdctVector ShiftRight8(IdctVector value)
+{
+	return _mm_srai_epi32(value, 8);
+}
+
+static IdctVector Splat(int32 value)
+{
+	return _mm_set1_epi32(value);
+}
+
+#elif defined(IDCT_NEON)
+
+#define IDCT_LANE_COUNT 4
+typedef int32x4_t IdctVector;
+
+static IdctVector LoadColumns(const int16* input)
+{
+	return vmovl_s16(vld1_s16(input));
+}
+
+static void StoreColumns(int16* output, IdctVector value)
+{
+	int16x4_t result = vqmovn_s32(vshrq_n_s32(value, 17));
+	result = vmin_s16(vmax_s16(result, vdup_n_s16(-256)), vdup_n_s16(255));
+	vst1_s16(output, result);
+}
+
+static IdctVector Add(IdctVector lhs, IdctVector rhs)
+{
+	return vaddq_s32(lhs, rhs);
+}
+
+static IdctVector Sub(IdctVector lhs, IdctVector rhs)
+{
+	return vsubq_s32(lhs, rhs);
+}
+
+static IdctVector Mul(IdctVector value, int32 factor)
+{
+	return vmulq_n_s32(value, factor);
+}
+
+static IdctVector ShiftRight8(IdctVector value)
+{
+	return vshrq_n_s32(value, 8);
+}
+
+static IdctVector Splat(int32 value)
+{
+	return vdupq_n_s32(value);
+}
+
+#else
+
+#define IDCT_LANE_COUNT 1
+typedef int32 IdctVector;
+
+static IdctVector LoadColumns(const int16* input)
+{
+	return *input;
+}
+
+static void StoreColumns(int16* output, IdctVector value)
+{
+	*output = static_cast<int16>(std::min<int32>(std::max<int32>(value >> 17, -256), 255));
+}
+
+static IdctVector Add(IdctVector lhs, IdctVector rhs)
+{
+	return lhs + rhs;
+}
+
+static IdctVector Sub(IdctVector lhs, IdctVector rhs)
+{
+	return lhs - rhs;
+}
+
+static IdctVector Mul(IdctVector value, int32 factor)
+{
+	return value * factor;
+}
+
+static IdctVector ShiftRight8(IdctVector value)
+{
+	return value >> 8;
+}
+
+static IdctVector Splat(int32 value)
+{
+	return value;
+}
+
+#endif
+
+//Products by W4 are done after shifting, values can use the whole 16 bits here
+static void TransformColumns(const int16* input, int16* output)
+{
+	//Even part
+	IdctVector d0 = Add(Mul(LoadColumns(input + (8 * 0)), 2048), Splat(65536));
+	IdctVector d2 = Mul(LoadColumns(input + (8 * 4)), 2048);
+	IdctVector c2 = LoadColumns(input + (8 * 2));
+	IdctVector c6 = LoadColumns(input + (8 * 6));
+	IdctVector t0 = Add(d0, d2);
+	IdctVector t1 = Sub(d0, d2);
+	IdctVector t2 = Add(Mul(c6, W6), Mul(c2, W2));
+	IdctVector t3 = Sub(Mul(c2, W6), Mul(c6, W2));
+	IdctVector a0 = Add(t0, t2);
+	IdctVector a1 = Add(t1, t3);
+	IdctVector a2 = Sub(t1, t3);
+	IdctVector a3 = Sub(t0, t2);
+
+	//Odd part
+	IdctVector c1 = LoadColumns(input + (8 * 1));
+	IdctVector c3 = LoadColumns(input + (8 * 3));
+	IdctVector c5 = LoadColumns(input + (8 * 5));
+	IdctVector c7 = LoadColumns(input + (8 * 7));
+	t0 = Add(Mul(c7, W7), Mul(c1, W1));
+	t1 = Sub(Mul(c1, W7), Mul(c7, W1));
+	t2 = Add(Mul(c3, W3), Mul(c5, W5));
+	t3 = Sub(Mul(c5, W3), Mul(c3, W5));
+	IdctVector b0 = Add(t0, t2);
+	IdctVector b3 = Add(t1, t3);
+	t0 = Sub(t0, t2);
+	t1 = Sub(t1, t3);
+	IdctVector b1 = Mul(ShiftRight8(Add(t0, t1)), W4);
+	IdctVector b2 = Mul(ShiftRight8(Sub(t0, t1)), W4);
+
+	StoreColumns(output + (8 * 0), Add(a0, b0));
+	StoreColumns(output + (8 * 1), Add(a1, b1));
+	StoreColumns(output + (8 * 2), Add(a2, b2));
+	StoreColumns(output + (8 * 3), Add(a3, b3));
+	StoreColumns(output + (8 * 4), Sub(a3, b3));
+	StoreColumns(output + (8 * 5), Sub(a2, b2));
+	StoreColumns(output + (8 * 6), Sub(a1, b1));
+	StoreColumns(output + (8 * 7), Sub(a0, b0));
+}
+
+CIdct* CIdct::GetInstance()
+{
+	static CIdct instance;
+	return &instance;
+}
+
+void CIdct::Transform(const int16* source, int16* dest) const
+{
+	int16 temp[64];
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		TransformRow(source + (8 * i), temp + (8 * i));
+	}
+	for(unsigned int i = 0; i < 8; i += IDCT_LANE_COUNT)
+	{
+		TransformColumns(temp + i, dest + i);
+	}
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Types.h"
+
+namespace IPU
+{
+	//Integer IDCT (Chen-Wang), as found in the MPEG-2 decoders used to emulate the IPU.
+	//Rows are transformed first and keep 3 fractional bits in 16 bits, columns round to
+	//nearest when scaling back. Results are within IEEE 1180 accuracy of the reference.
+	class CIdct
+	{
+	public:
+		static CIdct* GetInstance();
+
+		void Transform(const int16*, int16*) const;
+	};
+}
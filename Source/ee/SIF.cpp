@@ -259,7 +259,7 @@ void CSIF::SendDMA(void* pData, uint32 nSize)
 	m_dmac.SetRegister(CDMAC::D5_CHCR, CDMAC::CHCR_STR);
 }
 
-void CSIF::LoadState(Framework::CZipArchiveReader& archive)
+void CSIF::LoadState(CStateArchiveReader& archive)
 {
 	{
 		auto registerFile = CRegisterStateFile(*archive.BeginReadFile(STATE_REGS_XML));
@@ -278,7 +278,7 @@ void CSIF::LoadState(Framework::CZipArchiveReader& archive)
 	m_bindReplies = LoadBindReplies(archive);
 }
 
-void CSIF::SaveState(Framework::CZipArchiveWriter& archive)
+void CSIF::SaveState(CStateArchiveWriter& archive)
 {
 	{
 		auto registerFile = new CRegisterStateFile(STATE_REGS_XML);
@@ -298,7 +298,7 @@ void CSIF::SaveState(Framework::CZipArchiveWriter& archive)
 	SaveBindReplies(archive);
 }
 
-void CSIF::SaveCallReplies(Framework::CZipArchiveWriter& archive)
+void CSIF::SaveCallReplies(CStateArchiveWriter& archive)
 {
 	auto callRepliesFile = new CStructCollectionStateFile(STATE_CALL_REPLIES_XML);
 	for(const auto& callReplyIterator : m_callReplies)
@@ -315,7 +315,7 @@ void CSIF::SaveCallReplies(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(callRepliesFile);
 }
 
-void CSIF::SaveBindReplies(Framework::CZipArchiveWriter& archive)
+void CSIF::SaveBindReplies(CStateArchiveWriter& archive)
 {
 	auto bindRepliesFile = new CStructCollectionStateFile(STATE_BIND_REPLIES_XML);
 	for(const auto& bindReplyIterator : m_bindReplies)
@@ -331,7 +331,7 @@ void CSIF::SaveBindReplies(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(bindRepliesFile);
 }
 
-CSIF::PacketQueue CSIF::LoadPacketQueue(Framework::CZipArchiveReader& archive)
+CSIF::PacketQueue CSIF::LoadPacketQueue(CStateArchiveReader& archive)
 {
 	PacketQueue packetQueue;
 	auto file = archive.BeginReadFile(STATE_PACKETQUEUE);
@@ -346,7 +346,7 @@ CSIF::PacketQueue CSIF::LoadPacketQueue(Framework::CZipArchiveReader& archive)
 	return packetQueue;
 }
 
-CSIF::CallReplyMap CSIF::LoadCallReplies(Framework::CZipArchiveReader& archive)
+CSIF::CallReplyMap CSIF::LoadCallReplies(CStateArchiveReader& archive)
 {
 	CallReplyMap callReplies;
 	auto callRepliesFile = CStructCollectionStateFile(*archive.BeginReadFile(STATE_CALL_REPLIES_XML));
@@ -362,7 +362,7 @@ CSIF::CallReplyMap CSIF::LoadCallReplies(Framework::CZipArchiveReader& archive)
 	return callReplies;
 }
 
-CSIF::BindReplyMap CSIF::LoadBindReplies(Framework::CZipArchiveReader& archive)
+CSIF::BindReplyMap CSIF::LoadBindReplies(CStateArchiveReader& archive)
 {
 	BindReplyMap bindReplies;
 	auto bindRepliesFile = CStructCollectionStateFile(*archive.BeginReadFile(STATE_BIND_REPLIES_XML));
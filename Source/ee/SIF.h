@@ -5,8 +5,7 @@
 #include "../SifDefs.h"
 #include "../SifModule.h"
 #include "DMAC.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 #include "../states/RegisterStateFile.h"
 #include "../states/StructFile.h"
 
@@ -43,8 +42,8 @@ public:
 	uint32 GetRegister(uint32);
 	void SetRegister(uint32, uint32);
 
-	void LoadState(Framework::CZipArchiveReader&);
-	void SaveState(Framework::CZipArchiveWriter&);
+	void LoadState(CStateArchiveReader&);
+	void SaveState(CStateArchiveWriter&);
 
 private:
 	struct CALLREQUESTINFO
@@ -60,12 +59,12 @@ private:
 
 	void DeleteModules();
 
-	void SaveCallReplies(Framework::CZipArchiveWriter&);
-	void SaveBindReplies(Framework::CZipArchiveWriter&);
+	void SaveCallReplies(CStateArchiveWriter&);
+	void SaveBindReplies(CStateArchiveWriter&);
 
-	static PacketQueue LoadPacketQueue(Framework::CZipArchiveReader&);
-	static CallReplyMap LoadCallReplies(Framework::CZipArchiveReader&);
-	static BindReplyMap LoadBindReplies(Framework::CZipArchiveReader&);
+	static PacketQueue LoadPacketQueue(CStateArchiveReader&);
+	static CallReplyMap LoadCallReplies(CStateArchiveReader&);
+	static BindReplyMap LoadBindReplies(CStateArchiveReader&);
 
 	static void SaveState_Header(const std::string&, CStructFile&, const SIFCMDHEADER&);
 	static void SaveState_RpcCall(CStructFile&, const SIFRPCCALL&);
@@ -1,5 +1,6 @@
 #include <cstring>
 #include <stdio.h>
+#include <algorithm>
 #include "../Log.h"
 #include "../states/RegisterStateFile.h"
 #include "Timer.h"
@@ -17,9 +18,69 @@ CTimer::CTimer(CINTC& intc)
 void CTimer::Reset()
 {
 	memset(m_timer, 0, sizeof(TIMER) * 4);
+	m_pendingTicks = 0;
+	ComputeNextEventTicks();
 }
 
 void CTimer::Count(unsigned int ticks)
+{
+	m_pendingTicks += ticks;
+	if(m_pendingTicks < m_nextEventTicks) return;
+	UpdateTimers(m_pendingTicks);
+	m_pendingTicks = 0;
+	ComputeNextEventTicks();
+}
+
+static uint32 GetTimerDivider(uint32 mode)
+{
+	//BUSCLOCK runs at half EE frequency
+	switch(mode & CTimer::MODE_CLOCK_SELECT)
+	{
+	default:
+	case CTimer::MODE_CLOCK_SELECT_BUSCLOCK:
+		return 1 * 2;
+	case CTimer::MODE_CLOCK_SELECT_BUSCLOCK16:
+		return 16 * 2;
+	case CTimer::MODE_CLOCK_SELECT_BUSCLOCK256:
+		return 256 * 2;
+	case CTimer::MODE_CLOCK_SELECT_EXTERNAL:
+		return 9437; // PAL
+	}
+}
+
+void CTimer::Sync()
+{
+	//Nothing changed since the last update
+	if(m_pendingTicks == 0) return;
+	UpdateTimers(m_pendingTicks);
+	m_pendingTicks = 0;
+	ComputeNextEventTicks();
+}
+
+void CTimer::ComputeNextEventTicks()
+{
+	m_nextEventTicks = ~0ULL;
+	for(unsigned int i = 0; i < MAX_TIMER; i++)
+	{
+		const auto& timer = m_timer[i];
+
+		if(!(timer.nMODE & MODE_COUNT_ENABLE)) continue;
+
+		//Counts left before the counter hits the reference value or overflows
+		uint32 compare = (timer.nCOMP == 0) ? 0x10000 : timer.nCOMP;
+		uint32 eventCounts = (timer.nCOUNT < 0xFFFF) ? (0xFFFF - timer.nCOUNT) : 0;
+		if(timer.nCOUNT < compare)
+		{
+			eventCounts = std::min(eventCounts, compare - timer.nCOUNT);
+		}
+
+		uint64 eventTicks = static_cast<uint64>(eventCounts) * GetTimerDivider(timer.nMODE);
+		eventTicks = (eventTicks > timer.clockRemain) ? (eventTicks - timer.clockRemain) : 0;
+		m_nextEventTicks = std::min(m_nextEventTicks, eventTicks);
+	}
+}
+
+void CTimer::UpdateTimers(uint64 ticks)
 {
 	for(unsigned int i = 0; i < MAX_TIMER; i++)
 	{
@@ -30,28 +91,12 @@ void CTimer::Count(unsigned int ticks)
 		uint32 previousCount = timer.nCOUNT;
 		uint32 nextCount = timer.nCOUNT;
 
-		uint32 divider = 1;
-		//BUSCLOCK runs at half EE frequency
-		switch(timer.nMODE & MODE_CLOCK_SELECT)
-		{
-		case MODE_CLOCK_SELECT_BUSCLOCK:
-			divider = 1 * 2;
-			break;
-		case MODE_CLOCK_SELECT_BUSCLOCK16:
-			divider = 16 * 2;
-			break;
-		case MODE_CLOCK_SELECT_BUSCLOCK256:
-			divider = 256 * 2;
-			break;
-		case MODE_CLOCK_SELECT_EXTERNAL:
-			divider = 9437; // PAL
-			break;
-		}
+		uint32 divider = GetTimerDivider(timer.nMODE);
 
 		//Compute increment
-		uint32 totalTicks = timer.clockRemain + ticks;
-		uint32 countAdd = totalTicks / divider;
-		timer.clockRemain = totalTicks % divider;
+		uint64 totalTicks = timer.clockRemain + ticks;
+		uint32 countAdd = static_cast<uint32>(totalTicks / divider);
+		timer.clockRemain = static_cast<uint32>(totalTicks % divider);
 		nextCount = previousCount + countAdd;
 
 		uint32 compare = (timer.nCOMP == 0) ? 0x10000 : timer.nCOMP;
@@ -95,6 +140,8 @@ uint32 CTimer::GetRegister(uint32 nAddress)
 {
 	DisassembleGet(nAddress);
 
+	Sync();
+
 	unsigned int nTimerId = (nAddress >> 11) & 0x3;
 
 	switch(nAddress & 0x7FF)
@@ -143,6 +190,8 @@ void CTimer::SetRegister(uint32 nAddress, uint32 nValue)
 {
 	DisassembleSet(nAddress, nValue);
 
+	Sync();
+
 	unsigned int nTimerId = (nAddress >> 11) & 0x3;
 
 	switch(nAddress & 0x7FF)
@@ -185,6 +234,8 @@ void CTimer::SetRegister(uint32 nAddress, uint32 nValue)
 		CLog::GetInstance().Print(LOG_NAME, "Wrote to an unhandled IO port (0x%08X, 0x%08X).\r\n", nAddress, nValue);
 		break;
 	}
+
+	ComputeNextEventTicks();
 }
 
 void CTimer::DisassembleGet(uint32 nAddress)
@@ -235,7 +286,7 @@ void CTimer::DisassembleSet(uint32 nAddress, uint32 nValue)
 	}
 }
 
-void CTimer::LoadState(Framework::CZipArchiveReader& archive)
+void CTimer::LoadState(CStateArchiveReader& archive)
 {
 	CRegisterStateFile registerFile(*archive.BeginReadFile(STATE_REGS_XML));
 	for(unsigned int i = 0; i < MAX_TIMER; i++)
@@ -248,10 +299,13 @@ void CTimer::LoadState(Framework::CZipArchiveReader& archive)
 		timer.nHOLD = registerFile.GetRegister32((timerPrefix + "HOLD").c_str());
 		timer.clockRemain = registerFile.GetRegister32((timerPrefix + "REM").c_str());
 	}
+	m_pendingTicks = 0;
+	ComputeNextEventTicks();
 }
 
-void CTimer::SaveState(Framework::CZipArchiveWriter& archive)
+void CTimer::SaveState(CStateArchiveWriter& archive)
 {
+	Sync();
 	CRegisterStateFile* registerFile = new CRegisterStateFile(STATE_REGS_XML);
 	for(unsigned int i = 0; i < MAX_TIMER; i++)
 	{
@@ -278,6 +332,7 @@ void CTimer::NotifyVBlankEnd()
 
 void CTimer::ProcessGateEdgeChange(uint32 gate, uint32 edgeMode)
 {
+	Sync();
 	for(unsigned int i = 0; i < MAX_TIMER; i++)
 	{
 		auto& timer = m_timer[i];
@@ -293,4 +348,5 @@ void CTimer::ProcessGateEdgeChange(uint32 gate, uint32 edgeMode)
 			timer.clockRemain = 0;
 		}
 	}
+	ComputeNextEventTicks();
 }
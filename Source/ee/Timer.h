@@ -2,8 +2,7 @@
 
 #include "Types.h"
 #include "INTC.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 class CTimer
 {
@@ -50,8 +49,8 @@ public:
 	uint32 GetRegister(uint32);
 	void SetRegister(uint32, uint32);
 
-	void LoadState(Framework::CZipArchiveReader&);
-	void SaveState(Framework::CZipArchiveWriter&);
+	void LoadState(CStateArchiveReader&);
+	void SaveState(CStateArchiveWriter&);
 
 	void NotifyVBlankStart();
 	void NotifyVBlankEnd();
@@ -67,6 +66,10 @@ private:
 
 	void ProcessGateEdgeChange(uint32, uint32);
 
+	void Sync();
+	void UpdateTimers(uint64);
+	void ComputeNextEventTicks();
+
 	struct TIMER
 	{
 		uint32 nCOUNT;
@@ -79,4 +82,9 @@ private:
 
 	TIMER m_timer[MAX_TIMER];
 	CINTC& m_intc;
+
+	//Timers are only brought up to date when their registers are accessed or when
+	//enough ticks went by for one of them to hit its compare value or overflow
+	uint64 m_pendingTicks = 0;
+	uint64 m_nextEventTicks = 0;
 };
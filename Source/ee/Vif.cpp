@@ -11,6 +11,14 @@
 #include "Vif.h"
 #include "INTC.h"
 
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define VIF_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define VIF_NEON
+#include <arm_neon.h>
+#endif
+
 #define LOG_NAME ("ee_vif")
 
 #define STATE_PATH_REGS_FORMAT ("vpu/vif_%d.xml")
@@ -37,6 +45,55 @@
 #define STATE_REGS_WRITETICK ("writeTick")
 #define STATE_REGS_FIFOINDEX ("fifoIndex")
 
+//Size of a packed vector for each UNPACK format, 0 for invalid formats
+static const uint32 g_unpackVectorSizes[0x10] =
+    {
+        4, 2, 1, 0,
+        8, 4, 2, 0,
+        12, 6, 3, 0,
+        16, 8, 4, 2};
+
+#define UNPACK_VECTORS_FUNCTIONS(useMask, mode, usn)   \
+	&CVif::UnpackVectors<0x00, useMask, mode, usn>,    \
+	    &CVif::UnpackVectors<0x01, useMask, mode, usn>, \
+	    &CVif::UnpackVectors<0x02, useMask, mode, usn>, \
+	    nullptr,                                        \
+	    &CVif::UnpackVectors<0x04, useMask, mode, usn>, \
+	    &CVif::UnpackVectors<0x05, useMask, mode, usn>, \
+	    &CVif::UnpackVectors<0x06, useMask, mode, usn>, \
+	    nullptr,                                        \
+	    &CVif::UnpackVectors<0x08, useMask, mode, usn>, \
+	    &CVif::UnpackVectors<0x09, useMask, mode, usn>, \
+	    &CVif::UnpackVectors<0x0A, useMask, mode, usn>, \
+	    nullptr,                                        \
+	    &CVif::UnpackVectors<0x0C, useMask, mode, usn>, \
+	    &CVif::UnpackVectors<0x0D, useMask, mode, usn>, \
+	    &CVif::UnpackVectors<0x0E, useMask, mode, usn>, \
+	    &CVif::UnpackVectors<0x0F, useMask, mode, usn>
+
+//Indexed by format | (useMask << 4) | (mode << 5) | (usn << 7)
+const CVif::UnpackVectorsFunction CVif::g_unpackVectorsFunctions[0x100] =
+    {
+        UNPACK_VECTORS_FUNCTIONS(false, 0, false),
+        UNPACK_VECTORS_FUNCTIONS(true, 0, false),
+        UNPACK_VECTORS_FUNCTIONS(false, 1, false),
+        UNPACK_VECTORS_FUNCTIONS(true, 1, false),
+        UNPACK_VECTORS_FUNCTIONS(false, 2, false),
+        UNPACK_VECTORS_FUNCTIONS(true, 2, false),
+        UNPACK_VECTORS_FUNCTIONS(false, 3, false),
+        UNPACK_VECTORS_FUNCTIONS(true, 3, false),
+        UNPACK_VECTORS_FUNCTIONS(false, 0, true),
+        UNPACK_VECTORS_FUNCTIONS(true, 0, true),
+        UNPACK_VECTORS_FUNCTIONS(false, 1, true),
+        UNPACK_VECTORS_FUNCTIONS(true, 1, true),
+        UNPACK_VECTORS_FUNCTIONS(false, 2, true),
+        UNPACK_VECTORS_FUNCTIONS(true, 2, true),
+        UNPACK_VECTORS_FUNCTIONS(false, 3, true),
+        UNPACK_VECTORS_FUNCTIONS(true, 3, true),
+};
+
+#undef UNPACK_VECTORS_FUNCTIONS
+
 CVif::CVif(unsigned int number, CVpu& vpu, CINTC& intc, uint8* ram, uint8* spr)
     : m_number(number)
     , m_ram(ram)
@@ -178,7 +235,7 @@ void CVif::SetRegister(uint32 address, uint32 value)
 #endif
 }
 
-void CVif::SaveState(Framework::CZipArchiveWriter& archive)
+void CVif::SaveState(CStateArchiveWriter& archive)
 {
 	{
 		auto path = string_format(STATE_PATH_REGS_FORMAT, m_number);
@@ -211,7 +268,7 @@ void CVif::SaveState(Framework::CZipArchiveWriter& archive)
 	}
 }
 
-void CVif::LoadState(Framework::CZipArchiveReader& archive)
+void CVif::LoadState(CStateArchiveReader& archive)
 {
 	{
 		auto path = string_format(STATE_PATH_REGS_FORMAT, m_number);
@@ -286,6 +343,11 @@ bool CVif::IsWaitingForProgramEnd() const
 	return (m_STAT.nVEW != 0);
 }
 
+void CVif::SetFastUnpackEnabled(bool fastUnpackEnabled)
+{
+	m_fastUnpackEnabled = fastUnpackEnabled;
+}
+
 void CVif::ProcessFifoWrite(uint32 address, uint32 value)
 {
 	assert(m_fifoIndex != FIFO_SIZE);
@@ -636,8 +698,16 @@ void CVif::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 	assert(nDstAddr < vuMemSize);
 	nDstAddr &= (vuMemSize - 1);
 
+	//Vectors the fast path can't handle (split across transfers or cl < wl) go
+	//through the per-element loop, the fast path takes over again after them
 	while(currentNum != 0)
 	{
+		if(m_fastUnpackEnabled && (cl >= wl))
+		{
+			currentNum = Unpack_Fast(stream, nCommand, cl, wl, currentNum, nDstAddr);
+			if(currentNum == 0) break;
+		}
+
 		bool mustWrite = false;
 		uint128 writeValue;
 		memset(&writeValue, 0, sizeof(writeValue));
@@ -746,6 +816,484 @@ void CVif::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 	m_NUM = static_cast<uint8>(currentNum);
 }
 
+uint32 CVif::Unpack_Fast(StreamType& stream, const CODE& command, uint32 cl, uint32 wl, uint32 currentNum, uint32& dstAddr)
+{
+	assert(cl >= wl);
+
+	uint8 dataType = command.nCMD & 0x0F;
+	uint32 vectorSize = g_unpackVectorSizes[dataType];
+	if(vectorSize == 0) return currentNum;
+
+	//Ticks need to be in the state the main loop keeps them in when cl >= wl
+	if(m_writeTick != std::min(m_readTick, wl)) return currentNum;
+
+	uint32 vectorCount = std::min(currentNum, stream.GetAvailableReadBytes() / vectorSize);
+	if(vectorCount == 0) return currentNum;
+
+	//Partially read qword might come from a previous transfer
+	if(!stream.CanGetDirectPointer()) return currentNum;
+
+	bool usn = (m_CODE.nIMM & 0x4000) != 0;
+	bool useMask = (command.nCMD & 0x10) != 0;
+	uint32 functionIndex = dataType | (useMask ? 0x10 : 0) | ((m_MODE & 0x03) << 5) | (usn ? 0x80 : 0);
+	auto unpackVectors = g_unpackVectorsFunctions[functionIndex];
+	assert(unpackVectors != nullptr);
+
+	const auto vuMem = m_vpu.GetVuMemory();
+	const auto vuMemSize = m_vpu.GetVuMemorySize();
+	const uint8* src = stream.GetDirectPointer();
+	uint32 readSize = 0;
+
+	while(vectorCount != 0)
+	{
+		if(m_readTick < wl)
+		{
+			uint32 runCount = std::min(vectorCount, wl - m_readTick);
+			runCount = std::min(runCount, (vuMemSize - dstAddr) / 0x10);
+			(this->*unpackVectors)(src + readSize, reinterpret_cast<uint128*>(vuMem + dstAddr), runCount, m_writeTick);
+			readSize += runCount * vectorSize;
+			vectorCount -= runCount;
+			currentNum -= runCount;
+			m_readTick += runCount;
+			m_writeTick += runCount;
+			dstAddr += runCount * 0x10;
+		}
+		else
+		{
+			//Skipped cycles, nothing is read or written
+			dstAddr += (cl - m_readTick) * 0x10;
+			m_readTick = cl;
+		}
+
+		if(m_readTick == cl)
+		{
+			m_readTick = 0;
+			m_writeTick = 0;
+		}
+		dstAddr &= (vuMemSize - 1);
+	}
+
+	stream.Skip(readSize);
+	return currentNum;
+}
+
+template <uint8 dataType, bool usn>
+static inline uint32 Unpack_ReadField(const uint8* src)
+{
+	uint32 fieldSize = 4 >> (dataType & 0x03);
+	if(fieldSize == 4)
+	{
+		uint32 value = 0;
+		memcpy(&value, src, 4);
+		return value;
+	}
+	else if(fieldSize == 2)
+	{
+		uint16 value = 0;
+		memcpy(&value, src, 2);
+		return usn ? value : static_cast<int16>(value);
+	}
+	else
+	{
+		uint8 value = *src;
+		return usn ? value : static_cast<int8>(value);
+	}
+}
+
+template <uint8 dataType, bool usn>
+static inline void Unpack_DecodeVector(const uint8* src, uint32* value)
+{
+	if(dataType == 0x0F)
+	{
+		//V4-5
+		uint16 color = 0;
+		memcpy(&color, src, 2);
+		value[0] = ((color >> 0) & 0x1F) << 3;
+		value[1] = ((color >> 5) & 0x1F) << 3;
+		value[2] = ((color >> 10) & 0x1F) << 3;
+		value[3] = ((color >> 15) & 0x01) << 7;
+	}
+	else if((dataType & 0x0C) == 0)
+	{
+		//S-32, S-16, S-8
+		uint32 field = Unpack_ReadField<dataType, usn>(src);
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			value[i] = field;
+		}
+	}
+	else
+	{
+		unsigned int fieldCount = (dataType >> 2) + 1;
+		unsigned int fieldSize = 4 >> (dataType & 0x03);
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			value[i] = (i < fieldCount) ? Unpack_ReadField<dataType, usn>(src + (i * fieldSize)) : 0;
+		}
+	}
+}
+
+#if defined(VIF_SSE2)
+
+typedef __m128i UnpackVector;
+
+static inline UnpackVector UnpackVector_Load(const void* src)
+{
+	return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+}
+
+static inline void UnpackVector_Store(void* dst, UnpackVector value)
+{
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), value);
+}
+
+static inline UnpackVector UnpackVector_Splat(uint32 value)
+{
+	return _mm_set1_epi32(value);
+}
+
+static inline UnpackVector UnpackVector_FromLow(uint64 low)
+{
+	return _mm_set_epi64x(0, low);
+}
+
+static inline UnpackVector UnpackVector_FromLowHigh(uint64 low, uint32 high)
+{
+	return _mm_set_epi64x(high, low);
+}
+
+static inline UnpackVector UnpackVector_Add(UnpackVector lhs, UnpackVector rhs)
+{
+	return _mm_add_epi32(lhs, rhs);
+}
+
+static inline UnpackVector UnpackVector_And(UnpackVector lhs, UnpackVector rhs)
+{
+	return _mm_and_si128(lhs, rhs);
+}
+
+static inline UnpackVector UnpackVector_Or(UnpackVector lhs, UnpackVector rhs)
+{
+	return _mm_or_si128(lhs, rhs);
+}
+
+static inline UnpackVector UnpackVector_Equal(UnpackVector lhs, UnpackVector rhs)
+{
+	return _mm_cmpeq_epi32(lhs, rhs);
+}
+
+//Lanes of selected where select is set, lanes of other elsewhere
+static inline UnpackVector UnpackVector_Select(UnpackVector select, UnpackVector selected, UnpackVector other)
+{
+	return _mm_or_si128(_mm_and_si128(select, selected), _mm_andnot_si128(select, other));
+}
+
+//Mask operation of each lane from a column's mask byte, shifts are done with 16 bit multiplies
+static inline UnpackVector UnpackVector_MaskOps(uint32 colMask)
+{
+	__m128i ops = _mm_mullo_epi16(_mm_set1_epi32(colMask & 0xFF), _mm_set_epi32(1, 4, 16, 64));
+	return _mm_and_si128(_mm_srli_epi32(ops, 6), _mm_set1_epi32(0x03));
+}
+
+//Widens the 16 bit fields held in the low 64 bits
+template <bool usn>
+static inline UnpackVector UnpackVector_Widen16(UnpackVector value)
+{
+	return usn ? _mm_unpacklo_epi16(value, _mm_setzero_si128()) : _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16);
+}
+
+//Widens the 8 bit fields held in the low 32 bits
+template <bool usn>
+static inline UnpackVector UnpackVector_Widen8(UnpackVector value)
+{
+	if(usn)
+	{
+		value = _mm_unpacklo_epi8(value, _mm_setzero_si128());
+		return _mm_unpacklo_epi16(value, _mm_setzero_si128());
+	}
+	value = _mm_unpacklo_epi8(value, value);
+	return _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 24);
+}
+
+#elif defined(VIF_NEON)
+
+typedef uint32x4_t UnpackVector;
+
+static inline UnpackVector UnpackVector_Load(const void* src)
+{
+	return vld1q_u32(reinterpret_cast<const uint32*>(src));
+}
+
+static inline void UnpackVector_Store(void* dst, UnpackVector value)
+{
+	vst1q_u32(reinterpret_cast<uint32*>(dst), value);
+}
+
+static inline UnpackVector UnpackVector_Splat(uint32 value)
+{
+	return vdupq_n_u32(value);
+}
+
+static inline UnpackVector UnpackVector_FromLow(uint64 low)
+{
+	return vreinterpretq_u32_u64(vcombine_u64(vcreate_u64(low), vcreate_u64(0)));
+}
+
+static inline UnpackVector UnpackVector_FromLowHigh(uint64 low, uint32 high)
+{
+	return vreinterpretq_u32_u64(vcombine_u64(vcreate_u64(low), vcreate_u64(high)));
+}
+
+static inline UnpackVector UnpackVector_Add(UnpackVector lhs, UnpackVector rhs)
+{
+	return vaddq_u32(lhs, rhs);
+}
+
+static inline UnpackVector UnpackVector_And(UnpackVector lhs, UnpackVector rhs)
+{
+	return vandq_u32(lhs, rhs);
+}
+
+static inline UnpackVector UnpackVector_Or(UnpackVector lhs, UnpackVector rhs)
+{
+	return vorrq_u32(lhs, rhs);
+}
+
+static inline UnpackVector UnpackVector_Equal(UnpackVector lhs, UnpackVector rhs)
+{
+	return vceqq_u32(lhs, rhs);
+}
+
+//Lanes of selected where select is set, lanes of other elsewhere
+static inline UnpackVector UnpackVector_Select(UnpackVector select, UnpackVector selected, UnpackVector other)
+{
+	return vbslq_u32(select, selected, other);
+}
+
+//Mask operation of each lane from a column's mask byte
+static inline UnpackVector UnpackVector_MaskOps(uint32 colMask)
+{
+	static const int32 shifts[4] = {0, -2, -4, -6};
+	return vandq_u32(vshlq_u32(vdupq_n_u32(colMask), vld1q_s32(shifts)), vdupq_n_u32(0x03));
+}
+
+//Widens the 16 bit fields held in the low 64 bits
+template <bool usn>
+static inline UnpackVector UnpackVector_Widen16(UnpackVector value)
+{
+	uint16x4_t fields = vget_low_u16(vreinterpretq_u16_u32(value));
+	return usn ? vmovl_u16(fields) : vreinterpretq_u32_s32(vmovl_s16(vreinterpret_s16_u16(fields)));
+}
+
+//Widens the 8 bit fields held in the low 32 bits
+template <bool usn>
+static inline UnpackVector UnpackVector_Widen8(UnpackVector value)
+{
+	uint8x8_t fields = vget_low_u8(vreinterpretq_u8_u32(value));
+	if(usn)
+	{
+		return vmovl_u16(vget_low_u16(vmovl_u8(fields)));
+	}
+	return vreinterpretq_u32_s32(vmovl_s16(vget_low_s16(vmovl_s8(vreinterpret_s8_u8(fields)))));
+}
+
+#endif
+
+#if defined(VIF_SSE2) || defined(VIF_NEON)
+
+//Reads vectors of 8 bytes or less with power of 2 sized loads
+static inline uint64 Unpack_ReadPackedFields(const uint8* src, uint32 size)
+{
+	uint32 low = 0;
+	uint32 high = 0;
+	if(size >= 4)
+	{
+		memcpy(&low, src, 4);
+		if(size == 8)
+		{
+			memcpy(&high, src + 4, 4);
+		}
+		else if(size == 6)
+		{
+			uint16 highHalf = 0;
+			memcpy(&highHalf, src + 4, 2);
+			high = highHalf;
+		}
+	}
+	else
+	{
+		uint16 lowHalf = 0;
+		memcpy(&lowHalf, src, 2);
+		low = lowHalf;
+		if(size == 3)
+		{
+			low |= static_cast<uint32>(src[2]) << 16;
+		}
+	}
+	return static_cast<uint64>(low) | (static_cast<uint64>(high) << 32);
+}
+
+//Packed fields are gathered in registers, fields past the vector's field count are 0
+//like with the scalar decoder
+template <uint8 dataType, bool usn>
+static inline UnpackVector Unpack_DecodeVectorSimd(const uint8* src)
+{
+	if((dataType == 0x0F) || ((dataType & 0x0C) == 0))
+	{
+		//V4-5 and S-*
+		uint32 value[4];
+		Unpack_DecodeVector<dataType, usn>(src, value);
+		return UnpackVector_Load(value);
+	}
+	uint32 vectorSize = g_unpackVectorSizes[dataType];
+	UnpackVector value;
+	if(vectorSize == 16)
+	{
+		value = UnpackVector_Load(src);
+	}
+	else if(vectorSize > 8)
+	{
+		uint64 low = 0;
+		uint32 high = 0;
+		memcpy(&low, src, 8);
+		memcpy(&high, src + 8, vectorSize - 8);
+		value = UnpackVector_FromLowHigh(low, high);
+	}
+	else
+	{
+		value = UnpackVector_FromLow(Unpack_ReadPackedFields(src, vectorSize));
+	}
+	unsigned int fieldSize = 4 >> (dataType & 0x03);
+	if(fieldSize == 2)
+	{
+		return UnpackVector_Widen16<usn>(value);
+	}
+	else if(fieldSize == 1)
+	{
+		return UnpackVector_Widen8<usn>(value);
+	}
+	return value;
+}
+
+template <uint8 dataType, bool useMask, uint32 mode, bool usn>
+void CVif::UnpackVectors(const uint8* src, uint128* dst, uint32 count, uint32 writeTick)
+{
+	uint32 vectorSize = g_unpackVectorSizes[dataType];
+	UnpackVector row = UnpackVector_Load(m_R);
+
+	for(uint32 vectorIndex = 0; vectorIndex < count; vectorIndex++)
+	{
+		UnpackVector value = Unpack_DecodeVectorSimd<dataType, usn>(src);
+		src += vectorSize;
+
+		if((mode == MODE_OFFSET) || (mode == MODE_DIFFERENCE))
+		{
+			value = UnpackVector_Add(value, row);
+		}
+
+		if(!useMask)
+		{
+			if(mode == MODE_DIFFERENCE)
+			{
+				row = value;
+			}
+			UnpackVector_Store(dst, value);
+		}
+		else
+		{
+			//Runs are at most wl vectors long, selects are made for each vector instead of being set up for every column
+			uint32 col = std::min<uint32>(writeTick + vectorIndex, 3);
+			UnpackVector maskOps = UnpackVector_MaskOps(m_MASK >> (col * 8));
+			UnpackVector dataSelect = UnpackVector_Equal(maskOps, UnpackVector_Splat(MASK_DATA));
+			UnpackVector rowSelect = UnpackVector_Equal(maskOps, UnpackVector_Splat(MASK_ROW));
+			UnpackVector colSelect = UnpackVector_Equal(maskOps, UnpackVector_Splat(MASK_COL));
+			UnpackVector keepSelect = UnpackVector_Equal(maskOps, UnpackVector_Splat(MASK_MASK));
+			if(mode == MODE_DIFFERENCE)
+			{
+				row = UnpackVector_Select(dataSelect, value, row);
+			}
+			UnpackVector result = UnpackVector_Or(
+			    UnpackVector_Or(UnpackVector_And(value, dataSelect), UnpackVector_And(row, rowSelect)),
+			    UnpackVector_Or(UnpackVector_And(UnpackVector_Splat(m_C[col]), colSelect), UnpackVector_And(UnpackVector_Load(dst), keepSelect)));
+			UnpackVector_Store(dst, result);
+		}
+		dst++;
+	}
+
+	if(mode == MODE_DIFFERENCE)
+	{
+		UnpackVector_Store(m_R, row);
+	}
+}
+
+#else
+
+template <uint8 dataType, bool useMask, uint32 mode, bool usn>
+void CVif::UnpackVectors(const uint8* src, uint128* dst, uint32 count, uint32 writeTick)
+{
+	uint32 vectorSize = g_unpackVectorSizes[dataType];
+	uint32 row[4] = {m_R[0], m_R[1], m_R[2], m_R[3]};
+
+	for(uint32 vectorIndex = 0; vectorIndex < count; vectorIndex++)
+	{
+		uint32 value[4];
+		Unpack_DecodeVector<dataType, usn>(src, value);
+		src += vectorSize;
+
+		if(!useMask)
+		{
+			for(unsigned int i = 0; i < 4; i++)
+			{
+				if(mode == MODE_OFFSET)
+				{
+					value[i] += row[i];
+				}
+				else if(mode == MODE_DIFFERENCE)
+				{
+					value[i] += row[i];
+					row[i] = value[i];
+				}
+			}
+			memcpy(dst, value, sizeof(uint128));
+		}
+		else
+		{
+			uint32 col = std::min<uint32>(writeTick + vectorIndex, 3);
+			uint32 colValue = m_C[col];
+			uint32 colMask = m_MASK >> (col * 8);
+			uint32 result[4];
+			memcpy(result, dst, sizeof(uint128));
+			for(unsigned int i = 0; i < 4; i++)
+			{
+				uint32 maskOp = (colMask >> (i * 2)) & 0x03;
+				uint32 dataSelect = (maskOp == MASK_DATA) ? ~0U : 0;
+				uint32 rowSelect = (maskOp == MASK_ROW) ? ~0U : 0;
+				uint32 colSelect = (maskOp == MASK_COL) ? ~0U : 0;
+				uint32 keepSelect = (maskOp == MASK_MASK) ? ~0U : 0;
+				if(mode == MODE_OFFSET)
+				{
+					value[i] += row[i];
+				}
+				else if(mode == MODE_DIFFERENCE)
+				{
+					value[i] += row[i];
+					row[i] = (value[i] & dataSelect) | (row[i] & ~dataSelect);
+				}
+				result[i] = (value[i] & dataSelect) | (row[i] & rowSelect) | (colValue & colSelect) | (result[i] & keepSelect);
+			}
+			memcpy(dst, result, sizeof(uint128));
+		}
+		dst++;
+	}
+
+	if(mode == MODE_DIFFERENCE)
+	{
+		memcpy(m_R, row, sizeof(m_R));
+	}
+}
+
+#endif
+
 bool CVif::Unpack_ReadValue(const CODE& nCommand, StreamType& stream, uint128& writeValue, bool usn)
 {
 	bool success = false;
@@ -1255,6 +1803,12 @@ void CVif::CFifoStream::Align32()
 	assert((m_bufferPosition & 0x03) == 0);
 }
 
+bool CVif::CFifoStream::CanGetDirectPointer() const
+{
+	//Buffered qword needs to be part of the current transfer to be read in place
+	return !m_tagIncluded && ((m_bufferPosition == BUFFERSIZE) || ((m_nextAddress - m_startAddress) >= 0x10));
+}
+
 uint8* CVif::CFifoStream::GetDirectPointer() const
 {
 	assert(!m_tagIncluded);
@@ -1290,6 +1844,27 @@ void CVif::CFifoStream::Advance(uint32 size)
 	}
 }
 
+void CVif::CFifoStream::Skip(uint32 size)
+{
+	uint32 bufferRemain = BUFFERSIZE - m_bufferPosition;
+	if(size <= bufferRemain)
+	{
+		m_bufferPosition += size;
+		return;
+	}
+	//Skip whole qwords without going through the buffer
+	size -= bufferRemain;
+	m_bufferPosition = BUFFERSIZE;
+	m_nextAddress += (size & ~0x0F);
+	assert(m_nextAddress <= m_endAddress);
+	size &= 0x0F;
+	if(size != 0)
+	{
+		SyncBuffer();
+		m_bufferPosition += size;
+	}
+}
+
 void CVif::CFifoStream::SyncBuffer()
 {
 	assert(m_bufferPosition <= BUFFERSIZE);
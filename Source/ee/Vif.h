@@ -4,8 +4,7 @@
 #include "Convertible.h"
 #include "../uint128.h"
 #include "../Profiler.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 //#define DELAYED_MSCAL
 
@@ -59,8 +58,8 @@ public:
 	virtual void Reset();
 	uint32 GetRegister(uint32);
 	void SetRegister(uint32, uint32);
-	virtual void SaveState(Framework::CZipArchiveWriter&);
-	virtual void LoadState(Framework::CZipArchiveReader&);
+	virtual void SaveState(CStateArchiveWriter&);
+	virtual void LoadState(CStateArchiveReader&);
 
 	virtual uint32 GetTOP() const;
 	virtual uint32 GetITOP() const;
@@ -69,6 +68,9 @@ public:
 
 	bool IsWaitingForProgramEnd() const;
 
+	//Allows checking the specialized UNPACK kernels against the per-element loop
+	void SetFastUnpackEnabled(bool);
+
 protected:
 	enum
 	{
@@ -107,8 +109,10 @@ protected:
 		void SetDmaParams(uint32, uint32, bool);
 		void SetFifoParams(uint8*, uint32);
 
+		bool CanGetDirectPointer() const;
 		uint8* GetDirectPointer() const;
 		void Advance(uint32);
+		void Skip(uint32);
 
 	private:
 		void SyncBuffer();
@@ -195,6 +199,16 @@ protected:
 	void Cmd_STCOL(StreamType&, CODE);
 	void Cmd_STMASK(StreamType&, CODE);
 
+	typedef void (CVif::*UnpackVectorsFunction)(const uint8*, uint128*, uint32, uint32);
+
+	uint32 Unpack_Fast(StreamType&, const CODE&, uint32, uint32, uint32, uint32&);
+
+	//Specialized for every format (low 4 bits of UNPACK command), mask, mode and usn combination
+	template <uint8 dataType, bool useMask, uint32 mode, bool usn>
+	void UnpackVectors(const uint8*, uint128*, uint32, uint32);
+
+	static const UnpackVectorsFunction g_unpackVectorsFunctions[0x100];
+
 	bool Unpack_ReadValue(const CODE&, StreamType&, uint128&, bool);
 	bool Unpack_S32(StreamType&, uint128&);
 	bool Unpack_S16(StreamType&, uint128&, bool);
@@ -240,6 +254,7 @@ protected:
 	uint32 m_ITOPS;
 	uint32 m_readTick;
 	uint32 m_writeTick;
+	bool m_fastUnpackEnabled = true;
 #ifdef DELAYED_MSCAL
 	uint32 m_pendingMicroProgram;
 	CODE m_previousCODE;
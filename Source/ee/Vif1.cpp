@@ -33,7 +33,7 @@ void CVif1::Reset()
 	m_OFST = 0;
 }
 
-void CVif1::SaveState(Framework::CZipArchiveWriter& archive)
+void CVif1::SaveState(CStateArchiveWriter& archive)
 {
 	CVif::SaveState(archive);
 
@@ -46,7 +46,7 @@ void CVif1::SaveState(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(registerFile);
 }
 
-void CVif1::LoadState(Framework::CZipArchiveReader& archive)
+void CVif1::LoadState(CStateArchiveReader& archive)
 {
 	CVif::LoadState(archive);
 
@@ -12,8 +12,8 @@ public:
 	virtual ~CVif1();
 
 	void Reset() override;
-	void SaveState(Framework::CZipArchiveWriter&) override;
-	void LoadState(Framework::CZipArchiveReader&) override;
+	void SaveState(CStateArchiveWriter&) override;
+	void LoadState(CStateArchiveReader&) override;
 
 	uint32 GetTOP() const override;
 
@@ -98,12 +98,12 @@ void CVpu::Reset()
 	m_vif->Reset();
 }
 
-void CVpu::SaveState(Framework::CZipArchiveWriter& archive)
+void CVpu::SaveState(CStateArchiveWriter& archive)
 {
 	m_vif->SaveState(archive);
 }
 
-void CVpu::LoadState(Framework::CZipArchiveReader& archive)
+void CVpu::LoadState(CStateArchiveReader& archive)
 {
 	m_vif->LoadState(archive);
 }
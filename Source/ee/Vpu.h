@@ -4,8 +4,7 @@
 #include "../MIPS.h"
 #include "../Profiler.h"
 #include "Convertible.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 class CVif;
 class CGIF;
@@ -43,8 +42,8 @@ public:
 
 	void Execute(int32);
 	void Reset();
-	void SaveState(Framework::CZipArchiveWriter&);
-	void LoadState(Framework::CZipArchiveReader&);
+	void SaveState(CStateArchiveWriter&);
+	void LoadState(CStateArchiveReader&);
 
 	CMIPS& GetContext() const;
 	uint8* GetMicroMemory() const;
@@ -20,6 +20,7 @@
 
 #define NUM_SAMPLES 8
 #define FRAMEBUFFER_HEIGHT 1024
+#define FENCE_WAIT_TIMEOUT 1000000000
 
 // clang-format off
 const GLenum CGSH_OpenGL::g_nativeClampModes[CGSHandler::CLAMP_MODE_MAX] =
@@ -56,6 +57,36 @@ static uint32 MakeColor(uint8 r, uint8 g, uint8 b, uint8 a)
 	return (a << 24) | (b << 16) | (g << 8) | (r);
 }
 
+//Only these bits of PRIM change render states, others are used while building vertices
+static uint64 GetPrimRenderStateBits(uint64 primReg)
+{
+	auto prim = make_convertible<CGSHandler::PRMODE>(primReg);
+	auto result = make_convertible<CGSHandler::PRMODE>(0);
+	result.nTexture = prim.nTexture;
+	result.nFog = prim.nFog;
+	result.nAlpha = prim.nAlpha;
+	return result;
+}
+
+static GLenum GetPrimitiveMode(unsigned int primitiveType)
+{
+	switch(primitiveType)
+	{
+	case CGSHandler::PRIM_POINT:
+		return GL_POINTS;
+	case CGSHandler::PRIM_LINE:
+	case CGSHandler::PRIM_LINESTRIP:
+		return GL_LINES;
+	case CGSHandler::PRIM_TRIANGLE:
+	case CGSHandler::PRIM_TRIANGLESTRIP:
+	case CGSHandler::PRIM_TRIANGLEFAN:
+	case CGSHandler::PRIM_SPRITE:
+		return GL_TRIANGLES;
+	default:
+		return GL_NONE;
+	}
+}
+
 CGSH_OpenGL::CGSH_OpenGL(bool gsThreaded)
     : CGSHandler(gsThreaded)
     , m_pCvtBuffer(nullptr)
@@ -102,10 +133,9 @@ void CGSH_OpenGL::ReleaseImpl()
 	m_copyToFbTexture.Reset();
 	m_copyToFbVertexBuffer.Reset();
 	m_copyToFbVertexArray.Reset();
-	m_primBuffer.Reset();
+	m_primStreamBuffer.reset();
 	m_primVertexArray.Reset();
-	m_vertexParamsBuffer.Reset();
-	m_fragmentParamsBuffer.Reset();
+	m_paramsStreamBuffer.reset();
 }
 
 void CGSH_OpenGL::ResetImpl()
@@ -237,7 +267,7 @@ void CGSH_OpenGL::FlipImpl()
 	CGSHandler::FlipImpl();
 }
 
-void CGSH_OpenGL::LoadState(Framework::CZipArchiveReader& archive)
+void CGSH_OpenGL::LoadState(CStateArchiveReader& archive)
 {
 	CGSHandler::LoadState(archive);
 	SendGSCall(
@@ -246,11 +276,33 @@ void CGSH_OpenGL::LoadState(Framework::CZipArchiveReader& archive)
 	    });
 }
 
+void CGSH_OpenGL::InvalidateRamRange(uint32 start, uint32 size)
+{
+	SendGSCall(
+	    [this, start, size]() {
+		    m_textureCache.InvalidateRange(start, size);
+	    });
+}
+
+void CGSH_OpenGL::DiscardHostFramebuffers()
+{
+	SendGSCall(
+	    [this]() {
+		    //Pending primitives were also submitted after the snapshot
+		    m_vertexBuffer.clear();
+		    m_framebuffers.clear();
+		    m_depthbuffers.clear();
+		    m_renderState.isValid = false;
+		    m_validGlState = 0;
+	    });
+}
+
 void CGSH_OpenGL::RegisterPreferences()
 {
 	CGSHandler::RegisterPreferences();
 	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_CGSH_OPENGL_RESOLUTION_FACTOR, 1);
 	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_CGSH_OPENGL_FORCEBILINEARTEXTURES, false);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_CGSH_OPENGL_PROGRAMCACHE_ENABLED, true);
 }
 
 void CGSH_OpenGL::NotifyPreferencesChangedImpl()
@@ -290,11 +342,14 @@ void CGSH_OpenGL::InitializeRC()
 	m_copyToFbSrcPositionUniform = glGetUniformLocation(*m_copyToFbProgram, "g_srcPosition");
 	m_copyToFbSrcSizeUniform = glGetUniformLocation(*m_copyToFbProgram, "g_srcSize");
 
-	m_primBuffer = Framework::OpenGl::CBuffer::Create();
+	m_primStreamBuffer = std::make_shared<CStreamBuffer>(GL_ARRAY_BUFFER, VERTEX_STREAM_BUFFER_SIZE, sizeof(PRIM_VERTEX));
 	m_primVertexArray = GeneratePrimVertexArray();
 
-	m_vertexParamsBuffer = GenerateUniformBlockBuffer(sizeof(VERTEXPARAMS));
-	m_fragmentParamsBuffer = GenerateUniformBlockBuffer(sizeof(FRAGMENTPARAMS));
+	GLint paramsAlignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &paramsAlignment);
+	m_paramsStreamBuffer = std::make_shared<CStreamBuffer>(GL_UNIFORM_BUFFER, UNIFORM_STREAM_BUFFER_SIZE, std::max<GLint>(paramsAlignment, 1));
+
+	InitializeProgramCache();
 
 	PresentBackbuffer();
 
@@ -402,7 +457,7 @@ Framework::OpenGl::CVertexArray CGSH_OpenGL::GeneratePrimVertexArray()
 
 	glBindVertexArray(vertexArray);
 
-	glBindBuffer(GL_ARRAY_BUFFER, m_primBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, m_primStreamBuffer->GetBuffer());
 
 	glEnableVertexAttribArray(static_cast<GLuint>(PRIM_VERTEX_ATTRIB::POSITION));
 	glVertexAttribPointer(static_cast<GLuint>(PRIM_VERTEX_ATTRIB::POSITION), 2, GL_FLOAT,
@@ -431,17 +486,6 @@ Framework::OpenGl::CVertexArray CGSH_OpenGL::GeneratePrimVertexArray()
 	return vertexArray;
 }
 
-Framework::OpenGl::CBuffer CGSH_OpenGL::GenerateUniformBlockBuffer(size_t blockSize)
-{
-	auto uniformBlockBuffer = Framework::OpenGl::CBuffer::Create();
-
-	glBindBuffer(GL_UNIFORM_BUFFER, uniformBlockBuffer);
-	glBufferData(GL_UNIFORM_BUFFER, blockSize, nullptr, GL_STREAM_DRAW);
-	CHECKGLERROR();
-
-	return uniformBlockBuffer;
-}
-
 void CGSH_OpenGL::MakeLinearZOrtho(float* matrix, float left, float right, float bottom, float top)
 {
 	matrix[0] = 2.0f / (right - left);
@@ -474,36 +518,14 @@ Framework::OpenGl::ProgramPtr CGSH_OpenGL::GetShaderFromCaps(const SHADERCAPS& s
 	auto shaderIterator = m_shaders.find(static_cast<uint32>(shaderCaps));
 	if(shaderIterator == m_shaders.end())
 	{
-		auto shader = GenerateShader(shaderCaps);
-
-		glUseProgram(*shader);
-		m_validGlState &= ~GLSTATE_PROGRAM;
-
-		auto textureUniform = glGetUniformLocation(*shader, "g_texture");
-		if(textureUniform != -1)
-		{
-			glUniform1i(textureUniform, 0);
-		}
-
-		auto paletteUniform = glGetUniformLocation(*shader, "g_palette");
-		if(paletteUniform != -1)
-		{
-			glUniform1i(paletteUniform, 1);
-		}
-
-		auto vertexParamsUniformBlock = glGetUniformBlockIndex(*shader, "VertexParams");
-		if(vertexParamsUniformBlock != GL_INVALID_INDEX)
-		{
-			glUniformBlockBinding(*shader, vertexParamsUniformBlock, 0);
-		}
-
-		auto fragmentParamsUniformBlock = glGetUniformBlockIndex(*shader, "FragmentParams");
-		if(fragmentParamsUniformBlock != GL_INVALID_INDEX)
+		auto shader = LoadCachedProgram(shaderCaps);
+		if(!shader)
 		{
-			glUniformBlockBinding(*shader, fragmentParamsUniformBlock, 1);
+			shader = GenerateShader(shaderCaps);
+			SaveCachedProgram(shaderCaps, shader);
 		}
 
-		CHECKGLERROR();
+		SetupShaderUniforms(shader);
 
 		m_shaders.insert(std::make_pair(static_cast<uint32>(shaderCaps), shader));
 		shaderIterator = m_shaders.find(static_cast<uint32>(shaderCaps));
@@ -511,6 +533,39 @@ Framework::OpenGl::ProgramPtr CGSH_OpenGL::GetShaderFromCaps(const SHADERCAPS& s
 	return shaderIterator->second;
 }
 
+void CGSH_OpenGL::SetupShaderUniforms(const Framework::OpenGl::ProgramPtr& shader)
+{
+	//Uniform values and block bindings are not part of program binaries, always set them
+	glUseProgram(*shader);
+	m_validGlState &= ~GLSTATE_PROGRAM;
+
+	auto textureUniform = glGetUniformLocation(*shader, "g_texture");
+	if(textureUniform != -1)
+	{
+		glUniform1i(textureUniform, 0);
+	}
+
+	auto paletteUniform = glGetUniformLocation(*shader, "g_palette");
+	if(paletteUniform != -1)
+	{
+		glUniform1i(paletteUniform, 1);
+	}
+
+	auto vertexParamsUniformBlock = glGetUniformBlockIndex(*shader, "VertexParams");
+	if(vertexParamsUniformBlock != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(*shader, vertexParamsUniformBlock, 0);
+	}
+
+	auto fragmentParamsUniformBlock = glGetUniformBlockIndex(*shader, "FragmentParams");
+	if(fragmentParamsUniformBlock != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(*shader, fragmentParamsUniformBlock, 1);
+	}
+
+	CHECKGLERROR();
+}
+
 void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
 {
 	auto prim = make_convertible<PRMODE>(primReg);
@@ -569,8 +624,11 @@ void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
 	//Set render states
 	//--------------------------------------------------------
 
+	//Draws only differing by primitive type or vertex attributes end up in the same batch
+	bool primStateChanged = (GetPrimRenderStateBits(m_renderState.primReg) != GetPrimRenderStateBits(primReg));
+
 	if(!m_renderState.isValid ||
-	   (m_renderState.primReg != primReg))
+	   primStateChanged)
 	{
 		FlushVertexBuffer();
 
@@ -631,7 +689,7 @@ void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
 	   (m_renderState.tex1Reg != tex1Reg) ||
 	   (m_renderState.texAReg != texAReg) ||
 	   (m_renderState.clampReg != clampReg) ||
-	   (m_renderState.primReg != primReg))
+	   primStateChanged)
 	{
 		FlushVertexBuffer();
 		SetupTexture(primReg, tex0Reg, tex1Reg, texAReg, clampReg);
@@ -1581,7 +1639,14 @@ void CGSH_OpenGL::FlushVertexBuffer()
 			m_renderState.shaderHandle = *shader;
 			m_validGlState &= ~GLSTATE_PROGRAM;
 		}
-		DoRenderPass();
+
+		//Batches bigger than what the stream buffer can take are drawn in parts holding whole primitives
+		uint32 vertexCount = static_cast<uint32>(m_vertexBuffer.size());
+		uint32 maxPartVertexCount = ((m_primStreamBuffer->GetMaxWriteSize() / sizeof(PRIM_VERTEX)) / 6) * 6;
+		for(uint32 firstVertex = 0; firstVertex < vertexCount; firstVertex += maxPartVertexCount)
+		{
+			DoRenderPass(firstVertex, std::min(vertexCount - firstVertex, maxPartVertexCount));
+		}
 	}
 	else if(m_renderState.technique == TECHNIQUE::ALPHATEST_TWOPASS)
 	{
@@ -1595,7 +1660,7 @@ void CGSH_OpenGL::FlushVertexBuffer()
 			auto shader = GetShaderFromCaps(m_renderState.shaderCaps);
 			m_renderState.shaderHandle = *shader;
 			m_validGlState &= ~GLSTATE_PROGRAM;
-			DoRenderPass();
+			DoRenderPass(0, static_cast<uint32>(m_vertexBuffer.size()));
 		}
 
 		auto alphaTestMethodSave = m_renderState.shaderCaps.alphaTestMethod;
@@ -1607,7 +1672,7 @@ void CGSH_OpenGL::FlushVertexBuffer()
 			m_renderState.shaderHandle = *shader;
 			m_renderState.depthMask = false;
 			m_validGlState &= ~(GLSTATE_PROGRAM | GLSTATE_DEPTHMASK);
-			DoRenderPass();
+			DoRenderPass(0, static_cast<uint32>(m_vertexBuffer.size()));
 		}
 
 		m_renderState.depthMask = true;
@@ -1617,22 +1682,37 @@ void CGSH_OpenGL::FlushVertexBuffer()
 	m_vertexBuffer.clear();
 }
 
-void CGSH_OpenGL::DoRenderPass()
+void CGSH_OpenGL::DoRenderPass(uint32 firstVertex, uint32 vertexCount)
 {
-	if((m_validGlState & GLSTATE_VERTEX_PARAMS) == 0)
+	//Params are appended to the stream buffer, draws only need to point to their copy.
+	//The fence of a segment is placed when the buffer leaves it, draws issued after that
+	//must not use copies from that segment, so both copies are written again in the new one.
+	//Writing one of them can itself enter a new segment, hence the loop.
+	while(true)
 	{
-		glBindBuffer(GL_UNIFORM_BUFFER, m_vertexParamsBuffer);
-		glBufferData(GL_UNIFORM_BUFFER, sizeof(VERTEXPARAMS), &m_vertexParams, GL_STREAM_DRAW);
-		CHECKGLERROR();
-		m_validGlState |= GLSTATE_VERTEX_PARAMS;
-	}
+		if(m_paramsStreamBuffer->GetSegmentSerial() != m_paramsStreamSegmentSerial)
+		{
+			m_paramsStreamSegmentSerial = m_paramsStreamBuffer->GetSegmentSerial();
+			m_validGlState &= ~(GLSTATE_VERTEX_PARAMS | GLSTATE_FRAGMENT_PARAMS);
+		}
 
-	if((m_validGlState & GLSTATE_FRAGMENT_PARAMS) == 0)
-	{
-		glBindBuffer(GL_UNIFORM_BUFFER, m_fragmentParamsBuffer);
-		glBufferData(GL_UNIFORM_BUFFER, sizeof(FRAGMENTPARAMS), &m_fragmentParams, GL_STREAM_DRAW);
-		CHECKGLERROR();
-		m_validGlState |= GLSTATE_FRAGMENT_PARAMS;
+		if((m_validGlState & GLSTATE_VERTEX_PARAMS) == 0)
+		{
+			uint32 paramsOffset = m_paramsStreamBuffer->Write(&m_vertexParams, sizeof(VERTEXPARAMS));
+			glBindBufferRange(GL_UNIFORM_BUFFER, 0, m_paramsStreamBuffer->GetBuffer(), paramsOffset, sizeof(VERTEXPARAMS));
+			CHECKGLERROR();
+			m_validGlState |= GLSTATE_VERTEX_PARAMS;
+		}
+
+		if((m_validGlState & GLSTATE_FRAGMENT_PARAMS) == 0)
+		{
+			uint32 paramsOffset = m_paramsStreamBuffer->Write(&m_fragmentParams, sizeof(FRAGMENTPARAMS));
+			glBindBufferRange(GL_UNIFORM_BUFFER, 1, m_paramsStreamBuffer->GetBuffer(), paramsOffset, sizeof(FRAGMENTPARAMS));
+			CHECKGLERROR();
+			m_validGlState |= GLSTATE_FRAGMENT_PARAMS;
+		}
+
+		if(m_paramsStreamBuffer->GetSegmentSerial() == m_paramsStreamSegmentSerial) break;
 	}
 
 	if((m_validGlState & GLSTATE_PROGRAM) == 0)
@@ -1707,36 +1787,14 @@ void CGSH_OpenGL::DoRenderPass()
 		m_validGlState |= GLSTATE_FRAMEBUFFER;
 	}
 
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, m_vertexParamsBuffer);
-	glBindBufferBase(GL_UNIFORM_BUFFER, 1, m_fragmentParamsBuffer);
-
-	glBindBuffer(GL_ARRAY_BUFFER, m_primBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(PRIM_VERTEX) * m_vertexBuffer.size(), m_vertexBuffer.data(), GL_STREAM_DRAW);
+	uint32 vertexOffset = m_primStreamBuffer->Write(m_vertexBuffer.data() + firstVertex, sizeof(PRIM_VERTEX) * vertexCount);
 
 	glBindVertexArray(m_primVertexArray);
 
-	GLenum primitiveMode = GL_NONE;
-	switch(m_primitiveType)
-	{
-	case PRIM_POINT:
-		primitiveMode = GL_POINTS;
-		break;
-	case PRIM_LINE:
-	case PRIM_LINESTRIP:
-		primitiveMode = GL_LINES;
-		break;
-	case PRIM_TRIANGLE:
-	case PRIM_TRIANGLESTRIP:
-	case PRIM_TRIANGLEFAN:
-	case PRIM_SPRITE:
-		primitiveMode = GL_TRIANGLES;
-		break;
-	default:
-		assert(false);
-		break;
-	}
+	GLenum primitiveMode = GetPrimitiveMode(m_primitiveType);
+	assert(primitiveMode != GL_NONE);
 
-	glDrawArrays(primitiveMode, 0, m_vertexBuffer.size());
+	glDrawArrays(primitiveMode, vertexOffset / sizeof(PRIM_VERTEX), vertexCount);
 
 	m_drawCallCount++;
 }
@@ -1835,7 +1893,8 @@ void CGSH_OpenGL::WriteRegisterImpl(uint8 nRegister, uint64 nData)
 	case GS_REG_PRIM:
 	{
 		unsigned int newPrimitiveType = static_cast<unsigned int>(nData & 0x07);
-		if(newPrimitiveType != m_primitiveType)
+		//Vertices are always expanded to lists, only a different GL primitive needs a new batch
+		if(GetPrimitiveMode(newPrimitiveType) != GetPrimitiveMode(m_primitiveType))
 		{
 			FlushVertexBuffer();
 		}
@@ -2369,3 +2428,150 @@ CGSH_OpenGL::CDepthbuffer::~CDepthbuffer()
 		glDeleteRenderbuffers(1, &m_depthBuffer);
 	}
 }
+
+/////////////////////////////////////////////////////////////
+// Stream Buffer
+/////////////////////////////////////////////////////////////
+
+#ifdef USE_BUFFER_STORAGE
+static bool HasBufferStorage()
+{
+	GLint majorVersion = 0;
+	GLint minorVersion = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+	glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+	if((majorVersion > 4) || ((majorVersion == 4) && (minorVersion >= 4)))
+	{
+		return true;
+	}
+
+	GLint extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+	for(GLint i = 0; i < extensionCount; i++)
+	{
+		auto extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+		if((extension != nullptr) && !strcmp(extension, "GL_ARB_buffer_storage"))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+#endif
+
+CGSH_OpenGL::CStreamBuffer::CStreamBuffer(GLenum target, uint32 size, uint32 alignment)
+    : m_target(target)
+    , m_size(size)
+    , m_segmentSize(size / SEGMENT_COUNT)
+    , m_alignment(alignment)
+{
+	assert(m_segmentSize >= m_alignment);
+
+	m_buffer = Framework::OpenGl::CBuffer::Create();
+	glBindBuffer(m_target, m_buffer);
+#ifdef USE_BUFFER_STORAGE
+	if(HasBufferStorage())
+	{
+		//Mapped once for the lifetime of the buffer
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(m_target, m_size, nullptr, flags);
+		m_mappedMemory = reinterpret_cast<uint8*>(glMapBufferRange(m_target, 0, m_size, flags));
+		assert(m_mappedMemory != nullptr);
+	}
+	else
+#endif
+	{
+		glBufferData(m_target, m_size, nullptr, GL_STREAM_DRAW);
+	}
+	glBindBuffer(m_target, 0);
+	CHECKGLERROR();
+}
+
+CGSH_OpenGL::CStreamBuffer::~CStreamBuffer()
+{
+	for(auto& fence : m_fences)
+	{
+		if(fence != nullptr)
+		{
+			glDeleteSync(fence);
+		}
+	}
+	if(m_mappedMemory != nullptr)
+	{
+		glBindBuffer(m_target, m_buffer);
+		glUnmapBuffer(m_target);
+		glBindBuffer(m_target, 0);
+	}
+}
+
+GLuint CGSH_OpenGL::CStreamBuffer::GetBuffer() const
+{
+	return m_buffer;
+}
+
+uint32 CGSH_OpenGL::CStreamBuffer::GetMaxWriteSize() const
+{
+	return m_segmentSize;
+}
+
+uint32 CGSH_OpenGL::CStreamBuffer::GetSegmentSerial() const
+{
+	return m_segmentSerial;
+}
+
+uint32 CGSH_OpenGL::CStreamBuffer::Write(const void* data, uint32 size)
+{
+	assert((size != 0) && (size <= m_segmentSize));
+
+	//Writes never span two segments, otherwise the fence of the segment we're leaving
+	//would be inserted before the draw that uses the data written in it
+	uint32 offset = ((m_position + m_alignment - 1) / m_alignment) * m_alignment;
+	uint32 segmentEnd = ((offset / m_segmentSize) + 1) * m_segmentSize;
+	if((offset + size) > segmentEnd)
+	{
+		offset = segmentEnd;
+	}
+	if((offset + size) > m_size)
+	{
+		offset = 0;
+	}
+
+	EnterSegment(offset / m_segmentSize);
+
+	if(m_mappedMemory != nullptr)
+	{
+		memcpy(m_mappedMemory + offset, data, size);
+	}
+	else
+	{
+		//Fences already guarantee that the range isn't used anymore
+		glBindBuffer(m_target, m_buffer);
+		auto memory = glMapBufferRange(m_target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		assert(memory != nullptr);
+		memcpy(memory, data, size);
+		glUnmapBuffer(m_target);
+	}
+	CHECKGLERROR();
+
+	m_position = offset + size;
+	return offset;
+}
+
+void CGSH_OpenGL::CStreamBuffer::EnterSegment(unsigned int segment)
+{
+	if(segment == m_segment) return;
+
+	//Signaled when draws using the segment we're leaving are done
+	assert(m_fences[m_segment] == nullptr);
+	m_fences[m_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_segment = segment;
+	m_segmentSerial++;
+
+	auto& fence = m_fences[m_segment];
+	if(fence == nullptr) return;
+	while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT) == GL_TIMEOUT_EXPIRED)
+	{
+	}
+	glDeleteSync(fence);
+	fence = nullptr;
+}
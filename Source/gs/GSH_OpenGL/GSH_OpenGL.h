@@ -2,6 +2,7 @@
 
 #include <list>
 #include <unordered_map>
+#include "filesystem_def.h"
 #include "../GSHandler.h"
 #include "../GsCachedArea.h"
 #include "../GsTextureCache.h"
@@ -12,6 +13,7 @@
 
 #define PREF_CGSH_OPENGL_RESOLUTION_FACTOR "renderer.opengl.resfactor"
 #define PREF_CGSH_OPENGL_FORCEBILINEARTEXTURES "renderer.opengl.forcebilineartextures"
+#define PREF_CGSH_OPENGL_PROGRAMCACHE_ENABLED "renderer.opengl.programcache.enabled"
 
 #if !defined(GLES_COMPATIBILITY) && !defined(__APPLE__)
 //- Dual source blending is disabled on macOS because it seems to be problematic on
@@ -19,6 +21,11 @@
 #define USE_DUALSOURCE_BLENDING
 #endif
 
+#if !defined(GLES_COMPATIBILITY) && !defined(__APPLE__)
+//- Persistently mapped buffers need OpenGL 4.4, macOS stops at 4.1.
+#define USE_BUFFER_STORAGE
+#endif
+
 class CGSH_OpenGL : public CGSHandler
 {
 public:
@@ -27,7 +34,7 @@ public:
 
 	static void RegisterPreferences();
 
-	void LoadState(Framework::CZipArchiveReader&) override;
+	void LoadState(CStateArchiveReader&) override;
 
 	void ProcessHostToLocalTransfer() override;
 	void ProcessLocalToHostTransfer() override;
@@ -44,7 +51,10 @@ protected:
 	void ReleaseImpl() override;
 	void ResetImpl() override;
 	void NotifyPreferencesChangedImpl() override;
+	void NotifyExecutableChangedImpl(const std::string&) override;
 	void FlipImpl() override;
+	void InvalidateRamRange(uint32, uint32) override;
+	void DiscardHostFramebuffers() override;
 
 	GLuint m_presentFramebuffer = 0;
 
@@ -248,6 +258,40 @@ private:
 	typedef std::shared_ptr<CDepthbuffer> DepthbufferPtr;
 	typedef std::vector<DepthbufferPtr> DepthbufferList;
 
+	//Buffer used as a ring, fences make sure we don't overwrite data draws still need
+	class CStreamBuffer
+	{
+	public:
+		CStreamBuffer(GLenum, uint32, uint32);
+		~CStreamBuffer();
+
+		GLuint GetBuffer() const;
+		uint32 GetMaxWriteSize() const;
+		//Changes every time writes move to another segment
+		uint32 GetSegmentSerial() const;
+		uint32 Write(const void*, uint32);
+
+	private:
+		enum
+		{
+			SEGMENT_COUNT = 4,
+		};
+
+		void EnterSegment(unsigned int);
+
+		Framework::OpenGl::CBuffer m_buffer;
+		GLenum m_target = GL_NONE;
+		uint32 m_size = 0;
+		uint32 m_segmentSize = 0;
+		uint32 m_alignment = 1;
+		uint32 m_position = 0;
+		uint32 m_segmentSerial = 0;
+		unsigned int m_segment = 0;
+		GLsync m_fences[SEGMENT_COUNT] = {};
+		uint8* m_mappedMemory = nullptr;
+	};
+	typedef std::shared_ptr<CStreamBuffer> StreamBufferPtr;
+
 	struct TEXTURE_INFO
 	{
 		GLuint textureHandle = 0;
@@ -287,6 +331,12 @@ private:
 		VERTEX_BUFFER_SIZE = 0x1000,
 	};
 
+	enum STREAM_BUFFER_SIZE
+	{
+		VERTEX_STREAM_BUFFER_SIZE = 0x800000,
+		UNIFORM_STREAM_BUFFER_SIZE = 0x100000,
+	};
+
 	typedef std::vector<PRIM_VERTEX> VertexBuffer;
 
 	void WriteRegisterImpl(uint8, uint64) override;
@@ -302,12 +352,22 @@ private:
 	void VertexKick(uint8, uint64);
 
 	Framework::OpenGl::ProgramPtr GetShaderFromCaps(const SHADERCAPS&);
+	void SetupShaderUniforms(const Framework::OpenGl::ProgramPtr&);
 	Framework::OpenGl::ProgramPtr GenerateShader(const SHADERCAPS&);
 	Framework::OpenGl::CShader GenerateVertexShader(const SHADERCAPS&);
 	Framework::OpenGl::CShader GenerateFragmentShader(const SHADERCAPS&);
+	std::string GenerateVertexShaderSource(const SHADERCAPS&);
+	std::string GenerateFragmentShaderSource(const SHADERCAPS&);
 	std::string GenerateTexCoordClampingSection(TEXTURE_CLAMP_MODE, const char*);
 	std::string GenerateAlphaTestSection(ALPHA_TEST_METHOD);
 
+	void InitializeProgramCache();
+	void PrewarmProgramCache();
+	fs::path GetCachedProgramPath(uint32) const;
+	uint32 GetProgramSourceHash(const SHADERCAPS&);
+	Framework::OpenGl::ProgramPtr LoadCachedProgram(uint32);
+	void SaveCachedProgram(uint32, const Framework::OpenGl::ProgramPtr&);
+
 	Framework::OpenGl::ProgramPtr GeneratePresentProgram();
 	Framework::OpenGl::CBuffer GeneratePresentVertexBuffer();
 	Framework::OpenGl::CVertexArray GeneratePresentVertexArray();
@@ -317,7 +377,6 @@ private:
 	Framework::OpenGl::CVertexArray GenerateCopyToFbVertexArray();
 
 	Framework::OpenGl::CVertexArray GeneratePrimVertexArray();
-	Framework::OpenGl::CBuffer GenerateUniformBlockBuffer(size_t);
 
 	void Prim_Point();
 	void Prim_Line();
@@ -325,7 +384,7 @@ private:
 	void Prim_Sprite();
 
 	void FlushVertexBuffer();
-	void DoRenderPass();
+	void DoRenderPass(uint32, uint32);
 
 	void CopyToFb(int32, int32, int32, int32, int32, int32, int32, int32, int32, int32);
 	void DrawToDepth(unsigned int, uint64);
@@ -403,7 +462,7 @@ private:
 	FramebufferList m_framebuffers;
 	DepthbufferList m_depthbuffers;
 
-	Framework::OpenGl::CBuffer m_primBuffer;
+	StreamBufferPtr m_primStreamBuffer;
 	Framework::OpenGl::CVertexArray m_primVertexArray;
 
 	VERTEX m_VtxBuffer[3];
@@ -435,11 +494,14 @@ private:
 	};
 
 	ShaderMap m_shaders;
+	bool m_programCacheEnabled = false;
+	uint32 m_programCacheDriverHash = 0;
+	fs::path m_programCachePath;
 	RENDERSTATE m_renderState;
 	uint32 m_validGlState = 0;
 	VERTEXPARAMS m_vertexParams;
 	FRAGMENTPARAMS m_fragmentParams;
-	Framework::OpenGl::CBuffer m_vertexParamsBuffer;
-	Framework::OpenGl::CBuffer m_fragmentParamsBuffer;
+	StreamBufferPtr m_paramsStreamBuffer;
+	uint32 m_paramsStreamSegmentSerial = 0;
 	VertexBuffer m_vertexBuffer;
 };
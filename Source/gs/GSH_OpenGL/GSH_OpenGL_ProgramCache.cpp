@@ -0,0 +1,212 @@
+#include <cctype>
+#include "GSH_OpenGL.h"
+#include "../../AppConfig.h"
+#include "../../Log.h"
+#include "PathUtils.h"
+#include "StdStreamUtils.h"
+#include "string_format.h"
+
+#define LOG_NAME ("gsh_opengl")
+
+#define PROGRAM_CACHE_DIRECTORY "shadercache"
+#define PROGRAM_CACHE_EXTENSION ".bin"
+#define PROGRAM_CACHE_MAGIC (0x43504750)
+//Needs to be incremented every time the layout of cache files changes,
+//changes to the generated shaders are caught by the source hash
+#define PROGRAM_CACHE_VERSION (2)
+
+static uint32 HashString(uint32 hash, const char* value)
+{
+	//FNV-1a, needs to be stable between runs
+	if(value == nullptr) return hash;
+	for(; *value != 0; value++)
+	{
+		hash ^= static_cast<uint8>(*value);
+		hash *= 0x01000193;
+	}
+	return hash;
+}
+
+static std::string MakeTitleDirectoryName(const std::string& executableName)
+{
+	std::string result = executableName;
+	for(auto& character : result)
+	{
+		if(!isalnum(static_cast<unsigned char>(character)) && (character != '.') && (character != '-'))
+		{
+			character = '_';
+		}
+	}
+	return result;
+}
+
+void CGSH_OpenGL::InitializeProgramCache()
+{
+	m_programCacheEnabled = false;
+	if(!CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSH_OPENGL_PROGRAMCACHE_ENABLED))
+	{
+		return;
+	}
+
+	GLint binaryFormatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormatCount);
+	if(binaryFormatCount == 0)
+	{
+		CLog::GetInstance().Print(LOG_NAME, "Driver doesn't support program binaries, program cache disabled.\r\n");
+		return;
+	}
+
+	//Binaries are only valid for the driver that produced them
+	uint32 driverHash = 0x811C9DC5;
+	driverHash = HashString(driverHash, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+	driverHash = HashString(driverHash, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+	driverHash = HashString(driverHash, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+	m_programCacheDriverHash = driverHash;
+	m_programCacheEnabled = true;
+}
+
+void CGSH_OpenGL::NotifyExecutableChangedImpl(const std::string& executableName)
+{
+	m_programCachePath.clear();
+	if(!m_programCacheEnabled || executableName.empty()) return;
+
+	try
+	{
+		auto cachePath = CAppConfig::GetBasePath() / PROGRAM_CACHE_DIRECTORY / MakeTitleDirectoryName(executableName);
+		Framework::PathUtils::EnsurePathExists(cachePath);
+		m_programCachePath = cachePath;
+		PrewarmProgramCache();
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to prewarm program cache: %s\r\n", exception.what());
+	}
+}
+
+void CGSH_OpenGL::PrewarmProgramCache()
+{
+	unsigned int loadedCount = 0;
+	for(const auto& entry : fs::directory_iterator(m_programCachePath))
+	{
+		const auto& entryPath = entry.path();
+		if(entryPath.extension() != PROGRAM_CACHE_EXTENSION) continue;
+
+		uint32 shaderCaps = 0;
+		try
+		{
+			shaderCaps = std::stoul(entryPath.stem().string(), nullptr, 16);
+		}
+		catch(...)
+		{
+			continue;
+		}
+
+		if(m_shaders.find(shaderCaps) != m_shaders.end()) continue;
+
+		auto shader = LoadCachedProgram(shaderCaps);
+		if(!shader) continue;
+
+		SetupShaderUniforms(shader);
+		m_shaders.insert(std::make_pair(shaderCaps, shader));
+		loadedCount++;
+	}
+	CLog::GetInstance().Print(LOG_NAME, "Loaded %d program(s) from program cache.\r\n", loadedCount);
+}
+
+fs::path CGSH_OpenGL::GetCachedProgramPath(uint32 shaderCaps) const
+{
+	return m_programCachePath / string_format("%08X" PROGRAM_CACHE_EXTENSION, shaderCaps);
+}
+
+uint32 CGSH_OpenGL::GetProgramSourceHash(const SHADERCAPS& shaderCaps)
+{
+	uint32 sourceHash = 0x811C9DC5;
+	sourceHash = HashString(sourceHash, GenerateVertexShaderSource(shaderCaps).c_str());
+	sourceHash = HashString(sourceHash, GenerateFragmentShaderSource(shaderCaps).c_str());
+	return sourceHash;
+}
+
+Framework::OpenGl::ProgramPtr CGSH_OpenGL::LoadCachedProgram(uint32 shaderCaps)
+{
+	if(m_programCachePath.empty()) return Framework::OpenGl::ProgramPtr();
+
+	auto cachedProgramPath = GetCachedProgramPath(shaderCaps);
+	if(!fs::exists(cachedProgramPath)) return Framework::OpenGl::ProgramPtr();
+
+	GLenum binaryFormat = 0;
+	std::vector<uint8> binary;
+	try
+	{
+		auto stream = Framework::CreateInputStdStream(cachedProgramPath.native());
+		uint32 magic = stream.Read32();
+		uint32 version = stream.Read32();
+		uint32 driverHash = stream.Read32();
+		uint32 sourceHash = stream.Read32();
+		if((magic != PROGRAM_CACHE_MAGIC) || (version != PROGRAM_CACHE_VERSION) || (driverHash != m_programCacheDriverHash) ||
+		   (sourceHash != GetProgramSourceHash(make_convertible<SHADERCAPS>(shaderCaps))))
+		{
+			//Produced by another version, another driver or from other shader source, will be overwritten
+			return Framework::OpenGl::ProgramPtr();
+		}
+		binaryFormat = stream.Read32();
+		binary.resize(stream.Read32());
+		stream.Read(binary.data(), binary.size());
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to read cached program '%s': %s\r\n",
+		                         cachedProgramPath.string().c_str(), exception.what());
+		return Framework::OpenGl::ProgramPtr();
+	}
+
+	auto result = std::make_shared<Framework::OpenGl::CProgram>();
+	glProgramBinary(*result, binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+
+	//Drivers are free to reject binaries (after an update for example), source will be used instead
+	GLint linkStatus = GL_FALSE;
+	glGetProgramiv(*result, GL_LINK_STATUS, &linkStatus);
+	if(linkStatus == GL_FALSE)
+	{
+		//Unknown formats also raise an error, clear it
+		glGetError();
+		CLog::GetInstance().Print(LOG_NAME, "Driver rejected cached program 0x%08X.\r\n", shaderCaps);
+		return Framework::OpenGl::ProgramPtr();
+	}
+
+	CHECKGLERROR();
+
+	return result;
+}
+
+void CGSH_OpenGL::SaveCachedProgram(uint32 shaderCaps, const Framework::OpenGl::ProgramPtr& shader)
+{
+	if(m_programCachePath.empty()) return;
+
+	GLint binaryLength = 0;
+	glGetProgramiv(*shader, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if(binaryLength <= 0) return;
+
+	GLenum binaryFormat = 0;
+	std::vector<uint8> binary(binaryLength);
+	glGetProgramBinary(*shader, binaryLength, &binaryLength, &binaryFormat, binary.data());
+	CHECKGLERROR();
+	if(binaryLength <= 0) return;
+
+	auto cachedProgramPath = GetCachedProgramPath(shaderCaps);
+	try
+	{
+		auto stream = Framework::CreateOutputStdStream(cachedProgramPath.native());
+		stream.Write32(PROGRAM_CACHE_MAGIC);
+		stream.Write32(PROGRAM_CACHE_VERSION);
+		stream.Write32(m_programCacheDriverHash);
+		stream.Write32(GetProgramSourceHash(make_convertible<SHADERCAPS>(shaderCaps)));
+		stream.Write32(binaryFormat);
+		stream.Write32(binaryLength);
+		stream.Write(binary.data(), binaryLength);
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to write cached program '%s': %s\r\n",
+		                         cachedProgramPath.string().c_str(), exception.what());
+	}
+}
@@ -1,10 +1,12 @@
 #include <stdio.h>
 #include <string.h>
 #include <functional>
+#include <algorithm>
 #include "../AppConfig.h"
 #include "../Log.h"
 #include "../states/MemoryStateFile.h"
 #include "../states/RegisterStateFile.h"
+#include "../states/QuickState.h"
 #include "../FrameDump.h"
 #include "../ee/INTC.h"
 #include "GSHandler.h"
@@ -55,6 +57,8 @@
 #define STATE_REG_CBP0 ("cbp0")
 #define STATE_REG_CBP1 ("cbp1")
 
+#define QUICKSTATE_PAGE_SIZE (0x1000)
+
 #define LOG_NAME ("gs")
 
 struct MASSIVEWRITE_INFO
@@ -133,6 +137,11 @@ void CGSHandler::NotifyPreferencesChanged()
 	SendGSCall([this]() { NotifyPreferencesChangedImpl(); });
 }
 
+void CGSHandler::NotifyExecutableChanged(const std::string& executableName)
+{
+	SendGSCall([this, executableName]() { NotifyExecutableChangedImpl(executableName); });
+}
+
 void CGSHandler::SetIntc(CINTC* intc)
 {
 	m_intc = intc;
@@ -177,6 +186,10 @@ void CGSHandler::NotifyPreferencesChangedImpl()
 {
 }
 
+void CGSHandler::NotifyExecutableChangedImpl(const std::string&)
+{
+}
+
 void CGSHandler::SetPresentationParams(const PRESENTATION_PARAMS& presentationParams)
 {
 	m_presentationParams = presentationParams;
@@ -239,7 +252,7 @@ CGSHandler::PRESENTATION_VIEWPORT CGSHandler::GetPresentationViewport() const
 	return viewport;
 }
 
-void CGSHandler::SaveState(Framework::CZipArchiveWriter& archive)
+void CGSHandler::SaveState(CStateArchiveWriter& archive)
 {
 	archive.InsertFile(new CMemoryStateFile(STATE_RAM, GetRam(), RAMSIZE));
 	archive.InsertFile(new CMemoryStateFile(STATE_REGS, m_nReg, sizeof(uint64) * CGSHandler::REGISTER_MAX));
@@ -265,7 +278,7 @@ void CGSHandler::SaveState(Framework::CZipArchiveWriter& archive)
 	}
 }
 
-void CGSHandler::LoadState(Framework::CZipArchiveReader& archive)
+void CGSHandler::LoadState(CStateArchiveReader& archive)
 {
 	archive.BeginReadFile(STATE_RAM)->Read(GetRam(), RAMSIZE);
 	archive.BeginReadFile(STATE_REGS)->Read(m_nReg, sizeof(uint64) * CGSHandler::REGISTER_MAX);
@@ -288,6 +301,70 @@ void CGSHandler::LoadState(Framework::CZipArchiveReader& archive)
 	}
 }
 
+void CGSHandler::SaveQuickState(CQuickState& state)
+{
+	//Make sure the GS thread isn't touching anything we're about to copy
+	SendGSCall([]() {}, true);
+
+	std::lock_guard<std::recursive_mutex> registerMutexLock(m_registerMutex);
+
+	state.SaveMemory(GetRam(), RAMSIZE);
+	state.SaveMemory(m_nReg, sizeof(uint64) * CGSHandler::REGISTER_MAX);
+	state.SaveMemory(&m_trxCtx, sizeof(TRXCONTEXT));
+
+	state.SaveMemory(&m_nPMODE, sizeof(uint64));
+	state.SaveMemory(&m_nSMODE2, sizeof(uint64));
+	state.SaveMemory(&m_nDISPFB1, sizeof(DELAYED_REGISTER));
+	state.SaveMemory(&m_nDISPLAY1, sizeof(DELAYED_REGISTER));
+	state.SaveMemory(&m_nDISPFB2, sizeof(DELAYED_REGISTER));
+	state.SaveMemory(&m_nDISPLAY2, sizeof(DELAYED_REGISTER));
+	state.SaveMemory(&m_nCSR, sizeof(uint64));
+	state.SaveMemory(&m_nIMR, sizeof(uint64));
+	state.SaveMemory(&m_nSIGLBLID, sizeof(uint64));
+	state.SaveMemory(&m_nCrtMode, sizeof(unsigned int));
+	state.SaveMemory(&m_nCBP0, sizeof(uint32));
+	state.SaveMemory(&m_nCBP1, sizeof(uint32));
+}
+
+void CGSHandler::LoadQuickState(CQuickState& state)
+{
+	SendGSCall([]() {}, true);
+
+	std::lock_guard<std::recursive_mutex> registerMutexLock(m_registerMutex);
+
+	uint32 invalidStart = RAMSIZE;
+	uint32 invalidEnd = 0;
+	state.LoadMemory(GetRam(), RAMSIZE, QUICKSTATE_PAGE_SIZE,
+	                 [&](size_t offset, size_t size) {
+		                 invalidStart = std::min<uint32>(invalidStart, static_cast<uint32>(offset));
+		                 invalidEnd = std::max<uint32>(invalidEnd, static_cast<uint32>(offset + size));
+	                 });
+	state.LoadMemory(m_nReg, sizeof(uint64) * CGSHandler::REGISTER_MAX);
+	state.LoadMemory(&m_trxCtx, sizeof(TRXCONTEXT));
+
+	state.LoadMemory(&m_nPMODE, sizeof(uint64));
+	state.LoadMemory(&m_nSMODE2, sizeof(uint64));
+	state.LoadMemory(&m_nDISPFB1, sizeof(DELAYED_REGISTER));
+	state.LoadMemory(&m_nDISPLAY1, sizeof(DELAYED_REGISTER));
+	state.LoadMemory(&m_nDISPFB2, sizeof(DELAYED_REGISTER));
+	state.LoadMemory(&m_nDISPLAY2, sizeof(DELAYED_REGISTER));
+	state.LoadMemory(&m_nCSR, sizeof(uint64));
+	state.LoadMemory(&m_nIMR, sizeof(uint64));
+	state.LoadMemory(&m_nSIGLBLID, sizeof(uint64));
+	state.LoadMemory(&m_nCrtMode, sizeof(unsigned int));
+	state.LoadMemory(&m_nCBP0, sizeof(uint32));
+	state.LoadMemory(&m_nCBP1, sizeof(uint32));
+
+	if(invalidStart < invalidEnd)
+	{
+		InvalidateRamRange(invalidStart, invalidEnd - invalidStart);
+	}
+
+	//Render targets kept by the host contain what was drawn after the snapshot was
+	//taken, they need to be recreated from the restored memory
+	DiscardHostFramebuffers();
+}
+
 void CGSHandler::Copy(const CGSHandler* gs)
 {
 	memcpy(GetRam(), gs->GetRam(), RAMSIZE);
@@ -325,11 +402,27 @@ void CGSHandler::SetDrawEnabled(bool drawEnabled)
 	m_drawEnabled = drawEnabled;
 }
 
+bool CGSHandler::GetPresentEnabled() const
+{
+	return m_presentEnabled;
+}
+
+void CGSHandler::SetPresentEnabled(bool presentEnabled)
+{
+	m_presentEnabled = presentEnabled;
+}
+
 void CGSHandler::SetVBlank()
 {
+	if(m_presentEnabled)
 	{
 		Flip();
 	}
+	else
+	{
+		//Frame won't be shown, but keep in sync with the GS thread like Flip does
+		SendGSCall([]() {}, true);
+	}
 
 	std::lock_guard<std::recursive_mutex> registerMutexLock(m_registerMutex);
 	m_nCSR |= CSR_VSYNC_INT;
@@ -502,6 +595,14 @@ void CGSHandler::MarkNewFrame()
 #endif
 }
 
+void CGSHandler::InvalidateRamRange(uint32, uint32)
+{
+}
+
+void CGSHandler::DiscardHostFramebuffers()
+{
+}
+
 uint8* CGSHandler::GetRam() const
 {
 	return m_pRAM;
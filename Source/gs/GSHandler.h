@@ -12,12 +12,12 @@
 #include "Convertible.h"
 #include "../MailBox.h"
 #include "../Integer64.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 class CFrameDump;
 class CGsPacketMetadata;
 class CINTC;
+class CQuickState;
 struct MASSIVEWRITE_INFO;
 
 #define PREF_CGSHANDLER_PRESENTATION_MODE "renderer.presentationmode"
@@ -764,13 +764,16 @@ public:
 
 	static void RegisterPreferences();
 	void NotifyPreferencesChanged();
+	void NotifyExecutableChanged(const std::string&);
 
 	void SetIntc(CINTC*);
 	void Reset();
 	virtual void SetPresentationParams(const PRESENTATION_PARAMS&);
 
-	virtual void SaveState(Framework::CZipArchiveWriter&);
-	virtual void LoadState(Framework::CZipArchiveReader&);
+	virtual void SaveState(CStateArchiveWriter&);
+	virtual void LoadState(CStateArchiveReader&);
+	void SaveQuickState(CQuickState&);
+	void LoadQuickState(CQuickState&);
 	void Copy(const CGSHandler*);
 
 	void SetFrameDump(CFrameDump*);
@@ -778,6 +781,9 @@ public:
 	bool GetDrawEnabled() const;
 	void SetDrawEnabled(bool);
 
+	bool GetPresentEnabled() const;
+	void SetPresentEnabled(bool);
+
 	void WritePrivRegister(uint32, uint32);
 	uint32 ReadPrivRegister(uint32);
 
@@ -930,8 +936,11 @@ protected:
 	void ResetBase();
 	virtual void ResetImpl();
 	virtual void NotifyPreferencesChangedImpl();
+	virtual void NotifyExecutableChangedImpl(const std::string&);
 	virtual void FlipImpl();
 	virtual void MarkNewFrame();
+	virtual void InvalidateRamRange(uint32, uint32);
+	virtual void DiscardHostFramebuffers();
 	virtual void WriteRegisterImpl(uint8, uint64);
 	void FeedImageDataImpl(const uint8*, uint32);
 	void ReadImageDataImpl(void*, uint32);
@@ -1008,6 +1017,7 @@ protected:
 	bool m_threadDone;
 	CFrameDump* m_frameDump;
 	bool m_drawEnabled = true;
+	bool m_presentEnabled = true;
 	CINTC* m_intc = nullptr;
 	bool m_gsThreaded = true;
 	bool m_flipped = false;
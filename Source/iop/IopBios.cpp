@@ -142,6 +142,7 @@ void CIopBios::Reset(const Iop::SifManPtr& sifMan)
 	//0xBE00000 = Stupid constant to make FFX PSF happy
 	CurrentTime() = 0xBE00000;
 	ThreadLinkHead() = 0;
+	RebuildThreadReadyQueue();
 	m_currentThreadId = -1;
 
 	m_cpu.m_State.nCOP0[CCOP_SCU::STATUS] |= CMIPS::STATUS_IE;
@@ -302,7 +303,7 @@ uint32& CIopBios::ModuleStartRequestFree() const
 	return *reinterpret_cast<uint32*>(m_ram + BIOS_MODULESTARTREQUEST_FREE_BASE);
 }
 
-void CIopBios::SaveState(Framework::CZipArchiveWriter& archive)
+void CIopBios::SaveState(CStateArchiveWriter& archive)
 {
 	CStructCollectionStateFile* modulesFile = new CStructCollectionStateFile(STATE_MODULES);
 	{
@@ -332,7 +333,7 @@ void CIopBios::SaveState(Framework::CZipArchiveWriter& archive)
 #endif
 }
 
-void CIopBios::LoadState(Framework::CZipArchiveReader& archive)
+void CIopBios::LoadState(CStateArchiveReader& archive)
 {
 	//Remove all dynamic modules
 	for(auto modulePairIterator = m_modules.begin();
@@ -369,7 +370,11 @@ void CIopBios::LoadState(Framework::CZipArchiveReader& archive)
 	m_fileIo->LoadState(archive);
 	m_padman->LoadState(archive);
 	m_cdvdfsv->LoadState(archive);
+#endif
+
+	RebuildThreadReadyQueue();
 
+#ifdef _IOP_EMULATE_MODULES
 	//Make sure HLE modules are properly registered
 	for(const auto& loadedModule : m_loadedModules)
 	{
@@ -1065,8 +1070,8 @@ int32 CIopBios::StartThreadArgs(uint32 threadId, uint32 args, uint32 argpPtr)
 	    };
 
 	thread->status = THREAD_STATUS_RUNNING;
-	LinkThread(threadId);
 	thread->priority = thread->initPriority;
+	LinkThread(threadId);
 	thread->context.epc = thread->threadProc;
 	thread->context.gpr[CMIPS::RA] = m_threadFinishAddress;
 	thread->context.gpr[CMIPS::SP] = thread->stackBase + thread->stackSize;
@@ -1604,6 +1609,23 @@ void CIopBios::LinkThread(uint32 threadId)
 		}
 		nextThreadId = &currentThread->nextThreadId;
 	}
+
+	//Threads are linked after all threads of the same priority, a growing
+	//sequence number keeps that order in the ready queue
+	auto& scheduleInfo = m_threadScheduleInfos[threadId];
+	assert(!scheduleInfo.linked);
+	scheduleInfo.linked = true;
+	scheduleInfo.priority = thread->priority;
+	scheduleInfo.linkSequence = m_nextThreadLinkSequence++;
+	scheduleInfo.delayed = (GetCurrentTime() <= thread->nextActivateTime);
+	if(scheduleInfo.delayed)
+	{
+		m_delayedThreads.emplace(thread->nextActivateTime, scheduleInfo.linkSequence, threadId);
+	}
+	else
+	{
+		m_threadReadyQueue.emplace(scheduleInfo.priority, scheduleInfo.linkSequence, threadId);
+	}
 }
 
 void CIopBios::UnlinkThread(uint32 threadId)
@@ -1625,6 +1647,66 @@ void CIopBios::UnlinkThread(uint32 threadId)
 		}
 		nextThreadId = &currentThread->nextThreadId;
 	}
+
+	//Delayed thread heap entries are discarded when they come up
+	auto& scheduleInfo = m_threadScheduleInfos[threadId];
+	if(!scheduleInfo.linked) return;
+	if(!scheduleInfo.delayed)
+	{
+		m_threadReadyQueue.erase(std::make_tuple(scheduleInfo.priority, scheduleInfo.linkSequence, threadId));
+	}
+	scheduleInfo.linked = false;
+	scheduleInfo.delayed = false;
+}
+
+void CIopBios::RebuildThreadReadyQueue()
+{
+	m_threadScheduleInfos = decltype(m_threadScheduleInfos)();
+	m_threadReadyQueue.clear();
+	m_delayedThreads = DelayedThreadHeap();
+	m_nextThreadLinkSequence = 0;
+
+	uint32 nextThreadId = ThreadLinkHead();
+	while(nextThreadId != 0)
+	{
+		assert(nextThreadId < MAX_THREAD);
+		auto thread = m_threads[nextThreadId];
+		auto& scheduleInfo = m_threadScheduleInfos[nextThreadId];
+		scheduleInfo.linked = true;
+		scheduleInfo.priority = thread->priority;
+		scheduleInfo.linkSequence = m_nextThreadLinkSequence++;
+		scheduleInfo.delayed = (GetCurrentTime() <= thread->nextActivateTime);
+		if(scheduleInfo.delayed)
+		{
+			m_delayedThreads.emplace(thread->nextActivateTime, scheduleInfo.linkSequence, nextThreadId);
+		}
+		else
+		{
+			m_threadReadyQueue.emplace(scheduleInfo.priority, scheduleInfo.linkSequence, nextThreadId);
+		}
+		nextThreadId = thread->nextThreadId;
+	}
+}
+
+void CIopBios::PromoteDelayedThreads()
+{
+	while(!m_delayedThreads.empty())
+	{
+		const auto& delayedThread = m_delayedThreads.top();
+		if(GetCurrentTime() <= std::get<0>(delayedThread)) break;
+		uint64 linkSequence = std::get<1>(delayedThread);
+		uint32 threadId = std::get<2>(delayedThread);
+		m_delayedThreads.pop();
+
+		auto& scheduleInfo = m_threadScheduleInfos[threadId];
+		if(!scheduleInfo.linked || !scheduleInfo.delayed || (scheduleInfo.linkSequence != linkSequence))
+		{
+			//Thread was unlinked or relinked since it was delayed
+			continue;
+		}
+		scheduleInfo.delayed = false;
+		m_threadReadyQueue.emplace(scheduleInfo.priority, scheduleInfo.linkSequence, threadId);
+	}
 }
 
 void CIopBios::Reschedule()
@@ -1664,6 +1746,19 @@ void CIopBios::Reschedule()
 }
 
 uint32 CIopBios::GetNextReadyThread()
+{
+	PromoteDelayedThreads();
+	uint32 nextThreadId = m_threadReadyQueue.empty() ? -1 : std::get<2>(*m_threadReadyQueue.begin());
+#ifdef _DEBUG
+	assert(nextThreadId == FindNextReadyThreadInList());
+#endif
+	assert((nextThreadId == -1) || (m_threads[nextThreadId]->status == THREAD_STATUS_RUNNING));
+	return nextThreadId;
+}
+
+#ifdef _DEBUG
+
+uint32 CIopBios::FindNextReadyThreadInList()
 {
 	uint32 nextThreadId = ThreadLinkHead();
 	while(nextThreadId != 0)
@@ -1671,12 +1766,13 @@ uint32 CIopBios::GetNextReadyThread()
 		THREAD* nextThread = m_threads[nextThreadId];
 		nextThreadId = nextThread->nextThreadId;
 		if(GetCurrentTime() <= nextThread->nextActivateTime) continue;
-		assert(nextThread->status == THREAD_STATUS_RUNNING);
 		return nextThread->id;
 	}
 	return -1;
 }
 
+#endif
+
 uint64 CIopBios::GetCurrentTime() const
 {
 	return CurrentTime();
@@ -3,6 +3,10 @@
 #include <memory>
 #include <list>
 #include <map>
+#include <set>
+#include <tuple>
+#include <queue>
+#include <array>
 #include "../MIPSAssembler.h"
 #include "../MIPS.h"
 #include "../ELF.h"
@@ -169,8 +173,8 @@ public:
 
 	void Reset(const Iop::SifManPtr&);
 
-	void SaveState(Framework::CZipArchiveWriter&) override;
-	void LoadState(Framework::CZipArchiveReader&) override;
+	void SaveState(CStateArchiveWriter&) override;
+	void LoadState(CStateArchiveReader&) override;
 
 	bool IsIdle() override;
 
@@ -550,6 +554,11 @@ private:
 
 	void LinkThread(uint32);
 	void UnlinkThread(uint32);
+	void RebuildThreadReadyQueue();
+	void PromoteDelayedThreads();
+#ifdef _DEBUG
+	uint32 FindNextReadyThreadInList();
+#endif
 
 	uint32& ThreadLinkHead() const;
 	uint64& CurrentTime() const;
@@ -599,6 +608,28 @@ private:
 
 	uint32 m_moduleStarterThreadId;
 
+	//Host side index of the thread link list kept in IOP memory (the list itself is
+	//still maintained as it is part of save states). Ready threads are sorted by
+	//priority and link order, delayed threads wait in a heap until they can run.
+	struct THREAD_SCHEDULE_INFO
+	{
+		bool linked = false;
+		bool delayed = false;
+		uint32 priority = 0;
+		uint64 linkSequence = 0;
+	};
+
+	//Priority, link sequence, thread id
+	typedef std::set<std::tuple<uint32, uint64, uint32>> ThreadReadyQueue;
+	//Activate time, link sequence, thread id
+	typedef std::tuple<uint64, uint64, uint32> DelayedThread;
+	typedef std::priority_queue<DelayedThread, std::vector<DelayedThread>, std::greater<DelayedThread>> DelayedThreadHeap;
+
+	std::array<THREAD_SCHEDULE_INFO, MAX_THREAD> m_threadScheduleInfos;
+	ThreadReadyQueue m_threadReadyQueue;
+	DelayedThreadHeap m_delayedThreads;
+	uint64 m_nextThreadLinkSequence = 0;
+
 	bool m_rescheduleNeeded = false;
 	LoadedModuleList m_loadedModules;
 	ThreadList m_threads;
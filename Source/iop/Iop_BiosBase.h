@@ -3,8 +3,7 @@
 #include <memory>
 #include "Types.h"
 #include "../BiosDebugInfoProvider.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 #ifdef DEBUGGER_INCLUDED
 #include "xml/Node.h"
 #endif
@@ -24,8 +23,8 @@ namespace Iop
 
 		virtual bool IsIdle() = 0;
 
-		virtual void SaveState(Framework::CZipArchiveWriter&) = 0;
-		virtual void LoadState(Framework::CZipArchiveReader&) = 0;
+		virtual void SaveState(CStateArchiveWriter&) = 0;
+		virtual void LoadState(CStateArchiveReader&) = 0;
 
 #ifdef DEBUGGER_INCLUDED
 		virtual void SaveDebugTags(Framework::Xml::CNode*) = 0;
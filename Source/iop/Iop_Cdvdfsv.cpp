@@ -70,6 +70,8 @@ void CCdvdfsv::ProcessCommands(CSifMan* sifMan)
 			eeRam = sifManPs2->GetEeRam();
 		}
 
+		//Commands complete on the first ProcessCommands after they were issued, whatever the
+		//state of the host cache. Prefetching only makes the ReadBlock calls below faster.
 		if(m_pendingCommand == COMMAND_READ)
 		{
 			if(m_opticalMedia != nullptr)
@@ -114,12 +116,19 @@ void CCdvdfsv::ProcessCommands(CSifMan* sifMan)
 	}
 }
 
+void CCdvdfsv::PrefetchPendingRead()
+{
+	if(m_opticalMedia == nullptr) return;
+	uint32 sector = (m_pendingCommand == COMMAND_STREAM_READ) ? m_streamPos : m_pendingReadSector;
+	m_opticalMedia->GetFileSystem()->PrefetchBlocks(sector, m_pendingReadCount);
+}
+
 void CCdvdfsv::SetOpticalMedia(COpticalMedia* opticalMedia)
 {
 	m_opticalMedia = opticalMedia;
 }
 
-void CCdvdfsv::LoadState(Framework::CZipArchiveReader& archive)
+void CCdvdfsv::LoadState(CStateArchiveReader& archive)
 {
 	auto registerFile = CRegisterStateFile(*archive.BeginReadFile(STATE_FILENAME));
 
@@ -133,7 +142,7 @@ void CCdvdfsv::LoadState(Framework::CZipArchiveReader& archive)
 	m_streamBufferSize = registerFile.GetRegister32(STATE_STREAMBUFFERSIZE);
 }
 
-void CCdvdfsv::SaveState(Framework::CZipArchiveWriter& archive)
+void CCdvdfsv::SaveState(CStateArchiveWriter& archive)
 {
 	auto registerFile = new CRegisterStateFile(STATE_FILENAME);
 
@@ -378,6 +387,7 @@ void CCdvdfsv::Read(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 	m_pendingReadSector = sector;
 	m_pendingReadCount = count;
 	m_pendingReadAddr = dstAddr & 0x1FFFFFFF;
+	PrefetchPendingRead();
 }
 
 void CCdvdfsv::ReadIopMem(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize, uint8* ram)
@@ -400,6 +410,7 @@ void CCdvdfsv::ReadIopMem(uint32* args, uint32 argsSize, uint32* ret, uint32 ret
 	m_pendingReadSector = sector;
 	m_pendingReadCount = count;
 	m_pendingReadAddr = dstAddr & 0x1FFFFFFF;
+	PrefetchPendingRead();
 }
 
 bool CCdvdfsv::StreamCmd(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize, uint8* ram)
@@ -432,6 +443,7 @@ bool CCdvdfsv::StreamCmd(uint32* args, uint32 argsSize, uint32* ret, uint32 retS
 		m_pendingReadSector = 0;
 		m_pendingReadCount = count;
 		m_pendingReadAddr = dstAddr & (PS2::EE_RAM_SIZE - 1);
+		PrefetchPendingRead();
 		ret[0] = count;
 		immediateReply = false;
 		CLog::GetInstance().Print(LOG_NAME, "StreamRead(count = 0x%08X, dest = 0x%08X);\r\n",
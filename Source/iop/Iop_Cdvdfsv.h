@@ -4,8 +4,7 @@
 #include "Iop_SifMan.h"
 #include "../SifModuleAdapter.h"
 #include "../OpticalMedia.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 namespace Iop
 {
@@ -24,8 +23,8 @@ namespace Iop
 		void ProcessCommands(CSifMan*);
 		void SetOpticalMedia(COpticalMedia*);
 
-		void LoadState(Framework::CZipArchiveReader&);
-		void SaveState(Framework::CZipArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
 
 		enum MODULE_ID
 		{
@@ -48,7 +47,6 @@ namespace Iop
 			COMMAND_STREAM_READ,
 			COMMAND_NDISKREADY,
 		};
-
 		bool Invoke592(uint32, uint32*, uint32, uint32*, uint32, uint8*);
 		bool Invoke593(uint32, uint32*, uint32, uint32*, uint32, uint8*);
 		bool Invoke595(uint32, uint32*, uint32, uint32*, uint32, uint8*);
@@ -64,6 +62,8 @@ namespace Iop
 		bool NDiskReady(uint32*, uint32, uint32*, uint32, uint8*);
 		void SearchFile(uint32*, uint32, uint32*, uint32, uint8*);
 
+		void PrefetchPendingRead();
+
 		CCdvdman& m_cdvdman;
 		uint8* m_iopRam = nullptr;
 		COpticalMedia* m_opticalMedia = nullptr;
@@ -10,6 +10,9 @@
 #define STATE_CALLBACK_ADDRESS ("CallbackAddress")
 #define STATE_STATUS ("Status")
 #define STATE_PENDING_COMMAND ("PendingCommand")
+#define STATE_PENDING_READ_SECTOR ("PendingReadSector")
+#define STATE_PENDING_READ_COUNT ("PendingReadCount")
+#define STATE_PENDING_READ_ADDR ("PendingReadAddr")
 
 #define FUNCTION_CDINIT "CdInit"
 #define FUNCTION_CDREAD "CdRead"
@@ -41,20 +44,26 @@ CCdvdman::CCdvdman(CIopBios& bios, uint8* ram)
 {
 }
 
-void CCdvdman::LoadState(Framework::CZipArchiveReader& archive)
+void CCdvdman::LoadState(CStateArchiveReader& archive)
 {
 	CRegisterStateFile registerFile(*archive.BeginReadFile(STATE_FILENAME));
 	m_callbackPtr = registerFile.GetRegister32(STATE_CALLBACK_ADDRESS);
 	m_status = registerFile.GetRegister32(STATE_STATUS);
 	m_pendingCommand = static_cast<COMMAND>(registerFile.GetRegister32(STATE_PENDING_COMMAND));
+	m_pendingReadSector = registerFile.GetRegister32(STATE_PENDING_READ_SECTOR);
+	m_pendingReadCount = registerFile.GetRegister32(STATE_PENDING_READ_COUNT);
+	m_pendingReadAddr = registerFile.GetRegister32(STATE_PENDING_READ_ADDR);
 }
 
-void CCdvdman::SaveState(Framework::CZipArchiveWriter& archive)
+void CCdvdman::SaveState(CStateArchiveWriter& archive)
 {
 	auto registerFile = new CRegisterStateFile(STATE_FILENAME);
 	registerFile->SetRegister32(STATE_CALLBACK_ADDRESS, m_callbackPtr);
 	registerFile->SetRegister32(STATE_STATUS, m_status);
 	registerFile->SetRegister32(STATE_PENDING_COMMAND, m_pendingCommand);
+	registerFile->SetRegister32(STATE_PENDING_READ_SECTOR, m_pendingReadSector);
+	registerFile->SetRegister32(STATE_PENDING_READ_COUNT, m_pendingReadCount);
+	registerFile->SetRegister32(STATE_PENDING_READ_ADDR, m_pendingReadAddr);
 	archive.InsertFile(registerFile);
 }
 
@@ -281,6 +290,7 @@ void CCdvdman::ProcessCommands()
 		switch(m_pendingCommand)
 		{
 		case COMMAND_READ:
+			CompletePendingRead();
 			if(m_callbackPtr != 0)
 			{
 				m_bios.TriggerCallback(m_callbackPtr, CDVD_FUNCTION_READ);
@@ -300,6 +310,23 @@ void CCdvdman::ProcessCommands()
 	}
 }
 
+void CCdvdman::CompletePendingRead()
+{
+	//Reads complete on the first ProcessCommands or CdSync after they were issued, whatever
+	//the state of the host cache. Prefetching only makes these ReadBlock calls faster.
+	if(m_opticalMedia && (m_pendingReadAddr != 0))
+	{
+		auto fileSystem = m_opticalMedia->GetFileSystem();
+		uint8* buffer = &m_ram[m_pendingReadAddr];
+		static const uint32 sectorSize = 2048;
+		for(unsigned int i = 0; i < m_pendingReadCount; i++)
+		{
+			fileSystem->ReadBlock(m_pendingReadSector + i, buffer);
+			buffer += sectorSize;
+		}
+	}
+}
+
 void CCdvdman::SetOpticalMedia(COpticalMedia* opticalMedia)
 {
 	m_opticalMedia = opticalMedia;
@@ -331,16 +358,13 @@ uint32 CCdvdman::CdRead(uint32 startSector, uint32 sectorCount, uint32 bufferPtr
 		//Does that make sure it's 2048 byte mode?
 		assert(mode[2] == 0);
 	}
+	//Data is transferred when the command completes in ProcessCommands or CdSync
+	m_pendingReadSector = startSector;
+	m_pendingReadCount = sectorCount;
+	m_pendingReadAddr = bufferPtr;
 	if(m_opticalMedia && (bufferPtr != 0))
 	{
-		uint8* buffer = &m_ram[bufferPtr];
-		static const uint32 sectorSize = 2048;
-		auto fileSystem = m_opticalMedia->GetFileSystem();
-		for(unsigned int i = 0; i < sectorCount; i++)
-		{
-			fileSystem->ReadBlock(startSector + i, buffer);
-			buffer += sectorSize;
-		}
+		m_opticalMedia->GetFileSystem()->PrefetchBlocks(startSector, sectorCount);
 	}
 	m_pendingCommand = COMMAND_READ;
 	m_status = CDVD_STATUS_READING;
@@ -2,8 +2,7 @@
 
 #include "Iop_Module.h"
 #include "../OpticalMedia.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 class CIopBios;
 
@@ -37,8 +36,8 @@ namespace Iop
 		void ProcessCommands();
 		void SetOpticalMedia(COpticalMedia*);
 
-		void LoadState(Framework::CZipArchiveReader&);
-		void SaveState(Framework::CZipArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
 
 		uint32 CdReadClockDirect(uint8*);
 		uint32 CdGetDiskTypeDirect(COpticalMedia*);
@@ -79,6 +78,8 @@ namespace Iop
 		uint32 CdReadDvdDualInfo(uint32, uint32);
 		uint32 CdLayerSearchFile(uint32, uint32, uint32);
 
+		void CompletePendingRead();
+
 		CIopBios& m_bios;
 		COpticalMedia* m_opticalMedia = nullptr;
 		uint8* m_ram = nullptr;
@@ -88,6 +89,9 @@ namespace Iop
 		uint32 m_streamPos = 0;
 		uint32 m_streamBufferSize = 0;
 		COMMAND m_pendingCommand = COMMAND_NONE;
+		uint32 m_pendingReadSector = 0;
+		uint32 m_pendingReadCount = 0;
+		uint32 m_pendingReadAddr = 0;
 	};
 
 	typedef std::shared_ptr<CCdvdman> CdvdmanPtr;
@@ -150,7 +150,7 @@ uint32 CDmac::WriteRegister(uint32 address, uint32 value)
 	return 0;
 }
 
-void CDmac::LoadState(Framework::CZipArchiveReader& archive)
+void CDmac::LoadState(CStateArchiveReader& archive)
 {
 	{
 		auto registerFile = CRegisterStateFile(*archive.BeginReadFile(STATE_REGS_XML));
@@ -166,7 +166,7 @@ void CDmac::LoadState(Framework::CZipArchiveReader& archive)
 	}
 }
 
-void CDmac::SaveState(Framework::CZipArchiveWriter& archive)
+void CDmac::SaveState(CStateArchiveWriter& archive)
 {
 	{
 		auto registerFile = new CRegisterStateFile(STATE_REGS_XML);
@@ -1,8 +1,7 @@
 #pragma once
 
 #include "Types.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 #include "Iop_DmacChannel.h"
 
 namespace Iop
@@ -45,8 +44,8 @@ namespace Iop
 		uint32 ReadRegister(uint32);
 		uint32 WriteRegister(uint32, uint32);
 
-		void LoadState(Framework::CZipArchiveReader&);
-		void SaveState(Framework::CZipArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
 
 		void ResumeDma(unsigned int);
 
@@ -27,7 +27,7 @@ void CChannel::Reset()
 	m_MADR = 0;
 }
 
-void CChannel::LoadState(Framework::CZipArchiveReader& archive)
+void CChannel::LoadState(CStateArchiveReader& archive)
 {
 	auto path = string_format(STATE_REGS_XML_FORMAT, m_number);
 	auto registerFile = CRegisterStateFile(*archive.BeginReadFile(path.c_str()));
@@ -36,7 +36,7 @@ void CChannel::LoadState(Framework::CZipArchiveReader& archive)
 	m_MADR = registerFile.GetRegister32(STATE_REGS_MADR);
 }
 
-void CChannel::SaveState(Framework::CZipArchiveWriter& archive)
+void CChannel::SaveState(CStateArchiveWriter& archive)
 {
 	auto path = string_format(STATE_REGS_XML_FORMAT, m_number);
 	auto registerFile = new CRegisterStateFile(path.c_str());
@@ -2,8 +2,7 @@
 
 #include "Convertible.h"
 #include "Types.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 #include <functional>
 
 namespace Iop
@@ -46,8 +45,8 @@ namespace Iop
 			CChannel(uint32, unsigned int, CDmac&);
 			virtual ~CChannel() = default;
 
-			void SaveState(Framework::CZipArchiveWriter&);
-			void LoadState(Framework::CZipArchiveReader&);
+			void SaveState(CStateArchiveWriter&);
+			void LoadState(CStateArchiveReader&);
 
 			void Reset();
 			void SetReceiveFunction(const ReceiveFunctionType&);
@@ -64,7 +64,7 @@ bool CFileIo::Invoke(uint32 method, uint32* args, uint32 argsSize, uint32* ret,
 	return m_handler->Invoke(method, args, argsSize, ret, retSize, ram);
 }
 
-void CFileIo::LoadState(Framework::CZipArchiveReader& archive)
+void CFileIo::LoadState(CStateArchiveReader& archive)
 {
 	auto registerFile = CRegisterStateFile(*archive.BeginReadFile(STATE_VERSION_XML));
 	m_moduleVersion = registerFile.GetRegister32(STATE_VERSION_MODULEVERSION);
@@ -72,7 +72,7 @@ void CFileIo::LoadState(Framework::CZipArchiveReader& archive)
 	m_handler->LoadState(archive);
 }
 
-void CFileIo::SaveState(Framework::CZipArchiveWriter& archive) const
+void CFileIo::SaveState(CStateArchiveWriter& archive) const
 {
 	auto registerFile = new CRegisterStateFile(STATE_VERSION_XML);
 	registerFile->SetRegister32(STATE_VERSION_MODULEVERSION, m_moduleVersion);
@@ -2,8 +2,7 @@
 
 #include "Iop_SifMan.h"
 #include "Iop_Module.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 class CIopBios;
 
@@ -23,8 +22,8 @@ namespace Iop
 			virtual void Invoke(CMIPS&, unsigned int);
 			virtual bool Invoke(uint32, uint32*, uint32, uint32*, uint32, uint8*) = 0;
 
-			virtual void LoadState(Framework::CZipArchiveReader&){};
-			virtual void SaveState(Framework::CZipArchiveWriter&) const {};
+			virtual void LoadState(CStateArchiveReader&){};
+			virtual void SaveState(CStateArchiveWriter&) const {};
 
 			virtual void ProcessCommands(CSifMan*){};
 
@@ -46,8 +45,8 @@ namespace Iop
 		void Invoke(CMIPS&, unsigned int) override;
 		bool Invoke(uint32, uint32*, uint32, uint32*, uint32, uint8*) override;
 
-		void LoadState(Framework::CZipArchiveReader&);
-		void SaveState(Framework::CZipArchiveWriter&) const;
+		void LoadState(CStateArchiveReader&);
+		void SaveState(CStateArchiveWriter&) const;
 
 		void ProcessCommands(Iop::CSifMan*);
 
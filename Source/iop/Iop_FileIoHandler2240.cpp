@@ -86,7 +86,7 @@ bool CFileIoHandler2240::Invoke(uint32 method, uint32* args, uint32 argsSize, ui
 	return true;
 }
 
-void CFileIoHandler2240::LoadState(Framework::CZipArchiveReader& archive)
+void CFileIoHandler2240::LoadState(CStateArchiveReader& archive)
 {
 	{
 		auto registerFile = CRegisterStateFile(*archive.BeginReadFile(STATE_XML));
@@ -97,7 +97,7 @@ void CFileIoHandler2240::LoadState(Framework::CZipArchiveReader& archive)
 	archive.BeginReadFile(STATE_PENDINGREPLY)->Read(&m_pendingReply, sizeof(m_pendingReply));
 }
 
-void CFileIoHandler2240::SaveState(Framework::CZipArchiveWriter& archive) const
+void CFileIoHandler2240::SaveState(CStateArchiveWriter& archive) const
 {
 	{
 		auto registerFile = new CRegisterStateFile(STATE_XML);
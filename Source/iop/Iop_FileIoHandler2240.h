@@ -14,8 +14,8 @@ namespace Iop
 
 		bool Invoke(uint32, uint32*, uint32, uint32*, uint32, uint8*) override;
 
-		void LoadState(Framework::CZipArchiveReader&) override;
-		void SaveState(Framework::CZipArchiveWriter&) const override;
+		void LoadState(CStateArchiveReader&) override;
+		void SaveState(CStateArchiveWriter&) const override;
 
 		void ProcessCommands(CSifMan*) override;
 
@@ -23,14 +23,14 @@ void CIntc::Reset()
 	m_mask.f = 0;
 }
 
-void CIntc::LoadState(Framework::CZipArchiveReader& archive)
+void CIntc::LoadState(CStateArchiveReader& archive)
 {
 	CRegisterStateFile registerFile(*archive.BeginReadFile(STATE_REGS_XML));
 	m_status.f = registerFile.GetRegister64(STATE_REGS_STATUS);
 	m_mask.f = registerFile.GetRegister64(STATE_REGS_MASK);
 }
 
-void CIntc::SaveState(Framework::CZipArchiveWriter& archive)
+void CIntc::SaveState(CStateArchiveWriter& archive)
 {
 	CRegisterStateFile* registerFile = new CRegisterStateFile(STATE_REGS_XML);
 	registerFile->SetRegister64(STATE_REGS_STATUS, m_status.f);
@@ -3,8 +3,7 @@
 
 #include "Types.h"
 #include "BasicUnion.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 namespace Iop
 {
@@ -58,8 +57,8 @@ namespace Iop
 
 		void Reset();
 
-		void LoadState(Framework::CZipArchiveReader&);
-		void SaveState(Framework::CZipArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
 
 		uint32 ReadRegister(uint32);
 		uint32 WriteRegister(uint32, uint32);
@@ -736,19 +736,19 @@ void CIoman::Invoke(CMIPS& context, unsigned int functionId)
 	}
 }
 
-void CIoman::SaveState(Framework::CZipArchiveWriter& archive)
+void CIoman::SaveState(CStateArchiveWriter& archive)
 {
 	SaveFilesState(archive);
 	SaveUserDevicesState(archive);
 }
 
-void CIoman::LoadState(Framework::CZipArchiveReader& archive)
+void CIoman::LoadState(CStateArchiveReader& archive)
 {
 	LoadFilesState(archive);
 	LoadUserDevicesState(archive);
 }
 
-void CIoman::SaveFilesState(Framework::CZipArchiveWriter& archive)
+void CIoman::SaveFilesState(CStateArchiveWriter& archive)
 {
 	auto fileStateFile = new CXmlStateFile(STATE_FILES_FILENAME, STATE_FILES_FILESNODE);
 	auto filesStateNode = fileStateFile->GetRoot();
@@ -771,7 +771,7 @@ void CIoman::SaveFilesState(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(fileStateFile);
 }
 
-void CIoman::SaveUserDevicesState(Framework::CZipArchiveWriter& archive)
+void CIoman::SaveUserDevicesState(CStateArchiveWriter& archive)
 {
 	auto deviceStateFile = new CXmlStateFile(STATE_USERDEVICES_FILENAME, STATE_USERDEVICES_DEVICESNODE);
 	auto devicesStateNode = deviceStateFile->GetRoot();
@@ -787,7 +787,7 @@ void CIoman::SaveUserDevicesState(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(deviceStateFile);
 }
 
-void CIoman::LoadFilesState(Framework::CZipArchiveReader& archive)
+void CIoman::LoadFilesState(CStateArchiveReader& archive)
 {
 	std::experimental::erase_if(m_files,
 	                            [](const FileMapType::value_type& filePair) {
@@ -820,7 +820,7 @@ void CIoman::LoadFilesState(Framework::CZipArchiveReader& archive)
 	m_nextFileHandle = maxFileId + 1;
 }
 
-void CIoman::LoadUserDevicesState(Framework::CZipArchiveReader& archive)
+void CIoman::LoadUserDevicesState(CStateArchiveReader& archive)
 {
 	m_userDevices.clear();
 
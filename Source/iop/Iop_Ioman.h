@@ -6,8 +6,7 @@
 #include "Ioman_Defs.h"
 #include "Ioman_Device.h"
 #include "Stream.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 class CIopBios;
 
@@ -38,8 +37,8 @@ namespace Iop
 		std::string GetFunctionName(unsigned int) const override;
 		void Invoke(CMIPS&, unsigned int) override;
 
-		void SaveState(Framework::CZipArchiveWriter&);
-		void LoadState(Framework::CZipArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
 
 		void RegisterDevice(const char*, const DevicePtr&);
 
@@ -136,11 +135,11 @@ namespace Iop
 		bool IsUserDeviceFileHandle(int32) const;
 		uint32 GetUserDeviceFileDescPtr(int32) const;
 
-		void SaveFilesState(Framework::CZipArchiveWriter&);
-		void SaveUserDevicesState(Framework::CZipArchiveWriter&);
+		void SaveFilesState(CStateArchiveWriter&);
+		void SaveUserDevicesState(CStateArchiveWriter&);
 
-		void LoadFilesState(Framework::CZipArchiveReader&);
-		void LoadUserDevicesState(Framework::CZipArchiveReader&);
+		void LoadFilesState(CStateArchiveReader&);
+		void LoadUserDevicesState(CStateArchiveReader&);
 
 		FileMapType m_files;
 		DirectoryMapType m_directories;
@@ -127,13 +127,13 @@ bool CLoadcore::Invoke(uint32 method, uint32* args, uint32 argsSize, uint32* ret
 	return true;
 }
 
-void CLoadcore::LoadState(Framework::CZipArchiveReader& archive)
+void CLoadcore::LoadState(CStateArchiveReader& archive)
 {
 	auto registerFile = CRegisterStateFile(*archive.BeginReadFile(STATE_VERSION_XML));
 	m_moduleVersion = registerFile.GetRegister32(STATE_VERSION_MODULEVERSION);
 }
 
-void CLoadcore::SaveState(Framework::CZipArchiveWriter& archive)
+void CLoadcore::SaveState(CStateArchiveWriter& archive)
 {
 	auto registerFile = new CRegisterStateFile(STATE_VERSION_XML);
 	registerFile->SetRegister32(STATE_VERSION_MODULEVERSION, m_moduleVersion);
@@ -2,8 +2,7 @@
 
 #include "Iop_Module.h"
 #include "Iop_SifMan.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 #include <functional>
 
 class CIopBios;
@@ -30,8 +29,8 @@ namespace Iop
 		void Invoke(CMIPS&, unsigned int) override;
 		bool Invoke(uint32, uint32*, uint32, uint32*, uint32, uint8*) override;
 
-		void LoadState(Framework::CZipArchiveReader&);
-		void SaveState(Framework::CZipArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
 
 		void SetLoadExecutableHandler(const LoadExecutableHandler&);
 
@@ -75,7 +75,7 @@ bool CPadMan::Invoke(uint32 method, uint32* args, uint32 argsSize, uint32* ret,
 	return true;
 }
 
-void CPadMan::SaveState(Framework::CZipArchiveWriter& archive)
+void CPadMan::SaveState(CStateArchiveWriter& archive)
 {
 	CRegisterStateFile* registerFile = new CRegisterStateFile(STATE_PADDATA);
 
@@ -85,7 +85,7 @@ void CPadMan::SaveState(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(registerFile);
 }
 
-void CPadMan::LoadState(Framework::CZipArchiveReader& archive)
+void CPadMan::LoadState(CStateArchiveReader& archive)
 {
 	CRegisterStateFile registerFile(*archive.BeginReadFile(STATE_PADDATA));
 	m_nPadDataAddress = registerFile.GetRegister32(STATE_PADDATA_ADDRESS);
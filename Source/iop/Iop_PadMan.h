@@ -5,8 +5,7 @@
 #include "Iop_SifModuleProvider.h"
 #include "../PadListener.h"
 #include <functional>
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 //#define USE_EX
 
@@ -24,8 +23,8 @@ namespace Iop
 
 		void Invoke(CMIPS&, unsigned int) override;
 		bool Invoke(uint32, uint32*, uint32, uint32*, uint32, uint8*) override;
-		void SaveState(Framework::CZipArchiveWriter&);
-		void LoadState(Framework::CZipArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
 		void SetButtonState(unsigned int, PS2::CControllerInfo::BUTTON, bool, uint8*) override;
 		void SetAxisState(unsigned int, PS2::CControllerInfo::BUTTON, uint8, uint8*) override;
 
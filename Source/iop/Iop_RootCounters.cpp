@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <cstring>
+#include <algorithm>
 #include "Iop_RootCounters.h"
 #include "Iop_Intc.h"
 #include "string_format.h"
@@ -77,9 +78,11 @@ unsigned int CRootCounters::GetCounterIdByAddress(uint32 address)
 void CRootCounters::Reset()
 {
 	memset(&m_counter, 0, sizeof(m_counter));
+	m_pendingTicks = 0;
+	ComputeNextEventTicks();
 }
 
-void CRootCounters::LoadState(Framework::CZipArchiveReader& archive)
+void CRootCounters::LoadState(CStateArchiveReader& archive)
 {
 	CRegisterStateFile registerFile(*archive.BeginReadFile(STATE_REGS_XML));
 	for(unsigned int i = 0; i < MAX_COUNTERS; i++)
@@ -91,10 +94,13 @@ void CRootCounters::LoadState(Framework::CZipArchiveReader& archive)
 		counter.target = registerFile.GetRegister32((counterPrefix + "TGT").c_str());
 		counter.clockRemain = registerFile.GetRegister32((counterPrefix + "REM").c_str());
 	}
+	m_pendingTicks = 0;
+	ComputeNextEventTicks();
 }
 
-void CRootCounters::SaveState(Framework::CZipArchiveWriter& archive)
+void CRootCounters::SaveState(CStateArchiveWriter& archive)
 {
+	Sync();
 	CRegisterStateFile* registerFile = new CRegisterStateFile(STATE_REGS_XML);
 	for(unsigned int i = 0; i < MAX_COUNTERS; i++)
 	{
@@ -109,56 +115,102 @@ void CRootCounters::SaveState(Framework::CZipArchiveWriter& archive)
 }
 
 void CRootCounters::Update(unsigned int ticks)
+{
+	m_pendingTicks += ticks;
+	if(m_pendingTicks < m_nextEventTicks) return;
+	UpdateCounters(m_pendingTicks);
+	m_pendingTicks = 0;
+	ComputeNextEventTicks();
+}
+
+unsigned int CRootCounters::GetCounterClockRatio(unsigned int i) const
+{
+	const COUNTER& counter = m_counter[i];
+	unsigned int clockRatio = 1;
+	if(i == 0 && counter.mode.clc)
+	{
+		clockRatio = m_pixelClocks;
+	}
+	if(i == 1 && counter.mode.clc)
+	{
+		clockRatio = m_hsyncClocks;
+	}
+	if(i == 2 && (counter.mode.div != COUNTER_SCALE_1))
+	{
+		assert(counter.mode.div == COUNTER_SCALE_8);
+		clockRatio = 8;
+	}
+	if(
+	    ((i == 4) || (i == 5)) &&
+	    (counter.mode.div != COUNTER_SCALE_1))
+	{
+		switch(counter.mode.div)
+		{
+		case COUNTER_SCALE_8:
+			clockRatio = 8;
+			break;
+		case COUNTER_SCALE_16:
+			clockRatio = 16;
+			break;
+		case COUNTER_SCALE_256:
+			clockRatio = 256;
+			break;
+		}
+	}
+	return clockRatio;
+}
+
+uint32 CRootCounters::GetCounterMax(unsigned int i) const
+{
+	const COUNTER& counter = m_counter[i];
+	if(g_counterSizes[i] == 16)
+	{
+		return counter.mode.tar ? static_cast<uint16>(counter.target) : 0xFFFF;
+	}
+	else
+	{
+		return counter.mode.tar ? counter.target : 0xFFFFFFFF;
+	}
+}
+
+void CRootCounters::Sync()
+{
+	//Nothing changed since the last update
+	if(m_pendingTicks == 0) return;
+	UpdateCounters(m_pendingTicks);
+	m_pendingTicks = 0;
+	ComputeNextEventTicks();
+}
+
+void CRootCounters::ComputeNextEventTicks()
+{
+	m_nextEventTicks = ~0ULL;
+	for(unsigned int i = 0; i < MAX_COUNTERS; i++)
+	{
+		const COUNTER& counter = m_counter[i];
+		if(i == 2 && counter.mode.en) continue;
+		//Counts left before the counter reaches its maximum value and wraps around
+		uint32 counterMax = GetCounterMax(i);
+		uint32 eventCounts = (counter.count < counterMax) ? (counterMax - counter.count) : 0;
+		uint64 eventTicks = static_cast<uint64>(eventCounts) * GetCounterClockRatio(i);
+		eventTicks = (eventTicks > counter.clockRemain) ? (eventTicks - counter.clockRemain) : 0;
+		m_nextEventTicks = std::min(m_nextEventTicks, eventTicks);
+	}
+}
+
+void CRootCounters::UpdateCounters(uint64 ticks)
 {
 	for(unsigned int i = 0; i < MAX_COUNTERS; i++)
 	{
 		COUNTER& counter = m_counter[i];
 		if(i == 2 && counter.mode.en) continue;
 		//Compute count increment
-		unsigned int clockRatio = 1;
-		if(i == 0 && counter.mode.clc)
-		{
-			clockRatio = m_pixelClocks;
-		}
-		if(i == 1 && counter.mode.clc)
-		{
-			clockRatio = m_hsyncClocks;
-		}
-		if(i == 2 && (counter.mode.div != COUNTER_SCALE_1))
-		{
-			assert(counter.mode.div == COUNTER_SCALE_8);
-			clockRatio = 8;
-		}
-		if(
-		    ((i == 4) || (i == 5)) &&
-		    (counter.mode.div != COUNTER_SCALE_1))
-		{
-			switch(counter.mode.div)
-			{
-			case COUNTER_SCALE_8:
-				clockRatio = 8;
-				break;
-			case COUNTER_SCALE_16:
-				clockRatio = 16;
-				break;
-			case COUNTER_SCALE_256:
-				clockRatio = 256;
-				break;
-			}
-		}
-		unsigned int totalTicks = counter.clockRemain + ticks;
-		unsigned int countAdd = totalTicks / clockRatio;
-		counter.clockRemain = totalTicks % clockRatio;
+		unsigned int clockRatio = GetCounterClockRatio(i);
+		uint64 totalTicks = counter.clockRemain + ticks;
+		uint32 countAdd = static_cast<uint32>(totalTicks / clockRatio);
+		counter.clockRemain = static_cast<unsigned int>(totalTicks % clockRatio);
 		//Update count
-		uint32 counterMax = 0;
-		if(g_counterSizes[i] == 16)
-		{
-			counterMax = counter.mode.tar ? static_cast<uint16>(counter.target) : 0xFFFF;
-		}
-		else
-		{
-			counterMax = counter.mode.tar ? counter.target : 0xFFFFFFFF;
-		}
+		uint32 counterMax = GetCounterMax(i);
 		uint32 counterTemp = counter.count + countAdd;
 		if(counterTemp >= counterMax)
 		{
@@ -184,6 +236,7 @@ uint32 CRootCounters::ReadRegister(uint32 address)
 #ifdef _DEBUG
 	DisassembleRead(address);
 #endif
+	Sync();
 	unsigned int counterId = GetCounterIdByAddress(address);
 	unsigned int registerId = address & 0x0F;
 	assert(counterId < MAX_COUNTERS);
@@ -207,6 +260,7 @@ uint32 CRootCounters::WriteRegister(uint32 address, uint32 value)
 #ifdef _DEBUG
 	DisassembleWrite(address, value);
 #endif
+	Sync();
 	unsigned int counterId = GetCounterIdByAddress(address);
 	unsigned int registerId = address & 0x0F;
 	assert(counterId < MAX_COUNTERS);
@@ -223,6 +277,7 @@ uint32 CRootCounters::WriteRegister(uint32 address, uint32 value)
 		counter.target = value;
 		break;
 	}
+	ComputeNextEventTicks();
 	return 0;
 }
 
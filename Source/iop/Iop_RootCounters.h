@@ -2,8 +2,7 @@
 
 #include "Types.h"
 #include "Convertible.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 namespace Iop
 {
@@ -32,8 +31,8 @@ namespace Iop
 
 		void Reset();
 
-		void LoadState(Framework::CZipArchiveReader&);
-		void SaveState(Framework::CZipArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
 
 		void Update(unsigned int);
 
@@ -108,9 +107,21 @@ namespace Iop
 
 		static unsigned int GetCounterIdByAddress(uint32);
 
+		unsigned int GetCounterClockRatio(unsigned int) const;
+		uint32 GetCounterMax(unsigned int) const;
+
+		void Sync();
+		void UpdateCounters(uint64);
+		void ComputeNextEventTicks();
+
 		COUNTER m_counter[MAX_COUNTERS];
 		Iop::CIntc& m_intc;
 		unsigned int m_hsyncClocks;
 		unsigned int m_pixelClocks;
+
+		//Counters are only brought up to date when their registers are accessed
+		//or when enough ticks went by for one of them to reach its maximum value
+		uint64 m_pendingTicks = 0;
+		uint64 m_nextEventTicks = 0;
 	};
 }
@@ -66,7 +66,7 @@ CSifCmd::~CSifCmd()
 	ClearServers();
 }
 
-void CSifCmd::LoadState(Framework::CZipArchiveReader& archive)
+void CSifCmd::LoadState(CStateArchiveReader& archive)
 {
 	ClearServers();
 
@@ -85,7 +85,7 @@ void CSifCmd::LoadState(Framework::CZipArchiveReader& archive)
 	}
 }
 
-void CSifCmd::SaveState(Framework::CZipArchiveWriter& archive)
+void CSifCmd::SaveState(CStateArchiveWriter& archive)
 {
 	auto modulesFile = new CStructCollectionStateFile(STATE_MODULES);
 	{
@@ -4,8 +4,7 @@
 #include "Iop_SifMan.h"
 #include "Iop_SifDynamic.h"
 #include "Iop_Sysmem.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 class CIopBios;
 
@@ -23,8 +22,8 @@ namespace Iop
 
 		void ProcessInvocation(uint32, uint32, uint32*, uint32);
 
-		void LoadState(Framework::CZipArchiveReader&);
-		void SaveState(Framework::CZipArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
 
 		void SifBindRpc(CMIPS&);
 		void SifCallRpc(CMIPS&);
@@ -69,7 +69,7 @@ void CSio2::Reset()
 	}
 }
 
-void CSio2::LoadState(Framework::CZipArchiveReader& archive)
+void CSio2::LoadState(CStateArchiveReader& archive)
 {
 	static const auto readBuffer =
 	    [](ByteBufferType& outputBuffer, Framework::CStream& inputStream) {
@@ -96,7 +96,7 @@ void CSio2::LoadState(Framework::CZipArchiveReader& archive)
 	readBuffer(m_inputBuffer, *archive.BeginReadFile(STATE_INPUT));
 }
 
-void CSio2::SaveState(Framework::CZipArchiveWriter& archive)
+void CSio2::SaveState(CStateArchiveWriter& archive)
 {
 	auto inputBuffer = std::vector<uint8>(m_inputBuffer.begin(), m_inputBuffer.end());
 	auto outputBuffer = std::vector<uint8>(m_outputBuffer.begin(), m_outputBuffer.end());
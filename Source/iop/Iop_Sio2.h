@@ -21,8 +21,8 @@ namespace Iop
 
 		void Reset();
 
-		void LoadState(Framework::CZipArchiveReader&);
-		void SaveState(Framework::CZipArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
 
 		uint32 ReadRegister(uint32);
 		void WriteRegister(uint32, uint32);
@@ -6,6 +6,8 @@
 #include "../Log.h"
 #include "../states/RegisterStateFile.h"
 #include "Iop_SpuBase.h"
+#include "Iop_SpuMixer.h"
+#include "Iop_SpuReverb.h"
 
 using namespace Iop;
 
@@ -197,7 +199,7 @@ void CSpuBase::Reset()
 	m_blockWritePtr = 0;
 }
 
-void CSpuBase::LoadState(Framework::CZipArchiveReader& archive)
+void CSpuBase::LoadState(CStateArchiveReader& archive)
 {
 	auto path = string_format(STATE_PATH_FORMAT, m_spuNumber);
 
@@ -240,7 +242,7 @@ void CSpuBase::LoadState(Framework::CZipArchiveReader& archive)
 	}
 }
 
-void CSpuBase::SaveState(Framework::CZipArchiveWriter& archive)
+void CSpuBase::SaveState(CStateArchiveWriter& archive)
 {
 	auto path = string_format(STATE_PATH_FORMAT, m_spuNumber);
 
@@ -588,6 +590,21 @@ int32 CSpuBase::ComputeChannelVolume(const CHANNEL_VOLUME& volume, int32 current
 	return volumeLevel;
 }
 
+void CSpuBase::ComputeChannelVolumes(const CHANNEL_VOLUME& volume, int32& currentVolume, int16* volumes, unsigned int count)
+{
+	//Fixed volumes don't depend on the current level, no need to compute them more than once
+	unsigned int computeCount = volume.mode.mode ? count : 1;
+	for(unsigned int i = 0; i < computeCount; i++)
+	{
+		currentVolume = ComputeChannelVolume(volume, currentVolume);
+		volumes[i] = static_cast<int16>(std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(currentVolume >> 16) * m_volumeAdjust)));
+	}
+	for(unsigned int i = computeCount; i < count; i++)
+	{
+		volumes[i] = volumes[0];
+	}
+}
+
 void CSpuBase::MixSamples(int32 inputSample, int32 volumeLevel, int16* output)
 {
 	inputSample = (inputSample * volumeLevel) / 0x7FFF;
@@ -597,231 +614,146 @@ void CSpuBase::MixSamples(int32 inputSample, int32 volumeLevel, int16* output)
 	*output = static_cast<int16>(resultSample);
 }
 
-void CSpuBase::Render(int16* samples, unsigned int sampleCount, unsigned int sampleRate)
+void CSpuBase::RenderChannel(unsigned int channelIndex, MIX_BUSES& buses, unsigned int ticks, unsigned int sampleRate, bool checkIrqs, bool updateReverb)
 {
-	bool updateReverb = m_reverbEnabled && (m_ctrl & CONTROL_REVERB) && (m_reverbWorkAddrStart < m_reverbWorkAddrEnd);
-	bool checkIrqs = (m_ctrl & CONTROL_IRQ) && (m_irqAddr != INVALID_ADDRESS);
+	auto& channel(m_channel[channelIndex]);
+	auto& reader(m_reader[channelIndex]);
+	bool mixReverb = updateReverb && (m_channelReverb.f & (1 << channelIndex));
 
-	assert((sampleCount & 0x01) == 0);
-	//ticks are 44100Hz ticks
-	unsigned int ticks = sampleCount / 2;
-	memset(samples, 0, sizeof(int16) * sampleCount);
+	int16 readSamples[RENDER_BLOCK_TICKS];
+	uint32 adsrVolumes[RENDER_BLOCK_TICKS];
+	uint16 adsrLevels[RENDER_BLOCK_TICKS];
+	uint16 adsrStatuses[RENDER_BLOCK_TICKS];
+	int16 volumesLeft[RENDER_BLOCK_TICKS];
+	int16 volumesRight[RENDER_BLOCK_TICKS];
 
-	for(unsigned int j = 0; j < ticks; j++)
+	unsigned int tick = 0;
+	while(tick < ticks)
 	{
-		int16 reverbSample[2] = {0, 0};
-		//Update channels
-		for(unsigned int i = 0; i < 24; i++)
+		if((channel.status == STOPPED) && !checkIrqs) break;
+		if(channel.status == KEY_ON)
 		{
-			auto& channel(m_channel[i]);
-			if((channel.status == STOPPED) && !checkIrqs) continue;
-			auto& reader(m_reader[i]);
-			if(channel.status == KEY_ON)
+			reader.SetParams(channel.address, channel.repeat);
+			reader.ClearEndFlag();
+			channel.status = ATTACK;
+			channel.adsrVolume = 0;
+		}
+		else
+		{
+			if(reader.IsDone())
 			{
-				reader.SetParams(channel.address, channel.repeat);
-				reader.ClearEndFlag();
-				channel.status = ATTACK;
+				channel.status = STOPPED;
 				channel.adsrVolume = 0;
+				reader.ClearIsDone();
+				//No point in continuing if we don't need to check interrupts
+				if(!checkIrqs) break;
 			}
-			else
+			if(reader.DidChangeRepeat())
 			{
-				if(reader.IsDone())
-				{
-					channel.status = STOPPED;
-					channel.adsrVolume = 0;
-					reader.ClearIsDone();
-					//No point in continuing if we don't need to check interrupts
-					if(!checkIrqs) continue;
-				}
-				if(reader.DidChangeRepeat())
-				{
-					channel.repeat = reader.GetRepeat();
-					reader.ClearDidChangeRepeat();
-				}
-				//Update repeat in case it has been changed externally (needed for FFX)
-				reader.SetRepeat(channel.repeat);
+				channel.repeat = reader.GetRepeat();
+				reader.ClearDidChangeRepeat();
 			}
+			//Update repeat in case it has been changed externally (needed for FFX)
+			reader.SetRepeat(channel.repeat);
+		}
+
+		reader.SetIrqAddress(m_irqAddr);
+		reader.SetPitch(m_baseSamplingRate, channel.pitch);
 
-			reader.SetIrqAddress(m_irqAddr);
+		//Envelope doesn't depend on samples, so run it ahead to know how many
+		//samples we can read before the channel stops
+		unsigned int blockTicks = 0;
+		while((tick + blockTicks) < ticks)
+		{
+			UpdateAdsr(channel);
+			adsrVolumes[tick + blockTicks] = channel.adsrVolume;
+			adsrLevels[tick + blockTicks] = static_cast<uint16>(channel.adsrVolume >> 16);
+			adsrStatuses[tick + blockTicks] = channel.status;
+			blockTicks++;
+			if((channel.status == STOPPED) && !checkIrqs) break;
+		}
 
-			int16 readSample = 0;
-			reader.SetPitch(m_baseSamplingRate, channel.pitch);
-			reader.GetSamples(&readSample, 1, sampleRate);
-			channel.current = reader.GetCurrent();
+		//Reader stops early when it reaches the end or changes its repeat address,
+		//rewind the envelope to that point and resume from the top of the loop
+		unsigned int readCount = reader.GetSamples(readSamples + tick, blockTicks, sampleRate);
+		assert(readCount != 0);
+		channel.adsrVolume = adsrVolumes[tick + readCount - 1];
+		channel.status = adsrStatuses[tick + readCount - 1];
+		channel.current = reader.GetCurrent();
 
-			if(checkIrqs && reader.GetIrqPending())
-			{
-				m_irqPending = true;
-			}
+		if(checkIrqs && reader.GetIrqPending())
+		{
+			m_irqPending = true;
+		}
 
-			reader.ClearIrqPending();
+		reader.ClearIrqPending();
 
-			//Mix samples
-			UpdateAdsr(channel);
-			int32 inputSample = static_cast<int32>(readSample);
-			//Mix adsrVolume
-			{
-				inputSample = (inputSample * static_cast<int32>(channel.adsrVolume >> 16)) / static_cast<int32>(MAX_ADSR_VOLUME >> 16);
-			}
+		ComputeChannelVolumes(channel.volumeLeft, channel.volumeLeftAbs, volumesLeft + tick, readCount);
+		ComputeChannelVolumes(channel.volumeRight, channel.volumeRightAbs, volumesRight + tick, readCount);
 
-			channel.volumeLeftAbs = ComputeChannelVolume(channel.volumeLeft, channel.volumeLeftAbs);
-			channel.volumeRightAbs = ComputeChannelVolume(channel.volumeRight, channel.volumeRightAbs);
+		//Mix samples, in reverb buses too if enabled for this channel
+		static_assert((MAX_ADSR_VOLUME >> 16) == 0x7FFF, "Envelope levels must be scaled like volumes.");
+		CSpuMixer::MixVoice(buses.dryLeft + tick, buses.dryRight + tick,
+		                    mixReverb ? buses.reverbLeft + tick : nullptr, mixReverb ? buses.reverbRight + tick : nullptr,
+		                    readSamples + tick, adsrLevels + tick, volumesLeft + tick, volumesRight + tick, readCount);
 
-			int32 adjustedLeftVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeLeftAbs >> 16) * m_volumeAdjust));
-			int32 adjustedRightVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeRightAbs >> 16) * m_volumeAdjust));
-			MixSamples(inputSample, adjustedLeftVolume, samples + 0);
-			MixSamples(inputSample, adjustedRightVolume, samples + 1);
-			//Mix in reverb if enabled for this channel
-			if(updateReverb && (m_channelReverb.f & (1 << i)))
-			{
-				MixSamples(inputSample, adjustedLeftVolume, reverbSample + 0);
-				MixSamples(inputSample, adjustedRightVolume, reverbSample + 1);
-			}
-		}
+		tick += readCount;
+	}
+}
 
-		if(!m_blockReader.CanReadSamples() && (m_blockWritePtr == SOUND_INPUT_DATA_SIZE))
-		{
-			//We're ready to consume some data
-			m_blockReader.FillBlock(m_ram + m_soundInputDataAddr);
-			m_blockWritePtr = 0;
-		}
+void CSpuBase::Render(int16* samples, unsigned int sampleCount, unsigned int sampleRate)
+{
+	bool updateReverb = m_reverbEnabled && (m_ctrl & CONTROL_REVERB) && (m_reverbWorkAddrStart < m_reverbWorkAddrEnd);
+	bool checkIrqs = (m_ctrl & CONTROL_IRQ) && (m_irqAddr != INVALID_ADDRESS);
 
-		if(m_blockReader.CanReadSamples())
-		{
-			int16 sampleL = 0;
-			int16 sampleR = 0;
-			m_blockReader.GetSamples(sampleL, sampleR, sampleRate);
+	assert((sampleCount & 0x01) == 0);
+	//ticks are 44100Hz ticks
+	unsigned int ticks = sampleCount / 2;
 
-			MixSamples(sampleL, 0x3FFF, samples + 0);
-			MixSamples(sampleR, 0x3FFF, samples + 1);
+	MIX_BUSES buses;
+	for(unsigned int blockStart = 0; blockStart < ticks; blockStart += RENDER_BLOCK_TICKS)
+	{
+		unsigned int blockTicks = std::min<unsigned int>(ticks - blockStart, RENDER_BLOCK_TICKS);
+
+		//Channels are rendered one block at a time in channel order, so clamping after
+		//each channel gives the same results as mixing all channels tick by tick
+		memset(&buses, 0, sizeof(MIX_BUSES));
+		for(unsigned int i = 0; i < MAX_CHANNEL; i++)
+		{
+			RenderChannel(i, buses, blockTicks, sampleRate, checkIrqs, updateReverb);
 		}
 
-		//Update reverb
-		if(updateReverb)
+		int16* blockSamples = samples;
+		for(unsigned int j = 0; j < blockTicks; j++)
 		{
-			//Feed samples to FIR filter
-			if(m_reverbTicks & 1)
+			samples[0] = buses.dryLeft[j];
+			samples[1] = buses.dryRight[j];
+
+			if(!m_blockReader.CanReadSamples() && (m_blockWritePtr == SOUND_INPUT_DATA_SIZE))
 			{
-				//IIR_INPUT_A0 = buffer[IIR_SRC_A0] * IIR_COEF + INPUT_SAMPLE_L * IN_COEF_L;
-				//IIR_INPUT_A1 = buffer[IIR_SRC_A1] * IIR_COEF + INPUT_SAMPLE_R * IN_COEF_R;
-				//IIR_INPUT_B0 = buffer[IIR_SRC_B0] * IIR_COEF + INPUT_SAMPLE_L * IN_COEF_L;
-				//IIR_INPUT_B1 = buffer[IIR_SRC_B1] * IIR_COEF + INPUT_SAMPLE_R * IN_COEF_R;
-
-				float input_sample_l = static_cast<float>(reverbSample[0]) * 0.5f;
-				float input_sample_r = static_cast<float>(reverbSample[1]) * 0.5f;
-
-				float irr_coef = GetReverbCoef(IIR_COEF);
-				float in_coef_l = GetReverbCoef(IN_COEF_L);
-				float in_coef_r = GetReverbCoef(IN_COEF_R);
-
-				float iir_input_a0 = GetReverbSample(GetReverbOffset(ACC_SRC_A0)) * irr_coef + input_sample_l * in_coef_l;
-				float iir_input_a1 = GetReverbSample(GetReverbOffset(ACC_SRC_A1)) * irr_coef + input_sample_r * in_coef_r;
-				float iir_input_b0 = GetReverbSample(GetReverbOffset(ACC_SRC_B0)) * irr_coef + input_sample_l * in_coef_l;
-				float iir_input_b1 = GetReverbSample(GetReverbOffset(ACC_SRC_B1)) * irr_coef + input_sample_r * in_coef_r;
-
-				//IIR_A0 = IIR_INPUT_A0 * IIR_ALPHA + buffer[IIR_DEST_A0] * (1.0 - IIR_ALPHA);
-				//IIR_A1 = IIR_INPUT_A1 * IIR_ALPHA + buffer[IIR_DEST_A1] * (1.0 - IIR_ALPHA);
-				//IIR_B0 = IIR_INPUT_B0 * IIR_ALPHA + buffer[IIR_DEST_B0] * (1.0 - IIR_ALPHA);
-				//IIR_B1 = IIR_INPUT_B1 * IIR_ALPHA + buffer[IIR_DEST_B1] * (1.0 - IIR_ALPHA);
-
-				float iir_alpha = GetReverbCoef(IIR_ALPHA);
-
-				float iir_a0 = iir_input_a0 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_A0)) * (1.0f - iir_alpha);
-				float iir_a1 = iir_input_a1 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_A1)) * (1.0f - iir_alpha);
-				float iir_b0 = iir_input_b0 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_B0)) * (1.0f - iir_alpha);
-				float iir_b1 = iir_input_b1 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_B1)) * (1.0f - iir_alpha);
-
-				//buffer[IIR_DEST_A0 + 1sample] = IIR_A0;
-				//buffer[IIR_DEST_A1 + 1sample] = IIR_A1;
-				//buffer[IIR_DEST_B0 + 1sample] = IIR_B0;
-				//buffer[IIR_DEST_B1 + 1sample] = IIR_B1;
-
-				SetReverbSample(GetReverbOffset(IIR_DEST_A0) + 2, iir_a0);
-				SetReverbSample(GetReverbOffset(IIR_DEST_A1) + 2, iir_a1);
-				SetReverbSample(GetReverbOffset(IIR_DEST_B0) + 2, iir_b0);
-				SetReverbSample(GetReverbOffset(IIR_DEST_B1) + 2, iir_b1);
-
-				//ACC0 = buffer[ACC_SRC_A0] * ACC_COEF_A +
-				//	   buffer[ACC_SRC_B0] * ACC_COEF_B +
-				//	   buffer[ACC_SRC_C0] * ACC_COEF_C +
-				//	   buffer[ACC_SRC_D0] * ACC_COEF_D;
-				//ACC1 = buffer[ACC_SRC_A1] * ACC_COEF_A +
-				//	   buffer[ACC_SRC_B1] * ACC_COEF_B +
-				//	   buffer[ACC_SRC_C1] * ACC_COEF_C +
-				//	   buffer[ACC_SRC_D1] * ACC_COEF_D;
-
-				float acc_coef_a = GetReverbCoef(ACC_COEF_A);
-				float acc_coef_b = GetReverbCoef(ACC_COEF_B);
-				float acc_coef_c = GetReverbCoef(ACC_COEF_C);
-				float acc_coef_d = GetReverbCoef(ACC_COEF_D);
-
-				float acc0 =
-				    GetReverbSample(GetReverbOffset(ACC_SRC_A0)) * acc_coef_a +
-				    GetReverbSample(GetReverbOffset(ACC_SRC_B0)) * acc_coef_b +
-				    GetReverbSample(GetReverbOffset(ACC_SRC_C0)) * acc_coef_c +
-				    GetReverbSample(GetReverbOffset(ACC_SRC_D0)) * acc_coef_d;
-
-				float acc1 =
-				    GetReverbSample(GetReverbOffset(ACC_SRC_A1)) * acc_coef_a +
-				    GetReverbSample(GetReverbOffset(ACC_SRC_B1)) * acc_coef_b +
-				    GetReverbSample(GetReverbOffset(ACC_SRC_C1)) * acc_coef_c +
-				    GetReverbSample(GetReverbOffset(ACC_SRC_D1)) * acc_coef_d;
-
-				//FB_A0 = buffer[MIX_DEST_A0 - FB_SRC_A];
-				//FB_A1 = buffer[MIX_DEST_A1 - FB_SRC_A];
-				//FB_B0 = buffer[MIX_DEST_B0 - FB_SRC_B];
-				//FB_B1 = buffer[MIX_DEST_B1 - FB_SRC_B];
-
-				float fb_a0 = GetReverbSample(GetReverbOffset(MIX_DEST_A0) - GetReverbOffset(FB_SRC_A));
-				float fb_a1 = GetReverbSample(GetReverbOffset(MIX_DEST_A1) - GetReverbOffset(FB_SRC_A));
-				float fb_b0 = GetReverbSample(GetReverbOffset(MIX_DEST_B0) - GetReverbOffset(FB_SRC_B));
-				float fb_b1 = GetReverbSample(GetReverbOffset(MIX_DEST_B1) - GetReverbOffset(FB_SRC_B));
-
-				//buffer[MIX_DEST_A0] = ACC0 - FB_A0 * FB_ALPHA;
-				//buffer[MIX_DEST_A1] = ACC1 - FB_A1 * FB_ALPHA;
-				//buffer[MIX_DEST_B0] = (FB_ALPHA * ACC0) - FB_A0 * (FB_ALPHA^0x8000) - FB_B0 * FB_X;
-				//buffer[MIX_DEST_B1] = (FB_ALPHA * ACC1) - FB_A1 * (FB_ALPHA^0x8000) - FB_B1 * FB_X;
-
-				float fb_alpha = GetReverbCoef(FB_ALPHA);
-				float fb_x = GetReverbCoef(FB_X);
-
-				SetReverbSample(GetReverbOffset(MIX_DEST_A0), acc0 - fb_a0 * fb_alpha);
-				SetReverbSample(GetReverbOffset(MIX_DEST_A1), acc1 - fb_a1 * fb_alpha);
-				SetReverbSample(GetReverbOffset(MIX_DEST_B0), (fb_alpha * acc0) - fb_a0 * -fb_alpha - fb_b0 * fb_x);
-				SetReverbSample(GetReverbOffset(MIX_DEST_B1), (fb_alpha * acc1) - fb_a1 * -fb_alpha - fb_b1 * fb_x);
-
-				m_reverbCurrAddr += 2;
-				if(m_reverbCurrAddr >= m_reverbWorkAddrEnd)
-				{
-					m_reverbCurrAddr = m_reverbWorkAddrStart;
-				}
+				//We're ready to consume some data
+				m_blockReader.FillBlock(m_ram + m_soundInputDataAddr);
+				m_blockWritePtr = 0;
 			}
 
-			if(m_reverbWorkAddrStart != 0)
+			if(m_blockReader.CanReadSamples())
 			{
-				float sampleL = 0.333f * (GetReverbSample(GetReverbOffset(MIX_DEST_A0)) + GetReverbSample(GetReverbOffset(MIX_DEST_B0)));
-				float sampleR = 0.333f * (GetReverbSample(GetReverbOffset(MIX_DEST_A1)) + GetReverbSample(GetReverbOffset(MIX_DEST_B1)));
-
-				{
-					int16* output = samples + 0;
-					int32 resultSample = static_cast<int32>(sampleL) + static_cast<int32>(*output);
-					resultSample = std::max<int32>(resultSample, SHRT_MIN);
-					resultSample = std::min<int32>(resultSample, SHRT_MAX);
-					*output = static_cast<int16>(resultSample);
-				}
+				int16 sampleL = 0;
+				int16 sampleR = 0;
+				m_blockReader.GetSamples(sampleL, sampleR, sampleRate);
 
-				{
-					int16* output = samples + 1;
-					int32 resultSample = static_cast<int32>(sampleR) + static_cast<int32>(*output);
-					resultSample = std::max<int32>(resultSample, SHRT_MIN);
-					resultSample = std::min<int32>(resultSample, SHRT_MAX);
-					*output = static_cast<int16>(resultSample);
-				}
+				MixSamples(sampleL, 0x3FFF, samples + 0);
+				MixSamples(sampleR, 0x3FFF, samples + 1);
 			}
+			samples += 2;
+		}
 
-			m_reverbTicks++;
+		//Update reverb
+		if(updateReverb)
+		{
+			CSpuReverb reverb(m_ram, m_reverb, m_reverbWorkAddrStart, m_reverbWorkAddrEnd);
+			reverb.Process(blockSamples, buses.reverbLeft, buses.reverbRight, blockTicks, m_reverbCurrAddr, m_reverbTicks);
 		}
-		samples += 2;
 	}
 }
 
@@ -830,42 +762,6 @@ uint32 CSpuBase::GetAdsrDelta(unsigned int index) const
 	return m_adsrLogTable[index + 32];
 }
 
-float CSpuBase::GetReverbSample(uint32 address) const
-{
-	uint32 absoluteAddress = m_reverbCurrAddr + address;
-	while(absoluteAddress >= m_reverbWorkAddrEnd)
-	{
-		absoluteAddress -= m_reverbWorkAddrEnd;
-		absoluteAddress += m_reverbWorkAddrStart;
-	}
-	return static_cast<float>(*reinterpret_cast<int16*>(m_ram + absoluteAddress));
-}
-
-void CSpuBase::SetReverbSample(uint32 address, float value)
-{
-	uint32 absoluteAddress = m_reverbCurrAddr + address;
-	while(absoluteAddress >= m_reverbWorkAddrEnd)
-	{
-		absoluteAddress -= m_reverbWorkAddrEnd;
-		absoluteAddress += m_reverbWorkAddrStart;
-	}
-	value = std::max<float>(value, SHRT_MIN);
-	value = std::min<float>(value, SHRT_MAX);
-	int16 intValue = static_cast<int16>(value);
-	*reinterpret_cast<int16*>(m_ram + absoluteAddress) = intValue;
-}
-
-uint32 CSpuBase::GetReverbOffset(unsigned int registerId) const
-{
-	return m_reverb[registerId];
-}
-
-float CSpuBase::GetReverbCoef(unsigned int registerId) const
-{
-	int16 value = static_cast<int16>(m_reverb[registerId]);
-	return static_cast<float>(value) / static_cast<float>(0x8000);
-}
-
 void CSpuBase::UpdateAdsr(CHANNEL& channel)
 {
 	static const unsigned int logIndex[8] = {0, 4, 6, 8, 9, 10, 11, 12};
@@ -1073,29 +969,32 @@ void CSpuBase::CSampleReader::SetPitch(uint32 baseSamplingRate, uint16 pitch)
 	m_srcSamplingRate = baseSamplingRate * pitch / 4096;
 }
 
-void CSpuBase::CSampleReader::GetSamples(int16* samples, unsigned int sampleCount, unsigned int dstSamplingRate)
+unsigned int CSpuBase::CSampleReader::GetSamples(int16* samples, unsigned int sampleCount, unsigned int dstSamplingRate)
 {
+	//Stops right after the sample that made the reader reach its end or change its repeat
+	//address, caller needs to handle those before reading more samples
+	uint32 sampleStep = (m_srcSamplingRate * TIME_SCALE) / dstSamplingRate;
 	for(unsigned int i = 0; i < sampleCount; i++)
 	{
-		samples[i] = GetSample(dstSamplingRate);
-	}
-}
-
-int16 CSpuBase::CSampleReader::GetSample(unsigned int dstSamplingRate)
-{
-	uint32 srcSampleIdx = m_srcSampleIdx / TIME_SCALE;
-	int32 srcSampleAlpha = m_srcSampleIdx % TIME_SCALE;
-	int32 currentSample = m_buffer[srcSampleIdx];
-	int32 nextSample = m_buffer[srcSampleIdx + 1];
-	int32 resultSample = (currentSample * (TIME_SCALE - srcSampleAlpha) / TIME_SCALE) +
-	                     (nextSample * srcSampleAlpha / TIME_SCALE);
-	m_srcSampleIdx += (m_srcSamplingRate * TIME_SCALE) / dstSamplingRate;
-	if(srcSampleIdx >= BUFFER_SAMPLES)
-	{
-		m_srcSampleIdx -= BUFFER_SAMPLES * TIME_SCALE;
-		AdvanceBuffer();
+		uint32 srcSampleIdx = m_srcSampleIdx / TIME_SCALE;
+		int32 srcSampleAlpha = m_srcSampleIdx % TIME_SCALE;
+		int32 currentSample = m_buffer[srcSampleIdx];
+		int32 nextSample = m_buffer[srcSampleIdx + 1];
+		int32 resultSample = (currentSample * (TIME_SCALE - srcSampleAlpha) / TIME_SCALE) +
+		                     (nextSample * srcSampleAlpha / TIME_SCALE);
+		samples[i] = static_cast<int16>(resultSample);
+		m_srcSampleIdx += sampleStep;
+		if(srcSampleIdx >= BUFFER_SAMPLES)
+		{
+			m_srcSampleIdx -= BUFFER_SAMPLES * TIME_SCALE;
+			AdvanceBuffer();
+		}
+		if(m_done || m_didChangeRepeat)
+		{
+			return i + 1;
+		}
 	}
-	return static_cast<int16>(resultSample);
+	return sampleCount;
 }
 
 void CSpuBase::CSampleReader::AdvanceBuffer()
@@ -1115,8 +1014,6 @@ void CSpuBase::CSampleReader::AdvanceBuffer()
 
 void CSpuBase::CSampleReader::UnpackSamples(int16* dst)
 {
-	int32 workBuffer[BUFFER_SAMPLES];
-
 	uint8* nextSample = m_ram + m_nextSampleAddr;
 
 	if(m_nextSampleAddr == m_irqAddr)
@@ -1130,22 +1027,7 @@ void CSpuBase::CSampleReader::UnpackSamples(int16* dst)
 	uint8 flags = nextSample[1];
 	assert(predictNumber < 5);
 
-	//Get intermediate values
-	{
-		unsigned int workBufferPtr = 0;
-		for(unsigned int i = 2; i < 16; i++)
-		{
-			uint8 sampleByte = nextSample[i];
-			int16 firstSample = ((sampleByte & 0x0F) << 12);
-			int16 secondSample = ((sampleByte & 0xF0) << 8);
-			firstSample >>= shiftFactor;
-			secondSample >>= shiftFactor;
-			workBuffer[workBufferPtr++] = firstSample;
-			workBuffer[workBufferPtr++] = secondSample;
-		}
-	}
-
-	//Generate PCM samples
+	//Generate PCM samples for the whole block
 	{
 		static const int32 predictorTable[5][2] =
 		    {
@@ -1156,18 +1038,27 @@ void CSpuBase::CSampleReader::UnpackSamples(int16* dst)
 		        {122, -60},
 		    };
 
+		int32 predictor0 = predictorTable[predictNumber][0];
+		int32 predictor1 = predictorTable[predictNumber][1];
+		int32 s1 = m_s1;
+		int32 s2 = m_s2;
 		for(unsigned int i = 0; i < BUFFER_SAMPLES; i++)
 		{
-			int32 currentValue = workBuffer[i] * 64;
-			currentValue += (m_s1 * predictorTable[predictNumber][0]) / 64;
-			currentValue += (m_s2 * predictorTable[predictNumber][1]) / 64;
-			m_s2 = m_s1;
-			m_s1 = currentValue;
+			uint8 sampleByte = nextSample[2 + (i / 2)];
+			int16 sampleValue = static_cast<int16>((i & 1) ? ((sampleByte & 0xF0) << 8) : ((sampleByte & 0x0F) << 12));
+			sampleValue >>= shiftFactor;
+			int32 currentValue = static_cast<int32>(sampleValue) * 64;
+			currentValue += (s1 * predictor0) / 64;
+			currentValue += (s2 * predictor1) / 64;
+			s2 = s1;
+			s1 = currentValue;
 			int32 result = (currentValue + 32) / 64;
 			result = std::max<int32>(result, SHRT_MIN);
 			result = std::min<int32>(result, SHRT_MAX);
 			dst[i] = static_cast<int16>(result);
 		}
+		m_s1 = s1;
+		m_s2 = s2;
 	}
 
 	if(flags & 0x04)
@@ -3,8 +3,7 @@
 #include "Types.h"
 #include "BasicUnion.h"
 #include "Convertible.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
 
 class CRegisterStateFile;
 
@@ -158,8 +157,8 @@ namespace Iop
 
 		void Reset();
 
-		void LoadState(Framework::CZipArchiveReader&);
-		void SaveState(Framework::CZipArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
 
 		bool IsEnabled() const;
 
@@ -242,7 +241,7 @@ namespace Iop
 
 			void SetParams(uint32, uint32);
 			void SetPitch(uint32, uint16);
-			void GetSamples(int16*, unsigned int, unsigned int);
+			unsigned int GetSamples(int16*, unsigned int, unsigned int);
 			uint32 GetRepeat() const;
 			void SetRepeat(uint32);
 			uint32 GetCurrent() const;
@@ -265,7 +264,6 @@ namespace Iop
 
 			void UnpackSamples(int16*);
 			void AdvanceBuffer();
-			int16 GetSample(unsigned int);
 
 			uint8* m_ram = nullptr;
 			uint32 m_ramSize = 0;
@@ -312,15 +310,26 @@ namespace Iop
 			MAX_ADSR_VOLUME = 0x7FFFFFFF,
 		};
 
+		enum
+		{
+			RENDER_BLOCK_TICKS = 64,
+		};
+
+		struct MIX_BUSES
+		{
+			int16 dryLeft[RENDER_BLOCK_TICKS];
+			int16 dryRight[RENDER_BLOCK_TICKS];
+			int16 reverbLeft[RENDER_BLOCK_TICKS];
+			int16 reverbRight[RENDER_BLOCK_TICKS];
+		};
+
+		void RenderChannel(unsigned int, MIX_BUSES&, unsigned int, unsigned int, bool, bool);
 		void UpdateAdsr(CHANNEL&);
 		uint32 GetAdsrDelta(unsigned int) const;
-		float GetReverbSample(uint32) const;
-		void SetReverbSample(uint32, float);
-		uint32 GetReverbOffset(unsigned int) const;
-		float GetReverbCoef(unsigned int) const;
 
 		static void MixSamples(int32, int32, int16*);
 		int32 ComputeChannelVolume(const CHANNEL_VOLUME&, int32);
+		void ComputeChannelVolumes(const CHANNEL_VOLUME&, int32&, int16*, unsigned int);
 
 		static const uint32 g_linearIncreaseSweepDeltas[0x80];
 		static const uint32 g_linearDecreaseSweepDeltas[0x80];
@@ -0,0 +1,167 @@
+#include <climits>
+#include <algorithm>
+#include "Iop_SpuMixer.h"
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define SPUMIXER_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SPUMIXER_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace Iop;
+
+enum
+{
+	MAX_LEVEL = 0x7FFF,
+};
+
+//Mixes ticks one by one, used for the ticks that don't fill a whole vector and for
+//envelope levels above MAX_LEVEL (envelope in decay going past 0), products still fit in 32 bits
+static void MixVoiceScalar(int16* dryLeft, int16* dryRight, int16* reverbLeft, int16* reverbRight,
+                           const int16* samples, const uint16* envelopeLevels, const int16* volumesLeft, const int16* volumesRight,
+                           unsigned int begin, unsigned int end)
+{
+	for(unsigned int i = begin; i < end; i++)
+	{
+		int32 inputSample = (static_cast<int32>(samples[i]) * static_cast<int32>(envelopeLevels[i])) / MAX_LEVEL;
+		int32 left = (inputSample * volumesLeft[i]) / MAX_LEVEL;
+		int32 right = (inputSample * volumesRight[i]) / MAX_LEVEL;
+		dryLeft[i] = static_cast<int16>(std::min<int32>(std::max<int32>(dryLeft[i] + left, SHRT_MIN), SHRT_MAX));
+		dryRight[i] = static_cast<int16>(std::min<int32>(std::max<int32>(dryRight[i] + right, SHRT_MIN), SHRT_MAX));
+		if(reverbLeft)
+		{
+			reverbLeft[i] = static_cast<int16>(std::min<int32>(std::max<int32>(reverbLeft[i] + left, SHRT_MIN), SHRT_MAX));
+			reverbRight[i] = static_cast<int16>(std::min<int32>(std::max<int32>(reverbRight[i] + right, SHRT_MIN), SHRT_MAX));
+		}
+	}
+}
+
+//Vector paths multiply 16 bit values by levels in [0, MAX_LEVEL], the quotients then fit in 16 bits.
+//Division by 0x7FFF is done on magnitudes with (x + (x >> 15) + 1) >> 15, which is exact for x < 2^30.
+
+#if defined(SPUMIXER_SSE2)
+
+static __m128i DivideByMaxLevel(__m128i value)
+{
+	__m128i sign = _mm_srai_epi32(value, 31);
+	__m128i magnitude = _mm_sub_epi32(_mm_xor_si128(value, sign), sign);
+	__m128i quotient = _mm_add_epi32(magnitude, _mm_srli_epi32(magnitude, 15));
+	quotient = _mm_srli_epi32(_mm_add_epi32(quotient, _mm_set1_epi32(1)), 15);
+	return _mm_sub_epi32(_mm_xor_si128(quotient, sign), sign);
+}
+
+static __m128i MultiplyLevel(__m128i value, __m128i level)
+{
+	__m128i productLo = _mm_mullo_epi16(value, level);
+	__m128i productHi = _mm_mulhi_epi16(value, level);
+	__m128i result0 = DivideByMaxLevel(_mm_unpacklo_epi16(productLo, productHi));
+	__m128i result1 = DivideByMaxLevel(_mm_unpackhi_epi16(productLo, productHi));
+	return _mm_packs_epi32(result0, result1);
+}
+
+static void AddSaturate(int16* output, __m128i value)
+{
+	auto outputVector = reinterpret_cast<__m128i*>(output);
+	_mm_storeu_si128(outputVector, _mm_adds_epi16(_mm_loadu_si128(outputVector), value));
+}
+
+static unsigned int MixVoiceVector(int16* dryLeft, int16* dryRight, int16* reverbLeft, int16* reverbRight,
+                                   const int16* samples, const uint16* envelopeLevels, const int16* volumesLeft, const int16* volumesRight,
+                                   unsigned int count)
+{
+	unsigned int vectorCount = count & ~7;
+	for(unsigned int i = 0; i < vectorCount; i += 8)
+	{
+		__m128i sample = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+		__m128i envelopeLevel = _mm_loadu_si128(reinterpret_cast<const __m128i*>(envelopeLevels + i));
+		__m128i volumeLeft = _mm_loadu_si128(reinterpret_cast<const __m128i*>(volumesLeft + i));
+		__m128i volumeRight = _mm_loadu_si128(reinterpret_cast<const __m128i*>(volumesRight + i));
+
+		__m128i inputSample = MultiplyLevel(sample, envelopeLevel);
+		__m128i left = MultiplyLevel(inputSample, volumeLeft);
+		__m128i right = MultiplyLevel(inputSample, volumeRight);
+
+		AddSaturate(dryLeft + i, left);
+		AddSaturate(dryRight + i, right);
+		if(reverbLeft)
+		{
+			AddSaturate(reverbLeft + i, left);
+			AddSaturate(reverbRight + i, right);
+		}
+	}
+	return vectorCount;
+}
+
+#elif defined(SPUMIXER_NEON)
+
+static int32x4_t DivideByMaxLevel(int32x4_t value)
+{
+	int32x4_t sign = vshrq_n_s32(value, 31);
+	uint32x4_t magnitude = vreinterpretq_u32_s32(vabsq_s32(value));
+	uint32x4_t quotient = vaddq_u32(magnitude, vshrq_n_u32(magnitude, 15));
+	quotient = vshrq_n_u32(vaddq_u32(quotient, vdupq_n_u32(1)), 15);
+	return vsubq_s32(veorq_s32(vreinterpretq_s32_u32(quotient), sign), sign);
+}
+
+static int16x8_t MultiplyLevel(int16x8_t value, int16x8_t level)
+{
+	int32x4_t result0 = DivideByMaxLevel(vmull_s16(vget_low_s16(value), vget_low_s16(level)));
+	int32x4_t result1 = DivideByMaxLevel(vmull_s16(vget_high_s16(value), vget_high_s16(level)));
+	return vcombine_s16(vqmovn_s32(result0), vqmovn_s32(result1));
+}
+
+static void AddSaturate(int16* output, int16x8_t value)
+{
+	vst1q_s16(output, vqaddq_s16(vld1q_s16(output), value));
+}
+
+static unsigned int MixVoiceVector(int16* dryLeft, int16* dryRight, int16* reverbLeft, int16* reverbRight,
+                                   const int16* samples, const uint16* envelopeLevels, const int16* volumesLeft, const int16* volumesRight,
+                                   unsigned int count)
+{
+	unsigned int vectorCount = count & ~7;
+	for(unsigned int i = 0; i < vectorCount; i += 8)
+	{
+		int16x8_t sample = vld1q_s16(samples + i);
+		int16x8_t envelopeLevel = vreinterpretq_s16_u16(vld1q_u16(envelopeLevels + i));
+		int16x8_t volumeLeft = vld1q_s16(volumesLeft + i);
+		int16x8_t volumeRight = vld1q_s16(volumesRight + i);
+
+		int16x8_t inputSample = MultiplyLevel(sample, envelopeLevel);
+		int16x8_t left = MultiplyLevel(inputSample, volumeLeft);
+		int16x8_t right = MultiplyLevel(inputSample, volumeRight);
+
+		AddSaturate(dryLeft + i, left);
+		AddSaturate(dryRight + i, right);
+		if(reverbLeft)
+		{
+			AddSaturate(reverbLeft + i, left);
+			AddSaturate(reverbRight + i, right);
+		}
+	}
+	return vectorCount;
+}
+
+#else
+
+static unsigned int MixVoiceVector(int16*, int16*, int16*, int16*, const int16*, const uint16*, const int16*, const int16*, unsigned int)
+{
+	return 0;
+}
+
+#endif
+
+void CSpuMixer::MixVoice(int16* dryLeft, int16* dryRight, int16* reverbLeft, int16* reverbRight,
+                         const int16* samples, const uint16* envelopeLevels, const int16* volumesLeft, const int16* volumesRight,
+                         unsigned int count)
+{
+	unsigned int vectorCount = 0;
+	bool levelsInRange = std::all_of(envelopeLevels, envelopeLevels + count, [](uint16 level) { return level <= MAX_LEVEL; });
+	if(levelsInRange)
+	{
+		vectorCount = MixVoiceVector(dryLeft, dryRight, reverbLeft, reverbRight, samples, envelopeLevels, volumesLeft, volumesRight, count);
+	}
+	MixVoiceScalar(dryLeft, dryRight, reverbLeft, reverbRight, samples, envelopeLevels, volumesLeft, volumesRight, vectorCount, count);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Types.h"
+
+namespace Iop
+{
+	//Mixes one voice into the output buses. Results are the same as mixing the voice
+	//tick by tick: envelope and volume are applied with truncating divisions by 0x7FFF
+	//and the sum is clamped to 16 bits after each voice is added.
+	class CSpuMixer
+	{
+	public:
+		static void MixVoice(int16*, int16*, int16*, int16*, const int16*, const uint16*, const int16*, const int16*, unsigned int);
+	};
+}
@@ -0,0 +1,67 @@
+#include <cassert>
+#include "Iop_SpuRenderThread.h"
+
+using namespace Iop;
+
+CSpuRenderThread::CSpuRenderThread()
+    : m_busy(false)
+{
+	m_thread = std::thread([this]() { ThreadProc(); });
+}
+
+CSpuRenderThread::~CSpuRenderThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_threadDone = true;
+	}
+	m_condition.notify_all();
+	m_thread.join();
+}
+
+bool CSpuRenderThread::IsBusy() const
+{
+	return m_busy.load(std::memory_order_acquire);
+}
+
+void CSpuRenderThread::Start(Job job)
+{
+	assert(job);
+	Wait();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_job = std::move(job);
+		m_busy.store(true, std::memory_order_release);
+	}
+	m_condition.notify_all();
+}
+
+void CSpuRenderThread::Wait()
+{
+	if(!IsBusy()) return;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_condition.wait(lock, [this]() { return !m_job; });
+}
+
+void CSpuRenderThread::ThreadProc()
+{
+	while(1)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_threadDone || m_job; });
+			if(m_threadDone) break;
+			job = m_job;
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_job = Job();
+			m_busy.store(false, std::memory_order_release);
+		}
+		m_condition.notify_all();
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Iop
+{
+	//Runs SPU render jobs on a worker thread, one at a time. Callers must wait
+	//for the job in flight to be done before touching any SPU state.
+	class CSpuRenderThread
+	{
+	public:
+		typedef std::function<void()> Job;
+
+		CSpuRenderThread();
+		virtual ~CSpuRenderThread();
+
+		bool IsBusy() const;
+		void Start(Job);
+		void Wait();
+
+	private:
+		void ThreadProc();
+
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		Job m_job;
+		bool m_threadDone = false;
+		std::atomic<bool> m_busy;
+	};
+}
@@ -0,0 +1,201 @@
+#include <cassert>
+#include <climits>
+#include <algorithm>
+#include "Iop_SpuReverb.h"
+#include "Iop_SpuBase.h"
+
+using namespace Iop;
+
+static float GetReverbCoef(uint32 value)
+{
+	return static_cast<float>(static_cast<int16>(value)) / static_cast<float>(0x8000);
+}
+
+CSpuReverb::CSpuReverb(uint8* ram, const uint32* registers, uint32 workAddrStart, uint32 workAddrEnd)
+    : m_ram(ram)
+    , m_workAddrStart(workAddrStart)
+    , m_workAddrEnd(workAddrEnd)
+{
+	assert(workAddrStart < workAddrEnd);
+
+	//Lanes are A0, A1, B0, B1
+	static const unsigned int iirSrcRegisters[LANE_COUNT] = {CSpuBase::ACC_SRC_A0, CSpuBase::ACC_SRC_A1, CSpuBase::ACC_SRC_B0, CSpuBase::ACC_SRC_B1};
+	static const unsigned int iirDestRegisters[LANE_COUNT] = {CSpuBase::IIR_DEST_A0, CSpuBase::IIR_DEST_A1, CSpuBase::IIR_DEST_B0, CSpuBase::IIR_DEST_B1};
+	static const unsigned int fbSrcRegisters[LANE_COUNT] = {CSpuBase::FB_SRC_A, CSpuBase::FB_SRC_A, CSpuBase::FB_SRC_B, CSpuBase::FB_SRC_B};
+	static const unsigned int mixDestRegisters[LANE_COUNT] = {CSpuBase::MIX_DEST_A0, CSpuBase::MIX_DEST_A1, CSpuBase::MIX_DEST_B0, CSpuBase::MIX_DEST_B1};
+	static const unsigned int accSrcARegisters[2] = {CSpuBase::ACC_SRC_A0, CSpuBase::ACC_SRC_A1};
+	static const unsigned int accSrcBRegisters[2] = {CSpuBase::ACC_SRC_B0, CSpuBase::ACC_SRC_B1};
+	static const unsigned int accSrcCRegisters[2] = {CSpuBase::ACC_SRC_C0, CSpuBase::ACC_SRC_C1};
+	static const unsigned int accSrcDRegisters[2] = {CSpuBase::ACC_SRC_D0, CSpuBase::ACC_SRC_D1};
+
+	for(unsigned int i = 0; i < LANE_COUNT; i++)
+	{
+		m_tapOffsets[TAP_IIR_SRC + i] = registers[iirSrcRegisters[i]];
+		m_tapOffsets[TAP_IIR_DEST + i] = registers[iirDestRegisters[i]];
+		m_tapOffsets[TAP_IIR_DEST_NEXT + i] = registers[iirDestRegisters[i]] + 2;
+		m_tapOffsets[TAP_FB_SRC + i] = registers[mixDestRegisters[i]] - registers[fbSrcRegisters[i]];
+		m_tapOffsets[TAP_MIX_DEST + i] = registers[mixDestRegisters[i]];
+	}
+
+	for(unsigned int i = 0; i < 2; i++)
+	{
+		m_tapOffsets[TAP_ACC_SRC_A + i] = registers[accSrcARegisters[i]];
+		m_tapOffsets[TAP_ACC_SRC_B + i] = registers[accSrcBRegisters[i]];
+		m_tapOffsets[TAP_ACC_SRC_C + i] = registers[accSrcCRegisters[i]];
+		m_tapOffsets[TAP_ACC_SRC_D + i] = registers[accSrcDRegisters[i]];
+	}
+
+	m_iirCoef = GetReverbCoef(registers[CSpuBase::IIR_COEF]);
+	m_iirAlpha = GetReverbCoef(registers[CSpuBase::IIR_ALPHA]);
+	m_iirAlphaComplement = 1.0f - m_iirAlpha;
+	m_inCoef[0] = m_inCoef[2] = GetReverbCoef(registers[CSpuBase::IN_COEF_L]);
+	m_inCoef[1] = m_inCoef[3] = GetReverbCoef(registers[CSpuBase::IN_COEF_R]);
+	m_accCoefA = GetReverbCoef(registers[CSpuBase::ACC_COEF_A]);
+	m_accCoefB = GetReverbCoef(registers[CSpuBase::ACC_COEF_B]);
+	m_accCoefC = GetReverbCoef(registers[CSpuBase::ACC_COEF_C]);
+	m_accCoefD = GetReverbCoef(registers[CSpuBase::ACC_COEF_D]);
+	m_fbAlpha = GetReverbCoef(registers[CSpuBase::FB_ALPHA]);
+	m_fbX = GetReverbCoef(registers[CSpuBase::FB_X]);
+}
+
+void CSpuReverb::Process(int16* samples, const int16* inputLeft, const int16* inputRight, unsigned int tickCount, uint32& currAddr, int& reverbTicks)
+{
+	ResolveTaps(currAddr);
+
+	for(unsigned int i = 0; i < tickCount; i++)
+	{
+		//Filters run at half the output rate
+		if(reverbTicks & 1)
+		{
+			ProcessFilters(inputLeft[i], inputRight[i]);
+
+			currAddr += 2;
+			if(currAddr >= m_workAddrEnd)
+			{
+				currAddr = m_workAddrStart;
+			}
+
+			m_spanSteps--;
+			if(m_spanSteps == 0)
+			{
+				ResolveTaps(currAddr);
+			}
+			else
+			{
+				//All taps move forward by one sample inside the span
+				m_spanRam += 2;
+			}
+		}
+
+		if(m_workAddrStart != 0)
+		{
+			float sampleL = 0.333f * (ReadTap(TAP_MIX_DEST + 0) + ReadTap(TAP_MIX_DEST + 2));
+			float sampleR = 0.333f * (ReadTap(TAP_MIX_DEST + 1) + ReadTap(TAP_MIX_DEST + 3));
+
+			int32 resultL = static_cast<int32>(sampleL) + static_cast<int32>(samples[0]);
+			int32 resultR = static_cast<int32>(sampleR) + static_cast<int32>(samples[1]);
+			samples[0] = static_cast<int16>(std::min<int32>(std::max<int32>(resultL, SHRT_MIN), SHRT_MAX));
+			samples[1] = static_cast<int16>(std::min<int32>(std::max<int32>(resultR, SHRT_MIN), SHRT_MAX));
+		}
+
+		reverbTicks++;
+		samples += 2;
+	}
+}
+
+void CSpuReverb::ResolveTaps(uint32 currAddr)
+{
+	//Find how many filter steps we can go through before the current address
+	//or any of the taps wraps around the end of the work area
+	uint32 spanSteps = (currAddr < m_workAddrEnd) ? (m_workAddrEnd - currAddr + 1) / 2 : 1;
+	for(unsigned int i = 0; i < TAP_COUNT; i++)
+	{
+		uint32 address = currAddr + m_tapOffsets[i];
+		if(address >= m_workAddrEnd)
+		{
+			//Unwrapped address can also overflow before the tap reaches the end of the work area
+			spanSteps = std::min<uint64>(spanSteps, (0x100000000ULL - address) / 2);
+			address = m_workAddrStart + ((address - m_workAddrEnd) % (m_workAddrEnd - m_workAddrStart));
+		}
+		m_tapAddresses[i] = address;
+		spanSteps = std::min<uint32>(spanSteps, (m_workAddrEnd - address + 1) / 2);
+	}
+	assert(spanSteps != 0);
+	m_spanSteps = spanSteps;
+	m_spanRam = m_ram;
+}
+
+float CSpuReverb::ReadTap(unsigned int tap) const
+{
+	return static_cast<float>(*reinterpret_cast<const int16*>(m_spanRam + m_tapAddresses[tap]));
+}
+
+void CSpuReverb::WriteTap(unsigned int tap, float value)
+{
+	value = std::max<float>(value, SHRT_MIN);
+	value = std::min<float>(value, SHRT_MAX);
+	*reinterpret_cast<int16*>(m_spanRam + m_tapAddresses[tap]) = static_cast<int16>(value);
+}
+
+void CSpuReverb::ProcessFilters(int16 inputLeft, int16 inputRight)
+{
+	float inputs[LANE_COUNT];
+	inputs[0] = inputs[2] = static_cast<float>(inputLeft) * 0.5f;
+	inputs[1] = inputs[3] = static_cast<float>(inputRight) * 0.5f;
+
+	float iirSrc[LANE_COUNT];
+	float iirDest[LANE_COUNT];
+	for(unsigned int i = 0; i < LANE_COUNT; i++)
+	{
+		iirSrc[i] = ReadTap(TAP_IIR_SRC + i);
+		iirDest[i] = ReadTap(TAP_IIR_DEST + i);
+	}
+
+	//IIR_INPUT = buffer[IIR_SRC] * IIR_COEF + INPUT_SAMPLE * IN_COEF;
+	//IIR = IIR_INPUT * IIR_ALPHA + buffer[IIR_DEST] * (1.0 - IIR_ALPHA);
+	//buffer[IIR_DEST + 1sample] = IIR;
+	float iir[LANE_COUNT];
+	for(unsigned int i = 0; i < LANE_COUNT; i++)
+	{
+		float iirInput = iirSrc[i] * m_iirCoef + inputs[i] * m_inCoef[i];
+		iir[i] = iirInput * m_iirAlpha + iirDest[i] * m_iirAlphaComplement;
+	}
+
+	for(unsigned int i = 0; i < LANE_COUNT; i++)
+	{
+		WriteTap(TAP_IIR_DEST_NEXT + i, iir[i]);
+	}
+
+	//ACC = buffer[ACC_SRC_A] * ACC_COEF_A + buffer[ACC_SRC_B] * ACC_COEF_B +
+	//      buffer[ACC_SRC_C] * ACC_COEF_C + buffer[ACC_SRC_D] * ACC_COEF_D;
+	float acc[2];
+	for(unsigned int i = 0; i < 2; i++)
+	{
+		acc[i] =
+		    ReadTap(TAP_ACC_SRC_A + i) * m_accCoefA +
+		    ReadTap(TAP_ACC_SRC_B + i) * m_accCoefB +
+		    ReadTap(TAP_ACC_SRC_C + i) * m_accCoefC +
+		    ReadTap(TAP_ACC_SRC_D + i) * m_accCoefD;
+	}
+
+	//FB = buffer[MIX_DEST - FB_SRC];
+	float fb[LANE_COUNT];
+	for(unsigned int i = 0; i < LANE_COUNT; i++)
+	{
+		fb[i] = ReadTap(TAP_FB_SRC + i);
+	}
+
+	//buffer[MIX_DEST_A] = ACC - FB_A * FB_ALPHA;
+	//buffer[MIX_DEST_B] = (FB_ALPHA * ACC) - FB_A * (FB_ALPHA^0x8000) - FB_B * FB_X;
+	float mix[LANE_COUNT];
+	for(unsigned int i = 0; i < 2; i++)
+	{
+		mix[i] = acc[i] - fb[i] * m_fbAlpha;
+		mix[i + 2] = (m_fbAlpha * acc[i]) - fb[i] * -m_fbAlpha - fb[i + 2] * m_fbX;
+	}
+
+	for(unsigned int i = 0; i < LANE_COUNT; i++)
+	{
+		WriteTap(TAP_MIX_DEST + i, mix[i]);
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Types.h"
+
+namespace Iop
+{
+	//Block based implementation of the SPU reverb. Tap addresses are resolved
+	//once for every span of samples where none of them wraps around the work area
+	//and the four filter paths (A0, A1, B0, B1) are processed side by side.
+	class CSpuReverb
+	{
+	public:
+		CSpuReverb(uint8*, const uint32*, uint32, uint32);
+
+		void Process(int16*, const int16*, const int16*, unsigned int, uint32&, int&);
+
+	private:
+		enum
+		{
+			LANE_COUNT = 4,
+		};
+
+		enum TAP
+		{
+			TAP_IIR_SRC,
+			TAP_IIR_DEST = TAP_IIR_SRC + LANE_COUNT,
+			TAP_IIR_DEST_NEXT = TAP_IIR_DEST + LANE_COUNT,
+			TAP_ACC_SRC_A = TAP_IIR_DEST_NEXT + LANE_COUNT,
+			TAP_ACC_SRC_B = TAP_ACC_SRC_A + 2,
+			TAP_ACC_SRC_C = TAP_ACC_SRC_B + 2,
+			TAP_ACC_SRC_D = TAP_ACC_SRC_C + 2,
+			TAP_FB_SRC = TAP_ACC_SRC_D + 2,
+			TAP_MIX_DEST = TAP_FB_SRC + LANE_COUNT,
+			TAP_COUNT = TAP_MIX_DEST + LANE_COUNT,
+		};
+
+		void ResolveTaps(uint32);
+		float ReadTap(unsigned int) const;
+		void WriteTap(unsigned int, float);
+		void ProcessFilters(int16, int16);
+
+		uint8* m_ram = nullptr;
+		uint32 m_workAddrStart = 0;
+		uint32 m_workAddrEnd = 0;
+
+		uint32 m_tapOffsets[TAP_COUNT];
+		uint32 m_tapAddresses[TAP_COUNT];
+		uint32 m_spanSteps = 0;
+		uint8* m_spanRam = nullptr;
+
+		float m_iirCoef = 0;
+		float m_iirAlpha = 0;
+		float m_iirAlphaComplement = 0;
+		float m_inCoef[LANE_COUNT];
+		float m_accCoefA = 0;
+		float m_accCoefB = 0;
+		float m_accCoefC = 0;
+		float m_accCoefD = 0;
+		float m_fbAlpha = 0;
+		float m_fbX = 0;
+	};
+}
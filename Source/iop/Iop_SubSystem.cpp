@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <climits>
 #include "Iop_SubSystem.h"
 #include "IopBios.h"
 #include "GenericMipsExecutor.h"
@@ -5,7 +7,6 @@
 #include "../states/MemoryStateFile.h"
 #include "../Ps2Const.h"
 #include "../Log.h"
-#include "placeholder_def.h"
 
 using namespace Iop;
 using namespace PS2;
@@ -17,6 +18,8 @@ using namespace PS2;
 #define STATE_SCRATCH ("iop_scratch")
 #define STATE_SPURAM ("iop_spuram")
 
+#define QUICKSTATE_PAGE_SIZE (0x1000)
+
 CSubSystem::CSubSystem(bool ps2Mode)
     : m_cpu(MEMORYMAP_ENDIAN_LSBF, true)
     , m_ram(new uint8[IOP_RAM_SIZE])
@@ -72,14 +75,24 @@ CSubSystem::CSubSystem(bool ps2Mode)
 	m_cpu.m_pCOP[0] = &m_copScu;
 	m_cpu.m_pAddrTranslator = &CMIPS::TranslateAddress64;
 
-	m_dmac.SetReceiveFunction(4, std::bind(&CSpuBase::ReceiveDma, &m_spuCore0, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3));
-	m_dmac.SetReceiveFunction(8, std::bind(&CSpuBase::ReceiveDma, &m_spuCore1, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3));
+	//Transfers depend on the SPU's current state, wait for the block being rendered
+	m_dmac.SetReceiveFunction(4,
+	                          [this](uint8* buffer, uint32 blockSize, uint32 blockAmount) {
+		                          SyncSpu();
+		                          return m_spuCore0.ReceiveDma(buffer, blockSize, blockAmount);
+	                          });
+	m_dmac.SetReceiveFunction(8,
+	                          [this](uint8* buffer, uint32 blockSize, uint32 blockAmount) {
+		                          SyncSpu();
+		                          return m_spuCore1.ReceiveDma(buffer, blockSize, blockAmount);
+	                          });
 
 	SetupPageTable();
 }
 
 CSubSystem::~CSubSystem()
 {
+	m_spuRenderThread.reset();
 	m_bios.reset();
 	delete[] m_ram;
 	delete[] m_scratchPad;
@@ -98,12 +111,53 @@ void CSubSystem::NotifyVBlankEnd()
 	m_intc.AssertLine(Iop::CIntc::LINE_EVBLANK);
 }
 
-void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
+void CSubSystem::SaveState(CStateArchiveWriter& archive)
 {
+	SyncSpu();
 	archive.InsertFile(new CMemoryStateFile(STATE_CPU, &m_cpu.m_State, sizeof(MIPSSTATE)));
 	archive.InsertFile(new CMemoryStateFile(STATE_RAM, m_ram, IOP_RAM_SIZE));
 	archive.InsertFile(new CMemoryStateFile(STATE_SCRATCH, m_scratchPad, IOP_SCRATCH_SIZE));
 	archive.InsertFile(new CMemoryStateFile(STATE_SPURAM, m_spuRam, SPU_RAM_SIZE));
+	SaveDeviceState(archive);
+}
+
+void CSubSystem::LoadState(CStateArchiveReader& archive)
+{
+	SyncSpu();
+	archive.BeginReadFile(STATE_CPU)->Read(&m_cpu.m_State, sizeof(MIPSSTATE));
+	archive.BeginReadFile(STATE_RAM)->Read(m_ram, IOP_RAM_SIZE);
+	archive.BeginReadFile(STATE_SCRATCH)->Read(m_scratchPad, IOP_SCRATCH_SIZE);
+	archive.BeginReadFile(STATE_SPURAM)->Read(m_spuRam, SPU_RAM_SIZE);
+	LoadDeviceState(archive);
+}
+
+void CSubSystem::SaveQuickState(CQuickState& state)
+{
+	SyncSpu();
+	state.SaveMemory(&m_cpu.m_State, sizeof(MIPSSTATE));
+	state.SaveMemory(m_ram, IOP_RAM_SIZE);
+	state.SaveMemory(m_scratchPad, IOP_SCRATCH_SIZE);
+	state.SaveMemory(m_spuRam, SPU_RAM_SIZE);
+	SaveDeviceState(state.GetArchiveWriter());
+}
+
+void CSubSystem::LoadQuickState(CQuickState& state)
+{
+	SyncSpu();
+	state.LoadMemory(&m_cpu.m_State, sizeof(MIPSSTATE));
+	//Modules might have been loaded since the snapshot was taken, make sure
+	//we don't keep blocks compiled from code that isn't there anymore
+	state.LoadMemory(m_ram, IOP_RAM_SIZE, QUICKSTATE_PAGE_SIZE,
+	                 [this](size_t offset, size_t size) {
+		                 m_cpu.m_executor->ClearActiveBlocksInRange(static_cast<uint32>(offset), static_cast<uint32>(offset + size), false);
+	                 });
+	state.LoadMemory(m_scratchPad, IOP_SCRATCH_SIZE);
+	state.LoadMemory(m_spuRam, SPU_RAM_SIZE);
+	LoadDeviceState(state.GetArchiveReader());
+}
+
+void CSubSystem::SaveDeviceState(CStateArchiveWriter& archive)
+{
 	m_intc.SaveState(archive);
 	m_dmac.SaveState(archive);
 	m_counters.SaveState(archive);
@@ -115,12 +169,8 @@ void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
 	m_bios->SaveState(archive);
 }
 
-void CSubSystem::LoadState(Framework::CZipArchiveReader& archive)
+void CSubSystem::LoadDeviceState(CStateArchiveReader& archive)
 {
-	archive.BeginReadFile(STATE_CPU)->Read(&m_cpu.m_State, sizeof(MIPSSTATE));
-	archive.BeginReadFile(STATE_RAM)->Read(m_ram, IOP_RAM_SIZE);
-	archive.BeginReadFile(STATE_SCRATCH)->Read(m_scratchPad, IOP_SCRATCH_SIZE);
-	archive.BeginReadFile(STATE_SPURAM)->Read(m_spuRam, SPU_RAM_SIZE);
 	m_intc.LoadState(archive);
 	m_dmac.LoadState(archive);
 	m_counters.LoadState(archive);
@@ -134,6 +184,7 @@ void CSubSystem::LoadState(Framework::CZipArchiveReader& archive)
 
 void CSubSystem::Reset()
 {
+	SyncSpu();
 	memset(m_ram, 0, IOP_RAM_SIZE);
 	memset(m_scratchPad, 0, IOP_SCRATCH_SIZE);
 	memset(m_spuRam, 0, SPU_RAM_SIZE);
@@ -157,6 +208,101 @@ void CSubSystem::Reset()
 	m_dmaUpdateTicks = 0;
 }
 
+void CSubSystem::SetSpuRenderThreadEnabled(bool enabled)
+{
+	if(enabled == IsSpuRenderThreadEnabled()) return;
+	SyncSpu();
+	if(enabled)
+	{
+		m_spuRenderThread = std::make_unique<CSpuRenderThread>();
+	}
+	else
+	{
+		m_spuRenderThread.reset();
+	}
+}
+
+bool CSubSystem::IsSpuRenderThreadEnabled() const
+{
+	return static_cast<bool>(m_spuRenderThread);
+}
+
+void CSubSystem::RenderSpu(unsigned int sampleCount, unsigned int sampleRate, const SpuSamplesHandler& samplesHandler)
+{
+	if(!m_spuRenderThread)
+	{
+		RenderSpuImpl(sampleCount, sampleRate, samplesHandler);
+		return;
+	}
+	//Writes made while the previous block was rendering need to be visible to this one.
+	//The worker is at most one block ahead, anything that reads SPU state waits for it.
+	SyncSpu();
+	m_spuRenderThread->Start(
+	    [this, sampleCount, sampleRate, samplesHandler]() {
+		    RenderSpuImpl(sampleCount, sampleRate, samplesHandler);
+	    });
+}
+
+void CSubSystem::SyncSpu()
+{
+	if(!m_spuRenderThread) return;
+	m_spuRenderThread->Wait();
+	for(const auto& write : m_spuPendingWrites)
+	{
+		WriteSpuRegisterImpl(write.address, write.value);
+	}
+	m_spuPendingWrites.clear();
+}
+
+bool CSubSystem::IsSpuRendering() const
+{
+	return m_spuRenderThread && m_spuRenderThread->IsBusy();
+}
+
+void CSubSystem::RenderSpuImpl(unsigned int sampleCount, unsigned int sampleRate, const SpuSamplesHandler& samplesHandler)
+{
+	m_spuSamples.resize(sampleCount);
+	m_spuCore0.Render(m_spuSamples.data(), sampleCount, sampleRate);
+
+	if(m_spuCore1.IsEnabled())
+	{
+		m_spuCore1Samples.resize(sampleCount);
+		m_spuCore1.Render(m_spuCore1Samples.data(), sampleCount, sampleRate);
+
+		for(unsigned int i = 0; i < sampleCount; i++)
+		{
+			int32 resultSample = static_cast<int32>(m_spuSamples[i]) + static_cast<int32>(m_spuCore1Samples[i]);
+			resultSample = std::max<int32>(resultSample, SHRT_MIN);
+			resultSample = std::min<int32>(resultSample, SHRT_MAX);
+			m_spuSamples[i] = static_cast<int16>(resultSample);
+		}
+	}
+
+	samplesHandler(m_spuSamples.data(), sampleCount);
+}
+
+uint32 CSubSystem::WriteSpuRegister(uint32 address, uint32 value)
+{
+	if(IsSpuRendering())
+	{
+		//Record the write, it will be applied in order once the block being rendered is done
+		m_spuPendingWrites.push_back({address, value});
+		return 0;
+	}
+	SyncSpu();
+	return WriteSpuRegisterImpl(address, value);
+}
+
+uint32 CSubSystem::WriteSpuRegisterImpl(uint32 address, uint32 value)
+{
+	if(address >= CSpu::SPU_BEGIN && address <= CSpu::SPU_END)
+	{
+		m_spu.WriteRegister(address, static_cast<uint16>(value));
+		return 0;
+	}
+	return m_spu2.WriteRegister(address, value);
+}
+
 void CSubSystem::SetupPageTable()
 {
 	for(uint32 i = 0; i < 2; i++)
@@ -180,6 +326,7 @@ uint32 CSubSystem::ReadIoRegister(uint32 address)
 	}
 	else if(address >= CSpu::SPU_BEGIN && address <= CSpu::SPU_END)
 	{
+		SyncSpu();
 		return m_spu.ReadRegister(address);
 	}
 	else if(address >= CDmac::DMAC_ZONE1_START && address <= CDmac::DMAC_ZONE1_END)
@@ -208,6 +355,7 @@ uint32 CSubSystem::ReadIoRegister(uint32 address)
 #endif
 	else if(address >= CSpu2::REGS_BEGIN && address <= CSpu2::REGS_END)
 	{
+		SyncSpu();
 		return m_spu2.ReadRegister(address);
 	}
 	else if(address >= 0x1F808400 && address <= 0x1F808500)
@@ -230,7 +378,7 @@ uint32 CSubSystem::WriteIoRegister(uint32 address, uint32 value)
 	}
 	else if(address >= CSpu::SPU_BEGIN && address <= CSpu::SPU_END)
 	{
-		m_spu.WriteRegister(address, static_cast<uint16>(value));
+		WriteSpuRegister(address, value);
 	}
 	else if(address >= CDmac::DMAC_ZONE2_START && address <= CDmac::DMAC_ZONE2_END)
 	{
@@ -254,7 +402,7 @@ uint32 CSubSystem::WriteIoRegister(uint32 address, uint32 value)
 #endif
 	else if(address >= CSpu2::REGS_BEGIN && address <= CSpu2::REGS_END)
 	{
-		return m_spu2.WriteRegister(address, value);
+		return WriteSpuRegister(address, value);
 	}
 	else
 	{
@@ -300,7 +448,10 @@ void CSubSystem::CountTicks(int ticks)
 		m_dmac.ResumeDma(8);
 		m_dmaUpdateTicks -= g_dmaUpdateDelay;
 	}
+	//IRQs raised by the block being rendered will be seen once it's done
+	if(!IsSpuRendering())
 	{
+		SyncSpu();
 		bool irqPending = false;
 		irqPending |= m_spuCore0.GetIrqPending();
 		irqPending |= m_spuCore1.GetIrqPending();
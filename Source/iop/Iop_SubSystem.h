@@ -1,24 +1,30 @@
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <vector>
 #include "../MIPS.h"
 #include "../MA_MIPSIV.h"
 #include "../COP_SCU.h"
 #include "Iop_SpuBase.h"
 #include "Iop_Spu.h"
 #include "Iop_Spu2.h"
+#include "Iop_SpuRenderThread.h"
 #include "Iop_Sio2.h"
 #include "Iop_Dmac.h"
 #include "Iop_Intc.h"
 #include "Iop_RootCounters.h"
 #include "Iop_BiosBase.h"
-#include "zip/ZipArchiveWriter.h"
-#include "zip/ZipArchiveReader.h"
+#include "../states/StateArchive.h"
+#include "../states/QuickState.h"
 
 namespace Iop
 {
 	class CSubSystem
 	{
 	public:
+		typedef std::function<void(const int16*, unsigned int)> SpuSamplesHandler;
+
 		CSubSystem(bool ps2Mode);
 		virtual ~CSubSystem();
 
@@ -30,8 +36,16 @@ namespace Iop
 		void NotifyVBlankStart();
 		void NotifyVBlankEnd();
 
-		void SaveState(Framework::CZipArchiveWriter&);
-		void LoadState(Framework::CZipArchiveReader&);
+		void SaveState(CStateArchiveWriter&);
+		void LoadState(CStateArchiveReader&);
+
+		void SaveQuickState(CQuickState&);
+		void LoadQuickState(CQuickState&);
+
+		void SetSpuRenderThreadEnabled(bool);
+		bool IsSpuRenderThreadEnabled() const;
+		void RenderSpu(unsigned int, unsigned int, const SpuSamplesHandler&);
+		void SyncSpu();
 
 		uint8* m_ram;
 		uint8* m_scratchPad;
@@ -58,13 +72,32 @@ namespace Iop
 			HW_REG_END = 0x1F9FFFFF
 		};
 
+		struct SPU_REGISTER_WRITE
+		{
+			uint32 address;
+			uint32 value;
+		};
+
 		void SetupPageTable();
 
+		void SaveDeviceState(CStateArchiveWriter&);
+		void LoadDeviceState(CStateArchiveReader&);
+
 		uint32 ReadIoRegister(uint32);
 		uint32 WriteIoRegister(uint32, uint32);
 
+		bool IsSpuRendering() const;
+		void RenderSpuImpl(unsigned int, unsigned int, const SpuSamplesHandler&);
+		uint32 WriteSpuRegister(uint32, uint32);
+		uint32 WriteSpuRegisterImpl(uint32, uint32);
+
 		void CheckPendingInterrupts();
 
 		int m_dmaUpdateTicks;
+
+		std::unique_ptr<CSpuRenderThread> m_spuRenderThread;
+		std::vector<SPU_REGISTER_WRITE> m_spuPendingWrites;
+		std::vector<int16> m_spuSamples;
+		std::vector<int16> m_spuCore1Samples;
 	};
 }
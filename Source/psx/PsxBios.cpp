@@ -153,11 +153,11 @@ void CPsxBios::LoadExe(const uint8* exe)
 	}
 }
 
-void CPsxBios::SaveState(Framework::CZipArchiveWriter& archive)
+void CPsxBios::SaveState(CStateArchiveWriter& archive)
 {
 }
 
-void CPsxBios::LoadState(Framework::CZipArchiveReader& archive)
+void CPsxBios::LoadState(CStateArchiveReader& archive)
 {
 }
 
@@ -40,8 +40,8 @@ public:
 
 	void LoadExe(const uint8*);
 
-	void SaveState(Framework::CZipArchiveWriter&) override;
-	void LoadState(Framework::CZipArchiveReader&) override;
+	void SaveState(CStateArchiveWriter&) override;
+	void LoadState(CStateArchiveReader&) override;
 
 	void NotifyVBlankStart() override;
 	void NotifyVBlankEnd() override;
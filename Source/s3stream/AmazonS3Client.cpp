@@ -139,6 +139,25 @@ CAmazonS3Client::CAmazonS3Client(std::string accessKeyId, std::string secretAcce
 {
 }
 
+void CAmazonS3Client::SetEndpoint(const std::string& endpoint)
+{
+	auto schemeSeparatorPos = endpoint.find("://");
+	if(schemeSeparatorPos == std::string::npos)
+	{
+		m_endpointScheme = "https";
+		m_endpointHost = endpoint;
+	}
+	else
+	{
+		m_endpointScheme = endpoint.substr(0, schemeSeparatorPos);
+		m_endpointHost = endpoint.substr(schemeSeparatorPos + 3);
+	}
+	while(!m_endpointHost.empty() && (m_endpointHost.back() == '/'))
+	{
+		m_endpointHost.pop_back();
+	}
+}
+
 GetBucketLocationResult CAmazonS3Client::GetBucketLocation(const GetBucketLocationRequest& request)
 {
 	Request rq;
@@ -147,6 +166,7 @@ GetBucketLocationResult CAmazonS3Client::GetBucketLocation(const GetBucketLocati
 	rq.urlHost = S3_HOSTNAME;
 	rq.uri = "/";
 	rq.query = "location=";
+	SetupBucketRequest(rq, request.bucket);
 
 	auto response = ExecuteRequest(rq);
 	if(response.statusCode != Framework::Http::HTTP_STATUS_CODE::OK)
@@ -174,6 +194,7 @@ GetObjectResult CAmazonS3Client::GetObject(const GetObjectRequest& request)
 	rq.uri = "/" + Framework::Http::CHttpClient::UrlEncode(request.object);
 	rq.host = string_format("%s.s3-%s.amazonaws.com", request.bucket.c_str(), m_region.c_str());
 	rq.urlHost = rq.host;
+	SetupBucketRequest(rq, request.bucket);
 
 	if(request.range.first != request.range.second)
 	{
@@ -203,6 +224,7 @@ HeadObjectResult CAmazonS3Client::HeadObject(const HeadObjectRequest& request)
 	rq.uri = "/" + Framework::Http::CHttpClient::UrlEncode(request.object);
 	rq.host = string_format("%s.s3-%s.amazonaws.com", request.bucket.c_str(), m_region.c_str());
 	rq.urlHost = rq.host;
+	SetupBucketRequest(rq, request.bucket);
 
 	auto response = ExecuteRequest(rq);
 	if(response.statusCode != Framework::Http::HTTP_STATUS_CODE::OK)
@@ -235,6 +257,7 @@ ListObjectsResult CAmazonS3Client::ListObjects(std::string bucket)
 	rq.uri = "/";
 	rq.host = string_format("%s.s3-%s.amazonaws.com", bucket.c_str(), m_region.c_str());
 	rq.urlHost = rq.host;
+	SetupBucketRequest(rq, bucket);
 
 	auto response = ExecuteRequest(rq);
 	if(response.statusCode != Framework::Http::HTTP_STATUS_CODE::OK)
@@ -259,6 +282,15 @@ ListObjectsResult CAmazonS3Client::ListObjects(std::string bucket)
 	return result;
 }
 
+void CAmazonS3Client::SetupBucketRequest(Request& request, const std::string& bucket) const
+{
+	if(m_endpointHost.empty()) return;
+	//Custom endpoints don't have per bucket hosts, bucket goes in the path
+	request.host = m_endpointHost;
+	request.urlHost = m_endpointHost;
+	request.uri = "/" + bucket + request.uri;
+}
+
 Framework::Http::RequestResult CAmazonS3Client::ExecuteRequest(const Request& request)
 {
 	assert(!m_accessKeyId.empty());
@@ -303,7 +335,7 @@ Framework::Http::RequestResult CAmazonS3Client::ExecuteRequest(const Request& re
 	headers.insert(std::make_pair("Authorization", authorizationString));
 	headers.insert(request.headers.begin(), request.headers.end());
 
-	auto url = string_format("https://%s%s", request.urlHost.c_str(), request.uri.c_str());
+	auto url = string_format("%s://%s%s", m_endpointScheme.c_str(), request.urlHost.c_str(), request.uri.c_str());
 	if(!request.query.empty())
 	{
 		url += "?";
@@ -53,6 +53,10 @@ class CAmazonS3Client
 public:
 	CAmazonS3Client(std::string, std::string, std::string = "us-east-1");
 
+	//Sends requests to an S3 compatible server (ie.: "http://localhost:9000")
+	//using path-style addressing instead of the AWS virtual hosts.
+	void SetEndpoint(const std::string&);
+
 	GetBucketLocationResult GetBucketLocation(const GetBucketLocationRequest&);
 	GetObjectResult GetObject(const GetObjectRequest&);
 	HeadObjectResult HeadObject(const HeadObjectRequest&);
@@ -69,9 +73,12 @@ private:
 		Framework::Http::HeaderMap headers;
 	};
 
+	void SetupBucketRequest(Request&, const std::string&) const;
 	Framework::Http::RequestResult ExecuteRequest(const Request&);
 
 	std::string m_accessKeyId;
 	std::string m_secretAccessKey;
 	std::string m_region;
+	std::string m_endpointScheme = "https";
+	std::string m_endpointHost;
 };
@@ -1,5 +1,7 @@
 #include <cassert>
 #include <cstring>
+#include <algorithm>
+#include <cinttypes>
 #include "S3ObjectStream.h"
 #include "AmazonS3Client.h"
 #include "Singleton.h"
@@ -11,16 +13,27 @@
 
 #define PREF_S3_OBJECTSTREAM_ACCESSKEYID "s3.objectstream.accesskeyid"
 #define PREF_S3_OBJECTSTREAM_SECRETACCESSKEY "s3.objectstream.secretaccesskey"
+#define PREF_S3_OBJECTSTREAM_ENDPOINT "s3.objectstream.endpoint"
 #define CACHE_PATH "Play Data Files/s3objectstream_cache"
 
 #define LOG_NAME "s3objectstream"
 
 #define BUFFERSIZE 0x40000
 
+//Bounds the amount of windows kept in memory (16MB)
+#define MAX_WINDOW_COUNT 64
+//Windows fetched ahead of the read position once a sequential run is detected
+#define PREFETCH_WINDOW_COUNT 8
+//Maximum amount of adjacent windows merged in a single ranged GET
+#define MAX_COALESCED_WINDOW_COUNT 4
+#define FETCH_THREAD_COUNT 4
+#define SEQUENTIAL_THRESHOLD 1
+
 CS3ObjectStream::CConfig::CConfig()
 {
 	CAppConfig::GetInstance().RegisterPreferenceString(PREF_S3_OBJECTSTREAM_ACCESSKEYID, "");
 	CAppConfig::GetInstance().RegisterPreferenceString(PREF_S3_OBJECTSTREAM_SECRETACCESSKEY, "");
+	CAppConfig::GetInstance().RegisterPreferenceString(PREF_S3_OBJECTSTREAM_ENDPOINT, "");
 }
 
 std::string CS3ObjectStream::CConfig::GetAccessKeyId()
@@ -33,13 +46,142 @@ std::string CS3ObjectStream::CConfig::GetSecretAccessKey()
 	return CAppConfig::GetInstance().GetPreferenceString(PREF_S3_OBJECTSTREAM_SECRETACCESSKEY);
 }
 
+std::string CS3ObjectStream::CConfig::GetEndpoint()
+{
+	return CAppConfig::GetInstance().GetPreferenceString(PREF_S3_OBJECTSTREAM_ENDPOINT);
+}
+
+static std::string TrimQuotes(std::string input)
+{
+	if(input.empty()) return input;
+	if(input[0] == '"')
+	{
+		input = std::string(input.begin() + 1, input.end());
+	}
+	if(input.empty()) return input;
+	if(input[input.size() - 1] == '"')
+	{
+		input = std::string(input.begin(), input.end() - 1);
+	}
+	return input;
+}
+
+class CAmazonS3ObjectFetcher : public CS3ObjectStream::CObjectFetcher
+{
+public:
+	CAmazonS3ObjectFetcher(const char* bucketName, const char* objectName)
+	    : m_bucketName(bucketName)
+	    , m_objectName(objectName)
+	    , m_accessKeyId(CS3ObjectStream::CConfig::GetInstance().GetAccessKeyId())
+	    , m_secretAccessKey(CS3ObjectStream::CConfig::GetInstance().GetSecretAccessKey())
+	    , m_endpoint(CS3ObjectStream::CConfig::GetInstance().GetEndpoint())
+	{
+	}
+
+	OBJECT_INFO GetObjectInfo() override
+	{
+		//Obtain bucket region
+		{
+			auto client = CreateClient("us-east-1");
+
+			GetBucketLocationRequest request;
+			request.bucket = m_bucketName;
+
+			auto result = client->GetBucketLocation(request);
+			m_bucketRegion = result.locationConstraint;
+			if(m_bucketRegion.empty() && !m_endpoint.empty())
+			{
+				//S3 compatible servers usually don't report a location
+				m_bucketRegion = "us-east-1";
+			}
+		}
+
+		//Obtain object info
+		{
+			auto client = CreateClient(m_bucketRegion);
+
+			HeadObjectRequest request;
+			request.bucket = m_bucketName;
+			request.object = m_objectName;
+
+			auto objectHeader = client->HeadObject(request);
+
+			OBJECT_INFO objectInfo;
+			objectInfo.size = objectHeader.contentLength;
+			objectInfo.etag = TrimQuotes(objectHeader.etag);
+			return objectInfo;
+		}
+	}
+
+	std::vector<uint8> GetObjectRange(uint64 begin, uint64 end) override
+	{
+		auto client = CreateClient(m_bucketRegion);
+		GetObjectRequest objectRequest;
+		objectRequest.object = m_objectName;
+		objectRequest.bucket = m_bucketName;
+		objectRequest.range = std::make_pair(begin, end);
+		auto objectContent = client->GetObject(objectRequest);
+		return std::move(objectContent.data);
+	}
+
+private:
+	std::unique_ptr<CAmazonS3Client> CreateClient(const std::string& region) const
+	{
+		auto client = std::make_unique<CAmazonS3Client>(m_accessKeyId, m_secretAccessKey, region);
+		if(!m_endpoint.empty())
+		{
+			client->SetEndpoint(m_endpoint);
+		}
+		return client;
+	}
+
+	std::string m_bucketName;
+	std::string m_bucketRegion;
+	std::string m_objectName;
+
+	std::string m_accessKeyId;
+	std::string m_secretAccessKey;
+	std::string m_endpoint;
+};
+
 CS3ObjectStream::CS3ObjectStream(const char* bucketName, const char* objectName)
-    : m_bucketName(bucketName)
-    , m_objectName(objectName)
+    : CS3ObjectStream(std::make_unique<CAmazonS3ObjectFetcher>(bucketName, objectName), FETCH_THREAD_COUNT)
+{
+}
+
+CS3ObjectStream::CS3ObjectStream(ObjectFetcherPtr fetcher, uint32 fetchThreadCount)
+    : m_fetcher(std::move(fetcher))
+{
+	assert(fetchThreadCount != 0);
+	auto objectInfo = m_fetcher->GetObjectInfo();
+	m_objectSize = objectInfo.size;
+	m_objectEtag = objectInfo.etag;
+	if(!m_objectEtag.empty())
+	{
+		Framework::PathUtils::EnsurePathExists(GetCachePath());
+	}
+	for(uint32 i = 0; i < fetchThreadCount; i++)
+	{
+		m_fetchThreads.emplace_back([this]() { FetchThreadProc(); });
+	}
+}
+
+CS3ObjectStream::~CS3ObjectStream()
 {
-	m_buffer.resize(BUFFERSIZE);
-	Framework::PathUtils::EnsurePathExists(GetCachePath());
-	GetObjectInfo();
+	{
+		std::lock_guard<std::mutex> windowLock(m_windowMutex);
+		m_fetchThreadsDone = true;
+	}
+	m_fetchCondition.notify_all();
+	for(auto& fetchThread : m_fetchThreads)
+	{
+		fetchThread.join();
+	}
+
+	CLog::GetInstance().Print(LOG_NAME, "Hits: %" PRIu64 ", misses: %" PRIu64 ", prefetched windows: %" PRIu64 ", windows from disk cache: %" PRIu64 ".\r\n",
+	                          m_stats.hitCount, m_stats.missCount, m_stats.prefetchedWindowCount, m_stats.diskCacheWindowCount);
+	CLog::GetInstance().Print(LOG_NAME, "Requests: %" PRIu64 ", downloaded bytes: %" PRIu64 ".\r\n",
+	                          m_stats.requestCount, m_stats.downloadedBytes);
 }
 
 uint64 CS3ObjectStream::Read(void* buffer, uint64 size)
@@ -51,23 +193,20 @@ uint64 CS3ObjectStream::Read(void* buffer, uint64 size)
 
 	while(adjSize != 0)
 	{
-		//Read if we're inside buffer size
-		if((m_bufferPosition / BUFFERSIZE) == (m_objectPosition / BUFFERSIZE))
+		uint64 windowIndex = m_objectPosition / BUFFERSIZE;
+		if(!m_currentWindow || (m_currentWindow->index != windowIndex))
 		{
-			uint64 bufferOffset = m_objectPosition % BUFFERSIZE;
-			uint64 remainSize = BUFFERSIZE - bufferOffset;
-			assert(remainSize <= BUFFERSIZE);
-			auto copySize = std::min(remainSize, adjSize);
-			assert(copySize <= adjSize);
-			memcpy(outBuffer, m_buffer.data() + bufferOffset, copySize);
-			m_objectPosition += copySize;
-			outBuffer += copySize;
-			adjSize -= copySize;
-		}
-		else
-		{
-			SyncBuffer();
+			m_currentWindow = GetWindow(windowIndex);
 		}
+		uint64 bufferOffset = m_objectPosition % BUFFERSIZE;
+		uint64 remainSize = m_currentWindow->data.size() - bufferOffset;
+		assert(remainSize <= BUFFERSIZE);
+		auto copySize = std::min(remainSize, adjSize);
+		assert(copySize <= adjSize);
+		memcpy(outBuffer, m_currentWindow->data.data() + bufferOffset, copySize);
+		m_objectPosition += copySize;
+		outBuffer += copySize;
+		adjSize -= copySize;
 	}
 
 	assert(m_objectPosition <= m_objectSize);
@@ -111,108 +250,315 @@ fs::path CS3ObjectStream::GetCachePath()
 	return Framework::PathUtils::GetCachePath() / CACHE_PATH;
 }
 
+CS3ObjectStream::STATS CS3ObjectStream::GetStats() const
+{
+	std::lock_guard<std::mutex> windowLock(m_windowMutex);
+	return m_stats;
+}
+
 std::string CS3ObjectStream::GenerateReadCacheKey(const std::pair<uint64, uint64>& range) const
 {
 	return string_format("%s-%llu-%llu", m_objectEtag.c_str(), range.first, range.second);
 }
 
-static std::string TrimQuotes(std::string input)
+std::pair<uint64, uint64> CS3ObjectStream::GetWindowRange(uint64 windowIndex) const
 {
-	if(input.empty()) return input;
-	if(input[0] == '"')
+	uint64 position = windowIndex * BUFFERSIZE;
+	assert(position < m_objectSize);
+	uint64 size = std::min<uint64>(BUFFERSIZE, m_objectSize - position);
+	return std::make_pair(position, position + size - 1);
+}
+
+CS3ObjectStream::WindowPtr CS3ObjectStream::GetWindow(uint64 windowIndex)
+{
+	std::unique_lock<std::mutex> windowLock(m_windowMutex);
+	auto window = FindWindow(windowIndex);
+	if(window)
 	{
-		input = std::string(input.begin() + 1, input.end());
+		m_stats.hitCount++;
+		if(!window->ready && !window->failed)
+		{
+			PromoteFetch(window);
+		}
 	}
-	if(input.empty()) return input;
-	if(input[input.size() - 1] == '"')
+	else
 	{
-		input = std::string(input.begin(), input.end() - 1);
+		window = InsertWindow(windowIndex);
+		QueueFetch(window, true);
+		m_stats.missCount++;
 	}
-	return input;
+	UpdateAccessPattern(windowIndex);
+	m_windowReadyCondition.wait(windowLock, [&]() { return window->ready || window->failed; });
+	if(window->failed)
+	{
+		throw std::runtime_error(string_format("Failed to read object window: %s", window->error.c_str()));
+	}
+	return window;
+}
+
+CS3ObjectStream::WindowPtr CS3ObjectStream::FindWindow(uint64 windowIndex)
+{
+	auto windowIterator = m_windowMap.find(windowIndex);
+	if(windowIterator == std::end(m_windowMap)) return WindowPtr();
+	//Move to front of LRU list
+	m_windows.splice(std::begin(m_windows), m_windows, windowIterator->second);
+	return m_windows.front();
 }
 
-void CS3ObjectStream::GetObjectInfo()
+CS3ObjectStream::WindowPtr CS3ObjectStream::InsertWindow(uint64 windowIndex)
 {
-	//Obtain bucket region
+	assert(m_windowMap.find(windowIndex) == std::end(m_windowMap));
+	if(m_windows.size() >= MAX_WINDOW_COUNT)
 	{
-		CAmazonS3Client client(CConfig::GetInstance().GetAccessKeyId(), CConfig::GetInstance().GetSecretAccessKey());
+		//Windows still in use by a reader or a fetch request stay alive until they're released
+		m_windowMap.erase(m_windows.back()->index);
+		m_windows.pop_back();
+	}
+	auto window = std::make_shared<WINDOW>();
+	window->index = windowIndex;
+	m_windows.push_front(window);
+	m_windowMap[windowIndex] = std::begin(m_windows);
+	return window;
+}
 
-		GetBucketLocationRequest request;
-		request.bucket = m_bucketName;
+void CS3ObjectStream::RemoveWindow(const WindowPtr& window)
+{
+	auto windowIterator = m_windowMap.find(window->index);
+	if(windowIterator == std::end(m_windowMap)) return;
+	if(*windowIterator->second != window) return;
+	m_windows.erase(windowIterator->second);
+	m_windowMap.erase(windowIterator);
+}
 
-		auto result = client.GetBucketLocation(request);
-		m_bucketRegion = result.locationConstraint;
+void CS3ObjectStream::QueueFetch(const WindowPtr& window, bool urgent)
+{
+	if(urgent)
+	{
+		FETCH_REQUEST request;
+		request.windows.push_back(window);
+		request.urgent = true;
+		m_fetchQueue.push_front(std::move(request));
 	}
+	else
+	{
+		//Merge with the previous request if it ends right before this window
+		if(!m_fetchQueue.empty())
+		{
+			auto& lastRequest = m_fetchQueue.back();
+			if(
+			    !lastRequest.urgent &&
+			    (lastRequest.windows.size() < MAX_COALESCED_WINDOW_COUNT) &&
+			    ((lastRequest.windows.back()->index + 1) == window->index))
+			{
+				lastRequest.windows.push_back(window);
+				return;
+			}
+		}
+		FETCH_REQUEST request;
+		request.windows.push_back(window);
+		m_fetchQueue.push_back(std::move(request));
+	}
+	m_fetchCondition.notify_one();
+}
 
-	//Obtain object info
+void CS3ObjectStream::PromoteFetch(const WindowPtr& window)
+{
+	//Window might still be waiting behind other prefetches, the reader needs it now
+	for(auto requestIterator = std::begin(m_fetchQueue); requestIterator != std::end(m_fetchQueue); requestIterator++)
 	{
-		CAmazonS3Client client(CConfig::GetInstance().GetAccessKeyId(), CConfig::GetInstance().GetSecretAccessKey(), m_bucketRegion);
+		auto& request = *requestIterator;
+		auto windowIterator = std::find(std::begin(request.windows), std::end(request.windows), window);
+		if(windowIterator == std::end(request.windows)) continue;
+		if(request.urgent) return;
+		request.windows.erase(windowIterator);
+		if(request.windows.empty())
+		{
+			m_fetchQueue.erase(requestIterator);
+		}
+		QueueFetch(window, true);
+		return;
+	}
+}
 
-		HeadObjectRequest request;
-		request.bucket = m_bucketName;
-		request.object = m_objectName;
+void CS3ObjectStream::UpdateAccessPattern(uint64 windowIndex)
+{
+	if(windowIndex == (m_lastWindowIndex + 1))
+	{
+		m_sequentialCount++;
+	}
+	else if(windowIndex != m_lastWindowIndex)
+	{
+		m_sequentialCount = 0;
+	}
+	m_lastWindowIndex = windowIndex;
+
+	if(m_sequentialCount < SEQUENTIAL_THRESHOLD) return;
 
-		auto objectHeader = client.HeadObject(request);
-		m_objectSize = objectHeader.contentLength;
-		m_objectEtag = TrimQuotes(objectHeader.etag);
+	uint64 windowCount = (m_objectSize + BUFFERSIZE - 1) / BUFFERSIZE;
+	for(uint64 i = 1; i <= PREFETCH_WINDOW_COUNT; i++)
+	{
+		uint64 prefetchIndex = windowIndex + i;
+		if(prefetchIndex >= windowCount) break;
+		if(m_windowMap.find(prefetchIndex) != std::end(m_windowMap)) continue;
+		QueueFetch(InsertWindow(prefetchIndex), false);
 	}
 }
 
-void CS3ObjectStream::SyncBuffer()
+void CS3ObjectStream::FetchThreadProc()
 {
-	m_bufferPosition = (m_objectPosition / BUFFERSIZE) * BUFFERSIZE;
+	while(1)
+	{
+		FETCH_REQUEST request;
+		{
+			std::unique_lock<std::mutex> windowLock(m_windowMutex);
+			m_fetchCondition.wait(windowLock, [this]() { return m_fetchThreadsDone || !m_fetchQueue.empty(); });
+			if(m_fetchThreadsDone) break;
+			request = std::move(m_fetchQueue.front());
+			m_fetchQueue.pop_front();
+		}
+		FetchWindows(request);
+	}
+}
 
-	uint64 size = std::min<uint64>(BUFFERSIZE, m_objectSize - m_bufferPosition);
-	auto range = std::make_pair(m_bufferPosition, m_bufferPosition + size - 1);
-	auto readCacheFilePath = GetCachePath() / GenerateReadCacheKey(range);
+void CS3ObjectStream::FetchWindows(const FETCH_REQUEST& request)
+{
+	//Windows that are already in the disk cache are completed right away,
+	//the remaining ones are fetched in runs of adjacent windows
+	std::vector<WindowPtr> missingWindows;
+	for(const auto& window : request.windows)
+	{
+		if(ReadCachedWindow(window))
+		{
+			CompleteWindow(window, nullptr);
+		}
+		else
+		{
+			missingWindows.push_back(window);
+		}
+	}
+
+	auto runBegin = std::begin(missingWindows);
+	while(runBegin != std::end(missingWindows))
+	{
+		auto runEnd = std::next(runBegin);
+		while((runEnd != std::end(missingWindows)) && ((*runEnd)->index == ((*std::prev(runEnd))->index + 1)))
+		{
+			runEnd++;
+		}
+
+		auto range = std::make_pair(GetWindowRange((*runBegin)->index).first, GetWindowRange((*std::prev(runEnd))->index).second);
+		uint64 size = range.second - range.first + 1;
 
 #ifdef _TRACEGET
-	static FILE* output = fopen("getobject.log", "wb");
-	fprintf(output, "%ld,%ld,%ld\r\n", range.first, range.second, size);
-	fflush(output);
+		static FILE* output = fopen("getobject.log", "wb");
+		fprintf(output, "%ld,%ld,%ld\r\n", range.first, range.second, size);
+		fflush(output);
 #endif
 
-	bool cachedReadSucceeded =
-	    [&]() {
-		    try
-		    {
-			    if(fs::exists(readCacheFilePath))
-			    {
-				    auto readCacheFileStream = Framework::CreateInputStdStream(readCacheFilePath.native());
-				    auto cacheRead = readCacheFileStream.Read(m_buffer.data(), size);
-				    assert(cacheRead == size);
-				    return true;
-			    }
-		    }
-		    catch(const std::exception& exception)
-		    {
-			    //Not a problem if we failed to read cache
-			    CLog::GetInstance().Print(LOG_NAME, "Failed to read cache: '%s'.\r\n", exception.what());
-		    }
-		    return false;
-	    }();
-
-	if(!cachedReadSucceeded)
-	{
-		assert(size > 0);
-		CAmazonS3Client client(CConfig::GetInstance().GetAccessKeyId(), CConfig::GetInstance().GetSecretAccessKey(), m_bucketRegion);
-		GetObjectRequest request;
-		request.object = m_objectName;
-		request.bucket = m_bucketName;
-		request.range = range;
-		auto objectContent = client.GetObject(request);
-		assert(objectContent.data.size() == size);
-		memcpy(m_buffer.data(), objectContent.data.data(), size);
-
 		try
 		{
-			auto readCacheFileStream = Framework::CreateOutputStdStream(readCacheFilePath.native());
-			readCacheFileStream.Write(objectContent.data.data(), size);
+			auto objectData = m_fetcher->GetObjectRange(range.first, range.second);
+			if(objectData.size() != size)
+			{
+				throw std::runtime_error(string_format("Received %" PRIu64 " bytes, expected %" PRIu64 ".", static_cast<uint64>(objectData.size()), size));
+			}
+
+			{
+				std::lock_guard<std::mutex> windowLock(m_windowMutex);
+				m_stats.requestCount++;
+				m_stats.downloadedBytes += size;
+			}
+
+			for(auto windowIterator = runBegin; windowIterator != runEnd; windowIterator++)
+			{
+				const auto& window = *windowIterator;
+				auto windowRange = GetWindowRange(window->index);
+				auto windowData = objectData.data() + (windowRange.first - range.first);
+				window->data.assign(windowData, windowData + (windowRange.second - windowRange.first + 1));
+				WriteCachedWindow(window);
+				CompleteWindow(window, nullptr);
+			}
 		}
 		catch(const std::exception& exception)
 		{
-			//Not a problem if we failed to write cache
-			CLog::GetInstance().Print(LOG_NAME, "Failed to write cache: '%s'.\r\n", exception.what());
+			CLog::GetInstance().Warn(LOG_NAME, "Failed to get object range %" PRIu64 "-%" PRIu64 ": '%s'.\r\n", range.first, range.second, exception.what());
+			for(auto windowIterator = runBegin; windowIterator != runEnd; windowIterator++)
+			{
+				CompleteWindow(*windowIterator, exception.what());
+			}
+		}
+
+		runBegin = runEnd;
+	}
+
+	if(!request.urgent)
+	{
+		std::lock_guard<std::mutex> windowLock(m_windowMutex);
+		m_stats.prefetchedWindowCount += request.windows.size();
+	}
+}
+
+bool CS3ObjectStream::ReadCachedWindow(const WindowPtr& window)
+{
+	if(m_objectEtag.empty()) return false;
+	auto range = GetWindowRange(window->index);
+	uint64 size = range.second - range.first + 1;
+	auto readCacheFilePath = GetCachePath() / GenerateReadCacheKey(range);
+	try
+	{
+		if(fs::exists(readCacheFilePath))
+		{
+			auto readCacheFileStream = Framework::CreateInputStdStream(readCacheFilePath.native());
+			window->data.resize(size);
+			auto cacheRead = readCacheFileStream.Read(window->data.data(), size);
+			if(cacheRead == size)
+			{
+				std::lock_guard<std::mutex> windowLock(m_windowMutex);
+				m_stats.diskCacheWindowCount++;
+				return true;
+			}
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		//Not a problem if we failed to read cache
+		CLog::GetInstance().Print(LOG_NAME, "Failed to read cache: '%s'.\r\n", exception.what());
+	}
+	return false;
+}
+
+void CS3ObjectStream::WriteCachedWindow(const WindowPtr& window)
+{
+	if(m_objectEtag.empty()) return;
+	auto range = GetWindowRange(window->index);
+	auto readCacheFilePath = GetCachePath() / GenerateReadCacheKey(range);
+	try
+	{
+		auto readCacheFileStream = Framework::CreateOutputStdStream(readCacheFilePath.native());
+		readCacheFileStream.Write(window->data.data(), window->data.size());
+	}
+	catch(const std::exception& exception)
+	{
+		//Not a problem if we failed to write cache
+		CLog::GetInstance().Print(LOG_NAME, "Failed to write cache: '%s'.\r\n", exception.what());
+	}
+}
+
+void CS3ObjectStream::CompleteWindow(const WindowPtr& window, const char* error)
+{
+	{
+		std::lock_guard<std::mutex> windowLock(m_windowMutex);
+		if(error)
+		{
+			window->failed = true;
+			window->error = error;
+			//Allow a later read to try again
+			RemoveWindow(window);
+		}
+		else
+		{
+			window->ready = true;
 		}
 	}
+	m_windowReadyCondition.notify_all();
 }
@@ -1,6 +1,13 @@
 #pragma once
 
 #include <vector>
+#include <list>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "Singleton.h"
 #include "Stream.h"
 #include "filesystem_def.h"
@@ -14,9 +21,41 @@ public:
 		CConfig();
 		std::string GetAccessKeyId();
 		std::string GetSecretAccessKey();
+		std::string GetEndpoint();
+	};
+
+	//Provides the object's contents, the stream takes care of windowing, prefetching and caching
+	class CObjectFetcher
+	{
+	public:
+		struct OBJECT_INFO
+		{
+			uint64 size = 0;
+			//Windows are only cached on disk when the object has an etag
+			std::string etag;
+		};
+
+		virtual ~CObjectFetcher() = default;
+
+		virtual OBJECT_INFO GetObjectInfo() = 0;
+		//Called concurrently by fetch threads, range is inclusive
+		virtual std::vector<uint8> GetObjectRange(uint64, uint64) = 0;
+	};
+	typedef std::unique_ptr<CObjectFetcher> ObjectFetcherPtr;
+
+	struct STATS
+	{
+		uint64 hitCount = 0;
+		uint64 missCount = 0;
+		uint64 prefetchedWindowCount = 0;
+		uint64 diskCacheWindowCount = 0;
+		uint64 requestCount = 0;
+		uint64 downloadedBytes = 0;
 	};
 
 	CS3ObjectStream(const char*, const char*);
+	CS3ObjectStream(ObjectFetcherPtr, uint32);
+	virtual ~CS3ObjectStream();
 
 	uint64 Read(void*, uint64) override;
 	uint64 Write(const void*, uint64) override;
@@ -24,15 +63,47 @@ public:
 	uint64 Tell() override;
 	bool IsEOF() override;
 
+	STATS GetStats() const;
+
 private:
+	struct WINDOW
+	{
+		uint64 index = 0;
+		std::vector<uint8> data;
+		bool ready = false;
+		bool failed = false;
+		std::string error;
+	};
+	typedef std::shared_ptr<WINDOW> WindowPtr;
+	typedef std::list<WindowPtr> WindowList;
+	typedef std::unordered_map<uint64, WindowList::iterator> WindowMap;
+
+	//Contiguous windows fetched by a single ranged GET
+	struct FETCH_REQUEST
+	{
+		std::vector<WindowPtr> windows;
+		bool urgent = false;
+	};
+
 	static fs::path GetCachePath();
 	std::string GenerateReadCacheKey(const std::pair<uint64, uint64>&) const;
-	void GetObjectInfo();
-	void SyncBuffer();
+	std::pair<uint64, uint64> GetWindowRange(uint64) const;
 
-	std::string m_bucketName;
-	std::string m_bucketRegion;
-	std::string m_objectName;
+	WindowPtr GetWindow(uint64);
+	WindowPtr FindWindow(uint64);
+	WindowPtr InsertWindow(uint64);
+	void RemoveWindow(const WindowPtr&);
+	void QueueFetch(const WindowPtr&, bool);
+	void PromoteFetch(const WindowPtr&);
+	void UpdateAccessPattern(uint64);
+
+	void FetchThreadProc();
+	void FetchWindows(const FETCH_REQUEST&);
+	bool ReadCachedWindow(const WindowPtr&);
+	void WriteCachedWindow(const WindowPtr&);
+	void CompleteWindow(const WindowPtr&, const char*);
+
+	ObjectFetcherPtr m_fetcher;
 
 	//Object Metadata
 	uint64 m_objectSize = 0;
@@ -40,6 +111,19 @@ private:
 
 	uint64 m_objectPosition = 0;
 
-	std::vector<uint8> m_buffer;
-	uint64 m_bufferPosition = ~0ULL;
+	WindowPtr m_currentWindow;
+
+	mutable std::mutex m_windowMutex;
+	WindowList m_windows;
+	WindowMap m_windowMap;
+	std::condition_variable m_windowReadyCondition;
+	STATS m_stats;
+
+	uint64 m_lastWindowIndex = ~0ULL;
+	uint32 m_sequentialCount = 0;
+
+	std::deque<FETCH_REQUEST> m_fetchQueue;
+	std::condition_variable m_fetchCondition;
+	std::vector<std::thread> m_fetchThreads;
+	bool m_fetchThreadsDone = false;
 };
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include "QuickState.h"
+#include "MemStream.h"
+#include "PtrStream.h"
+#include "RegisterStateFile.h"
+#include "StructCollectionStateFile.h"
+
+bool CQuickState::IsValid() const
+{
+	return m_valid;
+}
+
+void CQuickState::BeginSave()
+{
+	assert(!m_archiveWriter && !m_archiveReader);
+	m_valid = false;
+	m_blockIndex = 0;
+	m_archive.clear();
+	m_archiveWriter = std::make_unique<CArchiveWriter>(m_archive);
+}
+
+void CQuickState::EndSave()
+{
+	assert(m_archiveWriter);
+	m_archiveWriter.reset();
+	//Keep the allocated blocks and archive around, they will be reused by the next save
+	assert(m_blockIndex <= m_blocks.size());
+	m_valid = true;
+}
+
+void CQuickState::BeginLoad()
+{
+	assert(m_valid);
+	assert(!m_archiveWriter && !m_archiveReader);
+	m_blockIndex = 0;
+	m_archiveReader = std::make_unique<CArchiveReader>(m_archive);
+}
+
+void CQuickState::EndLoad()
+{
+	assert(m_archiveReader);
+	m_archiveReader.reset();
+}
+
+void CQuickState::SaveMemory(const void* memory, size_t size)
+{
+	assert(m_archiveWriter);
+	if(m_blockIndex == m_blocks.size())
+	{
+		m_blocks.emplace_back();
+	}
+	auto& block = m_blocks[m_blockIndex++];
+	block.resize(size);
+	memcpy(block.data(), memory, size);
+}
+
+void CQuickState::LoadMemory(void* memory, size_t size)
+{
+	const auto& block = GetNextBlock(size);
+	memcpy(memory, block.data(), size);
+}
+
+void CQuickState::LoadMemory(void* memory, size_t size, size_t pageSize, const RangeChangedCallback& rangeChangedCallback)
+{
+	//Only write back pages that have been modified since the snapshot was taken.
+	//This avoids touching pages that are watched by something else (ie.: pages
+	//write protected by the EE executor) and lets callers know which ranges changed.
+	const auto& block = GetNextBlock(size);
+	auto dst = reinterpret_cast<uint8*>(memory);
+	auto src = block.data();
+	for(size_t offset = 0; offset < size; offset += pageSize)
+	{
+		size_t copySize = std::min<size_t>(pageSize, size - offset);
+		if(memcmp(dst + offset, src + offset, copySize) == 0) continue;
+		rangeChangedCallback(offset, copySize);
+		memcpy(dst + offset, src + offset, copySize);
+	}
+}
+
+CStateArchiveWriter& CQuickState::GetArchiveWriter()
+{
+	assert(m_archiveWriter);
+	return *m_archiveWriter;
+}
+
+CStateArchiveReader& CQuickState::GetArchiveReader()
+{
+	assert(m_archiveReader);
+	return *m_archiveReader;
+}
+
+const CQuickState::MemoryBlock& CQuickState::GetNextBlock(size_t size)
+{
+	assert(m_archiveReader);
+	if(m_blockIndex == m_blocks.size())
+	{
+		throw std::runtime_error("Quick state doesn't contain enough memory blocks.");
+	}
+	const auto& block = m_blocks[m_blockIndex++];
+	if(block.size() != size)
+	{
+		throw std::runtime_error("Quick state memory block size mismatch.");
+	}
+	return block;
+}
+
+CQuickState::CArchiveWriter::CArchiveWriter(MemoryBlock& archive)
+    : m_archive(archive)
+{
+}
+
+void CQuickState::CArchiveWriter::InsertFile(Framework::CZipFile* filePtr)
+{
+	auto file = std::unique_ptr<Framework::CZipFile>(filePtr);
+
+	//Register files are stored in binary form instead of going through XML
+	Framework::CMemStream fileStream;
+	if(auto registerFile = dynamic_cast<CRegisterStateFile*>(file.get()))
+	{
+		registerFile->WriteBinary(fileStream);
+	}
+	else if(auto structCollectionFile = dynamic_cast<CStructCollectionStateFile*>(file.get()))
+	{
+		structCollectionFile->WriteBinary(fileStream);
+	}
+	else
+	{
+		file->Write(fileStream);
+	}
+
+	std::string name = file->GetName();
+	uint32 nameSize = static_cast<uint32>(name.size());
+	uint32 dataSize = static_cast<uint32>(fileStream.GetSize());
+	size_t offset = m_archive.size();
+	m_archive.resize(offset + sizeof(uint32) + nameSize + sizeof(uint32) + dataSize);
+	auto output = m_archive.data() + offset;
+	memcpy(output, &nameSize, sizeof(uint32));
+	output += sizeof(uint32);
+	memcpy(output, name.data(), nameSize);
+	output += nameSize;
+	memcpy(output, &dataSize, sizeof(uint32));
+	output += sizeof(uint32);
+	memcpy(output, fileStream.GetBuffer(), dataSize);
+}
+
+CQuickState::CArchiveReader::CArchiveReader(const MemoryBlock& archive)
+{
+	auto input = archive.data();
+	size_t remainingSize = archive.size();
+	auto readSize =
+	    [&]() {
+		    if(remainingSize < sizeof(uint32))
+		    {
+			    throw std::runtime_error("Quick state archive is truncated.");
+		    }
+		    uint32 size = 0;
+		    memcpy(&size, input, sizeof(uint32));
+		    input += sizeof(uint32);
+		    remainingSize -= sizeof(uint32);
+		    if(remainingSize < size)
+		    {
+			    throw std::runtime_error("Quick state archive is truncated.");
+		    }
+		    return size;
+	    };
+	while(remainingSize != 0)
+	{
+		FILEINFO file;
+		file.nameSize = readSize();
+		file.name = reinterpret_cast<const char*>(input);
+		input += file.nameSize;
+		remainingSize -= file.nameSize;
+		file.size = readSize();
+		file.data = input;
+		input += file.size;
+		remainingSize -= file.size;
+		m_files.push_back(file);
+	}
+}
+
+CStateArchiveReader::StreamPtr CQuickState::CArchiveReader::BeginReadFile(const char* fileName)
+{
+	//Files are mostly read back in the order they were written, start looking after the last one
+	size_t nameSize = strlen(fileName);
+	for(size_t i = 0; i < m_files.size(); i++)
+	{
+		size_t fileIndex = (m_nextFileIndex + i) % m_files.size();
+		const auto& file = m_files[fileIndex];
+		if((file.nameSize != nameSize) || (memcmp(file.name, fileName, nameSize) != 0)) continue;
+		m_nextFileIndex = fileIndex + 1;
+		return std::make_unique<Framework::CPtrStream>(file.data, file.size);
+	}
+	throw std::runtime_error(std::string("Quick state archive doesn't contain '") + fileName + "'.");
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <functional>
+#include "Types.h"
+#include "StateArchive.h"
+
+//In-memory machine snapshot used for features that need to save and restore
+//state every frame (ie.: run-ahead). Memory blocks are copied as is and must be
+//loaded back in the same order they were saved. Small device states go through
+//a flat archive where files are stored one after the other in binary form.
+class CQuickState
+{
+public:
+	typedef std::function<void(size_t, size_t)> RangeChangedCallback;
+
+	bool IsValid() const;
+
+	void BeginSave();
+	void EndSave();
+
+	void BeginLoad();
+	void EndLoad();
+
+	void SaveMemory(const void*, size_t);
+	void LoadMemory(void*, size_t);
+	void LoadMemory(void*, size_t, size_t, const RangeChangedCallback&);
+
+	CStateArchiveWriter& GetArchiveWriter();
+	CStateArchiveReader& GetArchiveReader();
+
+private:
+	friend class CQuickStateFile;
+
+	typedef std::vector<uint8> MemoryBlock;
+	typedef std::vector<MemoryBlock> MemoryBlockArray;
+
+	//Each file is stored as its name size, its name, its data size and its data
+	class CArchiveWriter : public CStateArchiveWriter
+	{
+	public:
+		CArchiveWriter(MemoryBlock&);
+
+		void InsertFile(Framework::CZipFile*) override;
+
+	private:
+		MemoryBlock& m_archive;
+	};
+
+	class CArchiveReader : public CStateArchiveReader
+	{
+	public:
+		CArchiveReader(const MemoryBlock&);
+
+		StreamPtr BeginReadFile(const char*) override;
+
+	private:
+		struct FILEINFO
+		{
+			const char* name = nullptr;
+			uint32 nameSize = 0;
+			const uint8* data = nullptr;
+			uint32 size = 0;
+		};
+		typedef std::vector<FILEINFO> FileArray;
+
+		FileArray m_files;
+		size_t m_nextFileIndex = 0;
+	};
+
+	const MemoryBlock& GetNextBlock(size_t);
+
+	MemoryBlockArray m_blocks;
+	unsigned int m_blockIndex = 0;
+	bool m_valid = false;
+
+	MemoryBlock m_archive;
+	std::unique_ptr<CArchiveWriter> m_archiveWriter;
+	std::unique_ptr<CArchiveReader> m_archiveReader;
+};
@@ -0,0 +1,340 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <zlib.h>
+#ifdef HAS_ZSTD
+#include <zstd.h>
+#endif
+#include "ThreadPool.h"
+#include "QuickStateFile.h"
+
+//The archive containing device states is stored as an extra block after the memory blocks
+
+//Chunks are compressed with zstd when it's available, files using deflate can always be read
+#ifdef HAS_ZSTD
+#define QUICKSTATE_COMPRESSION COMPRESSION_ZSTD
+#else
+#define QUICKSTATE_COMPRESSION COMPRESSION_DEFLATE
+#endif
+
+static void Store32(uint8* bytes, uint32 value)
+{
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		bytes[i] = static_cast<uint8>(value >> (i * 8));
+	}
+}
+
+static uint32 Load32(const uint8* bytes)
+{
+	uint32 value = 0;
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		value |= static_cast<uint32>(bytes[i]) << (i * 8);
+	}
+	return value;
+}
+
+bool CQuickStateFile::IsQuickStateFile(Framework::CStream& stream)
+{
+	auto position = stream.Tell();
+	uint8 magic[4] = {};
+	auto readSize = stream.Read(magic, sizeof(magic));
+	stream.Seek(position, Framework::STREAM_SEEK_DIRECTION::STREAM_SEEK_SET);
+	return (readSize == sizeof(magic)) && (Load32(magic) == MAGIC);
+}
+
+void CQuickStateFile::Write(Framework::CStream& stream, const CQuickState& state)
+{
+	assert(state.IsValid());
+
+	std::vector<CQuickState::MemoryBlock*> blocks;
+	for(unsigned int i = 0; i < state.m_blockIndex; i++)
+	{
+		blocks.push_back(const_cast<CQuickState::MemoryBlock*>(&state.m_blocks[i]));
+	}
+	blocks.push_back(const_cast<CQuickState::MemoryBlock*>(&state.m_archive));
+
+	auto chunks = MakeChunks(blocks);
+
+	{
+		Framework::CThreadPool threadPool(std::max<unsigned int>(std::thread::hardware_concurrency(), 1));
+		for(auto& chunk : chunks)
+		{
+			threadPool.Enqueue(
+			    [&chunk]() {
+				    CompressChunk(chunk, QUICKSTATE_COMPRESSION);
+			    });
+		}
+	}
+
+	HEADER header = {};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.compression = QUICKSTATE_COMPRESSION;
+	header.chunkSize = CHUNK_SIZE;
+	header.blockCount = static_cast<uint32>(blocks.size());
+	header.chunkCount = static_cast<uint32>(chunks.size());
+	WriteHeader(stream, header);
+
+	std::vector<uint32> blockSizes;
+	for(const auto& block : blocks)
+	{
+		blockSizes.push_back(static_cast<uint32>(block->size()));
+	}
+	WriteSizes(stream, blockSizes);
+
+	std::vector<uint32> chunkSizes;
+	for(const auto& chunk : chunks)
+	{
+		chunkSizes.push_back(static_cast<uint32>(chunk.compressedData.size()));
+	}
+	WriteSizes(stream, chunkSizes);
+
+	for(const auto& chunk : chunks)
+	{
+		stream.Write(chunk.compressedData.data(), chunk.compressedData.size());
+	}
+}
+
+void CQuickStateFile::Read(Framework::CStream& stream, CQuickState& state)
+{
+	auto header = ReadHeader(stream);
+	if(header.magic != MAGIC)
+	{
+		throw std::runtime_error("Not a quick state file.");
+	}
+	if(header.version != VERSION)
+	{
+		throw std::runtime_error("Unsupported quick state file version.");
+	}
+	if((header.chunkSize != CHUNK_SIZE) || (header.blockCount == 0))
+	{
+		throw std::runtime_error("Invalid quick state file header.");
+	}
+	switch(header.compression)
+	{
+	case COMPRESSION_DEFLATE:
+		break;
+	case COMPRESSION_ZSTD:
+#ifdef HAS_ZSTD
+		break;
+#else
+		throw std::runtime_error("Quick state file requires zstd support.");
+#endif
+	default:
+		throw std::runtime_error("Invalid quick state file compression.");
+	}
+
+	//Sizes are validated against what's left in the stream before allocating anything
+	uint64 remainingSize = stream.GetLength() - stream.Tell();
+	if((static_cast<uint64>(header.blockCount) + header.chunkCount) * 4 > remainingSize)
+	{
+		throw std::runtime_error("Quick state file is truncated.");
+	}
+	remainingSize -= (static_cast<uint64>(header.blockCount) + header.chunkCount) * 4;
+
+	uint32 memoryBlockCount = header.blockCount - 1;
+
+	auto blockSizes = ReadSizes(stream, header.blockCount);
+	auto chunkSizes = ReadSizes(stream, header.chunkCount);
+
+	std::vector<CQuickState::MemoryBlock*> blocks;
+	state.m_blocks.resize(memoryBlockCount);
+	for(uint32 i = 0; i < header.blockCount; i++)
+	{
+		auto block = (i == memoryBlockCount) ? &state.m_archive : &state.m_blocks[i];
+		uint32 blockSize = blockSizes[i];
+		if(blockSize > MAX_BLOCK_SIZE)
+		{
+			throw std::runtime_error("Invalid quick state file block size.");
+		}
+		block->resize(blockSize);
+		blocks.push_back(block);
+	}
+
+	auto chunks = MakeChunks(blocks);
+	if(chunks.size() != header.chunkCount)
+	{
+		throw std::runtime_error("Quick state file chunk count mismatch.");
+	}
+
+	for(uint32 i = 0; i < header.chunkCount; i++)
+	{
+		//Chunks that don't compress are stored as is, compressed data is never bigger than the chunk
+		auto& chunk = chunks[i];
+		uint32 compressedSize = chunkSizes[i];
+		if((compressedSize > chunk.size) || (compressedSize > remainingSize))
+		{
+			throw std::runtime_error("Invalid quick state file chunk size.");
+		}
+		remainingSize -= compressedSize;
+		chunk.compressedData.resize(compressedSize);
+	}
+
+	//Chunks are read sequentially from the stream, but inflated in parallel
+	std::atomic<bool> failed(false);
+	{
+		Framework::CThreadPool threadPool(std::max<unsigned int>(std::thread::hardware_concurrency(), 1));
+		for(auto& chunk : chunks)
+		{
+			uint32 compressedSize = static_cast<uint32>(chunk.compressedData.size());
+			if(stream.Read(chunk.compressedData.data(), compressedSize) != compressedSize)
+			{
+				failed = true;
+				break;
+			}
+			uint32 compression = header.compression;
+			threadPool.Enqueue(
+			    [&chunk, &failed, compression]() {
+				    if(!DecompressChunk(chunk, compression))
+				    {
+					    failed = true;
+				    }
+			    });
+		}
+	}
+
+	if(failed)
+	{
+		state.m_valid = false;
+		throw std::runtime_error("Failed to read quick state file data.");
+	}
+
+	state.m_blockIndex = memoryBlockCount;
+	state.m_valid = true;
+}
+
+void CQuickStateFile::WriteHeader(Framework::CStream& stream, const HEADER& header)
+{
+	uint8 bytes[HEADER_SIZE];
+	Store32(bytes + 0x00, header.magic);
+	Store32(bytes + 0x04, header.version);
+	Store32(bytes + 0x08, header.compression);
+	Store32(bytes + 0x0C, header.chunkSize);
+	Store32(bytes + 0x10, header.blockCount);
+	Store32(bytes + 0x14, header.chunkCount);
+	stream.Write(bytes, HEADER_SIZE);
+}
+
+CQuickStateFile::HEADER CQuickStateFile::ReadHeader(Framework::CStream& stream)
+{
+	uint8 bytes[HEADER_SIZE];
+	if(stream.Read(bytes, HEADER_SIZE) != HEADER_SIZE)
+	{
+		throw std::runtime_error("Quick state file is truncated.");
+	}
+	HEADER header;
+	header.magic = Load32(bytes + 0x00);
+	header.version = Load32(bytes + 0x04);
+	header.compression = Load32(bytes + 0x08);
+	header.chunkSize = Load32(bytes + 0x0C);
+	header.blockCount = Load32(bytes + 0x10);
+	header.chunkCount = Load32(bytes + 0x14);
+	return header;
+}
+
+void CQuickStateFile::WriteSizes(Framework::CStream& stream, const std::vector<uint32>& sizes)
+{
+	std::vector<uint8> bytes(sizes.size() * 4);
+	for(size_t i = 0; i < sizes.size(); i++)
+	{
+		Store32(bytes.data() + (i * 4), sizes[i]);
+	}
+	stream.Write(bytes.data(), bytes.size());
+}
+
+std::vector<uint32> CQuickStateFile::ReadSizes(Framework::CStream& stream, uint32 count)
+{
+	std::vector<uint8> bytes(static_cast<size_t>(count) * 4);
+	if(stream.Read(bytes.data(), bytes.size()) != bytes.size())
+	{
+		throw std::runtime_error("Quick state file is truncated.");
+	}
+	std::vector<uint32> sizes(count);
+	for(size_t i = 0; i < sizes.size(); i++)
+	{
+		sizes[i] = Load32(bytes.data() + (i * 4));
+	}
+	return sizes;
+}
+
+void CQuickStateFile::CompressChunk(CHUNK& chunk, uint32 compression)
+{
+	size_t compressedSize = 0;
+	bool succeeded = false;
+	switch(compression)
+	{
+	case COMPRESSION_DEFLATE:
+	{
+		uLongf deflateSize = compressBound(chunk.size);
+		chunk.compressedData.resize(deflateSize);
+		succeeded = (compress2(chunk.compressedData.data(), &deflateSize, chunk.data, chunk.size, Z_BEST_SPEED) == Z_OK);
+		compressedSize = deflateSize;
+	}
+	break;
+#ifdef HAS_ZSTD
+	case COMPRESSION_ZSTD:
+		chunk.compressedData.resize(ZSTD_compressBound(chunk.size));
+		compressedSize = ZSTD_compress(chunk.compressedData.data(), chunk.compressedData.size(), chunk.data, chunk.size, 1);
+		succeeded = !ZSTD_isError(compressedSize);
+		break;
+#endif
+	}
+	if(!succeeded || (compressedSize >= chunk.size))
+	{
+		//Store chunk as is if it can't be compressed
+		chunk.compressedData.assign(chunk.data, chunk.data + chunk.size);
+	}
+	else
+	{
+		chunk.compressedData.resize(compressedSize);
+	}
+}
+
+bool CQuickStateFile::DecompressChunk(CHUNK& chunk, uint32 compression)
+{
+	if(chunk.compressedData.size() == chunk.size)
+	{
+		memcpy(chunk.data, chunk.compressedData.data(), chunk.size);
+		return true;
+	}
+	switch(compression)
+	{
+	case COMPRESSION_DEFLATE:
+	{
+		uLongf size = chunk.size;
+		int result = uncompress(chunk.data, &size, chunk.compressedData.data(), static_cast<uLong>(chunk.compressedData.size()));
+		return (result == Z_OK) && (size == chunk.size);
+	}
+#ifdef HAS_ZSTD
+	case COMPRESSION_ZSTD:
+	{
+		size_t size = ZSTD_decompress(chunk.data, chunk.size, chunk.compressedData.data(), chunk.compressedData.size());
+		return !ZSTD_isError(size) && (size == chunk.size);
+	}
+#endif
+	default:
+		return false;
+	}
+}
+
+CQuickStateFile::ChunkArray CQuickStateFile::MakeChunks(std::vector<CQuickState::MemoryBlock*>& blocks)
+{
+	ChunkArray chunks;
+	for(auto& block : blocks)
+	{
+		uint32 blockSize = static_cast<uint32>(block->size());
+		for(uint32 offset = 0; offset < blockSize; offset += CHUNK_SIZE)
+		{
+			CHUNK chunk;
+			chunk.data = block->data() + offset;
+			chunk.size = std::min<uint32>(CHUNK_SIZE, blockSize - offset);
+			chunks.push_back(std::move(chunk));
+		}
+	}
+	return chunks;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Stream.h"
+#include "QuickState.h"
+
+//Versioned binary container for quick states. Memory blocks are split in chunks
+//that are compressed independently, which allows them to be compressed and
+//decompressed in parallel. All values are stored little-endian.
+class CQuickStateFile
+{
+public:
+	static bool IsQuickStateFile(Framework::CStream&);
+
+	static void Write(Framework::CStream&, const CQuickState&);
+	static void Read(Framework::CStream&, CQuickState&);
+
+private:
+	enum
+	{
+		MAGIC = 0x54535350, //'PSST'
+		VERSION = 2,
+		CHUNK_SIZE = 0x100000,
+		//Largest block is EE RAM, anything bigger comes from a corrupted file
+		MAX_BLOCK_SIZE = 0x4000000,
+		HEADER_SIZE = 0x18,
+	};
+
+	enum COMPRESSION
+	{
+		COMPRESSION_NONE = 0,
+		COMPRESSION_DEFLATE = 1,
+		COMPRESSION_ZSTD = 2,
+	};
+
+	struct HEADER
+	{
+		uint32 magic;
+		uint32 version;
+		uint32 compression;
+		uint32 chunkSize;
+		uint32 blockCount;
+		uint32 chunkCount;
+	};
+
+	struct CHUNK
+	{
+		uint8* data = nullptr;
+		uint32 size = 0;
+		std::vector<uint8> compressedData;
+	};
+	typedef std::vector<CHUNK> ChunkArray;
+
+	static void WriteHeader(Framework::CStream&, const HEADER&);
+	static HEADER ReadHeader(Framework::CStream&);
+
+	static void WriteSizes(Framework::CStream&, const std::vector<uint32>&);
+	static std::vector<uint32> ReadSizes(Framework::CStream&, uint32);
+
+	static void CompressChunk(CHUNK&, uint32);
+	static bool DecompressChunk(CHUNK&, uint32);
+
+	static ChunkArray MakeChunks(std::vector<CQuickState::MemoryBlock*>&);
+};
@@ -1,11 +1,31 @@
 #include <string.h>
 #include <memory>
+#include <stdexcept>
+#include <vector>
 #include "RegisterStateFile.h"
+#include "PtrStream.h"
 #include "xml/Node.h"
 #include "xml/Writer.h"
 #include "xml/Parser.h"
 #include "lexical_cast_ex.h"
 
+//Binary form used by quick states, XML documents can't start with this
+#define BINARY_MAGIC (0x46535242) //'BRSF'
+
+static std::vector<uint8> ReadWholeStream(Framework::CStream& stream)
+{
+	std::vector<uint8> contents;
+	while(1)
+	{
+		static const uint32 bufferSize = 0x400;
+		uint8 buffer[bufferSize];
+		auto readSize = stream.Read(buffer, bufferSize);
+		if(readSize == 0) break;
+		contents.insert(std::end(contents), buffer, buffer + readSize);
+	}
+	return contents;
+}
+
 CRegisterStateFile::CRegisterStateFile(const char* name)
     : CZipFile(name)
 {
@@ -21,9 +41,18 @@ CRegisterStateFile::~CRegisterStateFile()
 {
 }
 
-void CRegisterStateFile::Read(Framework::CStream& stream)
+void CRegisterStateFile::Read(Framework::CStream& inputStream)
 {
 	m_registers.clear();
+	//Archive streams can't always be rewound, get the whole file before checking its format
+	auto contents = ReadWholeStream(inputStream);
+	Framework::CPtrStream stream(contents.data(), contents.size());
+	if((contents.size() >= sizeof(uint32)) && (stream.Read32() == BINARY_MAGIC))
+	{
+		ReadBinary(stream);
+		return;
+	}
+	stream.Seek(0, Framework::STREAM_SEEK_DIRECTION::STREAM_SEEK_SET);
 	auto rootNode = std::unique_ptr<Framework::Xml::CNode>(Framework::Xml::CParser::ParseDocument(stream));
 	auto registerList = rootNode->SelectNodes("RegisterFile/Register");
 	for(Framework::Xml::CNode::NodeIterator nodeIterator(registerList.begin());
@@ -75,6 +104,44 @@ void CRegisterStateFile::Write(Framework::CStream& stream)
 	delete rootNode;
 }
 
+void CRegisterStateFile::WriteBinary(Framework::CStream& stream)
+{
+	stream.Write32(BINARY_MAGIC);
+	stream.Write32(static_cast<uint32>(m_registers.size()));
+	for(const auto& registerPair : m_registers)
+	{
+		const auto& name = registerPair.first;
+		const auto& reg = registerPair.second;
+		stream.Write32(static_cast<uint32>(name.size()));
+		stream.Write(name.c_str(), name.size());
+		stream.Write8(reg.first);
+		stream.Write(reg.second.nV, sizeof(uint32) * reg.first);
+	}
+}
+
+void CRegisterStateFile::ReadBinary(Framework::CStream& stream)
+{
+	uint32 registerCount = stream.Read32();
+	for(uint32 i = 0; i < registerCount; i++)
+	{
+		uint32 nameSize = stream.Read32();
+		if(nameSize > (stream.GetLength() - stream.Tell()))
+		{
+			throw std::runtime_error("Invalid register state file.");
+		}
+		std::string name(nameSize, 0);
+		stream.Read(&name[0], nameSize);
+		uint8 size = stream.Read8();
+		if(size > 4)
+		{
+			throw std::runtime_error("Invalid register state file.");
+		}
+		uint128 value = {};
+		stream.Read(value.nV, sizeof(uint32) * size);
+		m_registers[name] = Register(size, value);
+	}
+}
+
 void CRegisterStateFile::SetRegister32(const char* name, uint32 value)
 {
 	uint128 longValue;
@@ -21,10 +21,13 @@ public:
 
 	void Read(Framework::CStream&);
 	void Write(Framework::CStream&) override;
+	void WriteBinary(Framework::CStream&);
 
 private:
 	typedef std::pair<uint8, uint128> Register;
 	typedef std::map<std::string, Register> RegisterList;
 
+	void ReadBinary(Framework::CStream&);
+
 	RegisterList m_registers;
 };
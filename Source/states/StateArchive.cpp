@@ -0,0 +1,21 @@
+#include "StateArchive.h"
+
+CZipStateArchiveWriter::CZipStateArchiveWriter(Framework::CZipArchiveWriter& archive)
+    : m_archive(archive)
+{
+}
+
+void CZipStateArchiveWriter::InsertFile(Framework::CZipFile* file)
+{
+	m_archive.InsertFile(file);
+}
+
+CZipStateArchiveReader::CZipStateArchiveReader(Framework::CZipArchiveReader& archive)
+    : m_archive(archive)
+{
+}
+
+CStateArchiveReader::StreamPtr CZipStateArchiveReader::BeginReadFile(const char* fileName)
+{
+	return m_archive.BeginReadFile(fileName);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include "Stream.h"
+#include "zip/ZipFile.h"
+#include "zip/ZipArchiveWriter.h"
+#include "zip/ZipArchiveReader.h"
+
+//Archives devices save their state to and load it from. Save state files go
+//through a zip archive, quick states use a flat in-memory archive instead.
+class CStateArchiveWriter
+{
+public:
+	virtual ~CStateArchiveWriter() = default;
+
+	//Archive takes ownership of the file
+	virtual void InsertFile(Framework::CZipFile*) = 0;
+};
+
+class CStateArchiveReader
+{
+public:
+	typedef std::unique_ptr<Framework::CStream> StreamPtr;
+
+	virtual ~CStateArchiveReader() = default;
+
+	virtual StreamPtr BeginReadFile(const char*) = 0;
+};
+
+class CZipStateArchiveWriter : public CStateArchiveWriter
+{
+public:
+	CZipStateArchiveWriter(Framework::CZipArchiveWriter&);
+
+	void InsertFile(Framework::CZipFile*) override;
+
+private:
+	Framework::CZipArchiveWriter& m_archive;
+};
+
+class CZipStateArchiveReader : public CStateArchiveReader
+{
+public:
+	CZipStateArchiveReader(Framework::CZipArchiveReader&);
+
+	StreamPtr BeginReadFile(const char*) override;
+
+private:
+	Framework::CZipArchiveReader& m_archive;
+};
@@ -1,5 +1,8 @@
 #include <memory>
+#include <stdexcept>
+#include <vector>
 #include "StructCollectionStateFile.h"
+#include "PtrStream.h"
 #include "xml/Node.h"
 #include "xml/Writer.h"
 #include "xml/Parser.h"
@@ -9,6 +12,23 @@
 #define STRUCT_DOCUMENT_DETAIL ("Struct")
 #define STRUCT_DOCUMENT_DETAIL_NAME ("Name")
 
+//Binary form used by quick states, XML documents can't start with this
+#define BINARY_MAGIC (0x46435342) //'BSCF'
+
+static std::vector<uint8> ReadWholeStream(Framework::CStream& stream)
+{
+	std::vector<uint8> contents;
+	while(1)
+	{
+		static const uint32 bufferSize = 0x400;
+		uint8 buffer[bufferSize];
+		auto readSize = stream.Read(buffer, bufferSize);
+		if(readSize == 0) break;
+		contents.insert(std::end(contents), buffer, buffer + readSize);
+	}
+	return contents;
+}
+
 CStructCollectionStateFile::CStructCollectionStateFile(const char* name)
     : CZipFile(name)
 {
@@ -45,9 +65,18 @@ void CStructCollectionStateFile::InsertStruct(const char* name, const CStructFil
 	m_structs[name] = structFile;
 }
 
-void CStructCollectionStateFile::Read(Framework::CStream& stream)
+void CStructCollectionStateFile::Read(Framework::CStream& inputStream)
 {
 	m_structs.clear();
+	//Archive streams can't always be rewound, get the whole file before checking its format
+	auto contents = ReadWholeStream(inputStream);
+	Framework::CPtrStream stream(contents.data(), contents.size());
+	if((contents.size() >= sizeof(uint32)) && (stream.Read32() == BINARY_MAGIC))
+	{
+		ReadBinary(stream);
+		return;
+	}
+	stream.Seek(0, Framework::STREAM_SEEK_DIRECTION::STREAM_SEEK_SET);
 	auto rootNode = std::unique_ptr<Framework::Xml::CNode>(Framework::Xml::CParser::ParseDocument(stream));
 	auto registerList = rootNode->SelectNodes((std::string(STRUCT_DOCUMENT_HEADER) + "/" + std::string(STRUCT_DOCUMENT_DETAIL)).c_str());
 	for(auto nodeIterator(registerList.begin());
@@ -83,3 +112,34 @@ void CStructCollectionStateFile::Write(Framework::CStream& stream)
 	Framework::Xml::CWriter::WriteDocument(stream, rootNode);
 	delete rootNode;
 }
+
+void CStructCollectionStateFile::WriteBinary(Framework::CStream& stream)
+{
+	stream.Write32(BINARY_MAGIC);
+	stream.Write32(static_cast<uint32>(m_structs.size()));
+	for(const auto& structPair : m_structs)
+	{
+		const auto& name = structPair.first;
+		stream.Write32(static_cast<uint32>(name.size()));
+		stream.Write(name.c_str(), name.size());
+		structPair.second.WriteBinary(stream);
+	}
+}
+
+void CStructCollectionStateFile::ReadBinary(Framework::CStream& stream)
+{
+	uint32 structCount = stream.Read32();
+	for(uint32 i = 0; i < structCount; i++)
+	{
+		uint32 nameSize = stream.Read32();
+		if(nameSize > (stream.GetLength() - stream.Tell()))
+		{
+			throw std::runtime_error("Invalid struct collection state file.");
+		}
+		std::string name(nameSize, 0);
+		stream.Read(&name[0], nameSize);
+		CStructFile structFile;
+		structFile.ReadBinary(stream);
+		m_structs[name] = structFile;
+	}
+}
@@ -18,6 +18,7 @@ public:
 	void InsertStruct(const char*, const CStructFile&);
 	void Read(Framework::CStream&);
 	void Write(Framework::CStream&) override;
+	void WriteBinary(Framework::CStream&);
 
 	StructIterator GetStructBegin() const;
 	StructIterator GetStructEnd() const;
@@ -26,5 +27,7 @@ public:
 	StructIterator end() const;
 
 private:
+	void ReadBinary(Framework::CStream&);
+
 	StructMap m_structs;
 };
@@ -1,4 +1,5 @@
 #include <string.h>
+#include <stdexcept>
 #include "StructFile.h"
 #include "xml/Node.h"
 #include "lexical_cast_ex.h"
@@ -43,6 +44,43 @@ void CStructFile::Read(Xml::CNode* rootNode)
 	}
 }
 
+void CStructFile::ReadBinary(CStream& stream)
+{
+	uint32 registerCount = stream.Read32();
+	for(uint32 i = 0; i < registerCount; i++)
+	{
+		uint32 nameSize = stream.Read32();
+		if(nameSize > (stream.GetLength() - stream.Tell()))
+		{
+			throw runtime_error("Invalid struct state file.");
+		}
+		string name(nameSize, 0);
+		stream.Read(&name[0], nameSize);
+		uint8 size = stream.Read8();
+		if(size > 4)
+		{
+			throw runtime_error("Invalid struct state file.");
+		}
+		uint128 value = {};
+		stream.Read(value.nV, sizeof(uint32) * size);
+		m_registers[name] = Register(size, value);
+	}
+}
+
+void CStructFile::WriteBinary(CStream& stream) const
+{
+	stream.Write32(static_cast<uint32>(m_registers.size()));
+	for(const auto& registerPair : m_registers)
+	{
+		const auto& name = registerPair.first;
+		const auto& reg = registerPair.second;
+		stream.Write32(static_cast<uint32>(name.size()));
+		stream.Write(name.c_str(), name.size());
+		stream.Write8(reg.first);
+		stream.Write(reg.second.nV, sizeof(uint32) * reg.first);
+	}
+}
+
 void CStructFile::Write(Xml::CNode* rootNode) const
 {
 	for(const auto& registerIterator : m_registers)
@@ -3,6 +3,7 @@
 
 #include <map>
 #include "xml/Node.h"
+#include "Stream.h"
 #include "uint128.h"
 
 class CStructFile
@@ -14,6 +15,9 @@ public:
 	void Read(Framework::Xml::CNode*);
 	void Write(Framework::Xml::CNode*) const;
 
+	void ReadBinary(Framework::CStream&);
+	void WriteBinary(Framework::CStream&) const;
+
 	void SetRegister32(const char*, uint32);
 	void SetRegister64(const char*, uint64);
 	void SetRegister128(const char*, uint128);
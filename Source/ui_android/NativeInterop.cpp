@@ -117,7 +117,7 @@ extern "C" JNIEXPORT void JNICALL Java_com_virtualapplications_play_NativeIntero
 {
 	assert(g_virtualMachine != nullptr);
 	if(g_virtualMachine == nullptr) return;
-	auto stateFilePath = g_virtualMachine->GenerateStatePath(slot);
+	auto stateFilePath = g_virtualMachine->FindStatePath(slot);
 	auto resultFuture = g_virtualMachine->LoadState(stateFilePath);
 	if(!resultFuture.get())
 	{
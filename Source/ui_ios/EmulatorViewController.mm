@@ -228,7 +228,7 @@ CPS2VM::ProfileFrameDoneSignal::Connection g_profileFrameDoneConnection;
 
 -(void)onLoadStateButtonClick
 {
-	auto statePath = g_virtualMachine->GenerateStatePath(0);
+	auto statePath = g_virtualMachine->FindStatePath(0);
 	g_virtualMachine->LoadState(statePath);
 	NSLog(@"Loaded state from '%s'.", statePath.string().c_str());
 }
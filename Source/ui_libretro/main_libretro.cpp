@@ -251,10 +251,11 @@ bool retro_serialize(void* data, size_t size)
 	{
 		Framework::CMemStream stateStream;
 		Framework::CZipArchiveWriter archive;
+		CZipStateArchiveWriter stateArchive(archive);
 
-		m_virtualMachine->m_ee->SaveState(archive);
-		m_virtualMachine->m_iop->SaveState(archive);
-		m_virtualMachine->m_ee->m_gs->SaveState(archive);
+		m_virtualMachine->m_ee->SaveState(stateArchive);
+		m_virtualMachine->m_iop->SaveState(stateArchive);
+		m_virtualMachine->m_ee->m_gs->SaveState(stateArchive);
 
 		archive.Write(stateStream);
 		stateStream.Seek(0, Framework::STREAM_SEEK_DIRECTION::STREAM_SEEK_SET);
@@ -276,12 +277,13 @@ bool retro_unserialize(const void* data, size_t size)
 	{
 		Framework::CPtrStream stateStream(data, size);
 		Framework::CZipArchiveReader archive(stateStream);
+		CZipStateArchiveReader stateArchive(archive);
 
 		try
 		{
-			m_virtualMachine->m_ee->LoadState(archive);
-			m_virtualMachine->m_iop->LoadState(archive);
-			m_virtualMachine->m_ee->m_gs->LoadState(archive);
+			m_virtualMachine->m_ee->LoadState(stateArchive);
+			m_virtualMachine->m_iop->LoadState(stateArchive);
+			m_virtualMachine->m_ee->m_gs->LoadState(stateArchive);
 		}
 		catch(...)
 		{
@@ -486,6 +488,7 @@ bool IsBootableDiscImagePath(const fs::path& filePath)
 	return (extension == ".iso") ||
 	       (extension == ".isz") ||
 	       (extension == ".cso") ||
+	       (extension == ".zsi") ||
 	       (extension == ".bin");
 }
 
@@ -8,6 +8,7 @@
 #include <QLabel>
 #include <QPixmap>
 #include <QPixmapCache>
+#include <QProgressDialog>
 #include <iostream>
 #include <thread>
 
@@ -116,23 +117,35 @@ void BootableListDialog::on_add_games_button_clicked()
 {
 	QFileDialog dialog(this);
 	dialog.setFileMode(QFileDialog::ExistingFile);
-	dialog.setNameFilter(tr("All supported types(*.iso *.bin *.isz *.cso *.elf);;UltraISO Compressed Disk Images (*.isz);;CISO Compressed Disk Images (*.cso);;ELF files (*.elf);;All files (*.*)"));
+	dialog.setNameFilter(tr("All supported types(*.iso *.bin *.isz *.cso *.zsi *.elf);;UltraISO Compressed Disk Images (*.isz);;CISO Compressed Disk Images (*.cso);;ZSI Compressed Disk Images (*.zsi);;ELF files (*.elf);;All files (*.*)"));
 	if(dialog.exec())
 	{
 		auto filePath = QStringToPath(dialog.selectedFiles().first()).parent_path();
-		try
-		{
-			ScanBootables(filePath, false);
-		}
-		catch(...)
-		{
-		}
+		ScanDirectory(filePath);
 		FetchGameTitles();
 		FetchGameCovers();
 		resetModel();
 	}
 }
 
+void BootableListDialog::ScanDirectory(const fs::path& path)
+{
+	QProgressDialog progressDialog(tr("Scanning for games..."), QString(), 0, 0, this);
+	progressDialog.setWindowModality(Qt::WindowModal);
+	progressDialog.setMinimumDuration(500);
+	try
+	{
+		ScanBootables(path, false,
+		              [&progressDialog](uint32 processedCount, uint32 totalCount) {
+			              progressDialog.setMaximum(totalCount);
+			              progressDialog.setValue(processedCount);
+		              });
+	}
+	catch(...)
+	{
+	}
+}
+
 void BootableListDialog::on_listView_doubleClicked(const QModelIndex& index)
 {
 	bootable = model->GetBootable(index);
@@ -144,13 +157,7 @@ void BootableListDialog::on_refresh_button_clicked()
 	auto bootables_paths = GetActiveBootableDirectories();
 	for(auto path : bootables_paths)
 	{
-		try
-		{
-			ScanBootables(path, false);
-		}
-		catch(...)
-		{
-		}
+		ScanDirectory(path);
 	}
 	FetchGameTitles();
 	FetchGameCovers();
@@ -46,6 +46,7 @@ private:
 	CContinuationChecker* m_continuationChecker = nullptr;
 
 	void resetModel();
+	void ScanDirectory(const fs::path&);
 	void SelectionChange(const QModelIndex&);
 
 Q_SIGNALS:
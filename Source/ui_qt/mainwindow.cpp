@@ -175,6 +175,8 @@ void MainWindow::InitVirtualMachine()
 		}
 	}
 
+	m_audioStatsUpdatedConnection = m_virtualMachine->AudioStatsUpdated.Connect(std::bind(&CStatsManager::OnAudioStatsUpdated, &CStatsManager::GetInstance(), std::placeholders::_1));
+
 #ifdef PROFILE
 	m_profileFrameDoneConnection = m_virtualMachine->ProfileFrameDone.Connect(std::bind(&CStatsManager::OnProfileFrameDone, &CStatsManager::GetInstance(), m_virtualMachine, std::placeholders::_1));
 #endif
@@ -272,7 +274,7 @@ void MainWindow::on_actionBoot_DiscImage_triggered()
 	QFileDialog dialog(this);
 	dialog.setDirectory(PathToQString(m_lastPath));
 	dialog.setFileMode(QFileDialog::ExistingFile);
-	dialog.setNameFilter(tr("All supported types(*.iso *.bin *.isz *.cso);;UltraISO Compressed Disk Images (*.isz);;CISO Compressed Disk Images (*.cso);;All files (*.*)"));
+	dialog.setNameFilter(tr("All supported types(*.iso *.bin *.isz *.cso *.zsi);;UltraISO Compressed Disk Images (*.isz);;CISO Compressed Disk Images (*.cso);;ZSI Compressed Disk Images (*.zsi);;All files (*.*)"));
 	if(dialog.exec())
 	{
 		auto filePath = QStringToPath(dialog.selectedFiles().first());
@@ -472,7 +474,9 @@ void MainWindow::updateStats()
 #ifdef PROFILE
 	m_profileStatsLabel->setText(QString::fromStdString(CStatsManager::GetInstance().GetProfilingInfo()));
 #endif
-	m_fpsLabel->setText(QString("%1 f/s, %2 dc/f").arg(frames).arg(dcpf));
+	uint32 audioLatency = CStatsManager::GetInstance().GetAudioLatency();
+	uint32 audioUnderruns = CStatsManager::GetInstance().GetAudioUnderrunCount();
+	m_fpsLabel->setText(QString("%1 f/s, %2 dc/f, %3 ms audio, %4 underruns").arg(frames).arg(dcpf).arg(audioLatency).arg(audioUnderruns));
 	CStatsManager::GetInstance().ClearStats();
 }
 
@@ -485,6 +489,7 @@ void MainWindow::on_actionSettings_triggered()
 	if(m_virtualMachine != nullptr)
 	{
 		m_virtualMachine->ReloadSpuBlockCount();
+		m_virtualMachine->ReloadRunAheadFrameCount();
 		auto new_gs_index = CAppConfig::GetInstance().GetPreferenceInteger(PREF_VIDEO_GS_HANDLER);
 		if(gs_index != new_gs_index)
 		{
@@ -552,7 +557,7 @@ void MainWindow::saveState(int stateSlot)
 
 void MainWindow::loadState(int stateSlot)
 {
-	auto stateFilePath = m_virtualMachine->GenerateStatePath(stateSlot);
+	auto stateFilePath = m_virtualMachine->FindStatePath(stateSlot);
 	auto future = m_virtualMachine->LoadState(stateFilePath);
 	m_continuationChecker->GetContinuationManager().Register(std::move(future),
 	                                                         [this, stateSlot = stateSlot](const bool& succeeded) {
@@ -572,7 +577,7 @@ void MainWindow::loadState(int stateSlot)
 
 QString MainWindow::GetSaveStateInfo(int stateSlot)
 {
-	auto stateFilePath = m_virtualMachine->GenerateStatePath(stateSlot);
+	auto stateFilePath = m_virtualMachine->FindStatePath(stateSlot);
 	QFileInfo file(PathToQString(stateFilePath));
 	if(file.exists() && file.isFile())
 	{
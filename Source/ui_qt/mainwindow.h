@@ -96,6 +96,7 @@ private:
 	QWindow* m_outputwindow = nullptr;
 	QLabel* m_fpsLabel = nullptr;
 	QLabel* m_gsLabel = nullptr;
+	CPS2VM::AudioStatsUpdatedSignal::Connection m_audioStatsUpdatedConnection;
 #ifdef PROFILE
 	QLabel* m_profileStatsLabel = nullptr;
 	CPS2VM::ProfileFrameDoneSignal::Connection m_profileFrameDoneConnection;
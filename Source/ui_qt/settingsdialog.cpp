@@ -56,6 +56,7 @@ void SettingsDialog::LoadPreferences()
 	ui->checkBox_enable_audio->setChecked(CAppConfig::GetInstance().GetPreferenceBoolean(PREFERENCE_AUDIO_ENABLEOUTPUT));
 	ui->spinBox_spuBlockCount->setValue(CAppConfig::GetInstance().GetPreferenceInteger(PREF_AUDIO_SPUBLOCKCOUNT));
 	ui->comboBox_presentation_mode->setCurrentIndex(CAppConfig::GetInstance().GetPreferenceInteger(PREF_CGSHANDLER_PRESENTATION_MODE));
+	ui->spinBox_runAheadFrames->setValue(CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_RUNAHEAD_FRAMES));
 }
 
 void SettingsDialog::on_checkBox_force_bilinear_filtering_clicked(bool checked)
@@ -88,3 +89,8 @@ void SettingsDialog::on_spinBox_spuBlockCount_valueChanged(int value)
 {
 	CAppConfig::GetInstance().SetPreferenceInteger(PREF_AUDIO_SPUBLOCKCOUNT, value);
 }
+
+void SettingsDialog::on_spinBox_runAheadFrames_valueChanged(int value)
+{
+	CAppConfig::GetInstance().SetPreferenceInteger(PREF_PS2_RUNAHEAD_FRAMES, value);
+}
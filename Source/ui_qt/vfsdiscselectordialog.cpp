@@ -35,7 +35,7 @@ void VFSDiscSelectorDialog::on_iso_browse_button_clicked()
 {
 	QFileDialog dialog(this);
 	dialog.setFileMode(QFileDialog::ExistingFile);
-	dialog.setNameFilter(tr("All supported types(*.iso *.bin *.isz *.cso);;UltraISO Compressed Disk Images (*.isz);;CISO Compressed Disk Images (*.cso);;All files (*.*)"));
+	dialog.setNameFilter(tr("All supported types(*.iso *.bin *.isz *.cso *.zsi);;UltraISO Compressed Disk Images (*.isz);;CISO Compressed Disk Images (*.cso);;ZSI Compressed Disk Images (*.zsi);;All files (*.*)"));
 	if(dialog.exec())
 	{
 		m_path = QStringToPath(dialog.selectedFiles().first());
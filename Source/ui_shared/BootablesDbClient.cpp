@@ -7,7 +7,7 @@
 
 using namespace BootablesDb;
 
-#define DATABASE_VERSION 2
+#define DATABASE_VERSION 3
 
 static const char* g_dbFileName = "bootables.db";
 
@@ -19,7 +19,9 @@ static const char* g_bootablesTableCreateStatement =
     "    title TEXT DEFAULT '',"
     "    coverUrl TEXT DEFAULT '',"
     "    lastBootedTime INTEGER DEFAULT 0,"
-    "    overview TEXT DEFAULT ''"
+    "    overview TEXT DEFAULT '',"
+    "    fileSize INTEGER DEFAULT 0,"
+    "    fileTime INTEGER DEFAULT 0"
     ")";
 
 CClient::CClient()
@@ -141,6 +143,27 @@ void CClient::SetOverview(const fs::path& path, const char* overview)
 	statement.StepNoResult();
 }
 
+void CClient::SetFileInfo(const fs::path& path, uint64 fileSize, int64 fileTime)
+{
+	Framework::CSqliteStatement statement(m_db, "UPDATE bootables SET fileSize = ?, fileTime = ? WHERE path = ?");
+	sqlite3_bind_int64(statement, 1, fileSize);
+	sqlite3_bind_int64(statement, 2, fileTime);
+	statement.BindText(3, Framework::PathUtils::GetNativeStringFromPath(path).c_str());
+	statement.StepNoResult();
+}
+
+void CClient::BeginTransaction()
+{
+	Framework::CSqliteStatement statement(m_db, "BEGIN TRANSACTION");
+	statement.StepNoResult();
+}
+
+void CClient::CommitTransaction()
+{
+	Framework::CSqliteStatement statement(m_db, "COMMIT");
+	statement.StepNoResult();
+}
+
 Bootable CClient::ReadBootable(Framework::CSqliteStatement& statement)
 {
 	Bootable bootable;
@@ -150,6 +173,8 @@ Bootable CClient::ReadBootable(Framework::CSqliteStatement& statement)
 	bootable.coverUrl = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
 	bootable.overview = reinterpret_cast<const char*>(sqlite3_column_text(statement, 5));
 	bootable.lastBootedTime = sqlite3_column_int(statement, 4);
+	bootable.fileSize = sqlite3_column_int64(statement, 6);
+	bootable.fileTime = sqlite3_column_int64(statement, 7);
 	return bootable;
 }
 
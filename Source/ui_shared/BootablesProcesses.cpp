@@ -1,4 +1,7 @@
 #include <algorithm>
+#include <map>
+#include <mutex>
+#include <condition_variable>
 #include "AppConfig.h"
 #include "BootablesProcesses.h"
 #include "BootablesDbClient.h"
@@ -7,6 +10,7 @@
 #include "PathUtils.h"
 #include "string_format.h"
 #include "StdStreamUtils.h"
+#include "ThreadPool.h"
 #include "http/HttpClientFactory.h"
 
 //Jobs
@@ -29,6 +33,7 @@ bool IsBootableDiscImagePath(const fs::path& filePath)
 	return (extension == ".iso") ||
 	       (extension == ".isz") ||
 	       (extension == ".cso") ||
+	       (extension == ".zsi") ||
 	       (extension == ".bin");
 }
 
@@ -45,7 +50,7 @@ void TryRegisteringBootable(const fs::path& path)
 	BootablesDb::CClient::GetInstance().RegisterBootable(path, path.filename().string().c_str(), serial.c_str());
 }
 
-void ScanBootables(const fs::path& parentPath, bool recursive)
+static void CollectBootableCandidates(std::vector<fs::path>& candidatePaths, const fs::path& parentPath, bool recursive)
 {
 	for(auto pathIterator = fs::directory_iterator(parentPath);
 	    pathIterator != fs::directory_iterator(); pathIterator++)
@@ -55,10 +60,13 @@ void ScanBootables(const fs::path& parentPath, bool recursive)
 		{
 			if(recursive && fs::is_directory(path))
 			{
-				ScanBootables(path, recursive);
+				CollectBootableCandidates(candidatePaths, path, recursive);
 				continue;
 			}
-			TryRegisteringBootable(path);
+			if(IsBootableExecutablePath(path) || IsBootableDiscImagePath(path))
+			{
+				candidatePaths.push_back(path);
+			}
 		}
 		catch(const std::exception& exception)
 		{
@@ -67,6 +75,128 @@ void ScanBootables(const fs::path& parentPath, bool recursive)
 	}
 }
 
+void ScanBootables(const fs::path& parentPath, bool recursive, const ScanBootablesProgressCallback& progressCallback)
+{
+	struct SCAN_ENTRY
+	{
+		fs::path path;
+		uint64 fileSize = 0;
+		int64 fileTime = 0;
+		bool registered = false;
+		bool bootable = false;
+		std::string serial;
+	};
+
+	std::vector<fs::path> candidatePaths;
+	CollectBootableCandidates(candidatePaths, parentPath, recursive);
+
+	std::map<fs::path, BootablesDb::Bootable> registeredBootables;
+	for(auto& bootable : BootablesDb::CClient::GetInstance().GetBootables())
+	{
+		registeredBootables.emplace(bootable.path, std::move(bootable));
+	}
+
+	//Skip files that haven't changed since they were last scanned
+	std::vector<SCAN_ENTRY> entries;
+	for(const auto& path : candidatePaths)
+	{
+		SCAN_ENTRY entry;
+		entry.path = path;
+		try
+		{
+			entry.fileSize = fs::file_size(path);
+			entry.fileTime = fs::last_write_time(path).time_since_epoch().count();
+		}
+		catch(const std::exception& exception)
+		{
+			continue;
+		}
+		auto bootableIterator = registeredBootables.find(path);
+		if(bootableIterator != std::end(registeredBootables))
+		{
+			const auto& bootable = bootableIterator->second;
+			if((bootable.fileSize == entry.fileSize) && (bootable.fileTime == entry.fileTime)) continue;
+			entry.registered = true;
+		}
+		entries.push_back(std::move(entry));
+	}
+
+	uint32 totalCount = static_cast<uint32>(entries.size());
+	if(progressCallback)
+	{
+		progressCallback(0, totalCount);
+	}
+
+	//Extract disc ids in parallel, progress is reported on the calling thread
+	{
+		std::mutex completedMutex;
+		std::condition_variable completedCondition;
+		uint32 completedCount = 0;
+
+		Framework::CThreadPool threadPool(std::max<unsigned int>(std::thread::hardware_concurrency(), 1));
+		for(auto& entry : entries)
+		{
+			threadPool.Enqueue(
+			    [&entry, &completedMutex, &completedCondition, &completedCount]() {
+				    try
+				    {
+					    entry.bootable = IsBootableExecutablePath(entry.path) ||
+					                     DiskUtils::TryGetDiskId(entry.path, &entry.serial);
+				    }
+				    catch(const std::exception& exception)
+				    {
+					    //Failed to process a path, keep going
+				    }
+				    {
+					    std::lock_guard<std::mutex> completedLock(completedMutex);
+					    completedCount++;
+				    }
+				    completedCondition.notify_one();
+			    });
+		}
+
+		uint32 reportedCount = 0;
+		while(reportedCount != totalCount)
+		{
+			{
+				std::unique_lock<std::mutex> completedLock(completedMutex);
+				completedCondition.wait(completedLock, [&]() { return completedCount != reportedCount; });
+				reportedCount = completedCount;
+			}
+			if(progressCallback)
+			{
+				progressCallback(reportedCount, totalCount);
+			}
+		}
+	}
+
+	if(entries.empty()) return;
+
+	auto& client = BootablesDb::CClient::GetInstance();
+	client.BeginTransaction();
+	for(const auto& entry : entries)
+	{
+		try
+		{
+			if(!entry.registered)
+			{
+				if(!entry.bootable) continue;
+				client.RegisterBootable(entry.path, entry.path.filename().string().c_str(), entry.serial.c_str());
+			}
+			else if(!entry.serial.empty())
+			{
+				client.SetDiscId(entry.path, entry.serial.c_str());
+			}
+			client.SetFileInfo(entry.path, entry.fileSize, entry.fileTime);
+		}
+		catch(const std::exception& exception)
+		{
+			//Failed to register a path, keep going
+		}
+	}
+	client.CommitTransaction();
+}
+
 std::set<fs::path> GetActiveBootableDirectories()
 {
 	std::set<fs::path> result;
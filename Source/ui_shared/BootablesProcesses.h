@@ -2,11 +2,16 @@
 
 #include "filesystem_def.h"
 #include <set>
+#include <functional>
+#include "Types.h"
+
+//Called with the amount of files processed and the total amount of files to process
+typedef std::function<void(uint32, uint32)> ScanBootablesProgressCallback;
 
 bool IsBootableExecutablePath(const fs::path&);
 bool IsBootableDiscImagePath(const fs::path&);
 void TryRegisteringBootable(const fs::path&);
-void ScanBootables(const fs::path&, bool = true);
+void ScanBootables(const fs::path&, bool = true, const ScanBootablesProgressCallback& = ScanBootablesProgressCallback());
 std::set<fs::path> GetActiveBootableDirectories();
 void PurgeInexistingFiles();
 void FetchGameTitles();
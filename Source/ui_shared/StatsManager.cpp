@@ -10,6 +10,12 @@ void CStatsManager::OnNewFrame(uint32 drawCalls)
 	m_drawCalls += drawCalls;
 }
 
+void CStatsManager::OnAudioStatsUpdated(const CPS2VM::AUDIO_STATS& audioStats)
+{
+	std::lock_guard<std::mutex> statsLock(m_statsMutex);
+	m_audioStats = audioStats;
+}
+
 uint32 CStatsManager::GetFrames()
 {
 	std::lock_guard<std::mutex> statsLock(m_statsMutex);
@@ -22,6 +28,18 @@ uint32 CStatsManager::GetDrawCalls()
 	return m_drawCalls;
 }
 
+uint32 CStatsManager::GetAudioLatency()
+{
+	std::lock_guard<std::mutex> statsLock(m_statsMutex);
+	return m_audioStats.latency;
+}
+
+uint32 CStatsManager::GetAudioUnderrunCount()
+{
+	std::lock_guard<std::mutex> statsLock(m_statsMutex);
+	return m_audioStats.underrunCount;
+}
+
 #ifdef PROFILE
 
 std::string CStatsManager::GetProfilingInfo()
@@ -11,9 +11,12 @@ class CStatsManager : public CSingleton<CStatsManager>
 {
 public:
 	void OnNewFrame(uint32);
+	void OnAudioStatsUpdated(const CPS2VM::AUDIO_STATS&);
 
 	uint32 GetFrames();
 	uint32 GetDrawCalls();
+	uint32 GetAudioLatency();
+	uint32 GetAudioUnderrunCount();
 #ifdef PROFILE
 	std::string GetProfilingInfo();
 #endif
@@ -29,6 +32,7 @@ private:
 
 	uint32 m_frames = 0;
 	uint32 m_drawCalls = 0;
+	CPS2VM::AUDIO_STATS m_audioStats;
 
 #ifdef PROFILE
 	struct ZONEINFO
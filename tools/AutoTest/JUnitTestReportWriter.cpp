@@ -22,10 +22,15 @@ void CJUnitTestReportWriter::ReportTestEntry(const std::string& testName, const
 {
 	auto testCaseNode = new Framework::Xml::CNode("testcase", true);
 	testCaseNode->InsertAttribute("name", testName.c_str());
+	testCaseNode->InsertAttribute("time", string_format("%0.3f", result.time).c_str());
 
 	if(!result.succeeded)
 	{
 		std::string failureDetails;
+		if(result.timedOut)
+		{
+			failureDetails = "Test timed out.\r\n";
+		}
 		for(const auto& lineDiff : result.lineDiffs)
 		{
 			auto failureLine = string_format(
@@ -38,16 +43,20 @@ void CJUnitTestReportWriter::ReportTestEntry(const std::string& testName, const
 		auto resultNode = new Framework::Xml::CNode("failure", true);
 		resultNode->InsertTextNode(failureDetails.c_str());
 		testCaseNode->InsertNode(resultNode);
+		m_failureCount++;
 	}
 
 	m_testSuiteNode->InsertNode(testCaseNode);
 
 	m_testCount++;
+	m_time += result.time;
 }
 
 void CJUnitTestReportWriter::Write(const fs::path& reportPath)
 {
 	m_testSuiteNode->InsertAttribute("tests", string_format("%d", m_testCount).c_str());
+	m_testSuiteNode->InsertAttribute("failures", string_format("%d", m_failureCount).c_str());
+	m_testSuiteNode->InsertAttribute("time", string_format("%0.3f", m_time).c_str());
 	auto testOutputFileStream = Framework::CreateOutputStdStream(reportPath.native());
 	Framework::Xml::CWriter::WriteDocument(testOutputFileStream, m_reportNode.get());
 }
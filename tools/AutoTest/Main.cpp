@@ -1,9 +1,13 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include "PS2VM.h"
 #include "filesystem_def.h"
 #include "StdStream.h"
 #include "StdStreamUtils.h"
 #include "iop/IopBios.h"
 #include "JUnitTestReportWriter.h"
+#include "ThreadPool.h"
 #include "gs/GSH_Null.h"
 #ifdef _WIN32
 #include "gs/GSH_OpenGLWin32/GSH_OpenGLWin32.h"
@@ -16,6 +20,8 @@
 
 #define DEFAULT_GS_HANDLER_NAME GS_HANDLER_NAME_NULL
 
+#define SLOWEST_TEST_COUNT 10
+
 static std::set<std::string> g_validGsHandlersNames =
     {
         GS_HANDLER_NAME_NULL,
@@ -110,13 +116,28 @@ TESTRESULT GetTestResult(const fs::path& testFilePath)
 	return result;
 }
 
-void ExecuteEeTest(const fs::path& testFilePath, const std::string& gsHandlerName)
+//Returns false if execution didn't end before the timeout (in seconds, 0 means no timeout)
+bool WaitForExecution(const std::atomic<bool>& executionOver, unsigned int timeout)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	while(!executionOver)
+	{
+		if((timeout != 0) && ((std::chrono::steady_clock::now() - startTime) >= std::chrono::seconds(timeout)))
+		{
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	return true;
+}
+
+bool ExecuteEeTest(const fs::path& testFilePath, const std::string& gsHandlerName, unsigned int timeout)
 {
 	auto resultFilePath = testFilePath;
 	resultFilePath.replace_extension(".result");
 	auto resultStream = new Framework::CStdStream(resultFilePath.string().c_str(), "wb");
 
-	bool executionOver = false;
+	std::atomic<bool> executionOver(false);
 
 	//Setup virtual machine
 	CPS2VM virtualMachine;
@@ -134,17 +155,16 @@ void ExecuteEeTest(const fs::path& testFilePath, const std::string& gsHandlerNam
 	}
 	virtualMachine.Resume();
 
-	while(!executionOver)
-	{
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	}
+	bool completed = WaitForExecution(executionOver, timeout);
 
 	virtualMachine.Pause();
 	virtualMachine.DestroyGSHandler();
 	virtualMachine.Destroy();
+
+	return completed;
 }
 
-void ExecuteIopTest(const fs::path& testFilePath)
+bool ExecuteIopTest(const fs::path& testFilePath, unsigned int timeout)
 {
 	//Read in the module data
 	std::vector<uint8> moduleData;
@@ -159,7 +179,7 @@ void ExecuteIopTest(const fs::path& testFilePath)
 	resultFilePath.replace_extension(".result");
 	auto resultStream = new Framework::CStdStream(resultFilePath.string().c_str(), "wb");
 
-	bool executionOver = false;
+	std::atomic<bool> executionOver(false);
 	CIopBios::ModuleStartedEvent::Connection connection;
 	//Setup virtual machine
 	CPS2VM virtualMachine;
@@ -180,16 +200,15 @@ void ExecuteIopTest(const fs::path& testFilePath)
 	}
 	virtualMachine.Resume();
 
-	while(!executionOver)
-	{
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	}
+	bool completed = WaitForExecution(executionOver, timeout);
 
 	virtualMachine.Pause();
 	virtualMachine.Destroy();
+
+	return completed;
 }
 
-void ScanAndExecuteTests(const fs::path& testDirPath, const TestReportWriterPtr& testReportWriter, const std::string& gsHandlerName)
+void ScanTests(const fs::path& testDirPath, std::vector<fs::path>& testPaths)
 {
 	fs::directory_iterator endIterator;
 	for(auto testPathIterator = fs::directory_iterator(testDirPath);
@@ -198,32 +217,89 @@ void ScanAndExecuteTests(const fs::path& testDirPath, const TestReportWriterPtr&
 		auto testPath = testPathIterator->path();
 		if(fs::is_directory(testPath))
 		{
-			ScanAndExecuteTests(testPath, testReportWriter, gsHandlerName);
+			ScanTests(testPath, testPaths);
 			continue;
 		}
+		if((testPath.extension() == ".elf") || (testPath.extension() == ".irx"))
+		{
+			testPaths.push_back(testPath);
+		}
+	}
+}
+
+TESTRESULT ExecuteTest(const fs::path& testPath, const std::string& gsHandlerName, unsigned int timeout)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	TESTRESULT result;
+	try
+	{
+		bool completed = false;
 		if(testPath.extension() == ".elf")
 		{
-			printf("Testing '%s': ", testPath.string().c_str());
-			ExecuteEeTest(testPath, gsHandlerName);
-			auto result = GetTestResult(testPath);
-			printf("%s.\r\n", result.succeeded ? "SUCCEEDED" : "FAILED");
-			if(testReportWriter)
-			{
-				testReportWriter->ReportTestEntry(testPath.string(), result);
-			}
+			completed = ExecuteEeTest(testPath, gsHandlerName, timeout);
 		}
-		else if(testPath.extension() == ".irx")
+		else
 		{
-			printf("Testing '%s': ", testPath.string().c_str());
-			ExecuteIopTest(testPath);
-			auto result = GetTestResult(testPath);
-			printf("%s.\r\n", result.succeeded ? "SUCCEEDED" : "FAILED");
-			if(testReportWriter)
-			{
-				testReportWriter->ReportTestEntry(testPath.string(), result);
-			}
+			completed = ExecuteIopTest(testPath, timeout);
+		}
+		if(completed)
+		{
+			result = GetTestResult(testPath);
+		}
+		result.timedOut = !completed;
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Error: Failed to execute '%s': %s\r\n", testPath.string().c_str(), exception.what());
+	}
+	result.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	return result;
+}
+
+//Each worker runs its tests in its own virtual machine
+void ExecuteTests(const std::vector<fs::path>& testPaths, const TestReportWriterPtr& testReportWriter, const std::string& gsHandlerName,
+                  unsigned int jobCount, unsigned int timeout)
+{
+	std::vector<TESTRESULT> results(testPaths.size());
+	{
+		Framework::CThreadPool threadPool(jobCount);
+		for(size_t i = 0; i < testPaths.size(); i++)
+		{
+			threadPool.Enqueue(
+			    [&, i]() {
+				    const auto& testPath = testPaths[i];
+				    auto result = ExecuteTest(testPath, gsHandlerName, timeout);
+				    printf("Testing '%s': %s (%0.2fs).\r\n", testPath.string().c_str(),
+				           result.succeeded ? "SUCCEEDED" : (result.timedOut ? "TIMED OUT" : "FAILED"), result.time);
+				    fflush(stdout);
+				    results[i] = std::move(result);
+			    });
 		}
 	}
+
+	//Report in scan order, whichever order the tests completed in
+	if(testReportWriter)
+	{
+		for(size_t i = 0; i < testPaths.size(); i++)
+		{
+			testReportWriter->ReportTestEntry(testPaths[i].string(), results[i]);
+		}
+	}
+
+	std::vector<size_t> testIndices(testPaths.size());
+	for(size_t i = 0; i < testIndices.size(); i++)
+	{
+		testIndices[i] = i;
+	}
+	std::sort(testIndices.begin(), testIndices.end(),
+	          [&results](size_t lhs, size_t rhs) { return results[lhs].time > results[rhs].time; });
+	testIndices.resize(std::min<size_t>(testIndices.size(), SLOWEST_TEST_COUNT));
+
+	printf("Slowest tests:\r\n");
+	for(auto testIndex : testIndices)
+	{
+		printf("\t%0.2fs\t%s\r\n", results[testIndex].time, testPaths[testIndex].string().c_str());
+	}
 }
 
 int main(int argc, const char** argv)
@@ -250,6 +326,9 @@ int main(int argc, const char** argv)
 		printf("\t --junitreport <path>\t Writes JUnit format report at <path>.\r\n");
 		printf("\t --gshandler <%s>\tSelects which GS handler to instantiate (default is '%s').\r\n",
 		       validGsHandlerNamesString.c_str(), DEFAULT_GS_HANDLER_NAME);
+		printf("\t --jobs <count>\t Runs <count> tests at once, 0 uses one per core (default is 1, needs '%s' GS handler).\r\n",
+		       GS_HANDLER_NAME_NULL);
+		printf("\t --timeout <seconds>\t Fails tests that don't complete in time (default is 0, no timeout).\r\n");
 		return -1;
 	}
 
@@ -257,6 +336,8 @@ int main(int argc, const char** argv)
 	fs::path autoTestRoot;
 	fs::path reportPath;
 	std::string gsHandlerName = DEFAULT_GS_HANDLER_NAME;
+	unsigned int jobCount = 1;
+	unsigned int timeout = 0;
 	assert(g_validGsHandlersNames.find(gsHandlerName) != std::end(g_validGsHandlersNames));
 
 	for(int i = 1; i < argc; i++)
@@ -287,6 +368,30 @@ int main(int argc, const char** argv)
 			}
 			i++;
 		}
+		else if(!strcmp(argv[i], "--jobs"))
+		{
+			if((i + 1) >= argc)
+			{
+				printf("Error: Job count must be specified for --jobs option.\r\n");
+				return -1;
+			}
+			jobCount = atoi(argv[i + 1]);
+			if(jobCount == 0)
+			{
+				jobCount = std::max<unsigned int>(std::thread::hardware_concurrency(), 1);
+			}
+			i++;
+		}
+		else if(!strcmp(argv[i], "--timeout"))
+		{
+			if((i + 1) >= argc)
+			{
+				printf("Error: Time must be specified for --timeout option.\r\n");
+				return -1;
+			}
+			timeout = atoi(argv[i + 1]);
+			i++;
+		}
 		else
 		{
 			autoTestRoot = argv[i];
@@ -294,6 +399,13 @@ int main(int argc, const char** argv)
 		}
 	}
 
+	if((jobCount > 1) && (gsHandlerName != GS_HANDLER_NAME_NULL))
+	{
+		//Other GS handlers share a single window
+		printf("Error: Running tests in parallel is only supported with the '%s' GS handler.\r\n", GS_HANDLER_NAME_NULL);
+		return -1;
+	}
+
 	if(autoTestRoot.empty())
 	{
 		printf("Error: No test directory specified.\r\n");
@@ -302,7 +414,9 @@ int main(int argc, const char** argv)
 
 	try
 	{
-		ScanAndExecuteTests(autoTestRoot, testReportWriter, gsHandlerName);
+		std::vector<fs::path> testPaths;
+		ScanTests(autoTestRoot, testPaths);
+		ExecuteTests(testPaths, testReportWriter, gsHandlerName, jobCount, timeout);
 	}
 	catch(const std::exception& exception)
 	{
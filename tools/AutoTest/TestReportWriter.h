@@ -16,6 +16,9 @@ struct TESTRESULT
 	typedef std::vector<LINEDIFF> LineDiffArray;
 
 	bool succeeded = false;
+	bool timedOut = false;
+	//Wall time taken by the test, in seconds
+	double time = 0;
 	LineDiffArray lineDiffs;
 };
 
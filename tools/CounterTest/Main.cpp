@@ -0,0 +1,327 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "MIPS.h"
+#include "Ps2Const.h"
+#include "ee/DMAC.h"
+#include "ee/INTC.h"
+#include "ee/Timer.h"
+#include "iop/Iop_Intc.h"
+#include "iop/Iop_RootCounters.h"
+
+//Checks that EE timers and IOP root counters, which are only brought up to date when
+//needed, raise the same interrupts and end up with the same registers as counters
+//updated after every slice of ticks. Register reads bring counters up to date, the
+//reference instance is read after every slice and the other one only from time to time.
+
+static const unsigned int g_stepCount = 200000;
+
+static const uint32 g_timerBaseAddresses[] =
+    {
+        0x10000000,
+        0x10000800,
+        0x10001000,
+        0x10001800,
+};
+
+enum TIMER_REGISTER
+{
+	TIMER_REGISTER_COUNT = 0x00,
+	TIMER_REGISTER_MODE = 0x10,
+	TIMER_REGISTER_COMP = 0x20,
+	TIMER_REGISTER_HOLD = 0x30,
+};
+
+static const uint32 g_timerRegisters[] =
+    {
+        TIMER_REGISTER_COUNT,
+        TIMER_REGISTER_MODE,
+        TIMER_REGISTER_COMP,
+        TIMER_REGISTER_HOLD,
+};
+
+static const uint32 g_counterRegisters[] =
+    {
+        Iop::CRootCounters::CNT_COUNT,
+        Iop::CRootCounters::CNT_MODE,
+        Iop::CRootCounters::CNT_TARGET,
+};
+
+class CEeTimerContext
+{
+public:
+	CEeTimerContext(uint8* ram)
+	    : m_ee(MEMORYMAP_ENDIAN_LSBF)
+	    , m_spr(PS2::EE_SPR_SIZE)
+	    , m_vuMem(PS2::VUMEM0SIZE)
+	    , m_dmac(ram, m_spr.data(), m_vuMem.data(), m_ee)
+	    , m_intc(m_dmac)
+	    , m_timer(m_intc)
+	{
+	}
+
+	CTimer& GetTimer()
+	{
+		return m_timer;
+	}
+
+	uint32 TakeInterrupts()
+	{
+		uint32 result = m_intc.GetRegister(CINTC::INTC_STAT);
+		m_intc.SetRegister(CINTC::INTC_STAT, result);
+		return result;
+	}
+
+private:
+	CMIPS m_ee;
+	std::vector<uint8> m_spr;
+	std::vector<uint8> m_vuMem;
+	CDMAC m_dmac;
+	CINTC m_intc;
+	CTimer m_timer;
+};
+
+class CIopCounterContext
+{
+public:
+	CIopCounterContext()
+	    : m_counters(PS2::IOP_CLOCK_OVER_FREQ, m_intc)
+	{
+	}
+
+	Iop::CRootCounters& GetCounters()
+	{
+		return m_counters;
+	}
+
+	uint32 TakeInterrupts()
+	{
+		uint32 result = m_intc.ReadRegister(Iop::CIntc::STATUS0);
+		m_intc.WriteRegister(Iop::CIntc::STATUS0, ~result);
+		return result;
+	}
+
+private:
+	Iop::CIntc m_intc;
+	Iop::CRootCounters m_counters;
+};
+
+static bool CheckCase(const char* caseName, unsigned int step, bool condition)
+{
+	if(!condition)
+	{
+		printf("%s: failed at step %d.\r\n", caseName, step);
+	}
+	return condition;
+}
+
+//Mostly short slices like the ones the VM runs, with a few long ones going over several events
+static unsigned int PickTicks(std::mt19937& generator)
+{
+	switch(generator() % 8)
+	{
+	default:
+		return generator() % 64;
+	case 5:
+	case 6:
+		return generator() % 0x1000;
+	case 7:
+		return generator() % 0x40000;
+	}
+}
+
+//Values close to the count make compare, target and overflow events frequent
+static uint32 PickCount(std::mt19937& generator, uint32 count, uint32 countMask)
+{
+	switch(generator() % 4)
+	{
+	case 0:
+		return generator() & countMask;
+	case 1:
+		return (countMask - (generator() % 0x100)) & countMask;
+	default:
+		return (count + (generator() % 0x100)) & countMask;
+	}
+}
+
+static unsigned int RunEeTimers(std::mt19937& generator, uint8* ram)
+{
+	CEeTimerContext batched(ram);
+	CEeTimerContext reference(ram);
+
+	unsigned int failedCount = 0;
+	for(unsigned int step = 0; step < g_stepCount; step++)
+	{
+		uint32 baseAddress = g_timerBaseAddresses[generator() % 4];
+		uint32 count = reference.GetTimer().GetRegister(baseAddress + TIMER_REGISTER_COUNT);
+		switch(generator() % 16)
+		{
+		default:
+		{
+			unsigned int ticks = PickTicks(generator);
+			batched.GetTimer().Count(ticks);
+			reference.GetTimer().Count(ticks);
+		}
+		break;
+		case 10:
+		case 11:
+		{
+			//Count enable set most of the time, flags are cleared by writing 1s
+			uint32 mode = generator() & 0xFFF;
+			if(generator() % 4) mode |= CTimer::MODE_COUNT_ENABLE;
+			batched.GetTimer().SetRegister(baseAddress + TIMER_REGISTER_MODE, mode);
+			reference.GetTimer().SetRegister(baseAddress + TIMER_REGISTER_MODE, mode);
+		}
+		break;
+		case 12:
+		{
+			uint32 compare = PickCount(generator, count, 0xFFFF);
+			batched.GetTimer().SetRegister(baseAddress + TIMER_REGISTER_COMP, compare);
+			reference.GetTimer().SetRegister(baseAddress + TIMER_REGISTER_COMP, compare);
+		}
+		break;
+		case 13:
+		{
+			uint32 newCount = PickCount(generator, count, 0xFFFF);
+			batched.GetTimer().SetRegister(baseAddress + TIMER_REGISTER_COUNT, newCount);
+			reference.GetTimer().SetRegister(baseAddress + TIMER_REGISTER_COUNT, newCount);
+		}
+		break;
+		case 14:
+		{
+			uint32 hold = generator() & 0xFFFF;
+			batched.GetTimer().SetRegister(baseAddress + TIMER_REGISTER_HOLD, hold);
+			reference.GetTimer().SetRegister(baseAddress + TIMER_REGISTER_HOLD, hold);
+		}
+		break;
+		case 15:
+			if(generator() % 2)
+			{
+				batched.GetTimer().NotifyVBlankStart();
+				reference.GetTimer().NotifyVBlankStart();
+			}
+			else
+			{
+				batched.GetTimer().NotifyVBlankEnd();
+				reference.GetTimer().NotifyVBlankEnd();
+			}
+			break;
+		}
+
+		//Brings every timer of the reference up to date
+		reference.GetTimer().GetRegister(g_timerBaseAddresses[0] + TIMER_REGISTER_COUNT);
+
+		if(!CheckCase("EeTimerInterrupts", step, batched.TakeInterrupts() == reference.TakeInterrupts()))
+		{
+			failedCount++;
+			break;
+		}
+
+		if((generator() % 64) != 0) continue;
+
+		bool registersMatch = true;
+		for(auto timerBaseAddress : g_timerBaseAddresses)
+		{
+			for(auto timerRegister : g_timerRegisters)
+			{
+				uint32 address = timerBaseAddress + timerRegister;
+				registersMatch &= (batched.GetTimer().GetRegister(address) == reference.GetTimer().GetRegister(address));
+			}
+		}
+		if(!CheckCase("EeTimerRegisters", step, registersMatch))
+		{
+			failedCount++;
+			break;
+		}
+	}
+	return failedCount;
+}
+
+static unsigned int RunIopCounters(std::mt19937& generator)
+{
+	CIopCounterContext batched;
+	CIopCounterContext reference;
+
+	unsigned int failedCount = 0;
+	for(unsigned int step = 0; step < g_stepCount; step++)
+	{
+		unsigned int counterId = generator() % Iop::CRootCounters::MAX_COUNTERS;
+		uint32 baseAddress = Iop::CRootCounters::g_counterBaseAddresses[counterId];
+		uint32 countMask = (Iop::CRootCounters::g_counterSizes[counterId] == 16) ? 0xFFFF : 0xFFFFFFFF;
+		uint32 count = reference.GetCounters().ReadRegister(baseAddress + Iop::CRootCounters::CNT_COUNT);
+		switch(generator() % 16)
+		{
+		default:
+		{
+			unsigned int ticks = PickTicks(generator);
+			batched.GetCounters().Update(ticks);
+			reference.GetCounters().Update(ticks);
+		}
+		break;
+		case 12:
+		case 13:
+		{
+			//Counter 2 only has a 1/8 prescaler
+			uint32 mode = generator() & 0x7FF;
+			if(counterId == 2) mode &= ~0x400;
+			batched.GetCounters().WriteRegister(baseAddress + Iop::CRootCounters::CNT_MODE, mode);
+			reference.GetCounters().WriteRegister(baseAddress + Iop::CRootCounters::CNT_MODE, mode);
+		}
+		break;
+		case 14:
+		{
+			uint32 target = PickCount(generator, count, countMask);
+			batched.GetCounters().WriteRegister(baseAddress + Iop::CRootCounters::CNT_TARGET, target);
+			reference.GetCounters().WriteRegister(baseAddress + Iop::CRootCounters::CNT_TARGET, target);
+		}
+		break;
+		case 15:
+		{
+			uint32 newCount = PickCount(generator, count, countMask);
+			batched.GetCounters().WriteRegister(baseAddress + Iop::CRootCounters::CNT_COUNT, newCount);
+			reference.GetCounters().WriteRegister(baseAddress + Iop::CRootCounters::CNT_COUNT, newCount);
+		}
+		break;
+		}
+
+		//Brings every counter of the reference up to date
+		reference.GetCounters().ReadRegister(Iop::CRootCounters::CNT0_BASE + Iop::CRootCounters::CNT_COUNT);
+
+		if(!CheckCase("IopCounterInterrupts", step, batched.TakeInterrupts() == reference.TakeInterrupts()))
+		{
+			failedCount++;
+			break;
+		}
+
+		if((generator() % 64) != 0) continue;
+
+		bool registersMatch = true;
+		for(auto counterBaseAddress : Iop::CRootCounters::g_counterBaseAddresses)
+		{
+			for(auto counterRegister : g_counterRegisters)
+			{
+				uint32 address = counterBaseAddress + counterRegister;
+				registersMatch &= (batched.GetCounters().ReadRegister(address) == reference.GetCounters().ReadRegister(address));
+			}
+		}
+		if(!CheckCase("IopCounterRegisters", step, registersMatch))
+		{
+			failedCount++;
+			break;
+		}
+	}
+	return failedCount;
+}
+
+int main(int argc, const char** argv)
+{
+	std::vector<uint8> ram(PS2::EE_RAM_SIZE);
+	std::mt19937 generator(0x7173);
+
+	unsigned int failedCount = 0;
+	failedCount += RunEeTimers(generator, ram.data());
+	failedCount += RunIopCounters(generator);
+
+	printf("%d failure(s).\r\n", failedCount);
+	return (failedCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <memory>
+#include "StdStream.h"
+#include "CsoImageStream.h"
+#ifdef HAS_ZSTD
+#include "ZsiImageStream.h"
+#endif
+#include "stricmp.h"
+#include "filesystem_def.h"
+
+//Measures sequential and random read throughput of disc image streams (ISO, CSO and ZSI)
+//Usage: DiscImageBench <image path> [random read count]
+
+static const uint32 g_sectorSize = 0x800;
+
+typedef std::unique_ptr<Framework::CStream> StreamPtr;
+
+static StreamPtr CreateStream(const fs::path& imagePath)
+{
+	auto extension = imagePath.extension().string();
+	auto baseStream = new Framework::CStdStream(imagePath.string().c_str(), "rb");
+	if(!stricmp(extension.c_str(), ".cso"))
+	{
+		return std::make_unique<CCsoImageStream>(baseStream);
+	}
+#ifdef HAS_ZSTD
+	if(!stricmp(extension.c_str(), ".zsi"))
+	{
+		return std::make_unique<CZsiImageStream>(baseStream);
+	}
+#endif
+	return StreamPtr(baseStream);
+}
+
+static double GetElapsedSeconds(const std::chrono::steady_clock::time_point& startTime)
+{
+	auto elapsed = std::chrono::steady_clock::now() - startTime;
+	return std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+}
+
+static void PrintResult(const char* name, uint64 bytes, uint32 reads, double seconds)
+{
+	double megabytes = static_cast<double>(bytes) / (1024.0 * 1024.0);
+	printf("%-12s %10.1f MB in %8.3fs: %8.1f MB/s, %10.0f reads/s\n",
+	       name, megabytes, seconds, megabytes / seconds, static_cast<double>(reads) / seconds);
+}
+
+static void RunSequential(const fs::path& imagePath)
+{
+	auto stream = CreateStream(imagePath);
+	std::vector<uint8> sector(g_sectorSize);
+	uint64 totalBytes = 0;
+	uint32 readCount = 0;
+	auto startTime = std::chrono::steady_clock::now();
+	while(true)
+	{
+		auto bytes = stream->Read(sector.data(), g_sectorSize);
+		totalBytes += bytes;
+		readCount++;
+		if(bytes != g_sectorSize) break;
+	}
+	PrintResult("Sequential", totalBytes, readCount, GetElapsedSeconds(startTime));
+}
+
+static void RunRandom(const fs::path& imagePath, uint32 readCount)
+{
+	auto stream = CreateStream(imagePath);
+	stream->Seek(0, Framework::STREAM_SEEK_END);
+	uint64 sectorCount = stream->Tell() / g_sectorSize;
+	if(sectorCount == 0) return;
+
+	std::mt19937 generator(0);
+	std::uniform_int_distribution<uint64> distribution(0, sectorCount - 1);
+	std::vector<uint8> sector(g_sectorSize);
+	uint64 totalBytes = 0;
+	auto startTime = std::chrono::steady_clock::now();
+	for(uint32 i = 0; i < readCount; i++)
+	{
+		stream->Seek(distribution(generator) * g_sectorSize, Framework::STREAM_SEEK_SET);
+		totalBytes += stream->Read(sector.data(), g_sectorSize);
+	}
+	PrintResult("Random", totalBytes, readCount, GetElapsedSeconds(startTime));
+}
+
+int main(int argc, const char** argv)
+{
+	if(argc < 2)
+	{
+		printf("Usage: DiscImageBench <image path> [random read count]\n");
+		return -1;
+	}
+
+	fs::path imagePath(argv[1]);
+	uint32 randomReadCount = (argc >= 3) ? atoi(argv[2]) : 0x10000;
+
+	try
+	{
+		RunSequential(imagePath);
+		RunRandom(imagePath, randomReadCount);
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Error: %s\n", exception.what());
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include "StdStream.h"
+#include "CsoImageStream.h"
+#include "IszImageStream.h"
+#include "stricmp.h"
+#include "filesystem_def.h"
+#ifdef HAS_ZSTD
+#include "ZsiImageWriter.h"
+#endif
+
+//Converts ISO, CSO and ISZ disc images to the seekable zstd compressed format (ZSI)
+
+static void PrintUsage()
+{
+	printf("Usage: DiscImageConverter [options] <input image> <output image>\n");
+	printf("Options:\n");
+	printf("  -l <level>       zstd compression level (default: 19)\n");
+	printf("  -f <frame size>  Uncompressed size of each frame in bytes (default: 65536)\n");
+	printf("  -t <threads>     Number of compression threads (default: all hardware threads)\n");
+	printf("  -d               Train a dictionary on the image's sectors\n");
+}
+
+#ifdef HAS_ZSTD
+
+static std::unique_ptr<Framework::CStream> CreateInputStream(const fs::path& imagePath)
+{
+	auto extension = imagePath.extension().string();
+	auto baseStream = new Framework::CStdStream(imagePath.string().c_str(), "rb");
+	if(!stricmp(extension.c_str(), ".cso"))
+	{
+		return std::make_unique<CCsoImageStream>(baseStream);
+	}
+	else if(!stricmp(extension.c_str(), ".isz"))
+	{
+		return std::make_unique<CIszImageStream>(baseStream);
+	}
+	return std::unique_ptr<Framework::CStream>(baseStream);
+}
+
+int main(int argc, const char** argv)
+{
+	CZsiImageWriter::PARAMS params;
+	fs::path inputPath;
+	fs::path outputPath;
+
+	for(int i = 1; i < argc; i++)
+	{
+		bool hasValue = (i + 1) < argc;
+		if(!strcmp(argv[i], "-l") && hasValue)
+		{
+			params.compressionLevel = atoi(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "-f") && hasValue)
+		{
+			params.frameSize = strtoul(argv[++i], nullptr, 0);
+		}
+		else if(!strcmp(argv[i], "-t") && hasValue)
+		{
+			params.threadCount = strtoul(argv[++i], nullptr, 0);
+		}
+		else if(!strcmp(argv[i], "-d"))
+		{
+			params.trainDictionary = true;
+		}
+		else if(inputPath.empty())
+		{
+			inputPath = argv[i];
+		}
+		else if(outputPath.empty())
+		{
+			outputPath = argv[i];
+		}
+		else
+		{
+			PrintUsage();
+			return -1;
+		}
+	}
+
+	if(inputPath.empty() || outputPath.empty())
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	params.progressCallback =
+	    [](uint64 processed, uint64 total) {
+		    printf("\r%u/%u MB", static_cast<uint32>(processed / (1024 * 1024)), static_cast<uint32>(total / (1024 * 1024)));
+		    fflush(stdout);
+	    };
+
+	try
+	{
+		auto inputStream = CreateInputStream(inputPath);
+		Framework::CStdStream outputStream(outputPath.string().c_str(), "wb");
+		CZsiImageWriter::Write(*inputStream, outputStream, params);
+		printf("\nDone.\n");
+	}
+	catch(const std::exception& exception)
+	{
+		printf("\nError: %s\n", exception.what());
+		return -1;
+	}
+
+	return 0;
+}
+
+#else
+
+int main(int argc, const char** argv)
+{
+	PrintUsage();
+	printf("ZSI support was disabled during build configuration.\n");
+	return -1;
+}
+
+#endif
@@ -0,0 +1,124 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "ee/EeLibcHle.h"
+#include "Ps2Const.h"
+
+//Checks that libc routines are hooked only where their code matches and that
+//hooks are dropped once the code they were installed on is replaced
+
+// clang-format off
+//memset as found in the PS2 SDK's libc, branch offsets are not part of the pattern
+static const uint32 g_memsetCode[] =
+{
+	0x2CC20008, 0x14400010, 0x0080182D, 0x3082000F, 0x14400010, 0x0080382D, 0x30A900FF, 0x2CCA0020,
+	0x0120402D, 0x00081A38, 0x00694025, 0x70081EE9, 0x15400010, 0x2CC20008, 0x70634389, 0x7CE80000,
+	0x24C6FFE0, 0x24E70010, 0x2CC20020, 0x7CE80000, 0x1040FFFA, 0x24E70010, 0x10000010, 0x2CC20008,
+	0x24C6FFF8, 0x24E70008, 0x2CC20008, 0x00000000, 0x00000000, 0x5040FFFB, 0xFCE30000, 0x00E0182D,
+	0x3C02FFFF, 0x24C6FFFF, 0x3442FFFF, 0x10C20010, 0x00000000, 0x3C02FFFF, 0x3442FFFF, 0xA0650000,
+	0x24C6FFFF, 0x00000000, 0x00000000, 0x24C6FFFF, 0x24A50001, 0xA0620000, 0x24630001, 0x14C4FFFB,
+	0x00000000, 0x03E00008, 0x0100102D,
+};
+// clang-format on
+
+static const uint32 g_codeAddress = 0x00100000;
+static const uint32 g_codeSize = sizeof(g_memsetCode);
+static const uint32 g_returnAddress = 0x00100400;
+
+static uint32 TranslateAddress(CMIPS*, uint32 address)
+{
+	return address & 0x1FFFFFFF;
+}
+
+static void SetupCall(CMIPS& context, uint32 dstAddress, uint8 value, uint32 size)
+{
+	context.m_State.nGPR[CMIPS::A0].nD0 = dstAddress;
+	context.m_State.nGPR[CMIPS::A1].nD0 = value;
+	context.m_State.nGPR[CMIPS::A2].nD0 = size;
+	context.m_State.nGPR[CMIPS::RA].nD0 = g_returnAddress;
+	context.m_State.nGPR[CMIPS::V0].nD0 = 0;
+	context.m_State.nPC = g_codeAddress;
+	context.m_State.cycleQuota = 10000;
+}
+
+static bool CheckCase(const char* caseName, bool condition)
+{
+	if(!condition)
+	{
+		printf("%s: failed.\r\n", caseName);
+	}
+	return condition;
+}
+
+int main(int argc, const char** argv)
+{
+	std::vector<uint8> ram(PS2::EE_RAM_SIZE);
+	memcpy(ram.data() + g_codeAddress, g_memsetCode, g_codeSize);
+
+	CMIPS context(MEMORYMAP_ENDIAN_LSBF);
+	context.m_pAddrTranslator = TranslateAddress;
+
+	CEeLibcHle libcHle(context, ram.data());
+	libcHle.SetEnabled(true);
+	libcHle.FindHooks(g_codeAddress - 0x100, g_codeAddress + g_codeSize + 0x100);
+
+	unsigned int failedCount = 0;
+
+	if(!CheckCase("Match", libcHle.HasHookAt(g_codeAddress) && !libcHle.HasHookAt(g_codeAddress + 4)))
+	{
+		failedCount++;
+	}
+
+	{
+		static const uint32 dstAddress = 0x00200003;
+		static const uint32 size = 0x45;
+		SetupCall(context, dstAddress, 0xAB, size);
+		bool executed = libcHle.ExecuteHook(g_codeAddress);
+		bool filled = true;
+		for(uint32 i = 0; i < size; i++)
+		{
+			filled &= (ram[dstAddress + i] == 0xAB);
+		}
+		filled &= (ram[dstAddress - 1] == 0) && (ram[dstAddress + size] == 0);
+		bool returned = (context.m_State.nPC == g_returnAddress) && (context.m_State.nGPR[CMIPS::V0].nV0 == dstAddress);
+		if(!CheckCase("Execute", executed && filled && returned))
+		{
+			failedCount++;
+		}
+	}
+
+	{
+		//Scratchpad isn't handled natively, emulated routine needs to run
+		SetupCall(context, 0x70000000, 0xCD, 0x10);
+		bool executed = libcHle.ExecuteHook(g_codeAddress);
+		if(!CheckCase("Fallback", !executed && (context.m_State.nPC == g_codeAddress)))
+		{
+			failedCount++;
+		}
+	}
+
+	{
+		//Overlay loaded over the routine, hook must not be used anymore
+		*reinterpret_cast<uint32*>(ram.data() + g_codeAddress + 0x10) = 0x24020001;
+		bool hooked = libcHle.HasHookAt(g_codeAddress);
+		SetupCall(context, 0x00200100, 0xEF, 0x10);
+		bool executed = libcHle.ExecuteHook(g_codeAddress);
+		if(!CheckCase("Replaced", !hooked && !executed && (ram[0x00200100] == 0)))
+		{
+			failedCount++;
+		}
+	}
+
+	{
+		//Rescanning an executable whose routine was restored hooks it again
+		memcpy(ram.data() + g_codeAddress, g_memsetCode, g_codeSize);
+		libcHle.FindHooks(g_codeAddress, g_codeAddress + g_codeSize);
+		if(!CheckCase("Rescan", libcHle.HasHookAt(g_codeAddress)))
+		{
+			failedCount++;
+		}
+	}
+
+	printf("%d failure(s).\r\n", failedCount);
+	return (failedCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+#include <cstdio>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "iop/IopBios.h"
+#include "iop/Iop_SubSystem.h"
+
+//Checks that the thread picked by the scheduler's ready queue is the one a walk of
+//the thread link list gives, while threads are started, stopped, delayed, put to sleep,
+//woken up and have their priority changed in random order
+
+//Thread ids past the thread table are reported as null by GetThread
+static const uint32 g_maxThreadId = 0x100;
+static const uint32 g_maxTestThreadCount = 48;
+static const uint32 g_priorityCount = 8;
+static const uint32 g_stepCount = 50000;
+
+//Link list walk the scheduler used before the ready queue was introduced
+static int32 FindNextReadyThreadInList(CIopBios& bios)
+{
+	//Linked threads are the running ones, the head is the only one no other thread links to
+	std::vector<bool> isLinkTarget(g_maxThreadId, false);
+	std::vector<uint32> linkedThreadIds;
+	for(uint32 threadId = 0; threadId < g_maxThreadId; threadId++)
+	{
+		auto thread = bios.GetThread(threadId);
+		if(!thread || (thread->status != CIopBios::THREAD_STATUS_RUNNING)) continue;
+		linkedThreadIds.push_back(threadId);
+		if(thread->nextThreadId < g_maxThreadId)
+		{
+			isLinkTarget[thread->nextThreadId] = true;
+		}
+	}
+
+	uint32 nextThreadId = 0;
+	for(auto threadId : linkedThreadIds)
+	{
+		if(!isLinkTarget[threadId])
+		{
+			nextThreadId = threadId;
+			break;
+		}
+	}
+
+	while(nextThreadId != 0)
+	{
+		auto thread = bios.GetThread(nextThreadId);
+		nextThreadId = thread->nextThreadId;
+		if(bios.GetCurrentTime() <= thread->nextActivateTime) continue;
+		return thread->id;
+	}
+	return -1;
+}
+
+static uint32 PickThread(std::mt19937& generator, const std::vector<uint32>& threadIds)
+{
+	return threadIds[generator() % threadIds.size()];
+}
+
+int main(int argc, const char** argv)
+{
+	Iop::CSubSystem subSystem(true);
+	subSystem.Reset();
+	auto bios = static_cast<CIopBios*>(subSystem.m_bios.get());
+	bios->Reset(std::shared_ptr<Iop::CSifMan>());
+
+	std::mt19937 generator(0x1E0);
+	std::vector<uint32> testThreadIds;
+	unsigned int failedCount = 0;
+
+	for(uint32 step = 0; step < g_stepCount; step++)
+	{
+		int32 currentThreadId = bios->GetCurrentThreadIdRaw();
+		auto currentThread = (currentThreadId != -1) ? bios->GetThread(currentThreadId) : nullptr;
+		bool currentIsTestThread = currentThread && (std::find(testThreadIds.begin(), testThreadIds.end(), static_cast<uint32>(currentThreadId)) != testThreadIds.end());
+
+		std::vector<uint32> dormantThreadIds;
+		std::vector<uint32> sleepingThreadIds;
+		std::vector<uint32> stoppableThreadIds;
+		for(auto threadId : testThreadIds)
+		{
+			auto thread = bios->GetThread(threadId);
+			if(thread->status == CIopBios::THREAD_STATUS_DORMANT) dormantThreadIds.push_back(threadId);
+			if(thread->status == CIopBios::THREAD_STATUS_SLEEPING) sleepingThreadIds.push_back(threadId);
+			if((thread->status != CIopBios::THREAD_STATUS_DORMANT) && (static_cast<int32>(threadId) != currentThreadId)) stoppableThreadIds.push_back(threadId);
+		}
+
+		switch(generator() % 9)
+		{
+		case 0:
+			if(testThreadIds.size() < g_maxTestThreadCount)
+			{
+				uint32 threadId = bios->CreateThread(0x1000, 1 + (generator() % g_priorityCount), 0x400, 0, 0);
+				testThreadIds.push_back(threadId);
+				bios->StartThread(threadId, 0);
+			}
+			break;
+		case 1:
+			if(!testThreadIds.empty())
+			{
+				bios->ChangeThreadPriority(PickThread(generator, testThreadIds), 1 + (generator() % g_priorityCount));
+			}
+			break;
+		case 2:
+			if(!stoppableThreadIds.empty())
+			{
+				bios->TerminateThread(PickThread(generator, stoppableThreadIds));
+			}
+			break;
+		case 3:
+			if(!dormantThreadIds.empty())
+			{
+				bios->StartThread(PickThread(generator, dormantThreadIds), 0);
+			}
+			break;
+		case 4:
+			if(currentIsTestThread && (currentThread->status == CIopBios::THREAD_STATUS_RUNNING))
+			{
+				bios->DelayThreadTicks(generator() % 2000);
+			}
+			break;
+		case 5:
+			if(currentIsTestThread && (currentThread->status == CIopBios::THREAD_STATUS_RUNNING))
+			{
+				bios->SleepThread();
+			}
+			break;
+		case 6:
+			if(!sleepingThreadIds.empty())
+			{
+				bios->WakeupThread(PickThread(generator, sleepingThreadIds), false);
+			}
+			break;
+		case 7:
+			bios->RotateThreadReadyQueue(1 + (generator() % g_priorityCount));
+			break;
+		case 8:
+			bios->CountTicks(generator() % 1500);
+			break;
+		}
+
+		int32 expectedThreadId = FindNextReadyThreadInList(*bios);
+		bios->Reschedule();
+		int32 pickedThreadId = bios->GetCurrentThreadIdRaw();
+		if(pickedThreadId != expectedThreadId)
+		{
+			printf("Step %d: picked thread %d, expected thread %d.\r\n", step, pickedThreadId, expectedThreadId);
+			failedCount++;
+			break;
+		}
+	}
+
+	printf("%d failure(s).\r\n", failedCount);
+	return (failedCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "MIPS.h"
+#include "Ps2Const.h"
+#include "ee/DMAC.h"
+#include "ee/INTC.h"
+#include "ee/IPU.h"
+
+//Checks that the bitstream position survives the sequence used by sceMpeg to reposition
+//the IPU: stop DMA4, rewind MADR by what IPU_BP says is still in the IN FIFO, BCLR with
+//the bit position and restart DMA4. This must hold when commands run on the async worker,
+//which is only possible if DMA4 never runs ahead of what the IN FIFO accounts for.
+
+static const uint32 g_streamAddress = 0x00100000;
+static const uint32 g_streamSize = 0x10000;
+static const uint32 g_commandCount = 2000;
+static const uint32 g_repositionInterval = 37;
+static const unsigned int g_maxPollCount = 1000000;
+
+enum
+{
+	IPU_CMD_BCLR = 0,
+	IPU_CMD_FDEC = 4,
+};
+
+class CIpuContext
+{
+public:
+	CIpuContext(uint8* ram, bool asyncEnabled)
+	    : m_ram(ram)
+	    , m_ee(MEMORYMAP_ENDIAN_LSBF)
+	    , m_spr(PS2::EE_SPR_SIZE)
+	    , m_vuMem(PS2::VUMEM0SIZE)
+	    , m_dmac(ram, m_spr.data(), m_vuMem.data(), m_ee)
+	    , m_intc(m_dmac)
+	    , m_ipu(m_intc)
+	{
+		m_ipu.SetDMA3ReceiveHandler([](const void*, uint32 qwc) { return qwc; });
+		m_ipu.SetAsyncEnabled(asyncEnabled);
+		StartDma(g_streamAddress, g_streamSize / 0x10);
+	}
+
+	~CIpuContext()
+	{
+		m_ipu.SetAsyncEnabled(false);
+	}
+
+	void StartDma(uint32 address, uint32 qwc)
+	{
+		m_dmaAddress = address;
+		m_dmaQwc = qwc;
+		m_dmaStarted = true;
+	}
+
+	void StopDma()
+	{
+		m_dmaStarted = false;
+	}
+
+	//Returns false if the command never completes
+	bool RunCommand(uint32 command)
+	{
+		m_ipu.SetRegister(CIPU::IPU_CMD, command);
+		for(unsigned int i = 0; i < g_maxPollCount; i++)
+		{
+			ResumeDma();
+			if(m_ipu.IsAsyncEnabled())
+			{
+				m_ipu.ProcessAsyncEvents();
+			}
+			else if(m_ipu.WillExecuteCommand())
+			{
+				m_ipu.ExecuteCommand();
+			}
+			if((m_ipu.GetRegister(CIPU::IPU_CTRL) & 0x80000000) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	uint32 GetCommandResult()
+	{
+		return m_ipu.GetRegister(CIPU::IPU_CMD);
+	}
+
+	//What sceMpeg does to move to another spot in the stream, here the same spot
+	bool Reposition()
+	{
+		StopDma();
+		uint32 bp = m_ipu.GetRegister(CIPU::IPU_BP);
+		uint32 fifoQwc = ((bp >> 8) & 0xFF) + ((bp >> 16) & 0x03);
+		uint32 address = m_dmaAddress - (fifoQwc * 0x10);
+		uint32 qwc = m_dmaQwc + fifoQwc;
+		if(!RunCommand((IPU_CMD_BCLR << 28) | (bp & 0x7F))) return false;
+		StartDma(address, qwc);
+		return true;
+	}
+
+private:
+	void ResumeDma()
+	{
+		if(!m_dmaStarted || (m_dmaQwc == 0)) return;
+		uint32 transferredQwc = m_ipu.ReceiveDMA4(m_dmaAddress, m_dmaQwc, false, m_ram, m_spr.data());
+		m_dmaAddress += transferredQwc * 0x10;
+		m_dmaQwc -= transferredQwc;
+	}
+
+	uint8* m_ram = nullptr;
+	CMIPS m_ee;
+	std::vector<uint8> m_spr;
+	std::vector<uint8> m_vuMem;
+	CDMAC m_dmac;
+	CINTC m_intc;
+	CIPU m_ipu;
+
+	bool m_dmaStarted = false;
+	uint32 m_dmaAddress = 0;
+	uint32 m_dmaQwc = 0;
+};
+
+static bool CheckCase(const char* caseName, bool condition)
+{
+	if(!condition)
+	{
+		printf("%s: failed.\r\n", caseName);
+	}
+	return condition;
+}
+
+static bool RunCommands(CIpuContext& context, const std::vector<uint32>& skips, bool reposition, std::vector<uint32>& results)
+{
+	for(uint32 i = 0; i < skips.size(); i++)
+	{
+		if(reposition && ((i % g_repositionInterval) == (g_repositionInterval - 1)))
+		{
+			if(!context.Reposition()) return false;
+		}
+		if(!context.RunCommand((IPU_CMD_FDEC << 28) | skips[i])) return false;
+		results.push_back(context.GetCommandResult());
+	}
+	return true;
+}
+
+int main(int argc, const char** argv)
+{
+	std::vector<uint8> ram(PS2::EE_RAM_SIZE);
+	std::mt19937 generator(0x1D4);
+	for(uint32 i = 0; i < g_streamSize; i++)
+	{
+		ram[g_streamAddress + i] = static_cast<uint8>(generator());
+	}
+
+	//FDEC skips up to 63 bits before reading 32 bits, stays well within the stream
+	std::vector<uint32> skips(g_commandCount);
+	for(auto& skip : skips)
+	{
+		skip = generator() % 64;
+	}
+
+	unsigned int failedCount = 0;
+
+	std::vector<uint32> referenceResults;
+	{
+		CIpuContext context(ram.data(), false);
+		if(!CheckCase("Reference", RunCommands(context, skips, false, referenceResults)))
+		{
+			failedCount++;
+		}
+	}
+
+	static const struct
+	{
+		const char* name;
+		bool asyncEnabled;
+	} g_cases[] =
+	    {
+	        {"Reposition", false},
+	        {"RepositionAsync", true},
+	    };
+
+	for(const auto& testCase : g_cases)
+	{
+		std::vector<uint32> results;
+		CIpuContext context(ram.data(), testCase.asyncEnabled);
+		bool completed = RunCommands(context, skips, true, results);
+		if(!CheckCase(testCase.name, completed && (results == referenceResults)))
+		{
+			failedCount++;
+		}
+	}
+
+	printf("%d failure(s).\r\n", failedCount);
+	return (failedCount == 0) ? 0 : 1;
+}
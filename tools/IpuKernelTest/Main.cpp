@@ -0,0 +1,545 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include "ee/IPU_Csc.h"
+#include "ee/IPU_Idct.h"
+#include "ee/IPU_DctCoefficientLookupTable.h"
+#include "mpeg2/DctCoefficientTable0.h"
+#include "mpeg2/DctCoefficientTable1.h"
+
+//Checks that the fixed point CSC gives the same results as a straightforward floating point
+//implementation, that the integer IDCT meets the IEEE 1180 accuracy requirements against a
+//floating point reference, and that decoding DCT coefficients through the lookup table
+//gives the same results as going through the coefficient tables
+
+using namespace MPEG2;
+
+static uint32 g_randomState = 0x12345678;
+
+static uint32 NextRandom()
+{
+	g_randomState = (g_randomState * 1103515245) + 12345;
+	return g_randomState >> 8;
+}
+
+//Products go through volatile variables to keep the compiler from fusing them with the
+//following additions, which would change the results depending on the target
+
+static uint32 ConvertPixelReference(uint8 y, uint8 cb, uint8 cr, uint16 TH0, uint16 TH1)
+{
+	float nY = y;
+	float nCb = cb;
+	float nCr = cr;
+
+	volatile float crToR = 1.402f * (nCr - 128);
+	volatile float cbToG = 0.34414f * (nCb - 128);
+	volatile float crToG = 0.71414f * (nCr - 128);
+	volatile float cbToB = 1.772f * (nCb - 128);
+
+	float nR = nY + crToR;
+	float nG = nY - cbToG - crToG;
+	float nB = nY + cbToB;
+
+	nR = std::min<float>(std::max<float>(nR, 0), 255);
+	nG = std::min<float>(std::max<float>(nG, 0), 255);
+	nB = std::min<float>(std::max<float>(nB, 0), 255);
+
+	uint32 alphaTh0 = (TH0 & 0xFF) | ((TH0 & 0xFF) << 8) | ((TH0 & 0xFF) << 16);
+	uint32 alphaTh1 = (TH1 & 0xFF) | ((TH1 & 0xFF) << 8) | ((TH1 & 0xFF) << 16);
+
+	uint32 rgb = (static_cast<uint8>(nB) << 16) | (static_cast<uint8>(nG) << 8) | (static_cast<uint8>(nR) << 0);
+	uint32 a = (rgb < alphaTh0) ? 0 : ((rgb < alphaTh1) ? 0x40 : 0x80);
+	return (a << 24) | rgb;
+}
+
+static void TransformReference(const int16* source, int16* dest)
+{
+	static const double pi = 3.14159265358979323846;
+
+	double c[8][8];
+	for(unsigned int freq = 0; freq < 8; freq++)
+	{
+		double scale = (freq == 0) ? sqrt(0.125) : 0.5;
+		for(unsigned int time = 0; time < 8; time++)
+		{
+			c[freq][time] = scale * cos((pi / 8.0) * freq * (time + 0.5));
+		}
+	}
+
+	double temp[64];
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		for(unsigned int j = 0; j < 8; j++)
+		{
+			double partial = 0.0;
+			for(unsigned int k = 0; k < 8; k++)
+			{
+				volatile double product = c[k][j] * source[(8 * i) + k];
+				partial += product;
+			}
+			temp[(8 * i) + j] = partial;
+		}
+	}
+
+	for(unsigned int j = 0; j < 8; j++)
+	{
+		for(unsigned int i = 0; i < 8; i++)
+		{
+			double partial = 0.0;
+			for(unsigned int k = 0; k < 8; k++)
+			{
+				volatile double product = c[k][i] * temp[(8 * k) + j];
+				partial += product;
+			}
+			int32 value = static_cast<int32>(floor(partial + 0.5));
+			dest[(8 * i) + j] = static_cast<int16>(std::min<int32>(std::max<int32>(value, -256), 255));
+		}
+	}
+}
+
+//Bit stream over a byte buffer, most significant bit first
+class CMemoryBitStream : public Framework::CBitStream
+{
+public:
+	CMemoryBitStream(const std::vector<uint8>& data, unsigned int bitCount)
+	    : m_data(data)
+	    , m_bitCount(bitCount)
+	{
+	}
+
+	void Advance(uint8 bits) override
+	{
+		if((m_position + bits) > m_bitCount)
+		{
+			throw CBitStreamException();
+		}
+		m_position += bits;
+	}
+
+	uint8 GetBitIndex() const override
+	{
+		return static_cast<uint8>(m_position);
+	}
+
+	bool TryPeekBits_LSBF(uint8, uint32&) override
+	{
+		return false;
+	}
+
+	bool TryPeekBits_MSBF(uint8 size, uint32& result) override
+	{
+		if((m_position + size) > m_bitCount)
+		{
+			return false;
+		}
+		uint64 bits = 0;
+		unsigned int byteIndex = m_position / 8;
+		for(unsigned int i = 0; i < 8; i++)
+		{
+			bits <<= 8;
+			if((byteIndex + i) < m_data.size())
+			{
+				bits |= m_data[byteIndex + i];
+			}
+		}
+		result = static_cast<uint32>((bits << (m_position % 8)) >> (64 - size));
+		return true;
+	}
+
+	unsigned int GetPosition() const
+	{
+		return m_position;
+	}
+
+private:
+	const std::vector<uint8>& m_data;
+	unsigned int m_bitCount = 0;
+	unsigned int m_position = 0;
+};
+
+enum DECODE_RESULT
+{
+	DECODE_COEFF,
+	DECODE_EOB,
+	DECODE_NOTENOUGHDATA,
+	DECODE_ERROR,
+};
+
+struct DECODE_STATE
+{
+	int16 block[64] = {};
+	unsigned int blockIndex = 0;
+};
+
+//One pass through the CHECKEOB, READCOEFF and SKIPEOB states of BDEC without the lookup table
+static DECODE_RESULT DecodeCoeffSlow(CDctCoefficientTable& table, bool isMpeg2, Framework::CBitStream& stream, DECODE_STATE& state)
+{
+	bool isEob = false;
+	if(table.TryIsEndOfBlock(&stream, isEob) != CVLCTable::DECODE_STATUS_SUCCESS)
+	{
+		return DECODE_NOTENOUGHDATA;
+	}
+	if((state.blockIndex != 0) && isEob)
+	{
+		return (table.TrySkipEndOfBlock(&stream) == CVLCTable::DECODE_STATUS_SUCCESS) ? DECODE_EOB : DECODE_NOTENOUGHDATA;
+	}
+	RUNLEVELPAIR runLevelPair;
+	auto status = (state.blockIndex == 0) ? table.TryGetRunLevelPairDc(&stream, &runLevelPair, isMpeg2) : table.TryGetRunLevelPair(&stream, &runLevelPair, isMpeg2);
+	switch(status)
+	{
+	case CVLCTable::DECODE_STATUS_SUCCESS:
+		break;
+	case CVLCTable::DECODE_STATUS_SYMBOLNOTFOUND:
+		return DECODE_ERROR;
+	default:
+		return DECODE_NOTENOUGHDATA;
+	}
+	state.blockIndex += runLevelPair.run;
+	if(state.blockIndex >= 0x40)
+	{
+		return DECODE_ERROR;
+	}
+	state.block[state.blockIndex] = static_cast<int16>(runLevelPair.level);
+	state.blockIndex++;
+	return DECODE_COEFF;
+}
+
+static DECODE_RESULT DecodeCoeffsReference(CDctCoefficientTable& table, bool isMpeg2, Framework::CBitStream& stream, DECODE_STATE& state)
+{
+	try
+	{
+		while(1)
+		{
+			auto result = DecodeCoeffSlow(table, isMpeg2, stream, state);
+			if(result != DECODE_COEFF) return result;
+		}
+	}
+	catch(...)
+	{
+		return DECODE_ERROR;
+	}
+}
+
+//Lookup table first and coefficient table when it gives up, like BDEC does
+static DECODE_RESULT DecodeCoeffsLookup(const IPU::CDctCoefficientLookupTable& lookupTable, CDctCoefficientTable& table, bool isMpeg2,
+                                        Framework::CBitStream& stream, DECODE_STATE& state)
+{
+	try
+	{
+		while(1)
+		{
+			if(lookupTable.TryDecodeCoeffs(stream, state.block, state.blockIndex)) return DECODE_EOB;
+			auto result = DecodeCoeffSlow(table, isMpeg2, stream, state);
+			if(result != DECODE_COEFF) return result;
+		}
+	}
+	catch(...)
+	{
+		return DECODE_ERROR;
+	}
+}
+
+//Random codes with frequent escapes, long codes and block ends, cut at a random length
+static unsigned int GenerateCoeffStream(std::vector<uint8>& data)
+{
+	data.clear();
+	unsigned int bitCount = 0;
+	auto writeBits = [&](uint32 value, unsigned int size) {
+		for(unsigned int i = 0; i < size; i++)
+		{
+			if((bitCount % 8) == 0) data.push_back(0);
+			if((value >> (size - i - 1)) & 1) data.back() |= (0x80 >> (bitCount % 8));
+			bitCount++;
+		}
+	};
+	unsigned int chunkCount = 1 + (NextRandom() % 32);
+	for(unsigned int i = 0; i < chunkCount; i++)
+	{
+		switch(NextRandom() % 5)
+		{
+		case 0:
+			//Escape followed by run and level bits
+			writeBits(0x01, 6);
+			writeBits(NextRandom(), 24);
+			break;
+		case 1:
+			//Long codes
+			writeBits(0, 4 + (NextRandom() % 8));
+			writeBits(1, 1);
+			writeBits(NextRandom(), 6);
+			break;
+		case 2:
+			//End of block in table 0 and table 1
+			if(NextRandom() % 2)
+			{
+				writeBits(0x2, 2);
+			}
+			else
+			{
+				writeBits(0x6, 4);
+			}
+			break;
+		default:
+			writeBits(NextRandom(), 1 + (NextRandom() % 16));
+			break;
+		}
+	}
+	return bitCount - (NextRandom() % std::min<unsigned int>(bitCount, 8));
+}
+
+static bool TestDctCoefficientDecoding()
+{
+	std::vector<uint8> data;
+	unsigned int resultCounts[4] = {};
+	for(unsigned int tableIndex = 0; tableIndex < 4; tableIndex++)
+	{
+		bool isTable1 = (tableIndex & 1) != 0;
+		bool isMpeg2 = (tableIndex & 2) != 0;
+		auto& table = isTable1 ? CDctCoefficientTable1::GetInstance() : CDctCoefficientTable0::GetInstance();
+		const auto& lookupTable = IPU::CDctCoefficientLookupTable::GetInstance(isTable1, isMpeg2);
+		for(unsigned int streamIndex = 0; streamIndex < 50000; streamIndex++)
+		{
+			unsigned int bitCount = GenerateCoeffStream(data);
+			//Intra blocks start after the DC coefficient
+			bool isIntra = (streamIndex % 2) != 0;
+
+			CMemoryBitStream referenceStream(data, bitCount);
+			DECODE_STATE referenceState;
+			referenceState.blockIndex = isIntra ? 1 : 0;
+			auto referenceResult = DecodeCoeffsReference(table, isMpeg2, referenceStream, referenceState);
+
+			CMemoryBitStream stream(data, bitCount);
+			DECODE_STATE state;
+			state.blockIndex = isIntra ? 1 : 0;
+			auto result = DecodeCoeffsLookup(lookupTable, table, isMpeg2, stream, state);
+
+			bool matches = (result == referenceResult);
+			if(matches && (result != DECODE_ERROR))
+			{
+				matches = (state.blockIndex == referenceState.blockIndex) &&
+				          (stream.GetPosition() == referenceStream.GetPosition()) &&
+				          (memcmp(state.block, referenceState.block, sizeof(state.block)) == 0);
+			}
+			if(!matches)
+			{
+				printf("DCT coefficient mismatch (table %d, MPEG%d, %s) at stream %d.\r\n",
+				       isTable1 ? 1 : 0, isMpeg2 ? 2 : 1, isIntra ? "intra" : "non intra", streamIndex);
+				return false;
+			}
+			resultCounts[result]++;
+		}
+	}
+	//Make sure streams reach every outcome
+	return (resultCounts[DECODE_EOB] != 0) && (resultCounts[DECODE_NOTENOUGHDATA] != 0) && (resultCounts[DECODE_ERROR] != 0);
+}
+
+static bool TestCsc()
+{
+	//Every Y/Cb/Cr combination is covered: each block holds 64 Cb/Cr pairs and
+	//each pair is seen with 4 luma values per block
+	auto csc = IPU::CCsc::GetInstance();
+	uint8 block[IPU::CCsc::BLOCK_SIZE];
+	uint32 pixels[IPU::CCsc::PIXEL_COUNT];
+	for(unsigned int chromaGroup = 0; chromaGroup < 0x400; chromaGroup++)
+	{
+		for(unsigned int lumaGroup = 0; lumaGroup < 0x40; lumaGroup++)
+		{
+			for(unsigned int i = 0; i < 0x40; i++)
+			{
+				unsigned int pair = (chromaGroup * 0x40) + i;
+				block[0x100 + i] = static_cast<uint8>(pair >> 8);
+				block[0x140 + i] = static_cast<uint8>(pair);
+			}
+			for(unsigned int i = 0; i < 0x100; i++)
+			{
+				unsigned int subPosition = (((i / 0x10) & 1) * 2) + (i & 1);
+				block[i] = static_cast<uint8>((lumaGroup * 4) + subPosition);
+			}
+
+			uint16 TH0 = static_cast<uint16>(NextRandom() & 0x1FF);
+			uint16 TH1 = static_cast<uint16>(NextRandom() & 0x1FF);
+			csc->ConvertBlockRgb32(block, pixels, TH0, TH1);
+
+			for(unsigned int i = 0; i < 0x100; i++)
+			{
+				unsigned int chromaIndex = ((i / 0x20) * 8) + ((i & 0xF) / 2);
+				uint8 y = block[i];
+				uint8 cb = block[0x100 + chromaIndex];
+				uint8 cr = block[0x140 + chromaIndex];
+				uint32 reference = ConvertPixelReference(y, cb, cr, TH0, TH1);
+				if(pixels[i] != reference)
+				{
+					printf("CSC mismatch (Y: %d, Cb: %d, Cr: %d): got 0x%08X, expected 0x%08X.\r\n",
+					       y, cb, cr, pixels[i], reference);
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+//Random number generator from IEEE 1180, gives a value in [-L, H]
+static int32 IeeeRandom(int32 L, int32 H)
+{
+	static uint32 randomState = 1;
+	randomState = (randomState * 1103515245) + 12345;
+	double x = static_cast<double>(randomState & 0x7FFFFFFE) / static_cast<double>(0x7FFFFFFF);
+	x *= (L + H + 1);
+	return static_cast<int32>(x) - L;
+}
+
+static void ForwardTransformReference(const int32* source, int16* dest)
+{
+	static const double pi = 3.14159265358979323846;
+
+	double c[8][8];
+	for(unsigned int freq = 0; freq < 8; freq++)
+	{
+		double scale = (freq == 0) ? sqrt(0.125) : 0.5;
+		for(unsigned int time = 0; time < 8; time++)
+		{
+			c[freq][time] = scale * cos((pi / 8.0) * freq * (time + 0.5));
+		}
+	}
+
+	double temp[64];
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		for(unsigned int u = 0; u < 8; u++)
+		{
+			double partial = 0.0;
+			for(unsigned int x = 0; x < 8; x++)
+			{
+				partial += c[u][x] * source[(8 * i) + x];
+			}
+			temp[(8 * i) + u] = partial;
+		}
+	}
+
+	for(unsigned int u = 0; u < 8; u++)
+	{
+		for(unsigned int v = 0; v < 8; v++)
+		{
+			double partial = 0.0;
+			for(unsigned int y = 0; y < 8; y++)
+			{
+				partial += c[v][y] * temp[(8 * y) + u];
+			}
+			int32 value = static_cast<int32>(floor(partial + 0.5));
+			dest[(8 * v) + u] = static_cast<int16>(std::min<int32>(std::max<int32>(value, -2048), 2047));
+		}
+	}
+}
+
+//Accuracy test from IEEE 1180: blocks of random pixels are transformed with a double
+//precision forward DCT, then the inverse transform is compared with the reference
+static bool TestIdctAccuracy(int32 L, int32 H, int32 sign)
+{
+	static const unsigned int blockCount = 10000;
+
+	auto idct = IPU::CIdct::GetInstance();
+	int64 errorSums[64] = {};
+	int64 squaredErrorSums[64] = {};
+	int32 peakError = 0;
+	for(unsigned int blockIndex = 0; blockIndex < blockCount; blockIndex++)
+	{
+		int32 pixels[64];
+		for(unsigned int i = 0; i < 64; i++)
+		{
+			pixels[i] = IeeeRandom(L, H) * sign;
+		}
+
+		int16 coefficients[64];
+		ForwardTransformReference(pixels, coefficients);
+
+		int16 result[64];
+		int16 reference[64];
+		idct->Transform(coefficients, result);
+		TransformReference(coefficients, reference);
+		for(unsigned int i = 0; i < 64; i++)
+		{
+			int32 error = result[i] - reference[i];
+			peakError = std::max<int32>(peakError, std::abs(error));
+			errorSums[i] += error;
+			squaredErrorSums[i] += error * error;
+		}
+	}
+
+	int64 totalError = 0;
+	int64 totalSquaredError = 0;
+	double peakMeanError = 0;
+	double peakMeanSquaredError = 0;
+	for(unsigned int i = 0; i < 64; i++)
+	{
+		totalError += errorSums[i];
+		totalSquaredError += squaredErrorSums[i];
+		peakMeanError = std::max<double>(peakMeanError, std::abs(static_cast<double>(errorSums[i]) / blockCount));
+		peakMeanSquaredError = std::max<double>(peakMeanSquaredError, static_cast<double>(squaredErrorSums[i]) / blockCount);
+	}
+	double overallMeanError = std::abs(static_cast<double>(totalError) / (64 * blockCount));
+	double overallMeanSquaredError = static_cast<double>(totalSquaredError) / (64 * blockCount);
+
+	bool passed = (peakError <= 1) &&
+	              (peakMeanSquaredError <= 0.06) && (overallMeanSquaredError <= 0.02) &&
+	              (peakMeanError <= 0.015) && (overallMeanError <= 0.0015);
+	if(!passed)
+	{
+		printf("IDCT accuracy (L = %d, H = %d, sign = %d): peak error %d, peak mse %f, overall mse %f, peak mean error %f, overall mean error %f.\r\n",
+		       L, H, sign, peakError, peakMeanSquaredError, overallMeanSquaredError, peakMeanError, overallMeanError);
+	}
+	return passed;
+}
+
+static bool TestIdct()
+{
+	bool passed = true;
+
+	static const int32 ranges[][2] = {{256, 255}, {5, 5}, {300, 300}};
+	for(const auto& range : ranges)
+	{
+		passed &= TestIdctAccuracy(range[0], range[1], 1);
+		passed &= TestIdctAccuracy(range[0], range[1], -1);
+	}
+
+	//Blocks without coefficients must give blocks without pixels
+	int16 source[64] = {};
+	int16 result[64];
+	IPU::CIdct::GetInstance()->Transform(source, result);
+	if(std::any_of(std::begin(result), std::end(result), [](int16 value) { return value != 0; }))
+	{
+		printf("IDCT: empty block gives non zero output.\r\n");
+		passed = false;
+	}
+
+	return passed;
+}
+
+int main(int argc, const char** argv)
+{
+	unsigned int failedCount = 0;
+
+	if(!TestCsc())
+	{
+		printf("CSC: failed.\r\n");
+		failedCount++;
+	}
+
+	if(!TestIdct())
+	{
+		printf("IDCT: failed.\r\n");
+		failedCount++;
+	}
+
+	if(!TestDctCoefficientDecoding())
+	{
+		printf("DCT coefficient decoding: failed.\r\n");
+		failedCount++;
+	}
+
+	printf("%d failure(s).\r\n", failedCount);
+	return (failedCount == 0) ? 0 : 1;
+}
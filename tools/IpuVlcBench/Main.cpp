@@ -0,0 +1,379 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include "StdStream.h"
+#include "ee/IPU_DctCoefficientLookupTable.h"
+#include "ee/IPU_MacroblockAddressIncrementTable.h"
+#include "mpeg2/DcSizeLuminanceTable.h"
+#include "mpeg2/DcSizeChrominanceTable.h"
+#include "mpeg2/DctCoefficientTable0.h"
+#include "mpeg2/DctCoefficientTable1.h"
+
+//Measures DCT coefficient decoding speed over the intra pictures of an MPEG-1/MPEG-2 video
+//elementary stream, going through the coefficient tables only and through the lookup table
+//first, like BDEC does. Slices are parsed the way a game drives the IPU for intra macroblocks.
+//Usage: IpuVlcBench <video stream path> [iteration count]
+
+using namespace MPEG2;
+
+struct SLICE
+{
+	std::vector<uint8> data;
+	unsigned int bitCount = 0;
+	bool isMpeg2 = false;
+	bool hasDctType = false;
+	bool intraVlcFormat = false;
+	bool hasVerticalPositionExtension = false;
+};
+
+struct DECODE_STATS
+{
+	uint64 blockCount = 0;
+	uint64 checksum = 0;
+	uint64 failedSliceCount = 0;
+};
+
+//Bit stream over a byte buffer, most significant bit first
+class CMemoryBitStream : public Framework::CBitStream
+{
+public:
+	CMemoryBitStream(const SLICE& slice)
+	    : m_data(slice.data)
+	    , m_bitCount(slice.bitCount)
+	{
+	}
+
+	void Advance(uint8 bits) override
+	{
+		if((m_position + bits) > m_bitCount)
+		{
+			throw CBitStreamException();
+		}
+		m_position += bits;
+	}
+
+	uint8 GetBitIndex() const override
+	{
+		return static_cast<uint8>(m_position);
+	}
+
+	bool TryPeekBits_LSBF(uint8, uint32&) override
+	{
+		return false;
+	}
+
+	//Data is padded so that 8 bytes can always be read from the current position
+	bool TryPeekBits_MSBF(uint8 size, uint32& result) override
+	{
+		if((m_position + size) > m_bitCount)
+		{
+			return false;
+		}
+		const uint8* bytes = m_data.data() + (m_position / 8);
+		uint64 bits = 0;
+		for(unsigned int i = 0; i < 8; i++)
+		{
+			bits = (bits << 8) | bytes[i];
+		}
+		result = static_cast<uint32>((bits << (m_position % 8)) >> (64 - size));
+		return true;
+	}
+
+private:
+	const std::vector<uint8>& m_data;
+	unsigned int m_bitCount = 0;
+	unsigned int m_position = 0;
+};
+
+static double GetElapsedSeconds(const std::chrono::steady_clock::time_point& startTime)
+{
+	auto elapsed = std::chrono::steady_clock::now() - startTime;
+	return std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+}
+
+static uint32 ReadBits(const std::vector<uint8>& data, size_t bytePosition, unsigned int bitOffset, unsigned int size)
+{
+	uint32 result = 0;
+	for(unsigned int i = 0; i < size; i++)
+	{
+		unsigned int bit = bitOffset + i;
+		size_t byteIndex = bytePosition + (bit / 8);
+		uint8 value = (byteIndex < data.size()) ? data[byteIndex] : 0;
+		result = (result << 1) | ((value >> (7 - (bit % 8))) & 1);
+	}
+	return result;
+}
+
+//Splits the stream at start codes and keeps the slices of intra pictures, along with the
+//picture parameters that affect how they are parsed
+static std::vector<SLICE> ExtractIntraSlices(const std::vector<uint8>& stream)
+{
+	std::vector<size_t> startCodes;
+	for(size_t i = 0; (i + 3) < stream.size(); i++)
+	{
+		if((stream[i] == 0) && (stream[i + 1] == 0) && (stream[i + 2] == 1))
+		{
+			startCodes.push_back(i);
+			i += 2;
+		}
+	}
+
+	std::vector<SLICE> slices;
+	bool isMpeg2 = false;
+	bool isIntraPicture = false;
+	bool isSupportedPicture = false;
+	bool isChroma420 = true;
+	bool hasDctType = false;
+	bool intraVlcFormat = false;
+	uint32 verticalSize = 0;
+	for(size_t i = 0; i < startCodes.size(); i++)
+	{
+		size_t begin = startCodes[i] + 4;
+		size_t end = ((i + 1) < startCodes.size()) ? startCodes[i + 1] : stream.size();
+		if(begin > end) continue;
+		uint8 code = stream[startCodes[i] + 3];
+		if(code == 0xB3)
+		{
+			//Sequence header
+			verticalSize = ReadBits(stream, begin, 12, 12);
+		}
+		else if(code == 0xB5)
+		{
+			uint32 extensionId = ReadBits(stream, begin, 0, 4);
+			if(extensionId == 1)
+			{
+				//Sequence extension, only 4:2:0 is handled
+				isMpeg2 = true;
+				verticalSize |= ReadBits(stream, begin, 17, 2) << 12;
+				isChroma420 = (ReadBits(stream, begin, 13, 2) == 1);
+			}
+			else if(extensionId == 8)
+			{
+				//Picture coding extension
+				uint32 pictureStructure = ReadBits(stream, begin, 22, 2);
+				bool framePredFrameDct = ReadBits(stream, begin, 25, 1) != 0;
+				bool concealmentMotionVectors = ReadBits(stream, begin, 26, 1) != 0;
+				intraVlcFormat = ReadBits(stream, begin, 28, 1) != 0;
+				hasDctType = (pictureStructure == 3) && !framePredFrameDct;
+				isSupportedPicture &= !concealmentMotionVectors;
+			}
+		}
+		else if(code == 0x00)
+		{
+			//Picture header
+			isIntraPicture = (ReadBits(stream, begin, 10, 3) == 1);
+			isSupportedPicture = isChroma420;
+			hasDctType = false;
+			intraVlcFormat = false;
+		}
+		else if((code >= 0x01) && (code <= 0xAF))
+		{
+			if(!isIntraPicture || !isSupportedPicture) continue;
+			SLICE slice;
+			slice.data.assign(stream.begin() + begin, stream.begin() + end);
+			slice.bitCount = static_cast<unsigned int>(slice.data.size() * 8);
+			slice.data.resize(slice.data.size() + 8);
+			slice.isMpeg2 = isMpeg2;
+			slice.hasDctType = hasDctType;
+			slice.intraVlcFormat = isMpeg2 && intraVlcFormat;
+			slice.hasVerticalPositionExtension = isMpeg2 && (verticalSize > 2800);
+			slices.push_back(std::move(slice));
+		}
+	}
+	return slices;
+}
+
+//Decodes coefficients through the coefficient table only
+static bool DecodeCoeffsTable(CDctCoefficientTable& table, const IPU::CDctCoefficientLookupTable&, bool isMpeg2,
+                              Framework::CBitStream& stream, int16* block, unsigned int& blockIndex)
+{
+	while(1)
+	{
+		bool isEob = false;
+		if(table.TryIsEndOfBlock(&stream, isEob) != CVLCTable::DECODE_STATUS_SUCCESS) return false;
+		if(isEob)
+		{
+			return (table.TrySkipEndOfBlock(&stream) == CVLCTable::DECODE_STATUS_SUCCESS);
+		}
+		RUNLEVELPAIR runLevelPair;
+		if(table.TryGetRunLevelPair(&stream, &runLevelPair, isMpeg2) != CVLCTable::DECODE_STATUS_SUCCESS) return false;
+		blockIndex += runLevelPair.run;
+		if(blockIndex >= 0x40) return false;
+		block[blockIndex] = static_cast<int16>(runLevelPair.level);
+		blockIndex++;
+	}
+}
+
+//Decodes coefficients through the lookup table first, then one code through the coefficient table when it gives up
+static bool DecodeCoeffsLookup(CDctCoefficientTable& table, const IPU::CDctCoefficientLookupTable& lookupTable, bool isMpeg2,
+                               Framework::CBitStream& stream, int16* block, unsigned int& blockIndex)
+{
+	while(1)
+	{
+		if(lookupTable.TryDecodeCoeffs(stream, block, blockIndex)) return true;
+		bool isEob = false;
+		if(table.TryIsEndOfBlock(&stream, isEob) != CVLCTable::DECODE_STATUS_SUCCESS) return false;
+		if(isEob)
+		{
+			return (table.TrySkipEndOfBlock(&stream) == CVLCTable::DECODE_STATUS_SUCCESS);
+		}
+		RUNLEVELPAIR runLevelPair;
+		if(table.TryGetRunLevelPair(&stream, &runLevelPair, isMpeg2) != CVLCTable::DECODE_STATUS_SUCCESS) return false;
+		blockIndex += runLevelPair.run;
+		if(blockIndex >= 0x40) return false;
+		block[blockIndex] = static_cast<int16>(runLevelPair.level);
+		blockIndex++;
+	}
+}
+
+typedef bool (*DecodeCoeffsFunction)(CDctCoefficientTable&, const IPU::CDctCoefficientLookupTable&, bool, Framework::CBitStream&, int16*, unsigned int&);
+
+//Parses the intra macroblocks of a slice, 4:2:0 only
+static bool DecodeSlice(const SLICE& slice, DecodeCoeffsFunction decodeCoeffs, DECODE_STATS& stats)
+{
+	bool isTable1 = slice.intraVlcFormat;
+	auto& table = isTable1 ? CDctCoefficientTable1::GetInstance() : CDctCoefficientTable0::GetInstance();
+	const auto& lookupTable = IPU::CDctCoefficientLookupTable::GetInstance(isTable1, slice.isMpeg2);
+
+	CMemoryBitStream stream(slice);
+	try
+	{
+		if(slice.hasVerticalPositionExtension) stream.Advance(3);
+		stream.Advance(5); //quantiser_scale_code
+		if(slice.isMpeg2 && (stream.PeekBits_MSBF(1) == 1))
+		{
+			stream.Advance(9); //intra_slice_flag, intra_slice, reserved_bits
+		}
+		while(stream.PeekBits_MSBF(1) == 1)
+		{
+			stream.Advance(9); //extra_bit_slice, extra_information_slice
+		}
+		stream.Advance(1);
+
+		uint32 bits = 0;
+		while(stream.TryPeekBits_MSBF(23, bits) && (bits != 0))
+		{
+			//Macroblock escapes and MPEG-1 stuffing
+			while(1)
+			{
+				uint32 prefix = stream.PeekBits_MSBF(11);
+				if((prefix != 0x008) && (prefix != 0x00F)) break;
+				stream.Advance(11);
+			}
+			uint32 increment = 0;
+			if(IPU::CMacroblockAddressIncrementTable::GetInstance()->TryGetSymbol(&stream, increment) != CVLCTable::DECODE_STATUS_SUCCESS) return false;
+
+			//macroblock_type is either intra ('1') or intra with quantiser_scale_code ('01')
+			bool hasQuant = (stream.PeekBits_MSBF(1) == 0);
+			stream.Advance(hasQuant ? 2 : 1);
+			if(slice.hasDctType) stream.Advance(1);
+			if(hasQuant) stream.Advance(5);
+
+			for(unsigned int blockNumber = 0; blockNumber < 6; blockNumber++)
+			{
+				auto dcSizeTable = (blockNumber < 4) ? CDcSizeLuminanceTable::GetInstance() : CDcSizeChrominanceTable::GetInstance();
+				uint32 dcSize = 0;
+				if(dcSizeTable->TryGetSymbol(&stream, dcSize) != CVLCTable::DECODE_STATUS_SUCCESS) return false;
+				if(dcSize != 0) stream.Advance(static_cast<uint8>(dcSize));
+
+				int16 block[64] = {};
+				unsigned int blockIndex = 1;
+				if(!decodeCoeffs(table, lookupTable, slice.isMpeg2, stream, block, blockIndex)) return false;
+				for(unsigned int i = 1; i < blockIndex; i++)
+				{
+					stats.checksum = (stats.checksum * 31) + static_cast<uint16>(block[i]);
+				}
+				stats.blockCount++;
+			}
+		}
+	}
+	catch(...)
+	{
+		return false;
+	}
+	return true;
+}
+
+static DECODE_STATS DecodeSlices(const std::vector<SLICE>& slices, DecodeCoeffsFunction decodeCoeffs)
+{
+	DECODE_STATS stats;
+	for(const auto& slice : slices)
+	{
+		if(!DecodeSlice(slice, decodeCoeffs, stats))
+		{
+			stats.failedSliceCount++;
+		}
+	}
+	return stats;
+}
+
+int main(int argc, const char** argv)
+{
+	if(argc < 2)
+	{
+		printf("Usage: IpuVlcBench <video stream path> [iteration count]\r\n");
+		return 1;
+	}
+
+	uint32 iterationCount = (argc >= 3) ? atoi(argv[2]) : 20;
+
+	std::vector<uint8> stream;
+	{
+		Framework::CStdStream input(argv[1], "rb");
+		stream.resize(input.GetLength());
+		input.Read(stream.data(), stream.size());
+	}
+
+	auto slices = ExtractIntraSlices(stream);
+	if(slices.empty())
+	{
+		printf("No intra picture slices found.\r\n");
+		return 1;
+	}
+
+	//Prepare the tables before timing
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		IPU::CDctCoefficientLookupTable::GetInstance((i & 1) != 0, (i & 2) != 0);
+	}
+
+	static const struct
+	{
+		const char* name;
+		DecodeCoeffsFunction decodeCoeffs;
+	} decoders[] =
+	    {
+	        {"Coefficient table", &DecodeCoeffsTable},
+	        {"Lookup table", &DecodeCoeffsLookup},
+	    };
+
+	DECODE_STATS referenceStats;
+	for(const auto& decoder : decoders)
+	{
+		DECODE_STATS stats;
+		auto startTime = std::chrono::steady_clock::now();
+		for(uint32 i = 0; i < iterationCount; i++)
+		{
+			stats = DecodeSlices(slices, decoder.decodeCoeffs);
+		}
+		double seconds = GetElapsedSeconds(startTime);
+
+		double blockCount = static_cast<double>(stats.blockCount) * iterationCount;
+		printf("%-18s %8.2f Mblocks/s, %d slice(s), %d failed, checksum 0x%016llX\r\n", decoder.name,
+		       blockCount / (seconds * 1000000.0), static_cast<int>(slices.size()), static_cast<int>(stats.failedSliceCount),
+		       static_cast<unsigned long long>(stats.checksum));
+
+		if(decoder.decodeCoeffs == &DecodeCoeffsTable)
+		{
+			referenceStats = stats;
+		}
+		else if((stats.checksum != referenceStats.checksum) || (stats.blockCount != referenceStats.blockCount))
+		{
+			printf("Decoded coefficients differ from the coefficient table results.\r\n");
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,187 @@
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "filesystem_def.h"
+#include "PS2VM.h"
+#include "ee/PS2OS.h"
+#include "gs/GSH_Null.h"
+#include "ELF.h"
+#include "MIPSAssembler.h"
+#include "StdStreamUtils.h"
+#include "string_format.h"
+
+//Runs several virtual machines at once, each one on its own thread. Programs keep patching
+//their own code, every patch goes through the EE executor's fault handler which needs to
+//find the machine owning the faulting address. Each machine has to end up with its own result.
+
+#define VM_COUNT (4)
+#define LOOP_COUNT (256)
+#define PATCH_STEP (3)
+#define TIMEOUT_SECONDS (60)
+
+#define PROGRAM_ADDRESS (0x00100000)
+//Function being patched is on a different page than the main loop
+#define FUNCTION_ADDRESS (0x00101000)
+#define RESULT_ADDRESS (0x00200000)
+
+#define ADDIU_V0_R0_OPCODE (0x24020000)
+#define SYSCALL_EXIT (0x04)
+
+static std::vector<uint32> AssembleProgram(uint16 seed)
+{
+	std::vector<uint32> program(((FUNCTION_ADDRESS - PROGRAM_ADDRESS) / 4) + 2, 0);
+
+	{
+		CMIPSAssembler assembler(program.data());
+		auto loopLabel = assembler.CreateLabel();
+
+		assembler.LI(CMIPS::S0, FUNCTION_ADDRESS);
+		assembler.LI(CMIPS::S1, ADDIU_V0_R0_OPCODE);
+		assembler.LI(CMIPS::S2, seed);
+		assembler.LI(CMIPS::S3, LOOP_COUNT);
+		assembler.ADDU(CMIPS::S4, CMIPS::R0, CMIPS::R0);
+
+		//Rewrite the function's return value, call it and accumulate what it returns
+		assembler.MarkLabel(loopLabel);
+		assembler.OR(CMIPS::T0, CMIPS::S1, CMIPS::S2);
+		assembler.SW(CMIPS::T0, 4, CMIPS::S0);
+		assembler.JAL(FUNCTION_ADDRESS);
+		assembler.NOP();
+		assembler.ADDU(CMIPS::S4, CMIPS::S4, CMIPS::V0);
+		assembler.ADDIU(CMIPS::S2, CMIPS::S2, PATCH_STEP);
+		assembler.ADDIU(CMIPS::S3, CMIPS::S3, 0xFFFF);
+		assembler.BNE(CMIPS::S3, CMIPS::R0, loopLabel);
+		assembler.NOP();
+
+		assembler.LI(CMIPS::T1, RESULT_ADDRESS);
+		assembler.SW(CMIPS::S4, 0, CMIPS::T1);
+		assembler.ADDIU(CMIPS::V1, CMIPS::R0, SYSCALL_EXIT);
+		assembler.SYSCALL();
+		assembler.NOP();
+	}
+
+	{
+		CMIPSAssembler assembler(program.data() + ((FUNCTION_ADDRESS - PROGRAM_ADDRESS) / 4));
+		assembler.JR(CMIPS::RA);
+		assembler.ADDIU(CMIPS::V0, CMIPS::R0, 0);
+	}
+
+	return program;
+}
+
+static void WriteElf(const fs::path& elfPath, const std::vector<uint32>& program)
+{
+	ELFHEADER header = {};
+	header.nId[0] = 0x7F;
+	header.nId[1] = 'E';
+	header.nId[2] = 'L';
+	header.nId[3] = 'F';
+	header.nId[4] = 1;
+	header.nId[5] = 1;
+	header.nId[6] = CELF::EV_CURRENT;
+	header.nType = CELF::ET_EXEC;
+	header.nCPU = CELF::EM_MIPS;
+	header.nVersion = CELF::EV_CURRENT;
+	header.nEntryPoint = PROGRAM_ADDRESS;
+	header.nProgHeaderStart = sizeof(ELFHEADER);
+	header.nSize = sizeof(ELFHEADER);
+	header.nProgHeaderEntrySize = sizeof(ELFPROGRAMHEADER);
+	header.nProgHeaderCount = 1;
+
+	uint32 programSize = static_cast<uint32>(program.size() * sizeof(uint32));
+
+	ELFPROGRAMHEADER programHeader = {};
+	programHeader.nType = CELF::PT_LOAD;
+	programHeader.nOffset = sizeof(ELFHEADER) + sizeof(ELFPROGRAMHEADER);
+	programHeader.nVAddress = PROGRAM_ADDRESS;
+	programHeader.nPAddress = PROGRAM_ADDRESS;
+	programHeader.nFileSize = programSize;
+	programHeader.nMemorySize = programSize;
+
+	auto stream = Framework::CreateOutputStdStream(elfPath.native());
+	stream.Write(&header, sizeof(ELFHEADER));
+	stream.Write(&programHeader, sizeof(ELFPROGRAMHEADER));
+	stream.Write(program.data(), programSize);
+}
+
+static bool ExecuteVm(unsigned int vmIndex)
+{
+	uint16 seed = static_cast<uint16>(0x100 * (vmIndex + 1));
+	uint32 expectedResult = 0;
+	for(unsigned int i = 0; i < LOOP_COUNT; i++)
+	{
+		expectedResult += seed + (i * PATCH_STEP);
+	}
+
+	auto elfPath = fs::temp_directory_path() / string_format("MultiVmTest_%d.elf", vmIndex);
+	WriteElf(elfPath, AssembleProgram(seed));
+
+	std::atomic<bool> executionOver(false);
+
+	CPS2VM virtualMachine;
+	virtualMachine.Initialize();
+	virtualMachine.Reset();
+	virtualMachine.CreateGSHandler(CGSH_Null::GetFactoryFunction());
+	auto connection = virtualMachine.m_ee->m_os->OnRequestExit.Connect(
+	    [&executionOver]() {
+		    executionOver = true;
+	    });
+	virtualMachine.m_ee->m_os->BootFromFile(elfPath);
+	virtualMachine.Resume();
+
+	auto startTime = std::chrono::steady_clock::now();
+	while(!executionOver)
+	{
+		if((std::chrono::steady_clock::now() - startTime) > std::chrono::seconds(TIMEOUT_SECONDS))
+		{
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	virtualMachine.Pause();
+
+	uint32 result = *reinterpret_cast<const uint32*>(virtualMachine.m_ee->m_ram + RESULT_ADDRESS);
+	bool succeeded = executionOver && (result == expectedResult);
+	printf("VM %d: %s (result: 0x%08X, expected: 0x%08X).\r\n",
+	       vmIndex, succeeded ? "SUCCEEDED" : "FAILED", result, expectedResult);
+
+	virtualMachine.DestroyGSHandler();
+	virtualMachine.Destroy();
+
+	fs::remove(elfPath);
+	return succeeded;
+}
+
+int main(int argc, const char** argv)
+{
+	std::atomic<unsigned int> failedCount(0);
+
+	std::vector<std::thread> threads;
+	for(unsigned int i = 0; i < VM_COUNT; i++)
+	{
+		threads.emplace_back(
+		    [i, &failedCount]() {
+			    try
+			    {
+				    if(!ExecuteVm(i))
+				    {
+					    failedCount++;
+				    }
+			    }
+			    catch(const std::exception& exception)
+			    {
+				    printf("VM %d: FAILED (%s).\r\n", i, exception.what());
+				    failedCount++;
+			    }
+		    });
+	}
+	for(auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	return (failedCount == 0) ? 0 : -1;
+}
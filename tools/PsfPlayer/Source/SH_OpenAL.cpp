@@ -1,6 +1,7 @@
 #include "SH_OpenAL.h"
 #include "alloca_def.h"
 #include <assert.h>
+#include <algorithm>
 
 //#define LOGGING
 #define SAMPLE_RATE 44100
@@ -47,6 +48,8 @@ void CSH_OpenAL::Reset()
 	CHECK_AL_ERROR();
 	m_availableBuffers.clear();
 	m_availableBuffers.insert(m_availableBuffers.begin(), m_bufferNames, m_bufferNames + MAX_BUFFERS);
+	m_queuedBufferSizes.clear();
+	m_playing = false;
 }
 
 void CSH_OpenAL::RecycleBuffers()
@@ -59,6 +62,8 @@ void CSH_OpenAL::RecycleBuffers()
 		alSourceUnqueueBuffers(m_source, bufferCount, bufferNames);
 		CHECK_AL_ERROR();
 		m_availableBuffers.insert(m_availableBuffers.begin(), bufferNames, bufferNames + bufferCount);
+		assert(m_queuedBufferSizes.size() >= bufferCount);
+		m_queuedBufferSizes.erase(m_queuedBufferSizes.begin(), m_queuedBufferSizes.begin() + bufferCount);
 	}
 }
 
@@ -79,11 +84,43 @@ void CSH_OpenAL::Write(int16* samples, unsigned int sampleCount, unsigned int sa
 
 	alSourceQueueBuffers(m_source, 1, &buffer);
 	CHECK_AL_ERROR();
+	m_queuedBufferSizes.push_back(sampleCount);
 
 	ALint sourceState = m_source.GetState();
 	if(sourceState != AL_PLAYING)
 	{
+		if(m_playing)
+		{
+			//Source stopped because it played everything that was queued
+			m_underrunCount++;
+		}
+		m_playing = true;
 		m_source.Play();
 		assert(m_source.GetState() == AL_PLAYING);
 	}
 }
+
+int CSH_OpenAL::GetQueuedSampleCount()
+{
+	if(m_source.GetState() != AL_PLAYING)
+	{
+		return 0;
+	}
+
+	//Sample offset is relative to the first buffer still in the queue
+	ALint sampleOffset = 0;
+	alGetSourcei(m_source, AL_SAMPLE_OFFSET, &sampleOffset);
+	CHECK_AL_ERROR();
+
+	int queuedSampleCount = 0;
+	for(auto bufferSize : m_queuedBufferSizes)
+	{
+		queuedSampleCount += bufferSize;
+	}
+	return std::max(queuedSampleCount - (sampleOffset * 2), 0);
+}
+
+uint32 CSH_OpenAL::GetUnderrunCount()
+{
+	return m_underrunCount;
+}
@@ -19,9 +19,12 @@ public:
 	void Write(int16*, unsigned int, unsigned int) override;
 	bool HasFreeBuffers() override;
 	void RecycleBuffers() override;
+	int GetQueuedSampleCount() override;
+	uint32 GetUnderrunCount() override;
 
 private:
 	typedef std::deque<ALuint> BufferList;
+	typedef std::deque<unsigned int> BufferSizeList;
 
 	enum
 	{
@@ -33,6 +36,9 @@ private:
 	OpenAl::CSource m_source;
 
 	BufferList m_availableBuffers;
+	BufferSizeList m_queuedBufferSizes;
+	bool m_playing = false;
+	uint32 m_underrunCount = 0;
 	uint64 m_lastUpdateTime;
 	bool m_mustSync;
 	ALuint m_bufferNames[MAX_BUFFERS];
@@ -17,5 +17,17 @@ public:
 	virtual bool HasFreeBuffers() = 0;
 	virtual void RecycleBuffers() = 0;
 
+	//Number of samples (both channels) waiting to be played, -1 if unknown
+	virtual int GetQueuedSampleCount()
+	{
+		return -1;
+	}
+
+	//Number of times playback ran out of samples
+	virtual uint32 GetUnderrunCount()
+	{
+		return 0;
+	}
+
 private:
 };
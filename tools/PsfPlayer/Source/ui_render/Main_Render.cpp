@@ -0,0 +1,267 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <thread>
+#include "filesystem_def.h"
+#include "PsfVm.h"
+#include "PsfLoader.h"
+#include "PsfTags.h"
+#include "Playlist.h"
+#include "StdStreamUtils.h"
+#include "ThreadPool.h"
+#include "SH_Capture.h"
+
+//Iop and Psp subsystems both write stereo samples at this rate
+#define SAMPLE_RATE (44100)
+#define CHANNEL_COUNT (2)
+#define DEFAULT_LENGTH (180.0)
+#define DEFAULT_FADE (10.0)
+//VM is considered stuck if it doesn't output anything for this long (in seconds)
+#define STALL_TIMEOUT (10)
+
+struct RENDER_JOB
+{
+	fs::path inputPath;
+	fs::path outputPath;
+};
+typedef std::vector<RENDER_JOB> RenderJobList;
+
+static void WriteWav(const fs::path& outputPath, const CSH_Capture::SampleArray& samples)
+{
+	auto stream = Framework::CreateOutputStdStream(outputPath.native());
+	uint32 dataSize = static_cast<uint32>(samples.size() * sizeof(int16));
+	const char riffSignature[4] = {'R', 'I', 'F', 'F'};
+	const char waveSignature[4] = {'W', 'A', 'V', 'E'};
+	const char fmtSignature[4] = {'f', 'm', 't', ' '};
+	const char dataSignature[4] = {'d', 'a', 't', 'a'};
+
+	stream.Write(riffSignature, 4);
+	stream.Write32(4 + 24 + 8 + dataSize);
+	stream.Write(waveSignature, 4);
+
+	stream.Write(fmtSignature, 4);
+	stream.Write32(16);
+	//AudioFormat (PCM)
+	stream.Write16(1);
+	stream.Write16(CHANNEL_COUNT);
+	stream.Write32(SAMPLE_RATE);
+	stream.Write32(SAMPLE_RATE * CHANNEL_COUNT * sizeof(int16));
+	stream.Write16(CHANNEL_COUNT * sizeof(int16));
+	stream.Write16(16);
+
+	stream.Write(dataSignature, 4);
+	stream.Write32(dataSize);
+	stream.Write(samples.data(), dataSize);
+}
+
+//Same fade out as the players: volume goes down linearly from the end of the track to the end of the fade
+static void ApplyFade(CSH_Capture::SampleArray& samples, size_t fadeStart)
+{
+	size_t frameCount = samples.size() / CHANNEL_COUNT;
+	size_t fadeStartFrame = fadeStart / CHANNEL_COUNT;
+	if(fadeStartFrame >= frameCount) return;
+	float fadeLength = static_cast<float>(frameCount - fadeStartFrame);
+	for(size_t frame = fadeStartFrame; frame < frameCount; frame++)
+	{
+		float volume = 1.0f - (static_cast<float>(frame - fadeStartFrame) / fadeLength);
+		for(unsigned int channel = 0; channel < CHANNEL_COUNT; channel++)
+		{
+			auto& sample = samples[(frame * CHANNEL_COUNT) + channel];
+			sample = static_cast<int16>(static_cast<float>(sample) * volume);
+		}
+	}
+}
+
+static size_t TimeToSampleCount(double time)
+{
+	return static_cast<size_t>(time * SAMPLE_RATE) * CHANNEL_COUNT;
+}
+
+static void Render(const RENDER_JOB& job, double defaultLength)
+{
+	auto startTime = std::chrono::steady_clock::now();
+
+	CPsfVm virtualMachine;
+	CPsfBase::TagMap tagMap;
+	CPsfLoader::LoadPsf(virtualMachine, job.inputPath.wstring(), fs::path(), &tagMap);
+
+	CPsfTags tags(tagMap);
+	try
+	{
+		virtualMachine.SetVolumeAdjust(std::stof(tags.GetTagValue("volume")));
+	}
+	catch(...)
+	{
+	}
+
+	double length = defaultLength;
+	double fade = DEFAULT_FADE;
+	if(tags.HasTag("length"))
+	{
+		length = CPsfTags::ConvertTimeString(tags.GetTagValue("length").c_str());
+	}
+	if(tags.HasTag("fade"))
+	{
+		fade = CPsfTags::ConvertTimeString(tags.GetTagValue("fade").c_str());
+	}
+
+	size_t fadeStart = TimeToSampleCount(length);
+	size_t sampleCount = fadeStart + TimeToSampleCount(fade);
+	if(sampleCount == 0)
+	{
+		throw std::runtime_error("Track has no length.");
+	}
+
+	//Capture handler never reports full buffers, VM thread runs as fast as it can
+	CSH_Capture::SampleArray samples;
+	std::promise<void> donePromise;
+	std::atomic<size_t> capturedCount(0);
+	auto doneFuture = donePromise.get_future();
+	virtualMachine.SetSpuHandler(
+	    [&]() -> CSoundHandler* {
+		    return new CSH_Capture(samples, sampleCount, donePromise, capturedCount);
+	    });
+	virtualMachine.Resume();
+	size_t lastCapturedCount = 0;
+	while(doneFuture.wait_for(std::chrono::seconds(STALL_TIMEOUT)) != std::future_status::ready)
+	{
+		size_t currentCapturedCount = capturedCount;
+		if(currentCapturedCount == lastCapturedCount)
+		{
+			virtualMachine.Pause();
+			virtualMachine.SetSpuHandler(CPsfVm::SpuHandlerFactory());
+			throw std::runtime_error("VM stopped producing samples.");
+		}
+		lastCapturedCount = currentCapturedCount;
+	}
+	virtualMachine.Pause();
+	virtualMachine.SetSpuHandler(CPsfVm::SpuHandlerFactory());
+
+	ApplyFade(samples, fadeStart);
+	WriteWav(job.outputPath, samples);
+
+	auto renderTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	double trackTime = static_cast<double>(sampleCount / CHANNEL_COUNT) / SAMPLE_RATE;
+	printf("Rendered '%s' (%.1fs of audio in %.1fs, %.1fx realtime).\r\n",
+	       job.inputPath.string().c_str(), trackTime, renderTime, trackTime / std::max(renderTime, 0.001));
+	fflush(stdout);
+}
+
+static void AddJob(RenderJobList& jobs, const fs::path& inputPath, const fs::path& outputPath)
+{
+	auto extension = inputPath.extension().string();
+	if(extension.empty() || !CPlaylist::IsLoadableExtension(extension.c_str() + 1))
+	{
+		return;
+	}
+	RENDER_JOB job;
+	job.inputPath = inputPath;
+	job.outputPath = outputPath / inputPath.filename();
+	job.outputPath.replace_extension(".wav");
+	jobs.push_back(job);
+}
+
+static RenderJobList GatherJobs(const std::vector<fs::path>& inputPaths, const fs::path& outputPath)
+{
+	RenderJobList jobs;
+	for(const auto& inputPath : inputPaths)
+	{
+		if(fs::is_directory(inputPath))
+		{
+			for(const auto& entry : fs::recursive_directory_iterator(inputPath))
+			{
+				if(!fs::is_regular_file(entry.path())) continue;
+				//Keep the directory layout of the input
+				auto relativeParent = fs::relative(entry.path().parent_path(), inputPath);
+				auto jobOutputPath = outputPath / relativeParent;
+				AddJob(jobs, entry.path(), jobOutputPath);
+			}
+		}
+		else
+		{
+			AddJob(jobs, inputPath, outputPath);
+		}
+	}
+	return jobs;
+}
+
+void PrintUsage()
+{
+	printf("PsfRender usage:\r\n");
+	printf("\tPsfRender [-j JobCount] [-l DefaultLength] [OutputPath] [InputFile|InputDirectory]...\r\n");
+	printf("\tJobCount is the number of tracks rendered in parallel (number of cores by default).\r\n");
+	printf("\tDefaultLength (in seconds) is used for tracks without a length tag.\r\n");
+}
+
+int main(int argc, char** argv)
+{
+	//Each thread compiles blocks with its own jitter, VMs can run side by side
+	unsigned int jobCount = std::max<unsigned int>(std::thread::hardware_concurrency(), 1);
+	double defaultLength = DEFAULT_LENGTH;
+
+	int argIndex = 1;
+	for(; argIndex < argc; argIndex++)
+	{
+		if(!strcmp(argv[argIndex], "-j") && ((argIndex + 1) < argc))
+		{
+			jobCount = std::max(atoi(argv[++argIndex]), 1);
+		}
+		else if(!strcmp(argv[argIndex], "-l") && ((argIndex + 1) < argc))
+		{
+			defaultLength = atof(argv[++argIndex]);
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if((argc - argIndex) < 2)
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	fs::path outputPath = argv[argIndex++];
+	std::vector<fs::path> inputPaths(argv + argIndex, argv + argc);
+
+	RenderJobList jobs;
+	try
+	{
+		jobs = GatherJobs(inputPaths, outputPath);
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Failed to gather input files: %s\r\n", exception.what());
+		return -1;
+	}
+
+	std::atomic<unsigned int> failedCount(0);
+	{
+		//One VM per job, each one running on its own thread
+		Framework::CThreadPool threadPool(jobCount);
+		for(const auto& job : jobs)
+		{
+			threadPool.Enqueue(
+			    [&job, &failedCount, defaultLength]() {
+				    try
+				    {
+					    fs::create_directories(job.outputPath.parent_path());
+					    Render(job, defaultLength);
+				    }
+				    catch(const std::exception& exception)
+				    {
+					    printf("Failed to render '%s', reason: '%s'.\r\n",
+					           job.inputPath.string().c_str(), exception.what());
+					    fflush(stdout);
+					    failedCount++;
+				    }
+			    });
+		}
+	}
+
+	printf("Rendered %d file(s), %d failure(s).\r\n",
+	       static_cast<int>(jobs.size() - failedCount), static_cast<int>(failedCount));
+	return (failedCount == 0) ? 0 : -1;
+}
@@ -0,0 +1,37 @@
+#include <algorithm>
+#include "SH_Capture.h"
+
+CSH_Capture::CSH_Capture(SampleArray& samples, size_t sampleCount, std::promise<void>& donePromise, std::atomic<size_t>& capturedCount)
+    : m_samples(samples)
+    , m_sampleCount(sampleCount)
+    , m_donePromise(donePromise)
+    , m_capturedCount(capturedCount)
+{
+	m_samples.reserve(sampleCount);
+}
+
+void CSH_Capture::Reset()
+{
+}
+
+void CSH_Capture::Write(int16* samples, unsigned int sampleCount, unsigned int sampleRate)
+{
+	if(m_done) return;
+	size_t copyCount = std::min<size_t>(sampleCount, m_sampleCount - m_samples.size());
+	m_samples.insert(m_samples.end(), samples, samples + copyCount);
+	m_capturedCount = m_samples.size();
+	if(m_samples.size() == m_sampleCount)
+	{
+		m_done = true;
+		m_donePromise.set_value();
+	}
+}
+
+bool CSH_Capture::HasFreeBuffers()
+{
+	return true;
+}
+
+void CSH_Capture::RecycleBuffers()
+{
+}
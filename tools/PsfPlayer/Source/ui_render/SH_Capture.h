@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <vector>
+#include "SoundHandler.h"
+
+//Sound handler that never throttles the VM and keeps everything that is written
+//to it until a given amount of samples was captured.
+class CSH_Capture : public CSoundHandler
+{
+public:
+	typedef std::vector<int16> SampleArray;
+
+	CSH_Capture(SampleArray&, size_t, std::promise<void>&, std::atomic<size_t>&);
+	virtual ~CSH_Capture() = default;
+
+	void Reset() override;
+	void Write(int16*, unsigned int, unsigned int) override;
+	bool HasFreeBuffers() override;
+	void RecycleBuffers() override;
+
+private:
+	SampleArray& m_samples;
+	size_t m_sampleCount = 0;
+	std::promise<void>& m_donePromise;
+	std::atomic<size_t>& m_capturedCount;
+	bool m_done = false;
+};
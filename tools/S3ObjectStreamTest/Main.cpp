@@ -0,0 +1,153 @@
+#include <cstdio>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "s3stream/S3ObjectStream.h"
+
+//Checks that a read waiting on a queued prefetch gets its window fetched
+//before the other prefetches that were queued ahead of it
+
+static const uint64 g_windowSize = 0x40000;
+static const uint64 g_objectSize = g_windowSize * 12;
+static const uint64 g_seekWindowIndex = 7;
+
+static uint8 GetObjectByte(uint64 position)
+{
+	return static_cast<uint8>((position * 7) ^ (position >> 12));
+}
+
+//Answers range requests only once they're allowed, so the test controls what the fetch thread is doing
+class CGatedFetcher : public CS3ObjectStream::CObjectFetcher
+{
+public:
+	typedef std::pair<uint64, uint64> Range;
+
+	OBJECT_INFO GetObjectInfo() override
+	{
+		OBJECT_INFO objectInfo;
+		objectInfo.size = g_objectSize;
+		return objectInfo;
+	}
+
+	std::vector<uint8> GetObjectRange(uint64 begin, uint64 end) override
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			size_t callIndex = m_ranges.size();
+			m_ranges.push_back(std::make_pair(begin, end));
+			m_condition.notify_all();
+			m_condition.wait(lock, [&]() { return callIndex < m_allowedCount; });
+		}
+		std::vector<uint8> result(end - begin + 1);
+		for(uint64 i = 0; i < result.size(); i++)
+		{
+			result[i] = GetObjectByte(begin + i);
+		}
+		return result;
+	}
+
+	void Allow(size_t allowedCount)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_allowedCount = allowedCount;
+		m_condition.notify_all();
+	}
+
+	Range WaitForCall(size_t callIndex)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [&]() { return callIndex < m_ranges.size(); });
+		return m_ranges[callIndex];
+	}
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::vector<Range> m_ranges;
+	size_t m_allowedCount = 0;
+};
+
+static bool CheckCase(const char* caseName, bool condition)
+{
+	if(!condition)
+	{
+		printf("%s: failed.\r\n", caseName);
+	}
+	return condition;
+}
+
+static bool CheckData(const std::vector<uint8>& data, uint64 position)
+{
+	for(uint64 i = 0; i < data.size(); i++)
+	{
+		if(data[i] != GetObjectByte(position + i)) return false;
+	}
+	return true;
+}
+
+int main(int argc, const char** argv)
+{
+	auto fetcher = new CGatedFetcher();
+	CS3ObjectStream stream(CS3ObjectStream::ObjectFetcherPtr(fetcher), 1);
+
+	unsigned int failedCount = 0;
+
+	//First read is a miss, starting from the beginning also queues prefetches for the following windows
+	fetcher->Allow(1);
+	{
+		std::vector<uint8> data(0x100);
+		stream.Read(data.data(), data.size());
+		if(!CheckCase("FirstRead", CheckData(data, 0)))
+		{
+			failedCount++;
+		}
+	}
+
+	//Fetch thread picks up the first prefetch request and stays busy with it
+	fetcher->WaitForCall(1);
+
+	//Reader jumps to a window that is queued behind that request
+	std::vector<uint8> seekData(0x100);
+	uint64 seekPosition = (g_seekWindowIndex * g_windowSize) + 0x80;
+	std::thread readerThread(
+	    [&]() {
+		    stream.Seek(seekPosition, Framework::STREAM_SEEK_SET);
+		    stream.Read(seekData.data(), seekData.size());
+	    });
+
+	//Window was already known to the stream, wait for the reader to register its hit
+	while(stream.GetStats().hitCount == 0)
+	{
+		std::this_thread::yield();
+	}
+
+	fetcher->Allow(2);
+	auto nextRange = fetcher->WaitForCall(2);
+	uint64 seekWindowBegin = g_seekWindowIndex * g_windowSize;
+	if(!CheckCase("Promoted", (nextRange.first == seekWindowBegin) && (nextRange.second == (seekWindowBegin + g_windowSize - 1))))
+	{
+		failedCount++;
+	}
+
+	fetcher->Allow(~static_cast<size_t>(0));
+	readerThread.join();
+	if(!CheckCase("SeekRead", CheckData(seekData, seekPosition)))
+	{
+		failedCount++;
+	}
+
+	{
+		//Remaining windows are still fetched once the reader goes back to them
+		std::vector<uint8> data(g_windowSize * 3);
+		uint64 position = (g_seekWindowIndex - 2) * g_windowSize;
+		stream.Seek(position, Framework::STREAM_SEEK_SET);
+		stream.Read(data.data(), data.size());
+		if(!CheckCase("Remaining", CheckData(data, position)))
+		{
+			failedCount++;
+		}
+	}
+
+	printf("%d failure(s).\r\n", failedCount);
+	return (failedCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+#include <cstdio>
+#include <climits>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "iop/Iop_SpuMixer.h"
+
+//Checks that mixing voices one block at a time gives the same buses as the original
+//mixer, kept below as reference, which went through every voice on each tick and
+//clamped the buses after adding each voice
+
+using namespace Iop;
+
+static const unsigned int g_voiceCount = 24;
+static const unsigned int g_blockTicks = 64;
+static const unsigned int g_blockCount = 20000;
+
+struct VOICE
+{
+	//Voice only plays between these ticks, like a voice starting or stopping within a block
+	unsigned int startTick = 0;
+	unsigned int endTick = 0;
+	bool reverb = false;
+	int16 samples[g_blockTicks];
+	uint32 adsrVolumes[g_blockTicks];
+	int16 volumesLeft[g_blockTicks];
+	int16 volumesRight[g_blockTicks];
+};
+
+struct BUSES
+{
+	int16 dryLeft[g_blockTicks] = {};
+	int16 dryRight[g_blockTicks] = {};
+	int16 reverbLeft[g_blockTicks] = {};
+	int16 reverbRight[g_blockTicks] = {};
+
+	bool operator==(const BUSES& rhs) const
+	{
+		return std::equal(std::begin(dryLeft), std::end(dryLeft), std::begin(rhs.dryLeft)) &&
+		       std::equal(std::begin(dryRight), std::end(dryRight), std::begin(rhs.dryRight)) &&
+		       std::equal(std::begin(reverbLeft), std::end(reverbLeft), std::begin(rhs.reverbLeft)) &&
+		       std::equal(std::begin(reverbRight), std::end(reverbRight), std::begin(rhs.reverbRight));
+	}
+};
+
+static void ReferenceMixSamples(int32 inputSample, int32 volumeLevel, int16* output)
+{
+	inputSample = (inputSample * volumeLevel) / 0x7FFF;
+	int32 resultSample = inputSample + static_cast<int32>(*output);
+	resultSample = std::max<int32>(resultSample, SHRT_MIN);
+	resultSample = std::min<int32>(resultSample, SHRT_MAX);
+	*output = static_cast<int16>(resultSample);
+}
+
+static void ReferenceMix(const std::vector<VOICE>& voices, BUSES& buses)
+{
+	for(unsigned int tick = 0; tick < g_blockTicks; tick++)
+	{
+		for(const auto& voice : voices)
+		{
+			if((tick < voice.startTick) || (tick >= voice.endTick)) continue;
+			int32 inputSample = static_cast<int32>(voice.samples[tick]);
+			inputSample = (inputSample * static_cast<int32>(voice.adsrVolumes[tick] >> 16)) / static_cast<int32>(0x7FFFFFFF >> 16);
+			ReferenceMixSamples(inputSample, voice.volumesLeft[tick], buses.dryLeft + tick);
+			ReferenceMixSamples(inputSample, voice.volumesRight[tick], buses.dryRight + tick);
+			if(voice.reverb)
+			{
+				ReferenceMixSamples(inputSample, voice.volumesLeft[tick], buses.reverbLeft + tick);
+				ReferenceMixSamples(inputSample, voice.volumesRight[tick], buses.reverbRight + tick);
+			}
+		}
+	}
+}
+
+static void BlockMix(std::mt19937& generator, const std::vector<VOICE>& voices, BUSES& buses)
+{
+	for(const auto& voice : voices)
+	{
+		uint16 adsrLevels[g_blockTicks];
+		for(unsigned int i = 0; i < g_blockTicks; i++)
+		{
+			adsrLevels[i] = static_cast<uint16>(voice.adsrVolumes[i] >> 16);
+		}
+		//Voices are mixed in several parts when the sample reader stops early
+		unsigned int tick = voice.startTick;
+		while(tick < voice.endTick)
+		{
+			unsigned int count = std::min<unsigned int>(voice.endTick - tick, 1 + (generator() % g_blockTicks));
+			CSpuMixer::MixVoice(buses.dryLeft + tick, buses.dryRight + tick,
+			                    voice.reverb ? buses.reverbLeft + tick : nullptr, voice.reverb ? buses.reverbRight + tick : nullptr,
+			                    voice.samples + tick, adsrLevels + tick, voice.volumesLeft + tick, voice.volumesRight + tick, count);
+			tick += count;
+		}
+	}
+}
+
+//Extremes are frequent to make the buses clip and to cover the rounding of the divisions
+static int16 PickSample(std::mt19937& generator)
+{
+	switch(generator() % 4)
+	{
+	case 0:
+		return (generator() % 2) ? SHRT_MAX : SHRT_MIN;
+	default:
+		return static_cast<int16>(generator());
+	}
+}
+
+static int16 PickVolume(std::mt19937& generator)
+{
+	switch(generator() % 4)
+	{
+	case 0:
+		return (generator() % 2) ? 0x7FFF : 0;
+	default:
+		return static_cast<int16>(generator() % 0x8000);
+	}
+}
+
+static uint32 PickAdsrVolume(std::mt19937& generator, bool decayPastZero)
+{
+	switch(generator() % 8)
+	{
+	case 0:
+		//Envelope in decay going past 0
+		if(decayPastZero) return 0x80000000 | generator();
+		return 0x7FFFFFFF;
+	case 1:
+		return 0x7FFFFFFF;
+	case 2:
+		return 0;
+	default:
+		return generator() & 0x7FFFFFFF;
+	}
+}
+
+static bool CheckCase(const char* caseName, unsigned int block, bool condition)
+{
+	if(!condition)
+	{
+		printf("%s: failed at block %d.\r\n", caseName, block);
+	}
+	return condition;
+}
+
+int main(int argc, const char** argv)
+{
+	std::mt19937 generator(0x5E12);
+
+	unsigned int failedCount = 0;
+	for(unsigned int block = 0; block < g_blockCount; block++)
+	{
+		std::vector<VOICE> voices(g_voiceCount);
+		for(auto& voice : voices)
+		{
+			bool wholeBlock = (generator() % 2) != 0;
+			voice.startTick = wholeBlock ? 0 : (generator() % g_blockTicks);
+			voice.endTick = wholeBlock ? g_blockTicks : (voice.startTick + (generator() % (g_blockTicks - voice.startTick + 1)));
+			voice.reverb = (generator() % 2) != 0;
+			//Envelope and sweeps change over the block, fixed volumes don't
+			bool fixedVolumes = (generator() % 2) != 0;
+			bool decayPastZero = (generator() % 16) == 0;
+			int16 volumeLeft = PickVolume(generator);
+			int16 volumeRight = PickVolume(generator);
+			for(unsigned int i = 0; i < g_blockTicks; i++)
+			{
+				voice.samples[i] = PickSample(generator);
+				voice.adsrVolumes[i] = PickAdsrVolume(generator, decayPastZero);
+				voice.volumesLeft[i] = fixedVolumes ? volumeLeft : PickVolume(generator);
+				voice.volumesRight[i] = fixedVolumes ? volumeRight : PickVolume(generator);
+			}
+		}
+
+		BUSES referenceBuses;
+		ReferenceMix(voices, referenceBuses);
+
+		BUSES buses;
+		BlockMix(generator, voices, buses);
+
+		if(!CheckCase("MixVoice", block, buses == referenceBuses))
+		{
+			failedCount++;
+			break;
+		}
+	}
+
+	printf("%d failure(s).\r\n", failedCount);
+	return (failedCount == 0) ? 0 : 1;
+}
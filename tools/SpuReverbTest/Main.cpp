@@ -0,0 +1,271 @@
+#include <cstdio>
+#include <climits>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "iop/Iop_SpuBase.h"
+#include "iop/Iop_SpuReverb.h"
+
+//Checks that the block based reverb produces the same output and the same work area
+//contents as the original sample by sample implementation kept below as reference
+
+using namespace Iop;
+
+class CReferenceReverb
+{
+public:
+	CReferenceReverb(uint8* ram, const uint32* registers, uint32 workAddrStart, uint32 workAddrEnd)
+	    : m_ram(ram)
+	    , m_registers(registers)
+	    , m_workAddrStart(workAddrStart)
+	    , m_workAddrEnd(workAddrEnd)
+	{
+	}
+
+	void Process(int16* samples, const int16* inputLeft, const int16* inputRight, unsigned int tickCount, uint32& currAddr, int& reverbTicks)
+	{
+		m_currAddr = currAddr;
+		for(unsigned int i = 0; i < tickCount; i++)
+		{
+			if(reverbTicks & 1)
+			{
+				float input_sample_l = static_cast<float>(inputLeft[i]) * 0.5f;
+				float input_sample_r = static_cast<float>(inputRight[i]) * 0.5f;
+
+				float irr_coef = GetCoef(CSpuBase::IIR_COEF);
+				float in_coef_l = GetCoef(CSpuBase::IN_COEF_L);
+				float in_coef_r = GetCoef(CSpuBase::IN_COEF_R);
+
+				float iir_input_a0 = GetSample(GetOffset(CSpuBase::ACC_SRC_A0)) * irr_coef + input_sample_l * in_coef_l;
+				float iir_input_a1 = GetSample(GetOffset(CSpuBase::ACC_SRC_A1)) * irr_coef + input_sample_r * in_coef_r;
+				float iir_input_b0 = GetSample(GetOffset(CSpuBase::ACC_SRC_B0)) * irr_coef + input_sample_l * in_coef_l;
+				float iir_input_b1 = GetSample(GetOffset(CSpuBase::ACC_SRC_B1)) * irr_coef + input_sample_r * in_coef_r;
+
+				float iir_alpha = GetCoef(CSpuBase::IIR_ALPHA);
+
+				float iir_a0 = iir_input_a0 * iir_alpha + GetSample(GetOffset(CSpuBase::IIR_DEST_A0)) * (1.0f - iir_alpha);
+				float iir_a1 = iir_input_a1 * iir_alpha + GetSample(GetOffset(CSpuBase::IIR_DEST_A1)) * (1.0f - iir_alpha);
+				float iir_b0 = iir_input_b0 * iir_alpha + GetSample(GetOffset(CSpuBase::IIR_DEST_B0)) * (1.0f - iir_alpha);
+				float iir_b1 = iir_input_b1 * iir_alpha + GetSample(GetOffset(CSpuBase::IIR_DEST_B1)) * (1.0f - iir_alpha);
+
+				SetSample(GetOffset(CSpuBase::IIR_DEST_A0) + 2, iir_a0);
+				SetSample(GetOffset(CSpuBase::IIR_DEST_A1) + 2, iir_a1);
+				SetSample(GetOffset(CSpuBase::IIR_DEST_B0) + 2, iir_b0);
+				SetSample(GetOffset(CSpuBase::IIR_DEST_B1) + 2, iir_b1);
+
+				float acc_coef_a = GetCoef(CSpuBase::ACC_COEF_A);
+				float acc_coef_b = GetCoef(CSpuBase::ACC_COEF_B);
+				float acc_coef_c = GetCoef(CSpuBase::ACC_COEF_C);
+				float acc_coef_d = GetCoef(CSpuBase::ACC_COEF_D);
+
+				float acc0 =
+				    GetSample(GetOffset(CSpuBase::ACC_SRC_A0)) * acc_coef_a +
+				    GetSample(GetOffset(CSpuBase::ACC_SRC_B0)) * acc_coef_b +
+				    GetSample(GetOffset(CSpuBase::ACC_SRC_C0)) * acc_coef_c +
+				    GetSample(GetOffset(CSpuBase::ACC_SRC_D0)) * acc_coef_d;
+
+				float acc1 =
+				    GetSample(GetOffset(CSpuBase::ACC_SRC_A1)) * acc_coef_a +
+				    GetSample(GetOffset(CSpuBase::ACC_SRC_B1)) * acc_coef_b +
+				    GetSample(GetOffset(CSpuBase::ACC_SRC_C1)) * acc_coef_c +
+				    GetSample(GetOffset(CSpuBase::ACC_SRC_D1)) * acc_coef_d;
+
+				float fb_a0 = GetSample(GetOffset(CSpuBase::MIX_DEST_A0) - GetOffset(CSpuBase::FB_SRC_A));
+				float fb_a1 = GetSample(GetOffset(CSpuBase::MIX_DEST_A1) - GetOffset(CSpuBase::FB_SRC_A));
+				float fb_b0 = GetSample(GetOffset(CSpuBase::MIX_DEST_B0) - GetOffset(CSpuBase::FB_SRC_B));
+				float fb_b1 = GetSample(GetOffset(CSpuBase::MIX_DEST_B1) - GetOffset(CSpuBase::FB_SRC_B));
+
+				float fb_alpha = GetCoef(CSpuBase::FB_ALPHA);
+				float fb_x = GetCoef(CSpuBase::FB_X);
+
+				SetSample(GetOffset(CSpuBase::MIX_DEST_A0), acc0 - fb_a0 * fb_alpha);
+				SetSample(GetOffset(CSpuBase::MIX_DEST_A1), acc1 - fb_a1 * fb_alpha);
+				SetSample(GetOffset(CSpuBase::MIX_DEST_B0), (fb_alpha * acc0) - fb_a0 * -fb_alpha - fb_b0 * fb_x);
+				SetSample(GetOffset(CSpuBase::MIX_DEST_B1), (fb_alpha * acc1) - fb_a1 * -fb_alpha - fb_b1 * fb_x);
+
+				m_currAddr += 2;
+				if(m_currAddr >= m_workAddrEnd)
+				{
+					m_currAddr = m_workAddrStart;
+				}
+			}
+
+			if(m_workAddrStart != 0)
+			{
+				float sampleL = 0.333f * (GetSample(GetOffset(CSpuBase::MIX_DEST_A0)) + GetSample(GetOffset(CSpuBase::MIX_DEST_B0)));
+				float sampleR = 0.333f * (GetSample(GetOffset(CSpuBase::MIX_DEST_A1)) + GetSample(GetOffset(CSpuBase::MIX_DEST_B1)));
+				MixSample(sampleL, samples + 0);
+				MixSample(sampleR, samples + 1);
+			}
+
+			reverbTicks++;
+			samples += 2;
+		}
+		currAddr = m_currAddr;
+	}
+
+private:
+	uint32 GetOffset(unsigned int registerId) const
+	{
+		return m_registers[registerId];
+	}
+
+	float GetCoef(unsigned int registerId) const
+	{
+		int16 value = static_cast<int16>(m_registers[registerId]);
+		return static_cast<float>(value) / static_cast<float>(0x8000);
+	}
+
+	uint32 GetAddress(uint32 offset) const
+	{
+		uint32 absoluteAddress = m_currAddr + offset;
+		if(absoluteAddress >= m_workAddrEnd)
+		{
+			absoluteAddress = m_workAddrStart + ((absoluteAddress - m_workAddrEnd) % (m_workAddrEnd - m_workAddrStart));
+		}
+		return absoluteAddress;
+	}
+
+	float GetSample(uint32 offset) const
+	{
+		return static_cast<float>(*reinterpret_cast<int16*>(m_ram + GetAddress(offset)));
+	}
+
+	void SetSample(uint32 offset, float value)
+	{
+		value = std::max<float>(value, SHRT_MIN);
+		value = std::min<float>(value, SHRT_MAX);
+		*reinterpret_cast<int16*>(m_ram + GetAddress(offset)) = static_cast<int16>(value);
+	}
+
+	static void MixSample(float sample, int16* output)
+	{
+		int32 resultSample = static_cast<int32>(sample) + static_cast<int32>(*output);
+		resultSample = std::max<int32>(resultSample, SHRT_MIN);
+		resultSample = std::min<int32>(resultSample, SHRT_MAX);
+		*output = static_cast<int16>(resultSample);
+	}
+
+	uint8* m_ram = nullptr;
+	const uint32* m_registers = nullptr;
+	uint32 m_workAddrStart = 0;
+	uint32 m_workAddrEnd = 0;
+	uint32 m_currAddr = 0;
+};
+
+static const uint32 g_ramSize = 0x200000;
+static const unsigned int g_caseCount = 200;
+static const unsigned int g_blockCount = 64;
+static const unsigned int g_maxBlockTicks = 64;
+
+static bool RunCase(unsigned int caseIndex)
+{
+	std::mt19937 random(caseIndex);
+
+	uint32 registers[CSpuBase::REVERB_REG_COUNT];
+	for(unsigned int i = 0; i < CSpuBase::REVERB_REG_COUNT; i++)
+	{
+		registers[i] = random() & 0xFFFF;
+	}
+
+	//Offsets are in bytes, some of them can go around the work area more than once
+	for(unsigned int i = 0; i < CSpuBase::REVERB_PARAM_COUNT; i++)
+	{
+		if(CSpuBase::g_reverbParamIsAddress[i])
+		{
+			registers[i] = (random() & 0xFFFF) * 8;
+		}
+	}
+
+	uint32 workAddrStart = ((random() % 0x400) + 1) * 0x100;
+	uint32 workAddrSize = ((random() % 0x100) + 0x10) * 0x100;
+	if((caseIndex % 4) == 0)
+	{
+		workAddrSize = ((random() % 0x10) + 1) * 0x10000;
+	}
+	if((caseIndex % 16) == 1)
+	{
+		workAddrStart = 0;
+	}
+	uint32 workAddrEnd = workAddrStart + workAddrSize;
+
+	uint32 currAddr = workAddrStart + ((random() % (workAddrSize / 2)) * 2);
+	if((caseIndex % 16) == 2)
+	{
+		//Work area was shrunk under the current address
+		currAddr = workAddrEnd + ((random() % 0x100) * 2);
+	}
+	if((caseIndex % 8) == 3)
+	{
+		//Make a feedback tap go through address 0 after a few steps
+		registers[CSpuBase::FB_SRC_A] = registers[CSpuBase::MIX_DEST_A0] + currAddr + ((random() % 0x20) * 8);
+	}
+	int reverbTicks = random() % 2;
+
+	std::vector<uint8> ram(g_ramSize);
+	for(uint32 address = workAddrStart; address < workAddrEnd; address += 4)
+	{
+		*reinterpret_cast<uint32*>(ram.data() + address) = random();
+	}
+	auto referenceRam = ram;
+	uint32 referenceCurrAddr = currAddr;
+	int referenceReverbTicks = reverbTicks;
+
+	for(unsigned int block = 0; block < g_blockCount; block++)
+	{
+		unsigned int blockTicks = (random() % g_maxBlockTicks) + 1;
+
+		int16 inputLeft[g_maxBlockTicks];
+		int16 inputRight[g_maxBlockTicks];
+		int16 samples[g_maxBlockTicks * 2];
+		for(unsigned int i = 0; i < blockTicks; i++)
+		{
+			inputLeft[i] = static_cast<int16>(random());
+			inputRight[i] = static_cast<int16>(random());
+			samples[(i * 2) + 0] = static_cast<int16>(random());
+			samples[(i * 2) + 1] = static_cast<int16>(random());
+		}
+
+		int16 referenceSamples[g_maxBlockTicks * 2];
+		std::copy(samples, samples + (blockTicks * 2), referenceSamples);
+
+		CReferenceReverb referenceReverb(referenceRam.data(), registers, workAddrStart, workAddrEnd);
+		referenceReverb.Process(referenceSamples, inputLeft, inputRight, blockTicks, referenceCurrAddr, referenceReverbTicks);
+
+		CSpuReverb reverb(ram.data(), registers, workAddrStart, workAddrEnd);
+		reverb.Process(samples, inputLeft, inputRight, blockTicks, currAddr, reverbTicks);
+
+		if(!std::equal(samples, samples + (blockTicks * 2), referenceSamples))
+		{
+			printf("Case %d, block %d: output samples mismatch.\r\n", caseIndex, block);
+			return false;
+		}
+		if((currAddr != referenceCurrAddr) || (reverbTicks != referenceReverbTicks))
+		{
+			printf("Case %d, block %d: state mismatch.\r\n", caseIndex, block);
+			return false;
+		}
+	}
+
+	if(ram != referenceRam)
+	{
+		printf("Case %d: work area mismatch.\r\n", caseIndex);
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, const char** argv)
+{
+	unsigned int failedCount = 0;
+	for(unsigned int i = 0; i < g_caseCount; i++)
+	{
+		if(!RunCase(i))
+		{
+			failedCount++;
+		}
+	}
+	printf("%d/%d cases passed.\r\n", g_caseCount - failedCount, g_caseCount);
+	return (failedCount == 0) ? 0 : 1;
+}
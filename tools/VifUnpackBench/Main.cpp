@@ -0,0 +1,123 @@
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "MIPS.h"
+#include "Ps2Const.h"
+#include "ee/DMAC.h"
+#include "ee/INTC.h"
+#include "ee/GIF.h"
+#include "ee/Vif.h"
+#include "ee/Vpu.h"
+
+//Measures VIF UNPACK throughput for every data format, with and without write masking
+//Usage: VifUnpackBench [iteration count]
+
+static const uint32 g_unpackCountPerPacket = 64;
+
+struct UNPACK_FORMAT
+{
+	const char* name;
+	uint8 dataType;
+	uint32 vectorSize;
+};
+
+static const UNPACK_FORMAT g_formats[] =
+{
+	{"S-32", 0x00, 4},
+	{"S-16", 0x01, 2},
+	{"S-8", 0x02, 1},
+	{"V2-32", 0x04, 8},
+	{"V2-16", 0x05, 4},
+	{"V2-8", 0x06, 2},
+	{"V3-32", 0x08, 12},
+	{"V3-16", 0x09, 6},
+	{"V3-8", 0x0A, 3},
+	{"V4-32", 0x0C, 16},
+	{"V4-16", 0x0D, 8},
+	{"V4-8", 0x0E, 4},
+	{"V4-5", 0x0F, 2},
+};
+
+static double GetElapsedSeconds(const std::chrono::steady_clock::time_point& startTime)
+{
+	auto elapsed = std::chrono::steady_clock::now() - startTime;
+	return std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+}
+
+//Writes a packet made of cycle/mode/mask setup followed by full 256 vector UNPACKs and returns its size in qwords
+static uint32 WritePacket(uint8* ram, const UNPACK_FORMAT& format, bool useMask, uint32 mode)
+{
+	std::vector<uint32> words;
+	words.push_back(0x01000404); //STCYCL cl = 4, wl = 4
+	words.push_back(0x05000000 | mode); //STMOD
+	words.push_back(0x20000000); //STMASK
+	words.push_back(0x1B1B1B1B);
+
+	std::mt19937 generator(format.dataType);
+	uint32 dataWordCount = (256 * format.vectorSize + 3) / 4;
+	for(uint32 i = 0; i < g_unpackCountPerPacket; i++)
+	{
+		uint32 cmd = 0x60 | format.dataType | (useMask ? 0x10 : 0);
+		words.push_back(cmd << 24);
+		for(uint32 j = 0; j < dataWordCount; j++)
+		{
+			words.push_back(generator());
+		}
+	}
+
+	while(words.size() & 3)
+	{
+		words.push_back(0);
+	}
+
+	memcpy(ram, words.data(), words.size() * sizeof(uint32));
+	return static_cast<uint32>(words.size() / 4);
+}
+
+int main(int argc, const char** argv)
+{
+	uint32 iterationCount = (argc >= 2) ? atoi(argv[1]) : 200;
+
+	CMIPS ee(MEMORYMAP_ENDIAN_LSBF);
+	CMIPS vu0(MEMORYMAP_ENDIAN_LSBF);
+	std::vector<uint8> ram(PS2::EE_RAM_SIZE);
+	std::vector<uint8> spr(PS2::EE_SPR_SIZE);
+	std::vector<uint8> vuMem0(PS2::VUMEM0SIZE);
+	std::vector<uint8> microMem0(PS2::MICROMEM0SIZE);
+	CGSHandler* gs = nullptr;
+
+	CDMAC dmac(ram.data(), spr.data(), vuMem0.data(), ee);
+	CINTC intc(dmac);
+	CGIF gif(gs, ram.data(), spr.data());
+	CVpu vpu(0, CVpu::VPUINIT(microMem0.data(), vuMem0.data(), &vu0), gif, intc, ram.data(), spr.data());
+	auto& vif = vpu.GetVif();
+
+	for(const auto& format : g_formats)
+	{
+		for(uint32 variant = 0; variant < 3; variant++)
+		{
+			bool useMask = (variant == 1);
+			uint32 mode = (variant == 2) ? 2 : 0;
+			uint32 qwc = WritePacket(ram.data(), format, useMask, mode);
+			vif.Reset();
+
+			auto startTime = std::chrono::steady_clock::now();
+			for(uint32 i = 0; i < iterationCount; i++)
+			{
+				vif.ReceiveDMA(0, qwc, 0, false);
+			}
+			double seconds = GetElapsedSeconds(startTime);
+
+			double vectorCount = static_cast<double>(iterationCount) * g_unpackCountPerPacket * 256;
+			double megabytes = (vectorCount * format.vectorSize) / (1024.0 * 1024.0);
+			static const char* variantNames[3] = {"", " masked", " diff"};
+			char name[32];
+			snprintf(name, sizeof(name), "%s%s", format.name, variantNames[variant]);
+			printf("%-14s %8.1f MB/s, %8.1f Mvectors/s\n", name, megabytes / seconds, vectorCount / (seconds * 1000000.0));
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,276 @@
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "MIPS.h"
+#include "Ps2Const.h"
+#include "ee/DMAC.h"
+#include "ee/INTC.h"
+#include "ee/GIF.h"
+#include "ee/Vif.h"
+#include "ee/Vpu.h"
+
+//Checks that the specialized UNPACK kernels write the same VU memory and row registers
+//as the per-element loop for every format, mask, mode and cycle setting, whether the
+//packet comes in one DMA transfer, in small transfers splitting vectors or through FIFO writes
+
+static const uint32 g_unpackCountPerPacket = 8;
+
+struct UNPACK_FORMAT
+{
+	const char* name;
+	uint8 dataType;
+	uint32 vectorSize;
+};
+
+static const UNPACK_FORMAT g_formats[] =
+{
+	{"S-32", 0x00, 4},
+	{"S-16", 0x01, 2},
+	{"S-8", 0x02, 1},
+	{"V2-32", 0x04, 8},
+	{"V2-16", 0x05, 4},
+	{"V2-8", 0x06, 2},
+	{"V3-32", 0x08, 12},
+	{"V3-16", 0x09, 6},
+	{"V3-8", 0x0A, 3},
+	{"V4-32", 0x0C, 16},
+	{"V4-16", 0x0D, 8},
+	{"V4-8", 0x0E, 4},
+	{"V4-5", 0x0F, 2},
+};
+
+struct CYCLE_SETTING
+{
+	uint32 cl;
+	uint32 wl;
+};
+
+static const CYCLE_SETTING g_cycleSettings[] =
+{
+	{1, 1},
+	{4, 4},
+	{4, 2},
+	{3, 1},
+	{2, 4},
+	{1, 3},
+};
+
+enum DELIVERY
+{
+	DELIVERY_DMA,
+	DELIVERY_DMA_SPLIT,
+	DELIVERY_FIFO,
+	DELIVERY_MAX,
+};
+
+static const char* g_deliveryNames[DELIVERY_MAX] = {"DMA", "split DMA", "FIFO"};
+
+class CVifContext
+{
+public:
+	CVifContext(uint8* ram)
+	    : m_ee(MEMORYMAP_ENDIAN_LSBF)
+	    , m_vu(MEMORYMAP_ENDIAN_LSBF)
+	    , m_spr(PS2::EE_SPR_SIZE)
+	    , m_vuMem(PS2::VUMEM0SIZE)
+	    , m_microMem(PS2::MICROMEM0SIZE)
+	    , m_dmac(ram, m_spr.data(), m_vuMem.data(), m_ee)
+	    , m_intc(m_dmac)
+	    , m_gif(m_gs, ram, m_spr.data())
+	    , m_vpu(0, CVpu::VPUINIT(m_microMem.data(), m_vuMem.data(), &m_vu), m_gif, m_intc, ram, m_spr.data())
+	{
+	}
+
+	CVif& GetVif()
+	{
+		return m_vpu.GetVif();
+	}
+
+	std::vector<uint8>& GetVuMemory()
+	{
+		return m_vuMem;
+	}
+
+private:
+	CMIPS m_ee;
+	CMIPS m_vu;
+	std::vector<uint8> m_spr;
+	std::vector<uint8> m_vuMem;
+	std::vector<uint8> m_microMem;
+	CGSHandler* m_gs = nullptr;
+	CDMAC m_dmac;
+	CINTC m_intc;
+	CGIF m_gif;
+	CVpu m_vpu;
+};
+
+//Amount of VU memory qwords covered by an UNPACK, skipping mode (cl > wl) leaves gaps between write cycles
+static uint32 GetDestinationSpan(uint32 num, uint32 cl, uint32 wl)
+{
+	if(cl <= wl) return num;
+	return (((num - 1) / wl) * cl) + ((num - 1) % wl) + 1;
+}
+
+//Amount of vectors read from the packet, fill mode (cl < wl) only reads cl vectors every wl writes
+static uint32 GetReadVectorCount(uint32 num, uint32 cl, uint32 wl)
+{
+	if(cl >= wl) return num;
+	return ((num / wl) * cl) + std::min(num % wl, cl);
+}
+
+//Writes cycle/mode/mask/row/col setup followed by UNPACKs of various sizes and returns the packet's size in qwords
+static uint32 WritePacket(uint8* ram, std::mt19937& generator, const UNPACK_FORMAT& format, bool useMask, uint32 mode, bool usn, const CYCLE_SETTING& cycle)
+{
+	std::vector<uint32> words;
+	words.push_back(0x01000000 | (cycle.wl << 8) | cycle.cl); //STCYCL
+	words.push_back(0x05000000 | mode); //STMOD
+	words.push_back(0x20000000); //STMASK
+	words.push_back(generator());
+	words.push_back(0x30000000); //STROW
+	for(uint32 i = 0; i < 4; i++)
+	{
+		words.push_back(generator());
+	}
+	words.push_back(0x31000000); //STCOL
+	for(uint32 i = 0; i < 4; i++)
+	{
+		words.push_back(generator());
+	}
+
+	for(uint32 i = 0; i < g_unpackCountPerPacket; i++)
+	{
+		//Destination stays within VU0 memory
+		static const uint32 vuMemQwordCount = PS2::VUMEM0SIZE / 0x10;
+		uint32 maxNum = (cycle.cl > cycle.wl) ? ((vuMemQwordCount * cycle.wl) / cycle.cl) : vuMemQwordCount;
+		uint32 num = 1 + (generator() % maxNum);
+		uint32 address = generator() % (vuMemQwordCount - GetDestinationSpan(num, cycle.cl, cycle.wl) + 1);
+		uint32 cmd = 0x60 | format.dataType | (useMask ? 0x10 : 0);
+		words.push_back((cmd << 24) | ((num & 0xFF) << 16) | (usn ? 0x4000 : 0) | address);
+
+		uint32 dataSize = GetReadVectorCount(num, cycle.cl, cycle.wl) * format.vectorSize;
+		uint32 dataWordCount = (dataSize + 3) / 4;
+		for(uint32 j = 0; j < dataWordCount; j++)
+		{
+			words.push_back(generator());
+		}
+	}
+
+	while(words.size() & 3)
+	{
+		words.push_back(0);
+	}
+
+	memcpy(ram, words.data(), words.size() * sizeof(uint32));
+	return static_cast<uint32>(words.size() / 4);
+}
+
+static bool SendPacket(CVif& vif, const uint8* ram, uint32 qwc, DELIVERY delivery, std::mt19937& generator)
+{
+	switch(delivery)
+	{
+	case DELIVERY_DMA:
+		return vif.ReceiveDMA(0, qwc, 0, false) == qwc;
+	case DELIVERY_DMA_SPLIT:
+	{
+		//Transfers of 1 to 3 qwords, vectors end up split between transfers
+		uint32 position = 0;
+		uint32 available = 0;
+		while(position != qwc)
+		{
+			available = std::min<uint32>(qwc, available + 1 + (generator() % 3));
+			uint32 processed = vif.ReceiveDMA(position * 0x10, available - position, 0, false);
+			if((processed == 0) && (available == qwc)) return false;
+			position += processed;
+		}
+		return true;
+	}
+	case DELIVERY_FIFO:
+		for(uint32 i = 0; i < qwc * 4; i++)
+		{
+			uint32 word = 0;
+			memcpy(&word, ram + (i * 4), 4);
+			vif.SetRegister(CVif::VIF0_FIFO_START + ((i & 3) * 4), word);
+		}
+		return true;
+	default:
+		return false;
+	}
+}
+
+static std::vector<uint32> GetRowRegisters(CVif& vif)
+{
+	std::vector<uint32> result;
+	for(uint32 i = 0; i < 4; i++)
+	{
+		result.push_back(vif.GetRegister(CVif::VIF0_R0 + (i * 0x10)));
+	}
+	return result;
+}
+
+int main(int argc, const char** argv)
+{
+	std::vector<uint8> ram(PS2::EE_RAM_SIZE);
+
+	CVifContext referenceContext(ram.data());
+	CVifContext fastContext(ram.data());
+	referenceContext.GetVif().SetFastUnpackEnabled(false);
+	fastContext.GetVif().SetFastUnpackEnabled(true);
+
+	unsigned int failedCount = 0;
+	uint32 seed = 0;
+
+	for(const auto& format : g_formats)
+	{
+		for(const auto& cycle : g_cycleSettings)
+		{
+			for(uint32 variant = 0; variant < 12; variant++)
+			{
+				bool useMask = (variant & 1) != 0;
+				bool usn = (variant & 2) != 0;
+				uint32 mode = variant / 4;
+
+				std::mt19937 packetGenerator(seed++);
+				uint32 qwc = WritePacket(ram.data(), packetGenerator, format, useMask, mode, usn, cycle);
+
+				//VU memory starts with the same garbage so that masked out fields can be checked
+				std::vector<uint8> initialVuMem(PS2::VUMEM0SIZE);
+				for(auto& value : initialVuMem)
+				{
+					value = static_cast<uint8>(packetGenerator());
+				}
+
+				auto& referenceVif = referenceContext.GetVif();
+				referenceVif.Reset();
+				referenceContext.GetVuMemory() = initialVuMem;
+				std::mt19937 referenceGenerator(seed);
+				bool referenceSent = SendPacket(referenceVif, ram.data(), qwc, DELIVERY_DMA, referenceGenerator);
+				auto referenceRows = GetRowRegisters(referenceVif);
+
+				for(uint32 delivery = 0; delivery < DELIVERY_MAX; delivery++)
+				{
+					auto& fastVif = fastContext.GetVif();
+					fastVif.Reset();
+					fastContext.GetVuMemory() = initialVuMem;
+					std::mt19937 deliveryGenerator(seed);
+					bool sent = SendPacket(fastVif, ram.data(), qwc, static_cast<DELIVERY>(delivery), deliveryGenerator);
+
+					bool matches =
+					    referenceSent && sent &&
+					    (fastContext.GetVuMemory() == referenceContext.GetVuMemory()) &&
+					    (GetRowRegisters(fastVif) == referenceRows) &&
+					    (fastVif.GetRegister(CVif::VIF0_NUM) == referenceVif.GetRegister(CVif::VIF0_NUM));
+					if(!matches)
+					{
+						printf("%s, cl = %d, wl = %d, mask = %d, mode = %d, usn = %d, %s: failed.\r\n",
+						       format.name, cycle.cl, cycle.wl, useMask, mode, usn, g_deliveryNames[delivery]);
+						failedCount++;
+					}
+				}
+			}
+		}
+	}
+
+	printf("%d failure(s).\r\n", failedCount);
+	return (failedCount == 0) ? 0 : 1;
+}